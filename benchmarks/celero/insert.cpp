@@ -5,8 +5,10 @@
 #include "btree_map.h"
 #include "art/radix_map.h"
 #include "parameters.h"
+#include "perf_fixture.h"
+#include "workloads/workloads.h"
 
-class InsertFixture : public celero::TestFixture {
+class InsertFixture : public PerfFixture {
 public:
     InsertFixture() {
     }
@@ -30,19 +32,15 @@ public:
     /// Before each run, build a vector of random integers.
     virtual void setUp(int64_t experimentValue) {
         this->arraySize = experimentValue;
+        this->setOperations(this->arraySize * INSERT_ITERATIONS);
         this->data.reserve(this->arraySize);
     }
 
-    /// Before each iteration. A common utility function to push back random ints to sort.
+    /// Before each iteration, the same sequential keys for every container.
     void generate_data() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
-
-        for (int i = 0; i < this->arraySize; i++) {
-            auto candidate = dis(gen);
-            this->data.emplace_back(i, i);
-        }
+        this->data.clear();
+        for (int64_t key : workloads::dense_keys<int64_t>(this->arraySize))
+            this->data.emplace_back(key, key);
     }
 
     std::vector<std::pair<int64_t, int64_t>> data;
@@ -5,8 +5,10 @@
 #include "btree_map.h"
 #include "art/radix_map.h"
 #include "parameters.h"
+#include "perf_fixture.h"
+#include "workloads/workloads.h"
 
-class IterationFixture : public celero::TestFixture {
+class IterationFixture : public PerfFixture {
 public:
     IterationFixture() {
     }
@@ -25,6 +27,7 @@ public:
     /// Before each run, build a vector of random integers.
     virtual void setUp(int64_t experimentValue) {
         this->arraySize = experimentValue;
+        this->setOperations(this->arraySize * ITERATION_ITERATIONS);
         this->data.reserve(this->arraySize);
         this->generate_data();
         this->build_map();
@@ -34,15 +37,9 @@ public:
     }
 
     void generate_data() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<int64_t> dis(std::numeric_limits<int64_t>::min(),
-                                                   std::numeric_limits<int64_t>::max());
-
-        for (int i = 0; i < this->arraySize; i++) {
-            int64_t candidate = dis(gen);
-            this->data.emplace_back(candidate, i);
-        }
+        const std::vector<int64_t> keys = workloads::uniform_keys<int64_t>(this->arraySize);
+        for (size_t i = 0; i < keys.size(); i++)
+            this->data.emplace_back(keys[i], i);
     }
 
     void build_map() {
@@ -0,0 +1,68 @@
+#ifndef ART_PERF_FIXTURE_H
+#define ART_PERF_FIXTURE_H
+
+#include <celero/Celero.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "perf/perf_counters.h"
+
+/// A user defined measurement of Celero for one perf event, per operation.
+class PerfMeasurement : public celero::UserDefinedMeasurementTemplate<double> {
+public:
+    explicit PerfMeasurement(const std::string &name) : name(name) {
+    }
+
+    virtual std::string getName() const override {
+        return this->name;
+    }
+
+private:
+    std::string name;
+};
+
+/// Base of the fixtures that counts hardware events around each sample, see perf::counters.
+/// Fixtures set the number of operations of a sample with setOperations().
+class PerfFixture : public celero::TestFixture {
+public:
+    PerfFixture() : operations(0) {
+        this->counters.warn_if_unavailable();
+        for (size_t i = 0; i < perf::EVENTS; i++) {
+            const perf::event e = static_cast<perf::event>(i);
+            if (this->counters.available(e))
+                this->measurements.emplace_back(e, std::make_shared<PerfMeasurement>(
+                        std::string(perf::name(e)) + "/op"));
+        }
+    }
+
+    void setOperations(int64_t operations) {
+        this->operations = operations;
+    }
+
+    virtual void onExperimentStart(int64_t) override {
+        this->counters.reset();
+        this->counters.start();
+    }
+
+    virtual void onExperimentEnd() override {
+        this->counters.stop();
+        if (this->operations <= 0)
+            return;
+        for (auto &m : this->measurements)
+            m.second->addValue(this->counters.value(m.first) / double(this->operations));
+    }
+
+    virtual std::vector<std::shared_ptr<celero::UserDefinedMeasurement>> getUserDefinedMeasurements() const override {
+        std::vector<std::shared_ptr<celero::UserDefinedMeasurement>> result;
+        for (auto &m : this->measurements)
+            result.push_back(m.second);
+        return result;
+    }
+
+private:
+    perf::counters counters;
+    std::vector<std::pair<perf::event, std::shared_ptr<PerfMeasurement>>> measurements;
+    int64_t operations;
+};
+
+#endif //ART_PERF_FIXTURE_H
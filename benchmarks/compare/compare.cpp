@@ -0,0 +1,410 @@
+// Summarizes the repetitions in the JSON output of a google benchmark
+// suite, e.g. gbench_suite.json, and compares them with a stored baseline.
+//
+// Usage: gbench_compare RESULTS.json
+//        gbench_compare BASELINE.json RESULTS.json [--threshold PERCENT]
+//
+// With one file it prints the mean real time of every benchmark with its
+// standard deviation and the 95% confidence interval of the mean, from the
+// repetitions (--benchmark_repetitions or Repetitions()). The aggregates
+// gbench adds itself are skipped.
+//
+// With two files it prints both means and the change of the mean, and
+// flags a benchmark as faster or slower when Welch's t-test finds the
+// difference significant at the 95% level and it exceeds the threshold,
+// 2% by default. The exit status is 1 if any benchmark got slower, so the
+// comparison can gate a change; 2 on unreadable input.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * Just enough JSON for the output of google benchmark.
+     */
+    struct json {
+        enum kind_type {
+            NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+        };
+
+        kind_type kind = NUL;
+        bool boolean = false;
+        double number = 0;
+        std::string string;
+        std::vector<json> array;
+        std::vector<std::pair<std::string, json> > object;
+
+        const json *find(const std::string &key) const {
+            for (const auto &member : object) {
+                if (member.first == key)
+                    return &member.second;
+            }
+            return nullptr;
+        }
+    };
+
+    class json_parser {
+        const std::string &_text;
+        size_t _pos;
+
+        void fail(const char *what) const {
+            throw std::runtime_error(std::string(what) + " at offset " + std::to_string(_pos));
+        }
+
+        void skip_space() {
+            while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])))
+                _pos++;
+        }
+
+        bool consume(const char *literal) {
+            const size_t length = std::char_traits<char>::length(literal);
+            if (_text.compare(_pos, length, literal) != 0)
+                return false;
+            _pos += length;
+            return true;
+        }
+
+        void expect(char c) {
+            skip_space();
+            if (_pos >= _text.size() || _text[_pos] != c)
+                fail((std::string("expected '") + c + "'").c_str());
+            _pos++;
+        }
+
+        std::string parse_string() {
+            expect('"');
+            std::string result;
+            while (_pos < _text.size() && _text[_pos] != '"') {
+                char c = _text[_pos++];
+                if (c == '\\') {
+                    if (_pos >= _text.size())
+                        break;
+                    c = _text[_pos++];
+                    switch (c) {
+                        case 'n':
+                            c = '\n';
+                            break;
+                        case 't':
+                            c = '\t';
+                            break;
+                        case 'u':
+                            // benchmark names are ASCII, keep other code points as '?'
+                            _pos += 4;
+                            c = '?';
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                result += c;
+            }
+            expect('"');
+            return result;
+        }
+
+        // skips the comma between two elements, returns false after the last one
+        bool next_element() {
+            skip_space();
+            if (_pos < _text.size() && _text[_pos] == ',') {
+                _pos++;
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        explicit json_parser(const std::string &text) : _text(text), _pos(0) {}
+
+        json parse() {
+            json value;
+            skip_space();
+            if (_pos >= _text.size())
+                fail("unexpected end");
+            const char c = _text[_pos];
+            if (c == '{') {
+                value.kind = json::OBJECT;
+                _pos++;
+                skip_space();
+                bool more = _pos < _text.size() && _text[_pos] != '}';
+                while (more) {
+                    std::string key = parse_string();
+                    expect(':');
+                    value.object.push_back(std::make_pair(key, parse()));
+                    more = next_element();
+                }
+                expect('}');
+            } else if (c == '[') {
+                value.kind = json::ARRAY;
+                _pos++;
+                skip_space();
+                bool more = _pos < _text.size() && _text[_pos] != ']';
+                while (more) {
+                    value.array.push_back(parse());
+                    more = next_element();
+                }
+                expect(']');
+            } else if (c == '"') {
+                value.kind = json::STRING;
+                value.string = parse_string();
+            } else if (consume("true")) {
+                value.kind = json::BOOLEAN;
+                value.boolean = true;
+            } else if (consume("false")) {
+                value.kind = json::BOOLEAN;
+            } else if (!consume("null")) {
+                const char *begin = _text.c_str() + _pos;
+                char *end;
+                value.kind = json::NUMBER;
+                value.number = std::strtod(begin, &end);
+                if (end == begin)
+                    fail("unexpected character");
+                _pos += end - begin;
+            }
+            return value;
+        }
+    };
+
+    // the 97.5% quantiles of Student's t-distribution for 1 to 30 degrees of freedom
+    const double T_QUANTILES[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    /**
+     * The factor of the standard error for a two-sided 95% interval.
+     */
+    double t_quantile(double degrees_of_freedom) {
+        if (degrees_of_freedom < 1)
+            return T_QUANTILES[0];
+        if (degrees_of_freedom <= 30)
+            return T_QUANTILES[static_cast<int>(degrees_of_freedom) - 1];
+        // within 0.3% of the exact quantile above 30 degrees of freedom
+        return 1.960 + 2.4 / degrees_of_freedom;
+    }
+
+    struct sample {
+        // real time per iteration in nanoseconds
+        std::vector<double> times;
+
+        double mean() const {
+            double sum = 0;
+            for (double t : times)
+                sum += t;
+            return sum / times.size();
+        }
+
+        double variance() const {
+            if (times.size() < 2)
+                return 0;
+            const double m = mean();
+            double sum = 0;
+            for (double t : times)
+                sum += (t - m) * (t - m);
+            return sum / (times.size() - 1);
+        }
+
+        double stddev() const {
+            return std::sqrt(variance());
+        }
+
+        // half the width of the 95% confidence interval of the mean
+        double confidence() const {
+            if (times.size() < 2)
+                return 0;
+            return t_quantile(times.size() - 1) * stddev() / std::sqrt(double(times.size()));
+        }
+    };
+
+    double nanoseconds_per(const std::string &unit) {
+        if (unit == "us")
+            return 1e3;
+        if (unit == "ms")
+            return 1e6;
+        if (unit == "s")
+            return 1e9;
+        return 1;
+    }
+
+    bool ends_with(const std::string &s, const std::string &suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    typedef std::vector<std::pair<std::string, sample> > results_type;
+
+    /**
+     * Reads the repetitions of every benchmark in @a path, in file order.
+     */
+    results_type read_results(const std::string &path) {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("cannot open " + path);
+        std::stringstream text;
+        text << in.rdbuf();
+        const std::string content = text.str();
+        const json root = json_parser(content).parse();
+        const json *benchmarks = root.find("benchmarks");
+        if (benchmarks == nullptr || benchmarks->kind != json::ARRAY)
+            throw std::runtime_error(path + ": no benchmarks, not the JSON output of google benchmark");
+
+        std::vector<std::pair<std::string, sample> > results;
+        std::map<std::string, size_t> index;
+        for (const json &b : benchmarks->array) {
+            const json *name = b.find("name");
+            const json *time = b.find("real_time");
+            const json *run_type = b.find("run_type");
+            const json *error = b.find("error_occurred");
+            if (name == nullptr || time == nullptr || (error != nullptr && error->boolean))
+                continue;
+            // the aggregates gbench computes, tagged in newer versions and only by name in older ones
+            if (run_type != nullptr && run_type->string == "aggregate")
+                continue;
+            if (ends_with(name->string, "_mean") || ends_with(name->string, "_median") ||
+                ends_with(name->string, "_stddev") || ends_with(name->string, "_cv"))
+                continue;
+
+            const json *unit = b.find("time_unit");
+            auto it = index.find(name->string);
+            if (it == index.end()) {
+                it = index.insert(std::make_pair(name->string, results.size())).first;
+                results.push_back(std::make_pair(name->string, sample()));
+            }
+            results[it->second].second.times.push_back(time->number * nanoseconds_per(unit ? unit->string : "ns"));
+        }
+        return results;
+    }
+
+    // e.g. "3.327 ms", in the largest unit the value is at least 1 of
+    std::string format(double nanoseconds) {
+        static const char *const units[] = {"ns", "us", "ms", "s"};
+        size_t unit = 0;
+        while (unit < 3 && std::fabs(nanoseconds) >= 1000) {
+            nanoseconds /= 1000;
+            unit++;
+        }
+        std::ostringstream out;
+        out << std::setprecision(4) << nanoseconds << " " << units[unit];
+        return out.str();
+    }
+
+    size_t name_width(const results_type &results) {
+        size_t width = 9;
+        for (const auto &r : results)
+            width = std::max(width, r.first.size());
+        return width + 2;
+    }
+
+    void summarize(const results_type &results) {
+        const size_t width = name_width(results);
+        std::cout << std::left << std::setw(width) << "benchmark" << std::right << std::setw(4) << "n"
+                  << std::setw(14) << "mean" << std::setw(14) << "stddev" << std::setw(16) << "95% CI" << std::endl;
+        for (const auto &r : results) {
+            const sample &s = r.second;
+            std::cout << std::left << std::setw(width) << r.first << std::right << std::setw(4) << s.times.size()
+                      << std::setw(14) << format(s.mean()) << std::setw(14) << format(s.stddev())
+                      << std::setw(16) << "+-" + format(s.confidence()) << std::endl;
+        }
+    }
+
+    /**
+     * @return  Whether a benchmark got slower.
+     */
+    bool compare(const results_type &baseline, const results_type &results, double threshold) {
+        std::map<std::string, const sample *> base;
+        for (const auto &b : baseline)
+            base[b.first] = &b.second;
+
+        bool slower = false;
+        const size_t width = std::max(name_width(baseline), name_width(results));
+        std::cout << std::left << std::setw(width) << "benchmark" << std::right << std::setw(26) << "baseline"
+                  << std::setw(26) << "results" << std::setw(10) << "change" << "  verdict" << std::endl;
+        for (const auto &r : results) {
+            const sample &now = r.second;
+            const auto it = base.find(r.first);
+            if (it == base.end()) {
+                std::cout << std::left << std::setw(width) << r.first << std::right << std::setw(26) << "-"
+                          << std::setw(26) << format(now.mean()) << std::setw(10) << "-" << "  new" << std::endl;
+                continue;
+            }
+            const sample &before = *it->second;
+            base.erase(it);
+
+            const double change = (now.mean() - before.mean()) / before.mean() * 100;
+            // Welch's t-test, the variances of two builds need not be equal
+            const double v1 = before.variance() / before.times.size();
+            const double v2 = now.variance() / now.times.size();
+            const char *verdict = "same";
+            if (before.times.size() < 2 || now.times.size() < 2) {
+                verdict = "too few repetitions";
+            } else if (std::fabs(change) >= threshold) {
+                const double t = v1 + v2 > 0 ? (now.mean() - before.mean()) / std::sqrt(v1 + v2) : HUGE_VAL;
+                const double df = v1 + v2 > 0
+                                  ? (v1 + v2) * (v1 + v2) /
+                                    (v1 * v1 / (before.times.size() - 1) + v2 * v2 / (now.times.size() - 1))
+                                  : 1;
+                if (std::fabs(t) > t_quantile(df)) {
+                    verdict = change > 0 ? "slower" : "faster";
+                    slower = slower || change > 0;
+                }
+            }
+
+            std::ostringstream percent;
+            percent << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+            std::cout << std::left << std::setw(width) << r.first << std::right
+                      << std::setw(26) << format(before.mean()) + " +-" + format(before.confidence())
+                      << std::setw(26) << format(now.mean()) + " +-" + format(now.confidence())
+                      << std::setw(10) << percent.str() << "  " << verdict << std::endl;
+        }
+        for (const auto &missing : base)
+            std::cout << std::left << std::setw(width) << missing.first << std::right << std::setw(26)
+                      << format(missing.second->mean()) << std::setw(26) << "-" << std::setw(10) << "-"
+                      << "  missing" << std::endl;
+        return slower;
+    }
+
+    void usage() {
+        std::cerr << "usage: gbench_compare RESULTS.json\n"
+                  << "       gbench_compare BASELINE.json RESULTS.json [--threshold PERCENT]" << std::endl;
+        std::exit(2);
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> files;
+    double threshold = 2;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--threshold") {
+            if (++i == argc)
+                usage();
+            threshold = std::strtod(argv[i], nullptr);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || files.size() > 2)
+        usage();
+
+    try {
+        if (files.size() == 1) {
+            summarize(read_results(files[0]));
+            return 0;
+        }
+        return compare(read_results(files[0]), read_results(files[1]), threshold) ? 1 : 0;
+    } catch (const std::runtime_error &e) {
+        std::cerr << "gbench_compare: " << e.what() << std::endl;
+        return 2;
+    }
+}
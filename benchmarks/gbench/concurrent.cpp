@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <random>
+#include <art/concurrent_radix_map.h>
+#include <art/radix_map.h>
+#include <art/sharded_radix_map.h>
+
+// Elements in the shared map, keys are drawn from twice as many candidates
+const uint64_t SIZE = 1 << 20;
+
+namespace
+{
+    // Spreads the candidate indices over the whole 64-bit key space
+    inline uint64_t key_of(uint64_t index) {
+        return index * 0x9E3779B97F4A7C15ULL;
+    }
+
+    // radix_map behind a single mutex, the baseline concurrent_radix_map replaces
+    class locked_radix_map {
+        std::mutex _mutex;
+        art::radix_map<uint64_t, uint64_t> _map;
+
+    public:
+        bool find(uint64_t key, uint64_t &value) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _map.find(key);
+            if (it == _map.end())
+                return false;
+            value = it->second;
+            return true;
+        }
+
+        bool insert(const std::pair<const uint64_t, uint64_t> &x) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _map.insert(x).second;
+        }
+
+        size_t erase(uint64_t key) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _map.erase(key);
+        }
+    };
+
+    // One map per type shared by all runs; the write mixes insert and erase
+    // with equal probability, so it stays at about SIZE elements.
+    template<typename Map>
+    Map &shared_map() {
+        static Map *map = [] {
+            Map *m = new Map();
+            for (uint64_t i = 0; i < 2 * SIZE; i += 2)
+                m->insert(std::make_pair(key_of(i), i));
+            return m;
+        }();
+        return *map;
+    }
+}  // namespace
+
+/**
+ * Random lookups, inserts and erases on a map shared by all threads,
+ * state.range(0) is the percentage of writes.
+ */
+template<typename Map>
+static void BM_Concurrent_Mix(benchmark::State &state) {
+    const int write_percent = state.range(0);
+    Map &m = shared_map<Map>();
+
+    std::mt19937_64 gen(state.thread_index + 1);
+    std::uniform_int_distribution<uint64_t> index_dis(0, 2 * SIZE - 1);
+    std::uniform_int_distribution<int> op_dis(0, 199);
+    uint64_t value = 0;
+    while (state.KeepRunning()) {
+        const uint64_t index = index_dis(gen);
+        const int op = op_dis(gen);
+        if (op < write_percent)
+            benchmark::DoNotOptimize(m.insert(std::make_pair(key_of(index), index)));
+        else if (op < 2 * write_percent)
+            benchmark::DoNotOptimize(m.erase(key_of(index)));
+        else
+            benchmark::DoNotOptimize(m.find(key_of(index), value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Thread 0 keeps inserting and erasing, all other threads look up keys;
+ * only the lookups are counted.
+ */
+template<typename Map>
+static void BM_Single_Writer(benchmark::State &state) {
+    Map &m = shared_map<Map>();
+
+    std::mt19937_64 gen(state.thread_index + 1);
+    std::uniform_int_distribution<uint64_t> index_dis(0, 2 * SIZE - 1);
+    uint64_t value = 0;
+    if (state.thread_index == 0) {
+        while (state.KeepRunning()) {
+            const uint64_t index = index_dis(gen);
+            if (index % 2)
+                benchmark::DoNotOptimize(m.insert(std::make_pair(key_of(index), index)));
+            else
+                benchmark::DoNotOptimize(m.erase(key_of(index)));
+        }
+    } else {
+        while (state.KeepRunning())
+            benchmark::DoNotOptimize(m.find(key_of(index_dis(gen)), value));
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+// read/write mixes 100/0, 95/5 and 50/50
+BENCHMARK_TEMPLATE(BM_Concurrent_Mix, art::concurrent_radix_map<uint64_t, uint64_t>)
+        ->Arg(0)->Arg(5)->Arg(50)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Concurrent_Mix, art::sharded_radix_map<uint64_t, uint64_t, 64>)
+        ->Arg(0)->Arg(5)->Arg(50)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Concurrent_Mix, locked_radix_map)
+        ->Arg(0)->Arg(5)->Arg(50)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+
+// one writer, 1-63 readers
+BENCHMARK_TEMPLATE(BM_Single_Writer,
+                   art::concurrent_radix_map<uint64_t, uint64_t, art::key_transform<uint64_t>, true>)
+        ->ThreadRange(2, 64)
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Single_Writer, art::concurrent_radix_map<uint64_t, uint64_t>)
+        ->ThreadRange(2, 64)
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Single_Writer, locked_radix_map)
+        ->ThreadRange(2, 64)
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -1,647 +1,614 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
 #include <btree_map.h>
 #include <art/radix_map.h>
+#include "perf/environment.h"
+#include "perf/gbench_counters.h"
+#include "workloads/workloads.h"
+
+// Every benchmark runs REPETITIONS times, gbench_compare turns the
+// repetitions in the JSON output (gbench_suite.json unless --benchmark_out
+// says otherwise) into means, standard deviations and confidence intervals
+// and compares them with a stored baseline. The process is pinned to one
+// CPU, see perf/environment.h.
+//
+// The containers are built once per benchmark and size and kept across the
+// trial runs and repetitions of gbench. Lookups run with warm caches, after
+// an untimed pass over the lookups, and with cold caches, flushed before
+// every iteration.
 
 const int START = 24;
 const int END = 24;
 
-template<typename T>
-struct Generator {
-    std::mt19937 gen;
-    std::uniform_int_distribution<T> dis;
+// fits into the last level cache, where warm and cold caches differ most
+const int CACHED_SIZE = 1 << 16;
 
-    Generator() {
-        std::random_device rd;
-        gen = std::mt19937(rd());
-        dis = std::uniform_int_distribution<T>(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
-    }
-
-    T next() {
-        return dis(gen);
-    }
-};
+const int REPETITIONS = 10;
 
 namespace
 {
+    enum cache_state {
+        WARM, COLD
+    };
+
+    /**
+     * A container and its keys, built once for all runs of the benchmarks
+     * that use the same container, distribution and size.
+     */
     template<typename Container>
-    Container ConstructRandomMap(int size) {
+    struct fixture {
         typedef typename std::remove_const<typename Container::key_type>::type K;
 
-        Container m;
-        Generator<K> key_generator;
-        for (int i = 0; i < size; ++i) {
-            m.insert(std::make_pair(key_generator.next(), key_generator.next()));
+        Container map;
+        // the keys of map, shuffled or in ascending order
+        std::vector<K> keys;
+    };
+
+    // Holds the fixture of the last benchmark only, so 16M element containers do not pile up
+    std::shared_ptr<void> &fixture_slot() {
+        static std::shared_ptr<void> slot;
+        return slot;
+    }
+
+    std::string &fixture_name() {
+        static std::string name;
+        return name;
+    }
+
+    /**
+     * Returns the cached fixture called @a name, building it from the keys
+     * @a make_keys returns if another fixture is cached.
+     */
+    template<typename Container, typename MakeKeys>
+    fixture<Container> &cached_fixture(const std::string &name, MakeKeys make_keys, bool shuffled) {
+        const std::string full_name = std::string(typeid(Container).name()) + "/" + name;
+        if (fixture_name() != full_name) {
+            fixture_slot().reset();
+            std::shared_ptr<fixture<Container> > f = std::make_shared<fixture<Container> >();
+            f->keys = make_keys();
+            for (size_t i = 0; i < f->keys.size(); ++i)
+                f->map.insert(std::make_pair(f->keys[i], static_cast<typename Container::mapped_type>(i)));
+            if (shuffled)
+                workloads::shuffle(f->keys, workloads::seed() + 1);
+            else
+                std::sort(f->keys.begin(), f->keys.end());
+            fixture_slot() = f;
+            fixture_name() = full_name;
         }
-        return m;
+        return *std::static_pointer_cast<fixture<Container> >(fixture_slot());
     }
 
     template<typename Container>
-    Container ConstructDenseMap(int size) {
-        typedef typename std::remove_const<typename Container::key_type>::type K;
+    fixture<Container> &cached_fixture(workloads::key_distribution distribution, size_t size, bool shuffled = true) {
+        typedef typename fixture<Container>::K K;
+        const std::string name = std::string(workloads::name(distribution)) + "/" + std::to_string(size) +
+                                 (shuffled ? "/shuffled" : "/sorted");
+        return cached_fixture<Container>(name, [&]() { return workloads::keys<K>(distribution, size); }, shuffled);
+    }
+
+    const char *CacheName(cache_state cache) {
+        return cache == WARM ? "warm" : "cold";
+    }
 
-        Container m;
-        Generator<K> key_generator;
-        for (int i = 0; i < size; ++i) {
-            m.insert(std::make_pair(i, key_generator.next()));
+    /**
+     * Looks up all of @a lookups in @a m per iteration, after a warm-up pass
+     * or with flushed caches.
+     */
+    template<typename Container, typename K>
+    void Lookup(benchmark::State &state, const Container &m, const std::vector<K> &lookups, cache_state cache) {
+        if (cache == WARM) {
+            for (const K &key : lookups)
+                benchmark::DoNotOptimize(m.find(key));
         }
-        return m;
+
+        perf::counters counters;
+        counters.start();
+        while (state.KeepRunning()) {
+            if (cache == COLD) {
+                perf::pause(state, counters);
+                perf::flush_caches();
+                perf::resume(state, counters);
+            }
+            for (const K &key : lookups)
+                benchmark::DoNotOptimize(m.find(key));
+        }
+        counters.stop();
+        const size_t items_processed = state.iterations() * lookups.size();
+        state.SetItemsProcessed(items_processed);
+        perf::report(state, counters, items_processed);
     }
 
+    /**
+     * Erases a tenth of the keys of @a f and inserts them again per
+     * iteration, a different tenth each time; only the inserts or only the
+     * erases are timed. The container is complete again after every
+     * iteration, so it serves all runs.
+     */
+    template<typename Container>
+    void ReinsertTenth(benchmark::State &state, fixture<Container> &f, bool time_erase) {
+        const size_t tenth = f.keys.size() / 10;
+        size_t round = 0;
+
+        perf::counters counters;
+        counters.start();
+        while (state.KeepRunning()) {
+            perf::pause(state, counters);
+            const auto first = f.keys.begin() + (round++ % 10) * tenth;
+            const auto last = first + tenth;
+
+            if (time_erase)
+                perf::resume(state, counters);
+            for (auto it = first; it != last; ++it)
+                f.map.erase(*it);
+            if (time_erase)
+                perf::pause(state, counters);
+            else
+                perf::resume(state, counters);
+            for (auto it = first; it != last; ++it)
+                f.map.insert(std::make_pair(*it, 1));
+        }
+        counters.stop();
+        const size_t items_processed = state.iterations() * tenth;
+        state.SetItemsProcessed(items_processed);
+        perf::report(state, counters, items_processed);
+    }
+
+    template<typename Container>
+    void Iterate(benchmark::State &state, const Container &m) {
+        typedef typename std::remove_const<typename Container::value_type>::type V;
+
+        perf::counters counters;
+        counters.start();
+        while (state.KeepRunning()) {
+            long sum = 0;
+            for (const auto &e : m) {
+                benchmark::DoNotOptimize(sum += e.second);
+            }
+        }
+        counters.stop();
+        const size_t items_processed = state.iterations() * m.size();
+        state.SetItemsProcessed(items_processed);
+        perf::report(state, counters, items_processed);
+        state.SetBytesProcessed(items_processed * sizeof(V));
+    }
 }  // namespace
 
+// Arguments: number of elements, cache_state
 template<typename Container>
 static void BM_Lookup_Sparse(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    Generator<K> key_generator;
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructRandomMap<Container>(size);
-        state.ResumeTiming();
-        for (int i = 0; i < size; ++i) {
-            benchmark::DoNotOptimize(m.find(key_generator.next()));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    //state.SetBytesProcessed(items_processed * sizeof(V));
+    typedef typename fixture<Container>::K K;
+
+    const fixture<Container> &f = cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0));
+    const std::vector<K> lookups = workloads::uniform_keys<K>(state.range(0), workloads::seed() + 1);
+    const cache_state cache = static_cast<cache_state>(state.range(1));
+    Lookup(state, f.map, lookups, cache);
+    state.SetLabel(CacheName(cache));
 }
 
+// Arguments: number of elements, cache_state
 template<typename Container>
 static void BM_Lookup_Sparse_Valid(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructRandomMap<Container>(size);
-        std::vector<K> keys;
-        for (auto &e : m)
-            keys.push_back(e.first);
-        std::random_shuffle(keys.begin(), keys.end());
-        const size_t key_size = keys.size();
-        state.ResumeTiming();
-        for (int i = 0; i < key_size; ++i) {
-            benchmark::DoNotOptimize(m.find(keys[i]));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    //state.SetBytesProcessed(items_processed * sizeof(V));
+    const fixture<Container> &f = cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0));
+    const cache_state cache = static_cast<cache_state>(state.range(1));
+    Lookup(state, f.map, f.keys, cache);
+    state.SetLabel(CacheName(cache));
 }
 
+// Arguments: number of elements, cache_state
 template<typename Container>
 static void BM_Lookup_Dense(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructDenseMap<Container>(size);
-        Generator<K> key_generator;
-        state.ResumeTiming();
-        for (int i = 0; i < size; ++i) {
-            benchmark::DoNotOptimize(m.find(key_generator.next()));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    //state.SetBytesProcessed(items_processed * sizeof(V));
+    typedef typename fixture<Container>::K K;
+
+    const fixture<Container> &f = cached_fixture<Container>(workloads::key_distribution::dense, state.range(0));
+    const std::vector<K> lookups = workloads::uniform_keys<K>(state.range(0), workloads::seed() + 1);
+    const cache_state cache = static_cast<cache_state>(state.range(1));
+    Lookup(state, f.map, lookups, cache);
+    state.SetLabel(CacheName(cache));
 }
 
+// Arguments: number of elements, cache_state
 template<typename Container>
 static void BM_Lookup_Dense_Valid(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructDenseMap<Container>(size);
-        std::vector<K> keys;
-        for (auto &e : m)
-            keys.push_back(e.first);
-        std::random_shuffle(keys.begin(), keys.end());
-        const size_t key_size = keys.size();
-        state.ResumeTiming();
-        for (int i = 0; i < key_size; ++i) {
-            benchmark::DoNotOptimize(m.find(keys[i]));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    //state.SetBytesProcessed(items_processed * sizeof(V));
+    const fixture<Container> &f = cached_fixture<Container>(workloads::key_distribution::dense, state.range(0));
+    const cache_state cache = static_cast<cache_state>(state.range(1));
+    Lookup(state, f.map, f.keys, cache);
+    state.SetLabel(CacheName(cache));
 }
 
 template<typename Container>
 static void BM_Insert_Sparse(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructRandomMap<Container>(size);
-
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
-
-        // Remove & re-insert a different 10% from the same map for 10 times
-        for (int i = 0; i < 10; i++) {
-            std::random_shuffle(values.begin(), values.end());
-            const size_t ten_percent = values.size() / 10;
-
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-            state.PauseTiming();
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0) / 10;
-    state.SetItemsProcessed(items_processed);
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0)), false);
 }
 
 template<typename Container>
 static void BM_Insert_Dense(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructDenseMap<Container>(size);
-
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
-
-        // Remove & re-insert a different 10% from the same map for 10 times
-        for (int i = 0; i < 10; i++) {
-            std::random_shuffle(values.begin(), values.end());
-            const size_t ten_percent = values.size() / 10;
-
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-            state.PauseTiming();
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0) / 10;
-    state.SetItemsProcessed(items_processed);
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::dense, state.range(0)), false);
 }
 
+// The tenths are consecutive keys, inserted in ascending order
 template<typename Container>
 static void BM_Insert_Sequential(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    Container m;
-    Generator<K> key_generator;
-
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        for (int i = 0; i < size; i++) {
-            m.insert(std::make_pair(i, key_generator.next()));
-        }
-
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
-
-        // Remove & re-insert the first 10% of the map
-        for (int i = 0; i < 10; i++) {
-            const size_t ten_percent = values.size() / 10;
-
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-            state.PauseTiming();
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0) / 10;
-    state.SetItemsProcessed(items_processed);
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::dense, state.range(0), false), false);
 }
 
 template<typename Container>
 static void BM_Erase_Sparse(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructRandomMap<Container>(size);
-
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
-
-        // Remove & re-insert a different 10% from the same map for 10 times
-        for (int i = 0; i < 10; i++) {
-            std::random_shuffle(values.begin(), values.end());
-            const size_t ten_percent = values.size() / 10;
-
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-            state.PauseTiming();
-
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0) / 10;
-    state.SetItemsProcessed(items_processed);
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0)), true);
 }
 
 template<typename Container>
 static void BM_Erase_Dense(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructDenseMap<Container>(size);
-
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
-
-        // Remove & re-insert a different 10% from the same map for 10 times
-        for (int i = 0; i < 10; i++) {
-            std::random_shuffle(values.begin(), values.end());
-            const size_t ten_percent = values.size() / 10;
-
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-            state.PauseTiming();
-
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0) / 10;
-    state.SetItemsProcessed(items_processed);
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::dense, state.range(0)), true);
 }
 
+// The tenths are consecutive keys, erased in ascending order
 template<typename Container>
 static void BM_Erase_Sequential(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::key_type>::type K;
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-    const int size = state.range(0);
-
-    Container m;
-    Generator<K> key_generator;
+    ReinsertTenth(state, cached_fixture<Container>(workloads::key_distribution::dense, state.range(0), false), true);
+}
 
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        for (int i = 0; i < size; i++) {
-            m.insert(std::make_pair(i, key_generator.next()));
-        }
+template<typename Container>
+static void BM_Iteration_Sparse(benchmark::State &state) {
+    Iterate(state, cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0)).map);
+}
 
-        std::vector<K> values;
-        for (auto &e : m)
-            values.push_back(e.first);
+template<typename Container>
+static void BM_Iteration_Dense(benchmark::State &state) {
+    Iterate(state, cached_fixture<Container>(workloads::key_distribution::dense, state.range(0)).map);
+}
 
-        // Remove & re-insert the first 10% of the map
-        for (int i = 0; i < 10; i++) {
-            const size_t ten_percent = values.size() / 10;
+// Arguments: number of elements, workloads::key_distribution
+template<typename Container>
+static void BM_Lookup_Distribution_Valid(benchmark::State &state) {
+    const auto distribution = static_cast<workloads::key_distribution>(state.range(1));
+    const fixture<Container> &f = cached_fixture<Container>(distribution, state.range(0));
+    Lookup(state, f.map, f.keys, WARM);
+    state.SetLabel(workloads::name(distribution));
+}
 
-            state.ResumeTiming();
-            for (int j = 0; j < ten_percent; j++)
-                m.erase(values[j]);
-            state.PauseTiming();
+// Arguments: number of elements, skew theta in percent
+template<typename Container>
+static void BM_Lookup_Zipf(benchmark::State &state) {
+    typedef typename fixture<Container>::K K;
 
-            for (int j = 0; j < ten_percent; j++)
-                m.insert(std::make_pair(values[j], 1));
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
+    const fixture<Container> &f = cached_fixture<Container>(workloads::key_distribution::uniform, state.range(0));
+    const std::vector<K> lookups = workloads::zipf_lookups(f.keys, f.keys.size(), state.range(1) / 100.0);
+    Lookup(state, f.map, lookups, WARM);
 }
 
+// Arguments: number of elements, workloads::string_kind
 template<typename Container>
-static void BM_Iteration_Sparse(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructRandomMap<Container>(size);
-        state.ResumeTiming();
-        long sum = 0;
-        for (const auto &e : m) {
-            benchmark::DoNotOptimize(sum += e.second);
-        }
-    }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    state.SetBytesProcessed(items_processed * sizeof(V));
+static void BM_Lookup_String_Valid(benchmark::State &state) {
+    const auto kind = static_cast<workloads::string_kind>(state.range(1));
+    const std::string name = "strings/" + std::to_string(state.range(0)) + "/" + std::to_string(state.range(1));
+    const fixture<Container> &f = cached_fixture<Container>(name, [&]() {
+        return workloads::string_keys(state.range(0), kind);
+    }, true);
+    Lookup(state, f.map, f.keys, WARM);
+    state.SetLabel(kind == workloads::string_kind::url ? "url" : "email");
 }
 
-template<typename Container>
-static void BM_Iteration_Dense(benchmark::State &state) {
-    typedef typename std::remove_const<typename Container::value_type>::type V;
-
-    const int size = state.range(0);
-    while (state.KeepRunning()) {
-        state.PauseTiming();
-        Container m = ConstructDenseMap<Container>(size);
-        state.ResumeTiming();
-        long sum = 0;
-        for (const auto &e : m) {
-            benchmark::DoNotOptimize(sum += e.second);
-        }
+// Arguments: number of elements, cache_state
+static void LookupArguments(benchmark::internal::Benchmark *b) {
+    for (int cache = WARM; cache <= COLD; cache++)
+        b->Args({CACHED_SIZE, cache});
+    for (int size = 1 << START; size <= 1 << END; size *= 8) {
+        for (int cache = WARM; cache <= COLD; cache++)
+            b->Args({size, cache});
     }
-    const size_t items_processed = state.iterations() * state.range(0);
-    state.SetItemsProcessed(items_processed);
-    state.SetBytesProcessed(items_processed * sizeof(V));
 }
 
-BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, btree::btree_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, art::radix_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-
-BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, btree::btree_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
-BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, art::radix_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(5.0);
+// Arguments: number of elements
+static void ModifyArguments(benchmark::internal::Benchmark *b) {
+    b->Range(1 << START, 1 << END);
+}
 
 ////////////
 // INSERT //
 ////////////
-const double MIN_INSERT_TIME = 2.0;
+const double MIN_INSERT_TIME = 0.5;
 
 BENCHMARK_TEMPLATE(BM_Insert_Sparse, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sparse, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sparse, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sparse, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Insert_Sequential, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sequential, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sequential, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Insert_Sequential, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_INSERT_TIME);
+        ->MinTime(MIN_INSERT_TIME)
+        ->Repetitions(REPETITIONS);
 
 
 ////////////
 // LOOKUP //
 ////////////
-
-const double MIN_LOOKUP_TIME = 5.0;
-/**
-BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
-        ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
-*/
-
+const double MIN_LOOKUP_TIME = 0.5;
 
 /**
 // SPARSE INT32 KEY
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::map<int32_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::unordered_map<int32_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, btree::btree_map<int32_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, art::radix_map<int32_t, int>)->Range(1 << START, 1 << END);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::map<int32_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::unordered_map<int32_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, btree::btree_map<int32_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, art::radix_map<int32_t, int>)->Apply(LookupArguments);
 */
 /**
 // SPARSE INT64 KEY
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::map<int64_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::unordered_map<int64_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, btree::btree_map<int64_t, int>)->Range(1 << START, 1 << END);
-//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, art::radix_map<int64_t, int>)->Range(1 << START, 1 << END);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::map<int64_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, std::unordered_map<int64_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, btree::btree_map<int64_t, int>)->Apply(LookupArguments);
+//BENCHMARK_TEMPLATE(BM_Lookup_Sparse, art::radix_map<int64_t, int>)->Apply(LookupArguments);
 */
 // SPARSE INT32 KEY: VALID KEYS ONLY
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, std::map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, std::unordered_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, btree::btree_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, art::radix_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 // SPARSE INT64 KEY: VALID KEYS ONLY
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Lookup_Sparse_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 /**
 // DENSE INT64 KEY
-BENCHMARK_TEMPLATE(BM_Lookup_Dense, std::map<int64_t, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense, std::unordered_map<int64_t, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense, btree::btree_map<int64_t, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Lookup_Dense, art::radix_map<int64_t, int>)->Range(1 << START, 1 << END);
+BENCHMARK_TEMPLATE(BM_Lookup_Dense, std::map<int64_t, int>)->Apply(LookupArguments);
+BENCHMARK_TEMPLATE(BM_Lookup_Dense, std::unordered_map<int64_t, int>)->Apply(LookupArguments);
+BENCHMARK_TEMPLATE(BM_Lookup_Dense, btree::btree_map<int64_t, int>)->Apply(LookupArguments);
+BENCHMARK_TEMPLATE(BM_Lookup_Dense, art::radix_map<int64_t, int>)->Apply(LookupArguments);
 */
 // DENSE INT32 KEY: VALID KEYS ONLY
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, std::map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, std::unordered_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, btree::btree_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, art::radix_map<int32_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 
 // DENSE INT64 KEY: VALID KEYS ONLY
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Lookup_Dense_Valid, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(LookupArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_LOOKUP_TIME);
+        ->MinTime(MIN_LOOKUP_TIME)
+        ->Repetitions(REPETITIONS);
 
 
 ///////////
 // ERASE //
 ///////////
 
-const double MIN_ERASE_TIME = 2.0;
+const double MIN_ERASE_TIME = 0.5;
 
 /*
 BENCHMARK_TEMPLATE(BM_Erase_Sparse, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sparse, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sparse, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sparse, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Erase_Dense, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Dense, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Dense, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Dense, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 
 BENCHMARK_TEMPLATE(BM_Erase_Sequential, std::map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sequential, std::unordered_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sequential, btree::btree_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 BENCHMARK_TEMPLATE(BM_Erase_Sequential, art::radix_map<int64_t, int>)
-        ->Range(1 << START, 1 << END)
+        ->Apply(ModifyArguments)
         ->Unit(benchmark::TimeUnit::kMillisecond)
-        ->MinTime(MIN_ERASE_TIME);
+        ->MinTime(MIN_ERASE_TIME)
+        ->Repetitions(REPETITIONS);
 */
 
 ///////////////
 // ITERATION //
 ///////////////
 /**
-BENCHMARK_TEMPLATE(BM_Iteration_Sparse, std::map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Sparse, std::unordered_map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Sparse, btree::btree_map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Sparse, art::radix_map<int, int>)->Range(1 << START, 1 << END);
-
-BENCHMARK_TEMPLATE(BM_Iteration_Dense, std::map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Dense, std::unordered_map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Dense, btree::btree_map<int, int>)->Range(1 << START, 1 << END);
-BENCHMARK_TEMPLATE(BM_Iteration_Dense, art::radix_map<int, int>)->Range(1 << START, 1 << END);
+BENCHMARK_TEMPLATE(BM_Iteration_Sparse, std::map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Sparse, std::unordered_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Sparse, btree::btree_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Sparse, art::radix_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+
+BENCHMARK_TEMPLATE(BM_Iteration_Dense, std::map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Dense, std::unordered_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Dense, btree::btree_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Iteration_Dense, art::radix_map<int, int>)->Apply(ModifyArguments)->Repetitions(REPETITIONS);
 */
 
-BENCHMARK_MAIN()
\ No newline at end of file
+///////////////////////
+// KEY DISTRIBUTIONS //
+///////////////////////
+static void DistributionArguments(benchmark::internal::Benchmark *b) {
+    for (int d = 0; d < static_cast<int>(workloads::key_distribution::_end); d++)
+        b->Args({1 << 20, d});
+}
+
+BENCHMARK_TEMPLATE(BM_Lookup_Distribution_Valid, std::map<int64_t, int>)
+        ->Apply(DistributionArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_Distribution_Valid, btree::btree_map<int64_t, int>)
+        ->Apply(DistributionArguments)->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_Distribution_Valid, art::radix_map<int64_t, int>)
+        ->Apply(DistributionArguments)->Repetitions(REPETITIONS);
+
+BENCHMARK_TEMPLATE(BM_Lookup_Zipf, std::map<int64_t, int>)->Args({1 << 20, 99})->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_Zipf, btree::btree_map<int64_t, int>)->Args({1 << 20, 99})->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_Zipf, art::radix_map<int64_t, int>)->Args({1 << 20, 99})->Repetitions(REPETITIONS);
+
+BENCHMARK_TEMPLATE(BM_Lookup_String_Valid, std::map<std::string, int>)
+        ->Args({1 << 20, 0})->Args({1 << 20, 1})->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_String_Valid, btree::btree_map<std::string, int>)
+        ->Args({1 << 20, 0})->Args({1 << 20, 1})->Repetitions(REPETITIONS);
+BENCHMARK_TEMPLATE(BM_Lookup_String_Valid, art::radix_map<std::string, int>)
+        ->Args({1 << 20, 0})->Args({1 << 20, 1})->Repetitions(REPETITIONS);
+
+int main(int argc, char **argv) {
+    perf::pin_from_environment();
+
+    // JSON for gbench_compare, unless the command line names another output
+    std::vector<char *> args(argv, argv + argc);
+    bool has_output = false;
+    for (int i = 1; i < argc; i++)
+        has_output = has_output || std::string(argv[i]).compare(0, 16, "--benchmark_out=") == 0;
+    static char output[] = "--benchmark_out=gbench_suite.json";
+    static char format[] = "--benchmark_out_format=json";
+    if (!has_output) {
+        args.push_back(output);
+        args.push_back(format);
+    }
+    int count = static_cast<int>(args.size());
+    args.push_back(nullptr);
+
+    benchmark::Initialize(&count, args.data());
+    benchmark::RunSpecifiedBenchmarks();
+}
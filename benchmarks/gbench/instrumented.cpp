@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+#include <art/instrumented_radix_map.h>
+#include <art/radix_map.h>
+
+namespace
+{
+    typedef art::radix_map<uint64_t, uint64_t> map_type;
+
+    std::vector<uint64_t> random_keys(size_t size) {
+        std::mt19937_64 gen(size);
+        std::vector<uint64_t> keys(size);
+        for (auto &key : keys)
+            key = gen();
+        return keys;
+    }
+
+    map_type filled_map(const std::vector<uint64_t> &keys) {
+        map_type map;
+        for (uint64_t key : keys)
+            map.insert(std::make_pair(key, key));
+        return map;
+    }
+}
+
+// Arguments: number of elements
+static void BM_Find(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    const map_type map = filled_map(keys);
+
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(map.find(keys[i]));
+        if (++i == keys.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Arguments: number of elements, sample interval
+static void BM_Instrumented_Find(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    const art::instrumented_radix_map<map_type> map(filled_map(keys), state.range(1));
+
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(map.find(keys[i]));
+        if (++i == keys.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["p99"] = map.latency(art::timed_operation::find).percentile(99);
+}
+
+// Arguments: number of elements
+static void BM_Iterate(benchmark::State &state) {
+    const map_type map = filled_map(random_keys(state.range(0)));
+
+    while (state.KeepRunning()) {
+        for (auto it = map.begin(); it != map.end(); ++it)
+            benchmark::DoNotOptimize(it->second);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Arguments: number of elements, sample interval
+static void BM_Instrumented_Iterate(benchmark::State &state) {
+    const art::instrumented_radix_map<map_type> map(filled_map(random_keys(state.range(0))), state.range(1));
+
+    while (state.KeepRunning()) {
+        for (auto it = map.begin(); it != map.end(); ++it)
+            benchmark::DoNotOptimize(it->second);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Find)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_Instrumented_Find)->Args({1 << 10, 1})->Args({1 << 10, 64})->Args({1 << 10, 1 << 30})->Args({1 << 20, 1})->Args({1 << 20, 64});
+BENCHMARK(BM_Iterate)->Arg(1 << 16);
+BENCHMARK(BM_Instrumented_Iterate)->Args({1 << 16, 1})->Args({1 << 16, 64});
+
+BENCHMARK_MAIN();
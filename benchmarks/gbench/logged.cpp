@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <art/logged_radix_map.h>
+#include <art/radix_map.h>
+
+namespace
+{
+    const char *LOG_PATH = "gbench_logged.log";
+
+    std::vector<uint64_t> random_keys(size_t size) {
+        std::mt19937_64 gen(size);
+        std::vector<uint64_t> keys(size);
+        for (auto &key : keys)
+            key = gen();
+        return keys;
+    }
+}
+
+// Arguments: number of elements, commit latency budget in microseconds
+static void BM_Logged_Insert(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    art::log_options options;
+    options.commit_latency = std::chrono::microseconds(state.range(1));
+
+    while (state.KeepRunning()) {
+        std::remove(LOG_PATH);
+        art::logged_radix_map<uint64_t, uint64_t> map(LOG_PATH, options);
+        for (uint64_t key : keys)
+            map.insert(std::make_pair(key, key));
+        map.sync();
+        state.counters["commits"] = map.commits();
+    }
+    std::remove(LOG_PATH);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Every insert waits for its own fsync, the hand-rolled baseline
+static void BM_Logged_Insert_Sync_Each(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+
+    while (state.KeepRunning()) {
+        std::remove(LOG_PATH);
+        art::logged_radix_map<uint64_t, uint64_t> map(LOG_PATH);
+        for (uint64_t key : keys) {
+            map.insert(std::make_pair(key, key));
+            map.sync();
+        }
+    }
+    std::remove(LOG_PATH);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// In-memory baseline
+static void BM_Radix_Map_Insert(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+
+    while (state.KeepRunning()) {
+        art::radix_map<uint64_t, uint64_t> map;
+        for (uint64_t key : keys)
+            map.insert(std::make_pair(key, key));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Logged_Insert)
+        ->Args({1 << 20, 0})->Args({1 << 20, 500})->Args({1 << 20, 2000})->Args({1 << 20, 10000})
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Logged_Insert_Sync_Each)->Arg(1 << 12)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Radix_Map_Insert)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <art/paged_radix_map.h>
+#include <art/radix_map.h>
+
+// Arguments: number of elements, number of buffer pages (4 KiB each)
+namespace
+{
+    typedef art::paged_radix_map<uint64_t, uint64_t> paged_map;
+
+    std::vector<uint64_t> random_keys(size_t size) {
+        std::mt19937_64 gen(size);
+        std::vector<uint64_t> keys(size);
+        for (auto &key : keys)
+            key = gen();
+        return keys;
+    }
+
+    // One filled map per configuration, shared by the lookup benchmarks
+    paged_map &filled_map(size_t size, size_t buffer_pages) {
+        static std::map<std::pair<size_t, size_t>, std::unique_ptr<paged_map> > cache;
+        std::unique_ptr<paged_map> &map = cache[std::make_pair(size, buffer_pages)];
+        if (!map) {
+            map.reset(new paged_map(buffer_pages));
+            for (uint64_t key : random_keys(size))
+                map->insert(std::make_pair(key, key));
+        }
+        return *map;
+    }
+}
+
+static void BM_Paged_Insert(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+
+    while (state.KeepRunning()) {
+        paged_map map(state.range(1));
+        for (uint64_t key : keys)
+            map.insert(std::make_pair(key, key));
+        state.counters["page_reads"] = map.page_reads();
+        state.counters["page_writes"] = map.page_writes();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Uniform lookups: with a small pool most of them read a leaf page
+static void BM_Paged_Lookup_Uniform(benchmark::State &state) {
+    paged_map &map = filled_map(state.range(0), state.range(1));
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> dis(0, keys.size() - 1);
+
+    const uint64_t reads = map.page_reads();
+    uint64_t value;
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(map.find(keys[dis(gen)], value));
+    state.counters["reads_per_lookup"] = double(map.page_reads() - reads) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 90% of the lookups go to the first 5% of the keys, the hot pages stay resident
+static void BM_Paged_Lookup_Skewed(benchmark::State &state) {
+    paged_map &map = filled_map(state.range(0), state.range(1));
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> hot(0, keys.size() / 20 - 1);
+    std::uniform_int_distribution<size_t> all(0, keys.size() - 1);
+    std::uniform_int_distribution<int> coin(0, 9);
+
+    const uint64_t reads = map.page_reads();
+    uint64_t value;
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(map.find(keys[coin(gen) == 0 ? all(gen) : hot(gen)], value));
+    state.counters["reads_per_lookup"] = double(map.page_reads() - reads) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+// In-memory baseline
+static void BM_Radix_Map_Lookup_Uniform(benchmark::State &state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0));
+    art::radix_map<uint64_t, uint64_t> map;
+    for (uint64_t key : keys)
+        map.insert(std::make_pair(key, key));
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> dis(0, keys.size() - 1);
+
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(map.find(keys[dis(gen)]));
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 2^22 elements take about 2^15 pages: all resident, an eighth, a 64th
+BENCHMARK(BM_Paged_Insert)
+        ->Args({1 << 22, 1 << 16})->Args({1 << 22, 1 << 12})->Args({1 << 22, 1 << 9})
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Paged_Lookup_Uniform)
+        ->Args({1 << 22, 1 << 16})->Args({1 << 22, 1 << 12})->Args({1 << 22, 1 << 9});
+BENCHMARK(BM_Paged_Lookup_Skewed)
+        ->Args({1 << 22, 1 << 16})->Args({1 << 22, 1 << 12})->Args({1 << 22, 1 << 9});
+BENCHMARK(BM_Radix_Map_Lookup_Uniform)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,307 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <btree_map.h>
+#include <art/radix_map.h>
+#include <art/rw_lock.h>
+#include "workloads/workloads.h"
+
+// Scaling of the single threaded containers with the number of threads:
+// lookups in a shared const map, lookups next to an externally synchronized
+// writer, building one map per thread and scanning disjoint ranges of a
+// shared map, for radix_map and btree_map.
+//
+// Besides the throughput every run reports
+//
+//   efficiency    throughput per thread relative to the run with the fewest
+//                 threads, 1 is linear scaling
+//   vs_btree_map  throughput per thread relative to btree_map at the same
+//                 number of threads, radix_map only
+//
+// Build and scan split a fixed amount of work between the threads (strong
+// scaling), lookups keep every thread busy with its own lookups (weak
+// scaling). Thread counts go up to the number of hardware threads, beyond
+// that the numbers show time slicing rather than scaling.
+
+// Elements in the shared maps, also the elements built per iteration of BM_Parallel_Build
+const size_t SIZE = 1 << 20;
+
+namespace
+{
+    typedef uint64_t key_type;
+    typedef std::chrono::steady_clock clock_type;
+
+    template<typename Map>
+    struct container_name;
+
+    template<>
+    struct container_name<art::radix_map<key_type, uint64_t> > {
+        static const char *value() { return "radix_map"; }
+    };
+
+    template<>
+    struct container_name<btree::btree_map<key_type, uint64_t> > {
+        static const char *value() { return "btree_map"; }
+    };
+
+    int max_threads() {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // SIZE keys in the shared maps, followed by SIZE keys the writer inserts and erases
+    const std::vector<key_type> &all_keys() {
+        static const std::vector<key_type> keys = workloads::uniform_keys<key_type>(2 * SIZE);
+        return keys;
+    }
+
+    template<typename Map>
+    Map build(const std::vector<key_type> &keys) {
+        Map m;
+        for (size_t i = 0; i < keys.size(); i++)
+            m.insert(std::make_pair(keys[i], i));
+        return m;
+    }
+
+    template<typename Map>
+    const Map &shared_map() {
+        static const Map m = build<Map>(std::vector<key_type>(all_keys().begin(), all_keys().begin() + SIZE));
+        return m;
+    }
+
+    /**
+     * The part of @a __parts equal ranges of the key space that @a __key falls
+     * into, as a sharded map would split the keys. Taken from the upper 32
+     * bits, so the ranges are equal up to 2^32 keys.
+     */
+    int part_of(key_type __key, int __parts) {
+        return static_cast<int>(((__key >> 32) * static_cast<uint64_t>(__parts)) >> 32);
+    }
+
+    // the smallest key of the @a __part-th range
+    key_type range_start(int __part, int __parts) {
+        return ((static_cast<uint64_t>(__part) << 32) + __parts - 1) / __parts << 32;
+    }
+
+    // the keys from @a __begin to @a __end that fall into the @a __part-th range
+    std::vector<key_type> partition(std::vector<key_type>::const_iterator __begin,
+                                    std::vector<key_type>::const_iterator __end, int __part, int __parts) {
+        std::vector<key_type> keys;
+        for (auto it = __begin; it != __end; ++it) {
+            if (part_of(*it, __parts) == __part)
+                keys.push_back(*it);
+        }
+        return keys;
+    }
+
+    /**
+     * Per-thread throughput of the runs so far, by scenario, container,
+     * thread count and thread, to compute the scaling counters. Runs with
+     * the same key overwrite each other, so the last of gbench's trial runs
+     * and repetitions counts.
+     */
+    class scaling {
+        typedef std::map<int, std::map<int, double> > runs;
+
+        std::mutex _mutex;
+        std::map<std::string, runs> _rates;
+
+        static double per_thread(const std::map<int, double> &rates) {
+            double sum = 0;
+            for (const auto &rate : rates)
+                sum += rate.second;
+            return rates.empty() ? 0 : sum / rates.size();
+        }
+
+    public:
+        static scaling &instance() {
+            static scaling s;
+            return s;
+        }
+
+        /**
+         * @brief Records the throughput of the calling thread and sets its share
+         * of the efficiency and vs_btree_map counters.
+         * @param __workers  Threads whose throughput is measured, the others
+         * (e.g. a writer) do not call report().
+         */
+        void report(benchmark::State &__state, const std::string &__scenario, const std::string &__container,
+                    double __rate, int __workers) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const int threads = __state.threads;
+            runs &own = _rates[__scenario + "/" + __container];
+            own[threads][__state.thread_index] = __rate;
+
+            // the counters are summed over all threads and divided by their number
+            const double share = double(threads) / __workers;
+            const auto base = own.begin();
+            const double base_rate = base->first == threads ? __rate : per_thread(base->second);
+            __state.counters["efficiency"] = benchmark::Counter(__rate / base_rate * share,
+                                                                benchmark::Counter::kAvgThreads);
+
+            if (__container == "btree_map")
+                return;
+            runs &btree = _rates[__scenario + "/btree_map"];
+            const auto it = btree.find(threads);
+            if (it != btree.end()) {
+                __state.counters["vs_btree_map"] = benchmark::Counter(__rate / per_thread(it->second) * share,
+                                                                      benchmark::Counter::kAvgThreads);
+            }
+        }
+    };
+
+    double seconds_since(clock_type::time_point __start) {
+        return std::chrono::duration<double>(clock_type::now() - __start).count();
+    }
+}  // namespace
+
+/**
+ * Random lookups of present keys in a const map shared by all threads.
+ */
+template<typename Map>
+static void BM_Shared_Lookup(benchmark::State &state) {
+    const Map &m = shared_map<Map>();
+    std::vector<key_type> lookups(all_keys().begin(), all_keys().begin() + SIZE);
+    workloads::shuffle(lookups, workloads::seed() + state.thread_index + 1);
+
+    size_t i = 0;
+    clock_type::time_point start;
+    while (state.KeepRunning()) {
+        if (i == 0)
+            start = clock_type::now();
+        benchmark::DoNotOptimize(m.find(lookups[i++ % SIZE]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    scaling::instance().report(state, "lookup", container_name<Map>::value(), i / seconds_since(start),
+                               state.threads);
+}
+
+/**
+ * Thread 0 inserts and erases keys under the exclusive lock of an
+ * rw_lock, all other threads look up keys under its shared lock; only
+ * the lookups are counted.
+ */
+template<typename Map>
+static void BM_Readers_Writer(benchmark::State &state) {
+    static Map m = build<Map>(std::vector<key_type>(all_keys().begin(), all_keys().begin() + SIZE));
+    static art::detail::rw_lock lock;
+
+    std::mt19937_64 gen(workloads::seed() + state.thread_index + 1);
+    std::uniform_int_distribution<size_t> index(0, SIZE - 1);
+    const std::vector<key_type> &keys = all_keys();
+    if (state.thread_index == 0) {
+        while (state.KeepRunning()) {
+            const key_type key = keys[SIZE + index(gen)];
+            std::lock_guard<art::detail::rw_lock> guard(lock);
+            if (m.erase(key) == 0)
+                m.insert(std::make_pair(key, key));
+        }
+        return;
+    }
+
+    size_t i = 0;
+    clock_type::time_point start;
+    while (state.KeepRunning()) {
+        if (i++ == 0)
+            start = clock_type::now();
+        const key_type key = keys[index(gen)];
+        art::detail::shared_guard guard(lock);
+        benchmark::DoNotOptimize(m.find(key) != m.end());
+    }
+    state.SetItemsProcessed(state.iterations());
+    scaling::instance().report(state, "readers_writer", container_name<Map>::value(), i / seconds_since(start),
+                               state.threads - 1);
+}
+
+/**
+ * Every thread builds a map of the keys in its share of the key space,
+ * together SIZE keys, and destroys it again.
+ */
+template<typename Map>
+static void BM_Parallel_Build(benchmark::State &state) {
+    const std::vector<key_type> keys = partition(all_keys().begin(), all_keys().begin() + SIZE,
+                                                 state.thread_index, state.threads);
+
+    size_t built = 0;
+    clock_type::time_point start;
+    while (state.KeepRunning()) {
+        if (built == 0)
+            start = clock_type::now();
+        const Map m = build<Map>(keys);
+        benchmark::DoNotOptimize(m.size());
+        built += keys.size();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+    scaling::instance().report(state, "build", container_name<Map>::value(), built / seconds_since(start),
+                               state.threads);
+}
+
+/**
+ * Every thread iterates over its share of the key space in a const map
+ * shared by all threads, together all SIZE elements.
+ */
+template<typename Map>
+static void BM_Parallel_Scan(benchmark::State &state) {
+    const Map &m = shared_map<Map>();
+    const key_type first = range_start(state.thread_index, state.threads);
+    const bool last = state.thread_index + 1 == state.threads;
+    const key_type end = last ? 0 : range_start(state.thread_index + 1, state.threads);
+
+    size_t visited = 0;
+    clock_type::time_point start;
+    while (state.KeepRunning()) {
+        if (visited == 0)
+            start = clock_type::now();
+        uint64_t sum = 0;
+        for (auto it = m.lower_bound(first); it != m.end() && (last || it->first < end); ++it) {
+            sum += it->second;
+            visited++;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(visited);
+    scaling::instance().report(state, "scan", container_name<Map>::value(), visited / seconds_since(start),
+                               state.threads);
+}
+
+// btree_map first, its runs are the reference of vs_btree_map
+BENCHMARK_TEMPLATE(BM_Shared_Lookup, btree::btree_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Shared_Lookup, art::radix_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+// one writer, 1 to max_threads() - 1 readers
+BENCHMARK_TEMPLATE(BM_Readers_Writer, btree::btree_map<key_type, uint64_t>)
+        ->ThreadRange(2, std::max(2, max_threads()))
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Readers_Writer, art::radix_map<key_type, uint64_t>)
+        ->ThreadRange(2, std::max(2, max_threads()))
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Parallel_Build, btree::btree_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Parallel_Build, art::radix_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Parallel_Scan, btree::btree_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Parallel_Scan, art::radix_map<key_type, uint64_t>)
+        ->ThreadRange(1, max_threads())
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
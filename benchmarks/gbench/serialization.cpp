@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <art/radix_map.h>
+
+namespace
+{
+    typedef art::radix_map<uint64_t, uint64_t> map_type;
+
+    // Sorted distinct random keys and the image of the map holding them,
+    // built once per size and shared by all benchmarks
+    struct dataset {
+        std::vector<std::pair<uint64_t, uint64_t> > sorted;
+        std::vector<std::pair<uint64_t, uint64_t> > shuffled;
+        std::string image;
+    };
+
+    const dataset &dataset_of(size_t size) {
+        static std::map<size_t, dataset> cache;
+        auto it = cache.find(size);
+        if (it != cache.end())
+            return it->second;
+
+        dataset &data = cache[size];
+        std::mt19937_64 gen(size);
+        while (data.sorted.size() < size) {
+            while (data.sorted.size() < size)
+                data.sorted.push_back(std::make_pair(gen(), gen()));
+            std::sort(data.sorted.begin(), data.sorted.end());
+            data.sorted.erase(std::unique(data.sorted.begin(), data.sorted.end(),
+                                          [](const std::pair<uint64_t, uint64_t> &a,
+                                             const std::pair<uint64_t, uint64_t> &b) { return a.first == b.first; }),
+                              data.sorted.end());
+        }
+        data.shuffled = data.sorted;
+        std::shuffle(data.shuffled.begin(), data.shuffled.end(), gen);
+
+        // built in key order, so that freeing it does not leave the heap
+        // handing out scattered addresses to the first measured run
+        map_type map;
+        for (auto &x : data.sorted)
+            map.insert(x);
+        std::ostringstream os;
+        map.save(os);
+        data.image = os.str();
+        return data;
+    }
+}
+
+// Reload from an in-memory image, decoding and the bottom-up build
+static void BM_Load(benchmark::State &state) {
+    const dataset &data = dataset_of(state.range(0));
+
+    while (state.KeepRunning()) {
+        std::istringstream is(data.image);
+        map_type *map = new map_type();
+        map->load(is);
+        benchmark::DoNotOptimize(map->size());
+        state.PauseTiming();
+        delete map;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * data.image.size());
+}
+
+// The insert path the reload replaces, with the same keys in key order
+static void BM_Insert_Sorted(benchmark::State &state) {
+    const dataset &data = dataset_of(state.range(0));
+
+    while (state.KeepRunning()) {
+        map_type *map = new map_type();
+        for (auto &x : data.sorted)
+            map->insert(x);
+        benchmark::DoNotOptimize(map->size());
+        state.PauseTiming();
+        delete map;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// ... and in random order, e.g. when reloading from another source
+static void BM_Insert_Random(benchmark::State &state) {
+    const dataset &data = dataset_of(state.range(0));
+
+    while (state.KeepRunning()) {
+        map_type *map = new map_type();
+        for (auto &x : data.shuffled)
+            map->insert(x);
+        benchmark::DoNotOptimize(map->size());
+        state.PauseTiming();
+        delete map;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Save(benchmark::State &state) {
+    const dataset &data = dataset_of(state.range(0));
+    std::istringstream is(data.image);
+    map_type map;
+    map.load(is);
+
+    while (state.KeepRunning()) {
+        std::ostringstream os;
+        map.save(os);
+        benchmark::DoNotOptimize(os.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * data.image.size());
+}
+
+// Arguments: number of elements, number of elements modified before each checkpoint
+static void BM_Checkpoint_Incremental(benchmark::State &state) {
+    const dataset &data = dataset_of(state.range(0));
+    std::istringstream is(data.image);
+    map_type map;
+    map.restore(is);
+    std::mt19937_64 gen(1);
+    std::uniform_int_distribution<size_t> dis(0, data.sorted.size() - 1);
+
+    size_t bytes = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        for (int64_t i = 0; i < state.range(1); i++) {
+            auto it = map.find(data.sorted[dis(gen)].first);
+            it->second++;
+            map.mark_changed(it);
+        }
+        std::ostringstream os;
+        state.ResumeTiming();
+
+        map.checkpoint_incremental(os);
+        bytes += os.str().size();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    state.SetBytesProcessed(bytes);
+    state.counters["bytes_per_change"] = double(bytes) / (state.iterations() * state.range(1));
+}
+
+BENCHMARK(BM_Load)->Arg(1 << 20)->Arg(1 << 23)->Arg(50000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Insert_Sorted)->Arg(1 << 20)->Arg(1 << 23)->Arg(50000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Insert_Random)->Arg(1 << 20)->Arg(1 << 23)->Arg(50000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Save)->Arg(1 << 20)->Arg(1 << 23)->Arg(50000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Checkpoint_Incremental)
+        ->Args({1 << 23, 1000})->Args({1 << 23, 100000})->Args({50000000, 1000})->Args({50000000, 100000})
+        ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
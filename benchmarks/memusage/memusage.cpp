@@ -1,106 +1,275 @@
-#include <unistd.h>
-#include <ios>
+// Exact memory usage of the containers, counted in a replaced global
+// operator new and delete instead of sampled from the resident set size,
+// which mixes in allocator caching and page granularity.
+//
+// Usage: memusage [elements] [churn rounds]
+//
+// For every container, key width (32 and 64 bit) and key distribution of
+// workloads.h it writes one CSV line to stdout:
+//
+//   live_bytes          bytes the container holds after inserting the keys
+//   bytes_per_key       live_bytes per element
+//   overhead_per_key    bytes_per_key minus the size of the value_type
+//   allocations         number of allocations while inserting
+//   peak_bytes          most bytes held at once while inserting
+//   churn_live_bytes    bytes held after the churn rounds, each erasing a
+//                       random 10% of the elements and inserting as many new ones
+//   churn_heap_bytes    churn_live_bytes plus the free memory the allocator
+//                       keeps from the system afterwards, glibc only, 0 elsewhere
+//
+// churn_heap_bytes / churn_live_bytes is the fragmentation the churn left
+// behind; every measurement runs in a child process with a fresh heap. Bytes are what the allocator hands out for a request, so with
+// glibc they include its rounding to size classes (malloc_usable_size);
+// elsewhere they are the requested sizes.
+//
+// The space overhead chart in the README plots overhead_per_key of the
+// 64 bit maps with uniform keys.
+
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
-#include <random>
 #include <map>
+#include <new>
+#include <random>
 #include <set>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <art/radix_map.h>
 #include <art/radix_set.h>
 #include "btree_map.h"
 #include "btree_set.h"
+#include "workloads/workloads.h"
 
-// Source: http://stackoverflow.com/a/671389/1311693
+#include <sys/wait.h>
+#include <unistd.h>
 
-//////////////////////////////////////////////////////////////////////////////
-//
-// process_mem_usage(double &, double &) - takes two doubles by reference,
-// attempts to read the system-dependent data for a process' virtual memory
-// size and resident set size, and return the results in KB.
-//
-// On failure, returns 0.0, 0.0
-
-void process_mem_usage(double &vm_usage, double &resident_set) {
-    using std::ios_base;
-    using std::ifstream;
-    using std::string;
-
-    vm_usage = 0.0;
-    resident_set = 0.0;
-
-    // 'file' stat seems to give the most reliable results
-    //
-    ifstream stat_stream("/proc/self/stat", ios_base::in);
-
-    // dummy vars for leading entries in stat that we don't care about
-    //
-    string pid, comm, state, ppid, pgrp, session, tty_nr;
-    string tpgid, flags, minflt, cminflt, majflt, cmajflt;
-    string utime, stime, cutime, cstime, priority, nice;
-    string O, itrealvalue, starttime;
-
-    // the two fields we want
-    //
-    unsigned long vsize;
-    long rss;
-
-    stat_stream >> pid >> comm >> state >> ppid >> pgrp >> session >> tty_nr
-    >> tpgid >> flags >> minflt >> cminflt >> majflt >> cmajflt
-    >> utime >> stime >> cutime >> cstime >> priority >> nice
-    >> O >> itrealvalue >> starttime >> vsize >> rss; // don't care about the rest
-
-    stat_stream.close();
-
-    long page_size_kb = sysconf(_SC_PAGE_SIZE) / 1024; // in case x86-64 is configured to use 2MB pages
-    vm_usage = vsize / 1024.0;
-    resident_set = rss * page_size_kb;
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace
+{
+    // allocation counters, memusage is single threaded
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t allocations = 0;
+
+#ifdef __GLIBC__
+    // glibc knows the size of every block, no header needed
+    const size_t HEADER = 0;
+
+    size_t block_size(void *block, size_t) {
+        return malloc_usable_size(block);
+    }
+#else
+    // elsewhere the requested size is stored in front of the block
+    const size_t HEADER = alignof(std::max_align_t);
+
+    size_t block_size(void *block, size_t requested) {
+        if (requested != 0)
+            *static_cast<size_t *>(block) = requested;
+        return *static_cast<size_t *>(block);
+    }
+#endif
+
+    void *allocate(size_t size) {
+        void *block = std::malloc(size + HEADER);
+        if (block == nullptr)
+            return nullptr;
+        live_bytes += block_size(block, size == 0 ? 1 : size);
+        peak_bytes = std::max(peak_bytes, live_bytes);
+        allocations++;
+        return static_cast<char *>(block) + HEADER;
+    }
+
+    void deallocate(void *p) {
+        if (p == nullptr)
+            return;
+        void *block = static_cast<char *>(p) - HEADER;
+        live_bytes -= block_size(block, 0);
+        std::free(block);
+    }
+
+    /**
+     * Bytes the allocator took from the system and did not give back.
+     */
+    size_t heap_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        const struct mallinfo2 info = mallinfo2();
+        return info.arena + info.hblkhd;
+#else
+        return 0;
+#endif
+    }
+
+    void release_free_memory() {
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+    }
 }
 
-int main() {
-    using std::cout;
-    using std::endl;
+void *operator new(size_t size) {
+    void *p = allocate(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
 
-    double vm, rss;
-    process_mem_usage(vm, rss);
-    cout << "VM: " << vm << "; RSS: " << rss << endl;
+void *operator new[](size_t size) {
+    return operator new(size);
+}
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int64_t> dis(std::numeric_limits<int64_t>::min(),
-                                               std::numeric_limits<int64_t>::max());
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
 
-    std::vector<std::pair<int64_t, int64_t> > data;
-    const int size = 8000000;
-    for (int i = 0; i < size; i++) {
-        int64_t candidate = dis(gen);
-        data.emplace_back(candidate, i);
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void *p) noexcept {
+    deallocate(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    deallocate(p);
+}
+
+namespace
+{
+    template<typename Container>
+    struct element {
+        template<typename K>
+        static typename Container::value_type make(K key) {
+            return typename Container::value_type(key, 0);
+        }
+    };
+
+    template<typename K>
+    struct element<std::set<K> > {
+        static K make(K key) { return key; }
+    };
+
+    template<typename K>
+    struct element<std::unordered_set<K> > {
+        static K make(K key) { return key; }
+    };
+
+    template<typename K>
+    struct element<btree::btree_set<K> > {
+        static K make(K key) { return key; }
+    };
+
+    template<typename K>
+    struct element<art::radix_set<K> > {
+        static K make(K key) { return key; }
+    };
+
+    template<typename Container>
+    void run(const char *name, workloads::key_distribution distribution, size_t size, size_t rounds) {
+        typedef typename Container::key_type K;
+
+        // the first size keys are inserted, the others replace erased keys during the churn
+        const size_t per_round = size / 10;
+        const std::vector<K> keys = workloads::keys<K>(distribution, size + rounds * per_round);
+        std::vector<size_t> present(size);
+        for (size_t i = 0; i < size; i++)
+            present[i] = i;
+        std::mt19937_64 gen(workloads::seed());
+
+        release_free_memory();
+        const size_t base_bytes = live_bytes;
+        const size_t base_allocations = allocations;
+        peak_bytes = live_bytes;
+        // free memory the allocator already held, e.g. from generating the keys
+        const size_t base_free = heap_bytes() > live_bytes ? heap_bytes() - live_bytes : 0;
+        {
+            Container container;
+            for (size_t i = 0; i < size; i++)
+                container.insert(element<Container>::make(keys[i]));
+            const size_t built_bytes = live_bytes - base_bytes;
+            const size_t built_allocations = allocations - base_allocations;
+            const size_t built_peak = peak_bytes - base_bytes;
+
+            size_t next = size;
+            for (size_t round = 0; round < rounds; round++) {
+                std::shuffle(present.begin(), present.end(), gen);
+                for (size_t i = 0; i < per_round; i++) {
+                    container.erase(keys[present[i]]);
+                    present[i] = next++;
+                    container.insert(element<Container>::make(keys[present[i]]));
+                }
+            }
+            const size_t churn_bytes = live_bytes - base_bytes;
+            // the container's blocks plus the free memory the allocator holds on to since
+            const size_t held = heap_bytes();
+            const size_t free_bytes = held > live_bytes ? held - live_bytes : 0;
+            const size_t churn_heap = held == 0 ? 0 : churn_bytes + (free_bytes > base_free ? free_bytes - base_free : 0);
+
+            const double per_key = double(built_bytes) / double(size);
+            std::cout << name << "," << sizeof(K) * 8 << "," << workloads::name(distribution) << "," << size
+                      << "," << built_bytes << "," << per_key << ","
+                      << per_key - double(sizeof(typename Container::value_type)) << "," << built_allocations
+                      << "," << built_peak << "," << churn_bytes << "," << churn_heap << std::endl;
+        }
     }
 
-    double basline_vm, basline_rss;
-    process_mem_usage(basline_vm, basline_rss);
-    cout << "Baseline VM: " << basline_vm << "; RSS: " << basline_rss << endl;
-
-    {
-        //std::map<int64_t, int64_t> map;
-        //std::unordered_map<int64_t, int64_t> map;
-        //btree::btree_map<int64_t, int64_t> map;
-        art::radix_map<int64_t, int64_t> map;
-        //std::set<int64_t> set;
-        //std::unordered_set<int64_t> set;
-        //btree::btree_set<int64_t> set;
-        //art::radix_set<int64_t> set;
-        for (auto &d : data) {
-            map.insert(d);
-            //set.insert(d.first);
+    /**
+     * Runs one measurement in a child process, so that it starts with a heap
+     * that no other container fragmented.
+     */
+    template<typename Container>
+    void measure(const char *name, workloads::key_distribution distribution, size_t size, size_t rounds) {
+        std::cout.flush();
+        const pid_t pid = fork();
+        if (pid == 0) {
+            run<Container>(name, distribution, size, rounds);
+            std::cout.flush();
+            std::_Exit(0);
         }
+        if (pid < 0) {
+            run<Container>(name, distribution, size, rounds);
+            return;
+        }
+        int status;
+        waitpid(pid, &status, 0);
+    }
 
-        double vm, rss;
-        process_mem_usage(vm, rss);
-        cout << "Afterwards VM: " << vm << "; RSS: " << rss << endl;
-        double byte_overhead = (((vm - basline_vm) * 1024) / ((double) size)) - sizeof(std::pair<int64_t, int64_t>);
-        //double byte_overhead = (((vm - basline_vm) * 1024) / ((double) size)) - sizeof(int64_t);
-        cout << "Overhead/Key in Byte: " << byte_overhead << endl;
+    template<typename K>
+    void measure_all(workloads::key_distribution d, size_t size, size_t rounds) {
+        measure<std::map<K, uint64_t> >("std::map", d, size, rounds);
+        measure<std::unordered_map<K, uint64_t> >("std::unordered_map", d, size, rounds);
+        measure<btree::btree_map<K, uint64_t> >("btree_map", d, size, rounds);
+        measure<art::radix_map<K, uint64_t> >("radix_map", d, size, rounds);
+        measure<std::set<K> >("std::set", d, size, rounds);
+        measure<std::unordered_set<K> >("std::unordered_set", d, size, rounds);
+        measure<btree::btree_set<K> >("btree_set", d, size, rounds);
+        measure<art::radix_set<K> >("radix_set", d, size, rounds);
     }
-}
\ No newline at end of file
+}
+
+int main(int argc, char **argv) {
+    const size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+
+    std::cout << "container,key_bits,distribution,size,live_bytes,bytes_per_key,overhead_per_key,allocations,"
+              << "peak_bytes,churn_live_bytes,churn_heap_bytes" << std::endl;
+    for (int d = 0; d < static_cast<int>(workloads::key_distribution::_end); d++) {
+        const auto distribution = static_cast<workloads::key_distribution>(d);
+        measure_all<int32_t>(distribution, size, rounds);
+        measure_all<int64_t>(distribution, size, rounds);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef ART_BENCHMARKS_ENVIRONMENT_H
+#define ART_BENCHMARKS_ENVIRONMENT_H
+
+#include <cstdlib>
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/**
+ * Control over the machine state a benchmark runs in, to lower the
+ * variance between runs: the CPU it runs on and the contents of the caches.
+ *
+ * The environment variable ART_BENCH_CPU selects the CPU to pin to, by
+ * default the one the process starts on; -1 leaves the scheduler free.
+ * ART_BENCH_FLUSH_MB sets the bytes flush_caches() writes, by default
+ * 256 MiB, at least twice the last level cache of common servers.
+ */
+namespace perf {
+    /**
+     * @brief Restricts the calling thread, and the threads it starts later,
+     * to CPU @a __cpu, so the scheduler cannot migrate it away from its
+     * warm caches mid-run.
+     * @return  Whether the affinity was set, always false without Linux.
+     */
+    inline bool pin_to_cpu(int __cpu) {
+#ifdef __linux__
+        if (__cpu < 0 || __cpu >= CPU_SETSIZE)
+            return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(__cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void) __cpu;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Pins the calling thread as ART_BENCH_CPU says and writes the
+     * outcome to std::cerr.
+     * @return  The CPU pinned to, -1 if none.
+     */
+    inline int pin_from_environment() {
+        const char *env = std::getenv("ART_BENCH_CPU");
+#ifdef __linux__
+        const int cpu = env != nullptr ? std::atoi(env) : sched_getcpu();
+#else
+        const int cpu = env != nullptr ? std::atoi(env) : -1;
+#endif
+        if (cpu < 0)
+            return -1;
+        if (!pin_to_cpu(cpu)) {
+            std::cerr << "cannot pin to CPU " << cpu << ", running unpinned" << std::endl;
+            return -1;
+        }
+        std::cerr << "pinned to CPU " << cpu << std::endl;
+        return cpu;
+    }
+
+    /**
+     * @brief Evicts the data of earlier work from the caches and TLBs by
+     * writing and reading a buffer larger than them, for cold-cache runs.
+     */
+    inline void flush_caches() {
+        static std::vector<uint64_t> buffer([]() {
+            const char *env = std::getenv("ART_BENCH_FLUSH_MB");
+            const size_t mb = env != nullptr ? std::strtoull(env, nullptr, 10) : 256;
+            return mb * (1 << 20) / sizeof(uint64_t);
+        }());
+        static volatile uint64_t sink;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < buffer.size(); i += 8) {
+            buffer[i] += i;
+            sum += buffer[i];
+        }
+        sink = sum;
+    }
+}
+
+#endif //ART_BENCHMARKS_ENVIRONMENT_H
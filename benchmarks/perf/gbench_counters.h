@@ -0,0 +1,55 @@
+#ifndef ART_BENCHMARKS_GBENCH_COUNTERS_H
+#define ART_BENCHMARKS_GBENCH_COUNTERS_H
+
+#include <string>
+#include <benchmark/benchmark.h>
+#include "perf_counters.h"
+
+/**
+ * Google benchmark glue for perf::counters: the counters follow the timer
+ * of the benchmark and are reported per operation as user counters, e.g.
+ * "L1d-miss/op". Without counters the benchmarks report what they did before.
+ */
+namespace perf {
+    inline const char *short_name(event __e) {
+        static const char *const names[EVENTS] = {
+                "instr/op", "cycles/op", "br-miss/op", "LLC-miss/op", "L1d-miss/op", "dTLB-miss/op"
+        };
+        return names[static_cast<size_t>(__e)];
+    }
+
+    /**
+     * Stops the counters and the timer, use instead of state.PauseTiming().
+     */
+    inline void pause(benchmark::State &__state, counters &__c) {
+        __c.stop();
+        __state.PauseTiming();
+    }
+
+    /**
+     * Starts the timer and the counters, use instead of state.ResumeTiming().
+     */
+    inline void resume(benchmark::State &__state, counters &__c) {
+        __state.ResumeTiming();
+        __c.start();
+    }
+
+    /**
+     * @brief Adds the counted events divided by @a __operations to the user
+     * counters of the benchmark, plus the instructions per cycle.
+     */
+    inline void report(benchmark::State &__state, const counters &__c, double __operations) {
+        __c.warn_if_unavailable();
+        if (__operations <= 0)
+            return;
+        for (size_t i = 0; i < EVENTS; i++) {
+            const event e = static_cast<event>(i);
+            if (__c.available(e))
+                __state.counters[short_name(e)] = __c.value(e) / __operations;
+        }
+        if (__c.available(event::instructions) && __c.available(event::cycles) && __c.value(event::cycles) > 0)
+            __state.counters["IPC"] = __c.value(event::instructions) / __c.value(event::cycles);
+    }
+}
+
+#endif //ART_BENCHMARKS_GBENCH_COUNTERS_H
@@ -0,0 +1,213 @@
+#ifndef ART_BENCHMARKS_PERF_COUNTERS_H
+#define ART_BENCHMARKS_PERF_COUNTERS_H
+
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware performance counters of the calling thread, read with
+ * perf_event_open(2), for the benchmark suites.
+ *
+ * Counters the kernel or the processor do not provide, e.g. in a VM,
+ * without Linux or with a too restrictive kernel.perf_event_paranoid, are
+ * reported as unavailable and the benchmarks run as before. Only user
+ * space is counted, which perf_event_paranoid 2, the default, allows.
+ */
+namespace perf {
+    enum class event : unsigned {
+        instructions,
+        cycles,
+        branch_misses,
+        // last level cache misses
+        cache_misses,
+        l1d_load_misses,
+        dtlb_load_misses,
+        _end
+    };
+
+    const size_t EVENTS = static_cast<size_t>(event::_end);
+
+    /**
+     * Returns the name of an event, as perf-stat(1) calls it.
+     */
+    inline const char *name(event __e) {
+        static const char *const names[EVENTS] = {
+                "instructions", "cycles", "branch-misses", "cache-misses", "L1-dcache-load-misses",
+                "dTLB-load-misses"
+        };
+        return names[static_cast<size_t>(__e)];
+    }
+
+    /**
+     * @brief A set of counters that add up the events between start() and stop().
+     *
+     * The counters run from construction on, start() and stop() read them,
+     * which costs one system call per event. When the processor has fewer
+     * counters than requested, the kernel multiplexes them and the counts
+     * are scaled up by the share of the time each one ran.
+     */
+    class counters {
+        int _M_fds[EVENTS];
+        double _M_totals[EVENTS];
+        uint64_t _M_start[EVENTS][3];
+        bool _M_running;
+
+#ifdef __linux__
+        static int open(event __e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (__e) {
+                case event::instructions:
+                    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                    break;
+                case event::cycles:
+                    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                    break;
+                case event::branch_misses:
+                    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                    break;
+                case event::cache_misses:
+                    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                    break;
+                case event::l1d_load_misses:
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                    break;
+                default:
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                    break;
+            }
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            const int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            return fd;
+        }
+
+        // value, time enabled, time running
+        bool read(size_t __i, uint64_t (&__values)[3]) const {
+            return ::read(_M_fds[__i], __values, sizeof(__values)) == static_cast<ssize_t>(sizeof(__values));
+        }
+
+        void disable(size_t __i) {
+            close(_M_fds[__i]);
+            _M_fds[__i] = -1;
+        }
+#else
+        static int open(event) {
+            return -1;
+        }
+
+        bool read(size_t, uint64_t (&)[3]) const {
+            return false;
+        }
+
+        void disable(size_t) {}
+#endif
+
+    public:
+        counters() {
+            for (size_t i = 0; i < EVENTS; i++) {
+                _M_fds[i] = open(static_cast<event>(i));
+                _M_totals[i] = 0;
+            }
+            _M_running = false;
+        }
+
+        counters(const counters &) = delete;
+
+        counters &operator=(const counters &) = delete;
+
+        ~counters() {
+#ifdef __linux__
+            for (int fd : _M_fds) {
+                if (fd >= 0)
+                    close(fd);
+            }
+#endif
+        }
+
+        bool available(event __e) const {
+            return _M_fds[static_cast<size_t>(__e)] >= 0;
+        }
+
+        /**
+         * Returns whether at least one event can be counted.
+         */
+        bool any_available() const {
+            for (int fd : _M_fds) {
+                if (fd >= 0)
+                    return true;
+            }
+            return false;
+        }
+
+        void start() {
+            _M_running = true;
+            for (size_t i = 0; i < EVENTS; i++) {
+                if (_M_fds[i] >= 0 && !read(i, _M_start[i]))
+                    disable(i);
+            }
+        }
+
+        /**
+         * Adds the events since start(), does nothing if the counters are already stopped.
+         */
+        void stop() {
+            if (!_M_running)
+                return;
+            _M_running = false;
+            for (size_t i = 0; i < EVENTS; i++) {
+                uint64_t now[3];
+                if (_M_fds[i] < 0 || !read(i, now))
+                    continue;
+                const double enabled = double(now[1] - _M_start[i][1]);
+                const double running = double(now[2] - _M_start[i][2]);
+                const double value = double(now[0] - _M_start[i][0]);
+                _M_totals[i] += running > 0 ? value * enabled / running : 0;
+            }
+        }
+
+        /**
+         * Returns the events counted between all pairs of start() and stop() so far.
+         */
+        double value(event __e) const {
+            return _M_totals[static_cast<size_t>(__e)];
+        }
+
+        void reset() {
+            for (double &total : _M_totals)
+                total = 0;
+        }
+
+        /**
+         * @brief Writes a note to std::cerr if no event can be counted, once per process.
+         */
+        void warn_if_unavailable() const {
+            static bool warned = false;
+            if (!warned && !any_available()) {
+                std::cerr << "perf counters unavailable (not Linux, no PMU or kernel.perf_event_paranoid > 2), "
+                          << "running without them" << std::endl;
+                warned = true;
+            }
+        }
+    };
+}
+
+#endif //ART_BENCHMARKS_PERF_COUNTERS_H
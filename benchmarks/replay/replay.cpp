@@ -0,0 +1,303 @@
+// Replays an operation trace against radix_map and the containers it
+// competes with.
+//
+// Usage: replay TRACE [--container all|radix_map|map|unordered_map|btree_map]
+//               [--sample N] [--signed]
+//        replay --generate TRACE [--operations N]
+//
+// Traces are written by art::recording_radix_map (include/art/trace.h has
+// the format) around a map of a real application, so the containers are
+// compared on its keys and access pattern instead of a synthetic one.
+// They hold 32 or 64 bit integer keys; their order, which lower_bound and
+// scans depend on, is unsigned unless --signed is given.
+//
+// The trace is read into memory first. Its load records, the elements the
+// recorded map held when the recording started, are inserted before the
+// clock starts. Every other operation counts for the throughput, every
+// --sample-th operation of a kind also for its latency percentiles.
+// std::unordered_map has no order and skips traces with lower_bound or
+// scan records.
+//
+// --generate writes an example trace: a recording radix_map with a million
+// uniform keys serving Zipf distributed finds with some inserts, erases
+// and scans, seeded like the other benchmarks.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <art/latency_histogram.h>
+#include <art/radix_map.h>
+#include <art/recording_radix_map.h>
+#include <art/trace.h>
+#include "btree_map.h"
+#include "workloads/workloads.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock clock_type;
+
+    // the trace operations without load
+    const int OPERATION_KINDS = 5;
+
+    const char *const OPERATION_NAMES[OPERATION_KINDS] = {"find", "insert", "erase", "lower_bound", "scan"};
+
+    int kind(art::trace_op op) {
+        return static_cast<int>(op) - static_cast<int>(art::trace_op::find);
+    }
+
+    struct options {
+        std::string trace;
+        std::string container = "all";
+        uint32_t sample = 16;
+        bool is_signed = false;
+        bool generate = false;
+        size_t operations = 10000000;
+    };
+
+    template<typename K>
+    std::vector<art::trace_event<K> > read_trace(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        art::trace_reader<K> reader(in);
+        std::vector<art::trace_event<K> > events;
+        art::trace_event<K> event;
+        while (reader.next(event))
+            events.push_back(event);
+        return events;
+    }
+
+    template<typename Map>
+    struct is_ordered {
+        static const bool value = true;
+    };
+
+    template<typename K, typename V>
+    struct is_ordered<std::unordered_map<K, V> > {
+        static const bool value = false;
+    };
+
+    template<typename Map, typename K>
+    uint64_t lower_bound(const Map &m, K key, std::true_type) {
+        auto it = m.lower_bound(key);
+        return it != m.end() ? it->second : 0;
+    }
+
+    template<typename Map, typename K>
+    uint64_t scan(const Map &m, K key, uint64_t length, std::true_type) {
+        uint64_t sum = 0;
+        auto it = m.lower_bound(key);
+        for (uint64_t i = 0; i < length && it != m.end(); ++i, ++it)
+            sum += it->second;
+        return sum;
+    }
+
+    template<typename Map, typename K>
+    uint64_t lower_bound(const Map &, K, std::false_type) {
+        return 0;
+    }
+
+    template<typename Map, typename K>
+    uint64_t scan(const Map &, K, uint64_t, std::false_type) {
+        return 0;
+    }
+
+    template<typename Map>
+    void run(const char *name, const std::vector<art::trace_event<typename Map::key_type> > &events,
+             const options &opts) {
+        typedef std::integral_constant<bool, is_ordered<Map>::value> ordered;
+
+        Map m;
+        std::vector<art::latency_histogram> latency(OPERATION_KINDS);
+        std::vector<uint64_t> count(OPERATION_KINDS, 0);
+        uint64_t checksum = 0;
+        uint64_t operations = 0;
+        for (const auto &event : events) {
+            if (event.op == art::trace_op::load) {
+                m.insert(std::make_pair(event.key, 0));
+                continue;
+            }
+            if ((event.op == art::trace_op::lower_bound || event.op == art::trace_op::scan) && !ordered::value) {
+                std::cout << name << ": no ordered lookups, skipped" << std::endl;
+                return;
+            }
+        }
+        const size_t loaded = m.size();
+
+        const clock_type::time_point start = clock_type::now();
+        for (const auto &event : events) {
+            if (event.op == art::trace_op::load)
+                continue;
+            const int k = kind(event.op);
+            const bool sampled = ++count[k] % opts.sample == 0;
+            const clock_type::time_point op_start = sampled ? clock_type::now() : clock_type::time_point();
+
+            switch (event.op) {
+                case art::trace_op::find: {
+                    auto it = m.find(event.key);
+                    if (it != m.end())
+                        checksum += it->second;
+                    break;
+                }
+                case art::trace_op::insert:
+                    m.insert(std::make_pair(event.key, operations));
+                    break;
+                case art::trace_op::erase:
+                    m.erase(event.key);
+                    break;
+                case art::trace_op::lower_bound:
+                    checksum += lower_bound(m, event.key, ordered());
+                    break;
+                default:
+                    checksum += scan(m, event.key, event.length, ordered());
+                    break;
+            }
+            operations++;
+
+            if (sampled) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - op_start);
+                latency[k].record(elapsed.count());
+            }
+        }
+        const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        std::cout << name << ": " << std::fixed << std::setprecision(0) << operations / seconds << " ops/s, "
+                  << loaded << " loaded, " << m.size() << " at the end (checksum " << checksum % 1000 << ")"
+                  << std::endl;
+        for (int k = 0; k < OPERATION_KINDS; k++) {
+            if (count[k] == 0)
+                continue;
+            const art::latency_histogram &h = latency[k];
+            std::cout << "  " << std::left << std::setw(12) << OPERATION_NAMES[k] << std::right
+                      << " ops=" << count[k] << " p50=" << h.percentile(50) << "ns p99=" << h.percentile(99)
+                      << "ns p999=" << h.percentile(99.9) << "ns max=" << h.max() << "ns" << std::endl;
+        }
+    }
+
+    template<typename K>
+    void replay(const options &opts) {
+        const std::vector<art::trace_event<K> > events = read_trace<K>(opts.trace);
+        std::cout << opts.trace << ": " << events.size() << " records, " << sizeof(K) * 8 << " bit "
+                  << (opts.is_signed ? "signed" : "unsigned") << " keys" << std::endl;
+
+        const std::string &c = opts.container;
+        if (c == "all" || c == "radix_map")
+            run<art::radix_map<K, uint64_t> >("radix_map", events, opts);
+        if (c == "all" || c == "btree_map")
+            run<btree::btree_map<K, uint64_t> >("btree_map", events, opts);
+        if (c == "all" || c == "map")
+            run<std::map<K, uint64_t> >("map", events, opts);
+        if (c == "all" || c == "unordered_map")
+            run<std::unordered_map<K, uint64_t> >("unordered_map", events, opts);
+    }
+
+    void generate(const options &opts) {
+        const size_t records = 1000000;
+        const std::vector<uint64_t> keys = workloads::uniform_keys<uint64_t>(records + opts.operations / 20);
+        art::radix_map<uint64_t, uint64_t> initial;
+        for (size_t i = 0; i < records; i++)
+            initial.insert(std::make_pair(keys[i], i));
+
+        std::ofstream out(opts.trace, std::ios::binary | std::ios::trunc);
+        art::recording_radix_map<art::radix_map<uint64_t, uint64_t> > m(initial, out);
+        std::mt19937_64 gen(workloads::seed());
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<size_t> scan_length(1, 100);
+        workloads::zipf_distribution popular(records);
+        size_t inserted = records;
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < opts.operations; i++) {
+            const int p = percent(gen);
+            const uint64_t key = keys[popular(gen)];
+            if (p < 90) {
+                auto it = m.find(key);
+                checksum += it != m.end() ? it->second : 0;
+            } else if (p < 95 && inserted < keys.size()) {
+                m.insert(std::make_pair(keys[inserted++], i));
+            } else if (p < 97) {
+                m.erase(key);
+            } else {
+                m.scan(key, scan_length(gen), [&](const std::pair<const uint64_t, uint64_t> &x) {
+                    checksum += x.second;
+                });
+            }
+        }
+        m.close();
+        std::cout << opts.trace << ": " << m.records() << " records (checksum " << checksum % 1000 << ")"
+                  << std::endl;
+    }
+
+    void usage() {
+        std::cerr << "usage: replay TRACE [--container all|radix_map|map|unordered_map|btree_map]\n"
+                  << "              [--sample N] [--signed]\n"
+                  << "       replay --generate TRACE [--operations N]" << std::endl;
+        std::exit(1);
+    }
+
+    options parse(int argc, char **argv) {
+        options opts;
+        for (int i = 1; i < argc; i++) {
+            const std::string flag = argv[i];
+            if (flag == "--signed") {
+                opts.is_signed = true;
+                continue;
+            }
+            if (flag.compare(0, 2, "--") != 0) {
+                if (!opts.trace.empty())
+                    usage();
+                opts.trace = flag;
+                continue;
+            }
+            if (i + 1 == argc)
+                usage();
+            const std::string value = argv[++i];
+            if (flag == "--generate") {
+                opts.generate = true;
+                opts.trace = value;
+            } else if (flag == "--container") {
+                opts.container = value;
+            } else if (flag == "--sample") {
+                opts.sample = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (flag == "--operations") {
+                opts.operations = std::strtoull(value.c_str(), nullptr, 10);
+            } else {
+                usage();
+            }
+        }
+        if (opts.trace.empty() || opts.sample == 0)
+            usage();
+        return opts;
+    }
+}
+
+int main(int argc, char **argv) {
+    const options opts = parse(argc, argv);
+    try {
+        if (opts.generate) {
+            generate(opts);
+            return 0;
+        }
+        std::ifstream in(opts.trace, std::ios::binary);
+        if (!in) {
+            std::cerr << opts.trace << ": cannot open" << std::endl;
+            return 1;
+        }
+        const uint32_t key_size = art::trace_key_size(in);
+        if (key_size == 4)
+            opts.is_signed ? replay<int32_t>(opts) : replay<uint32_t>(opts);
+        else if (key_size == 8)
+            opts.is_signed ? replay<int64_t>(opts) : replay<uint64_t>(opts);
+        else
+            std::cerr << opts.trace << ": " << key_size << " byte keys, only 4 and 8 are supported" << std::endl;
+        return key_size == 4 || key_size == 8 ? 0 : 1;
+    } catch (const art::serialization_error &e) {
+        std::cerr << opts.trace << ": " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,298 @@
+#ifndef ART_BENCHMARKS_WORKLOADS_H
+#define ART_BENCHMARKS_WORKLOADS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Seeded key generators shared by the benchmark suites, so that runs can be
+ * compared across commits and containers: the same seed gives the same keys
+ * in the same order, whatever the container under test.
+ *
+ * The seed is DEFAULT_SEED unless the environment variable ART_BENCH_SEED
+ * sets another one.
+ */
+namespace workloads {
+    const uint64_t DEFAULT_SEED = 42;
+
+    /**
+     * Returns the seed of this run, see ART_BENCH_SEED.
+     */
+    inline uint64_t seed() {
+        static const uint64_t value = []() {
+            const char *env = std::getenv("ART_BENCH_SEED");
+            return env != nullptr ? std::strtoull(env, nullptr, 10) : DEFAULT_SEED;
+        }();
+        return value;
+    }
+
+    /**
+     * @brief The key sets the generators below produce, e.g. to select one by a
+     * numeric benchmark argument.
+     */
+    enum class key_distribution : int {
+        // uniform over the whole domain of the key type
+        uniform,
+        // 0, 1, 2, ...
+        dense,
+        // runs of nearby keys around uniformly distributed starting points
+        clustered,
+        // increasing with random gaps, arriving slightly out of order
+        monotonic,
+        _end
+    };
+
+    inline const char *name(key_distribution __d) {
+        static const char *const names[] = {"uniform", "dense", "clustered", "monotonic"};
+        return names[static_cast<int>(__d)];
+    }
+
+    namespace detail {
+        /**
+         * Calls @a __next until it returned @a __n distinct keys, which are
+         * returned in the order they were first produced.
+         */
+        template<typename _Key, typename _Next>
+        std::vector<_Key> distinct(size_t __n, _Next __next) {
+            std::vector<_Key> keys;
+            keys.reserve(__n);
+            std::unordered_set<_Key> seen(__n);
+            while (keys.size() < __n) {
+                const _Key key = __next();
+                if (seen.insert(key).second)
+                    keys.push_back(key);
+            }
+            return keys;
+        }
+
+        /**
+         * Converts an unsigned 64 bit value to _Key, keeping the low bits.
+         */
+        template<typename _Key>
+        _Key truncate(uint64_t __v) {
+            typedef typename std::make_unsigned<_Key>::type unsigned_key;
+            return static_cast<_Key>(static_cast<unsigned_key>(__v));
+        }
+    }
+
+    /**
+     * @brief Shuffles @a __v reproducibly, unlike std::random_shuffle whose
+     * randomness is unspecified.
+     */
+    template<typename _T>
+    void shuffle(std::vector<_T> &__v, uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        std::shuffle(__v.begin(), __v.end(), gen);
+    }
+
+    /**
+     * Returns @a __n distinct keys drawn uniformly from the domain of _Key, in random order.
+     */
+    template<typename _Key>
+    std::vector<_Key> uniform_keys(size_t __n, uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        std::uniform_int_distribution<_Key> dis(std::numeric_limits<_Key>::min(), std::numeric_limits<_Key>::max());
+        return detail::distinct<_Key>(__n, [&]() { return dis(gen); });
+    }
+
+    /**
+     * Returns the keys 0 to @a __n - 1 in ascending order.
+     */
+    template<typename _Key>
+    std::vector<_Key> dense_keys(size_t __n) {
+        std::vector<_Key> keys(__n);
+        for (size_t i = 0; i < __n; i++)
+            keys[i] = static_cast<_Key>(i);
+        return keys;
+    }
+
+    /**
+     * @brief Returns @a __n distinct keys in runs of @a __cluster_size, in random order.
+     *
+     * Each run starts at a uniformly drawn key and continues with gaps of 1
+     * to 4, like the ids of records that were created together.
+     */
+    template<typename _Key>
+    std::vector<_Key> clustered_keys(size_t __n, size_t __cluster_size = 1024, uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        std::uniform_int_distribution<uint64_t> gap(1, 4);
+        uint64_t next = 0;
+        size_t left = 0;
+        std::vector<_Key> keys = detail::distinct<_Key>(__n, [&]() {
+            if (left == 0) {
+                next = gen();
+                left = __cluster_size;
+            }
+            left--;
+            next += gap(gen);
+            return detail::truncate<_Key>(next);
+        });
+        shuffle(keys, __seed + 1);
+        return keys;
+    }
+
+    /**
+     * @brief Returns @a __n distinct, increasing keys that arrive out of order
+     * by up to @a __window positions, like timestamps of events that are
+     * collected from several sources.
+     *
+     * The keys start at 0 and grow by 1 to 16.
+     */
+    template<typename _Key>
+    std::vector<_Key> monotonic_keys(size_t __n, size_t __window = 64, uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        std::uniform_int_distribution<uint64_t> gap(1, 16);
+        std::vector<_Key> keys(__n);
+        uint64_t next = 0;
+        for (size_t i = 0; i < __n; i++) {
+            keys[i] = detail::truncate<_Key>(next);
+            next += gap(gen);
+        }
+        for (size_t start = 0; start < __n; start += __window)
+            std::shuffle(keys.begin() + start, keys.begin() + std::min(__n, start + __window), gen);
+        return keys;
+    }
+
+    /**
+     * Returns @a __n distinct keys of the given distribution.
+     */
+    template<typename _Key>
+    std::vector<_Key> keys(key_distribution __d, size_t __n, uint64_t __seed = seed()) {
+        switch (__d) {
+            case key_distribution::uniform:
+                return uniform_keys<_Key>(__n, __seed);
+            case key_distribution::dense:
+                return dense_keys<_Key>(__n);
+            case key_distribution::clustered:
+                return clustered_keys<_Key>(__n, 1024, __seed);
+            default:
+                return monotonic_keys<_Key>(__n, 64, __seed);
+        }
+    }
+
+    /**
+     * @brief Draws ranks 0 to n - 1 with probability proportional to
+     * 1 / (rank + 1)^theta, with the method of Gray et al., "Quickly
+     * generating billion-record synthetic databases", as YCSB does.
+     *
+     * Construction takes O(n), drawing O(1). theta must be in (0, 1).
+     */
+    class zipf_distribution {
+        uint64_t _M_n;
+        double _M_theta;
+        double _M_zetan;
+        double _M_alpha;
+        double _M_eta;
+        std::uniform_real_distribution<double> _M_uniform;
+
+        static double zeta(uint64_t __n, double __theta) {
+            double sum = 0;
+            for (uint64_t i = 1; i <= __n; i++)
+                sum += 1 / std::pow(double(i), __theta);
+            return sum;
+        }
+
+    public:
+        zipf_distribution(uint64_t __n, double __theta = 0.99)
+                : _M_n(__n), _M_theta(__theta), _M_zetan(zeta(__n, __theta)), _M_alpha(1 / (1 - __theta)),
+                  _M_eta((1 - std::pow(2.0 / double(__n), 1 - __theta)) / (1 - zeta(2, __theta) / _M_zetan)),
+                  _M_uniform(0, 1) {}
+
+        template<typename _Gen>
+        uint64_t operator()(_Gen &__gen) {
+            const double u = _M_uniform(__gen);
+            const double uz = u * _M_zetan;
+            if (uz < 1)
+                return 0;
+            if (uz < 1 + std::pow(0.5, _M_theta))
+                return 1;
+            const uint64_t rank = static_cast<uint64_t>(double(_M_n) * std::pow(_M_eta * u - _M_eta + 1, _M_alpha));
+            return std::min(rank, _M_n - 1);
+        }
+    };
+
+    /**
+     * @brief Returns @a __count lookups into @a __keys, Zipf distributed with
+     * skew @a __theta: keys[0] is the most popular key, keys[1] the second
+     * and so on.
+     *
+     * The popular keys are spread over the key space as long as @a __keys
+     * is in random order, as uniform_keys() and clustered_keys() return them.
+     */
+    template<typename _Key>
+    std::vector<_Key> zipf_lookups(const std::vector<_Key> &__keys, size_t __count, double __theta = 0.99,
+                                   uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        zipf_distribution dis(__keys.size(), __theta);
+        std::vector<_Key> lookups(__count);
+        for (auto &lookup : lookups)
+            lookup = __keys[dis(gen)];
+        return lookups;
+    }
+
+    /**
+     * @brief The kinds of string keys string_keys() produces.
+     */
+    enum class string_kind {
+        // e.g. "https://www.tebrasopu.com/kevu/rote/4711"
+        url,
+        // e.g. "ma.tesoku17@dubara.org"
+        email
+    };
+
+    namespace detail {
+        template<typename _Gen>
+        std::string word(_Gen &__gen, size_t __min_syllables, size_t __max_syllables) {
+            static const char consonants[] = "bdfghklmnprstvz";
+            static const char vowels[] = "aeiou";
+            std::uniform_int_distribution<size_t> syllables(__min_syllables, __max_syllables);
+            std::uniform_int_distribution<size_t> consonant(0, sizeof(consonants) - 2);
+            std::uniform_int_distribution<size_t> vowel(0, sizeof(vowels) - 2);
+            std::string result;
+            for (size_t i = syllables(__gen); i > 0; i--) {
+                result += consonants[consonant(__gen)];
+                result += vowels[vowel(__gen)];
+            }
+            return result;
+        }
+    }
+
+    /**
+     * @brief Returns @a __n distinct URL- or email-like strings in random order.
+     *
+     * Like real URLs and addresses they share prefixes and suffixes: hosts
+     * and domains come from a small pool, so many keys share the bytes up
+     * to the path or the local part. All keys are shorter than 64 bytes.
+     */
+    inline std::vector<std::string> string_keys(size_t __n, string_kind __kind, uint64_t __seed = seed()) {
+        std::mt19937_64 gen(__seed);
+        std::vector<std::string> hosts(std::max<size_t>(__n / 1000, 16));
+        for (auto &host : hosts)
+            host = detail::word(gen, 2, 4);
+        std::uniform_int_distribution<size_t> host(0, hosts.size() - 1);
+        std::uniform_int_distribution<size_t> top_level(0, 3);
+        std::uniform_int_distribution<int> number(0, 9999);
+        static const char *const top_level_domains[] = {".com", ".org", ".net", ".de"};
+
+        return detail::distinct<std::string>(__n, [&]() {
+            const std::string domain = hosts[host(gen)] + top_level_domains[top_level(gen)];
+            if (__kind == string_kind::url) {
+                return "https://www." + domain + "/" + detail::word(gen, 1, 3) + "/" + detail::word(gen, 1, 3) +
+                       "/" + std::to_string(number(gen));
+            }
+            return detail::word(gen, 1, 2) + "." + detail::word(gen, 1, 3) + std::to_string(number(gen) % 100) +
+                   "@" + domain;
+        });
+    }
+}
+
+#endif //ART_BENCHMARKS_WORKLOADS_H
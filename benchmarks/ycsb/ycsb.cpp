@@ -0,0 +1,289 @@
+// YCSB-like mixed workloads over radix_map and the containers it competes with.
+//
+// Usage: ycsb [--workload A-F] [--distribution zipfian|uniform|latest]
+//             [--records N] [--operations N] [--sample N]
+//             [--container all|radix_map|map|unordered_map|btree_map]
+//
+// The core workloads of YCSB (Cooper et al., "Benchmarking cloud serving
+// systems with YCSB", SoCC 2010), run in-process on one thread:
+//
+//   A  50% read, 50% update                 (session store)
+//   B  95% read,  5% update                 (photo tagging)
+//   C 100% read                             (user profile cache)
+//   D  95% read,  5% insert, reads of the latest records (status updates)
+//   E  95% scan of 1 to 100 records, 5% insert (threaded conversations)
+//   F  50% read, 50% read-modify-write      (user database)
+//
+// Records are 64 bit keys with 64 bit values instead of YCSB's ten string
+// fields, so the numbers show the cost of the index and not of copying
+// values. Keys are a bijective hash of the insertion number, so inserted
+// records land all over the key space. std::unordered_map has no order
+// and skips workload E.
+//
+// Every operation counts for the throughput, every --sample-th operation
+// of a kind also for its latency percentiles, since reading the clock
+// costs about as much as a lookup in a small map.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <art/latency_histogram.h>
+#include <art/radix_map.h>
+#include "btree_map.h"
+#include "workloads/workloads.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock clock_type;
+
+    enum operation_kind {
+        READ, UPDATE, INSERT, SCAN, READ_MODIFY_WRITE, OPERATION_KINDS
+    };
+
+    const char *const OPERATION_NAMES[OPERATION_KINDS] = {"read", "update", "insert", "scan", "read-modify-write"};
+
+    enum distribution_kind {
+        ZIPFIAN, UNIFORM, LATEST
+    };
+
+    struct workload {
+        char name;
+        // percent of each operation kind, summing up to 100
+        int mix[OPERATION_KINDS];
+        distribution_kind distribution;
+    };
+
+    const workload WORKLOADS[] = {
+            {'A', {50, 50, 0, 0, 0},  ZIPFIAN},
+            {'B', {95, 5,  0, 0, 0},  ZIPFIAN},
+            {'C', {100, 0, 0, 0, 0},  ZIPFIAN},
+            {'D', {95, 0,  5, 0, 0},  LATEST},
+            {'E', {0,  0,  5, 95, 0}, ZIPFIAN},
+            {'F', {50, 0,  0, 0, 50}, ZIPFIAN}
+    };
+
+    const size_t MAX_SCAN_LENGTH = 100;
+
+    struct options {
+        workload load = WORKLOADS[0];
+        bool distribution_set = false;
+        distribution_kind distribution = ZIPFIAN;
+        size_t records = 1000000;
+        size_t operations = 10000000;
+        uint32_t sample = 16;
+        std::string container = "all";
+    };
+
+    // the splitmix64 finalizer, a bijection, so distinct insertion numbers give distinct keys
+    uint64_t record_key(uint64_t n) {
+        n += 0x9e3779b97f4a7c15ULL;
+        n = (n ^ (n >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        n = (n ^ (n >> 27)) * 0x94d049bb133111ebULL;
+        return n ^ (n >> 31);
+    }
+
+    /**
+     * Picks the insertion number of the record an operation targets.
+     */
+    class record_chooser {
+        distribution_kind _distribution;
+        workloads::zipf_distribution _zipf;
+
+    public:
+        record_chooser(distribution_kind distribution, size_t records)
+                : _distribution(distribution), _zipf(records) {}
+
+        template<typename Gen>
+        uint64_t operator()(Gen &gen, uint64_t inserted) {
+            switch (_distribution) {
+                case UNIFORM:
+                    return std::uniform_int_distribution<uint64_t>(0, inserted - 1)(gen);
+                case LATEST:
+                    return inserted - 1 - std::min(_zipf(gen), inserted - 1);
+                default:
+                    // scramble the ranks, otherwise the popular records would be the oldest ones
+                    return record_key(_zipf(gen)) % inserted;
+            }
+        }
+    };
+
+    template<typename Map>
+    struct supports_scan {
+        static const bool value = true;
+    };
+
+    template<typename K, typename V>
+    struct supports_scan<std::unordered_map<K, V> > {
+        static const bool value = false;
+    };
+
+    template<typename Map>
+    uint64_t scan(const Map &m, uint64_t key, size_t length, std::true_type) {
+        uint64_t sum = 0;
+        auto it = m.lower_bound(key);
+        for (size_t i = 0; i < length && it != m.end(); ++i, ++it)
+            sum += it->second;
+        return sum;
+    }
+
+    template<typename Map>
+    uint64_t scan(const Map &, uint64_t, size_t, std::false_type) {
+        return 0;
+    }
+
+    template<typename Map>
+    void run(const char *name, const options &opts) {
+        const workload &load = opts.load;
+        if (load.mix[SCAN] > 0 && !supports_scan<Map>::value) {
+            std::cout << name << ": no ordered scans, skipped" << std::endl;
+            return;
+        }
+
+        Map m;
+        for (uint64_t n = 0; n < opts.records; n++)
+            m.insert(std::make_pair(record_key(n), n));
+        uint64_t inserted = opts.records;
+
+        // the same operations in the same order for every container
+        std::mt19937_64 gen(workloads::seed());
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<size_t> scan_length(1, MAX_SCAN_LENGTH);
+        record_chooser choose(opts.distribution, opts.records);
+
+        std::vector<art::latency_histogram> latency(OPERATION_KINDS);
+        std::vector<uint64_t> count(OPERATION_KINDS, 0);
+        uint64_t checksum = 0;
+
+        const clock_type::time_point start = clock_type::now();
+        for (size_t i = 0; i < opts.operations; i++) {
+            int kind = 0;
+            for (int p = percent(gen); p >= load.mix[kind]; kind++)
+                p -= load.mix[kind];
+
+            const uint64_t key = kind == INSERT ? record_key(inserted++) : record_key(choose(gen, inserted));
+            const size_t length = kind == SCAN ? scan_length(gen) : 0;
+            const bool sampled = ++count[kind] % opts.sample == 0;
+            const clock_type::time_point op_start = sampled ? clock_type::now() : clock_type::time_point();
+
+            switch (kind) {
+                case READ: {
+                    auto it = m.find(key);
+                    if (it != m.end())
+                        checksum += it->second;
+                    break;
+                }
+                case UPDATE: {
+                    auto it = m.find(key);
+                    if (it != m.end())
+                        it->second = i;
+                    break;
+                }
+                case INSERT:
+                    m.insert(std::make_pair(key, i));
+                    break;
+                case SCAN:
+                    checksum += scan(m, key, length, std::integral_constant<bool, supports_scan<Map>::value>());
+                    break;
+                default: {
+                    auto it = m.find(key);
+                    if (it != m.end())
+                        it->second = it->second * 31 + i;
+                    break;
+                }
+            }
+
+            if (sampled) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - op_start);
+                latency[kind].record(elapsed.count());
+            }
+        }
+        const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        std::cout << name << ": " << std::fixed << std::setprecision(0) << opts.operations / seconds
+                  << " ops/s, " << m.size() << " records (checksum " << checksum % 1000 << ")" << std::endl;
+        for (int kind = 0; kind < OPERATION_KINDS; kind++) {
+            if (count[kind] == 0)
+                continue;
+            const art::latency_histogram &h = latency[kind];
+            std::cout << "  " << std::left << std::setw(18) << OPERATION_NAMES[kind] << std::right
+                      << " ops=" << count[kind] << " p50=" << h.percentile(50) << "ns p99=" << h.percentile(99)
+                      << "ns p999=" << h.percentile(99.9) << "ns max=" << h.max() << "ns" << std::endl;
+        }
+    }
+
+    void usage() {
+        std::cerr << "usage: ycsb [--workload A-F] [--distribution zipfian|uniform|latest] [--records N]\n"
+                  << "            [--operations N] [--sample N]\n"
+                  << "            [--container all|radix_map|map|unordered_map|btree_map]" << std::endl;
+        std::exit(1);
+    }
+
+    options parse(int argc, char **argv) {
+        options opts;
+        for (int i = 1; i < argc; i++) {
+            if (i + 1 == argc)
+                usage();
+            const std::string flag = argv[i];
+            const std::string value = argv[++i];
+            if (flag == "--workload") {
+                const char name = value.empty() ? ' ' : static_cast<char>(std::toupper(value[0]));
+                if (name < 'A' || name > 'F' || value.size() != 1)
+                    usage();
+                opts.load = WORKLOADS[name - 'A'];
+            } else if (flag == "--distribution") {
+                opts.distribution_set = true;
+                if (value == "zipfian")
+                    opts.distribution = ZIPFIAN;
+                else if (value == "uniform")
+                    opts.distribution = UNIFORM;
+                else if (value == "latest")
+                    opts.distribution = LATEST;
+                else
+                    usage();
+            } else if (flag == "--records") {
+                opts.records = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (flag == "--operations") {
+                opts.operations = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (flag == "--sample") {
+                opts.sample = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (flag == "--container") {
+                opts.container = value;
+            } else {
+                usage();
+            }
+        }
+        if (opts.records < 2 || opts.sample == 0)
+            usage();
+        if (!opts.distribution_set)
+            opts.distribution = opts.load.distribution;
+        return opts;
+    }
+}
+
+int main(int argc, char **argv) {
+    const options opts = parse(argc, argv);
+    static const char *const distributions[] = {"zipfian", "uniform", "latest"};
+    std::cout << "Workload " << opts.load.name << ", " << distributions[opts.distribution] << ", "
+              << opts.records << " records, " << opts.operations << " operations, seed "
+              << workloads::seed() << std::endl;
+
+    const std::string &c = opts.container;
+    if (c == "all" || c == "radix_map")
+        run<art::radix_map<uint64_t, uint64_t> >("radix_map", opts);
+    if (c == "all" || c == "btree_map")
+        run<btree::btree_map<uint64_t, uint64_t> >("btree_map", opts);
+    if (c == "all" || c == "map")
+        run<std::map<uint64_t, uint64_t> >("map", opts);
+    if (c == "all" || c == "unordered_map")
+        run<std::unordered_map<uint64_t, uint64_t> >("unordered_map", opts);
+}
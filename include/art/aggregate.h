@@ -0,0 +1,117 @@
+#ifndef ART_AGGREGATE_H
+#define ART_AGGREGATE_H
+
+#include <algorithm>
+#include <limits>
+
+namespace art {
+    /**
+     * @brief Default aggregate, no summaries are stored in the nodes.
+     *
+     * An aggregate is a monoid over the elements of a container. It provides
+     *  - summary_type:  the summary of a range of elements,
+     *  - identity():  the summary of an empty range,
+     *  - lift(x):  the summary of a single element (the mapped value of a map
+     *              element, the key of a set element),
+     *  - combine(a, b):  the summary of two adjacent ranges, a left of b. It
+     *                    has to be associative but not commutative.
+     */
+    struct no_aggregate {
+        struct summary_type {
+        };
+
+        static summary_type identity() { return summary_type(); }
+
+        template<typename _Value>
+        static summary_type lift(const _Value &) { return summary_type(); }
+
+        static summary_type combine(const summary_type &, const summary_type &) { return summary_type(); }
+    };
+
+    /**
+     * @brief Sum of the values, identity is the value initialized _Tp.
+     */
+    template<typename _Tp>
+    struct sum_aggregate {
+        typedef _Tp summary_type;
+
+        static summary_type identity() { return _Tp(); }
+
+        static summary_type lift(const _Tp &__x) { return __x; }
+
+        static summary_type combine(const summary_type &__a, const summary_type &__b) { return __a + __b; }
+    };
+
+    /**
+     * @brief Minimum of the values, identity is the largest _Tp.
+     */
+    template<typename _Tp>
+    struct min_aggregate {
+        typedef _Tp summary_type;
+
+        static summary_type identity() { return std::numeric_limits<_Tp>::max(); }
+
+        static summary_type lift(const _Tp &__x) { return __x; }
+
+        static summary_type combine(const summary_type &__a, const summary_type &__b) { return std::min(__a, __b); }
+    };
+
+    /**
+     * @brief Maximum of the values, identity is the lowest _Tp.
+     */
+    template<typename _Tp>
+    struct max_aggregate {
+        typedef _Tp summary_type;
+
+        static summary_type identity() { return std::numeric_limits<_Tp>::lowest(); }
+
+        static summary_type lift(const _Tp &__x) { return __x; }
+
+        static summary_type combine(const summary_type &__a, const summary_type &__b) { return std::max(__a, __b); }
+    };
+
+    namespace detail {
+        /**
+         * @brief Summary of all leaves below an inner node.
+         *
+         *  @tparam _Aggregate  Monoid of the summary, nothing is stored for no_aggregate.
+         */
+        template<typename _Aggregate>
+        struct subtree_summary {
+            typedef typename _Aggregate::summary_type summary_type;
+
+            summary_type _summary = _Aggregate::identity();
+
+            const summary_type &summary() const { return _summary; }
+
+            void set_summary(const summary_type &summary) { _summary = summary; }
+        };
+
+        template<>
+        struct subtree_summary<no_aggregate> {
+            typedef no_aggregate::summary_type summary_type;
+
+            summary_type summary() const { return summary_type(); }
+
+            void set_summary(const summary_type &) {}
+        };
+
+        /**
+         * @brief Applies an aggregate to the mapped values of (key, value) pairs.
+         */
+        template<typename _Aggregate, typename _Pair>
+        struct mapped_aggregate {
+            typedef typename _Aggregate::summary_type summary_type;
+
+            static summary_type identity() { return _Aggregate::identity(); }
+
+            static summary_type lift(const _Pair &__x) { return _Aggregate::lift(__x.second); }
+
+            static summary_type combine(const summary_type &__a, const summary_type &__b) {
+                return _Aggregate::combine(__a, __b);
+            }
+        };
+    }
+}
+
+#endif //ART_AGGREGATE_H
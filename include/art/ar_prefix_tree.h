@@ -1,13 +1,22 @@
 #ifndef ART_AR_PREFIX_TREE_H
 #define ART_AR_PREFIX_TREE_H
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <stddef.h>
 #include <iterator>
 #include <utility>
 #include <limits>
+#include <type_traits>
+#include <vector>
+#include "aggregate.h"
+#include "batch_op.h"
+#include "key_region.h"
 #include "key_transform.h"
+#include "memory_stats.h"
+#include "stats.h"
+#include "subtree_count.h"
 
 #ifdef ART_DEBUG
 
@@ -24,7 +33,8 @@ namespace art {
     static const size_t MAX_PREFIX_LENGTH = 8;
 
     template<typename _Key, typename _Value, typename _KeyOfValue,
-            typename _Key_transform = key_transform<_Key> >
+            typename _Key_transform = key_transform<_Key>, bool _Order_statistics = false,
+            typename _Aggregate = no_aggregate>
     struct ar_prefix_tree {
     public:
         // Forward declaration for typedefs
@@ -39,6 +49,7 @@ namespace art {
 
         typedef _Key key_type;
         typedef _Value value_type;
+        typedef typename _Aggregate::summary_type summary_type;
 
     protected:
         typedef _Node *Node_ptr;
@@ -130,35 +141,44 @@ namespace art {
 #endif
         };
 
-        struct _Inner_Node : public _Node {
+        struct _Inner_Node : public _Node, public detail::subtree_count<_Order_statistics>,
+                             public detail::subtree_summary<_Aggregate> {
         public:
             uint16_t _count;
 
             uint16_t _prefix_length;
 
-            int32_t _depth;
+            // 16 bits leave room for the flag below without growing the node
+            int16_t _depth;
+
+            // Modified since the last collect_changes(), new nodes start out modified
+            bool _dirty;
 
             std::array<byte, MAX_PREFIX_LENGTH> _prefix{};
 
             _Inner_Node(Node_ptr parent, uint16_t count, int32_t depth)
-                    : _Node(parent), _count(count), _depth(depth), _prefix_length(0) {}
+                    : _Node(parent), _count(count), _depth(depth), _dirty(true), _prefix_length(0) {}
 
             _Inner_Node(Node_ptr parent, uint16_t count, int32_t depth, uint16_t prefix_length,
                         const std::array<byte, MAX_PREFIX_LENGTH> &prefix)
-                    : _Node(parent), _count(count), _depth(depth),
+                    : _Node(parent), _count(count), _depth(depth), _dirty(true),
                       _prefix_length(prefix_length), _prefix(prefix) {}
 
 
             // Copy constructor
             _Inner_Node(const _Inner_Node &__x)
-                    : _Node(__x._parent), _count(__x._count), _depth(__x._depth),
-                      _prefix_length(__x._prefix_length), _prefix(__x._prefix) {}
+                    : _Node(__x._parent), detail::subtree_count<_Order_statistics>(__x),
+                      detail::subtree_summary<_Aggregate>(__x), _count(__x._count), _depth(__x._depth),
+                      _dirty(__x._dirty), _prefix_length(__x._prefix_length), _prefix(__x._prefix) {}
 
             // Copy assignment
             _Inner_Node &operator=(const _Inner_Node &__x) {
                 this->_parent = __x._parent;
                 _count = __x._count;
                 _depth = __x._depth;
+                _dirty = __x._dirty;
+                this->set_leaves(__x.leaves());
+                this->set_summary(__x.summary());
                 _prefix_length = __x._prefix_length;
                 _prefix = __x._prefix;
                 return *this;
@@ -184,6 +204,7 @@ namespace art {
 
                 // optimistic path compression
                 if (_prefix_length > MAX_PREFIX_LENGTH) {
+                    ART_STAT(optimistic_prefix_loads);
                     Key min_key = {_Key_transform()(_KeyOfValue()(static_cast<Const_Leaf_ptr>(this->minimum())->_value))};
                     for (; pos < _prefix_length; pos++)
                         if (key.chunks[_depth + pos] != min_key.chunks[_depth + pos])
@@ -461,9 +482,14 @@ namespace art {
             std::array<byte, 4> keys{};
             std::array<Node_ptr, 4> children{};
 
+            // Empty constructor, children are added with insert()
+            _Node_4(Node_ptr parent, int32_t depth)
+                    : _Inner_Node(parent, 0, depth) {}
+
             // Grow constructor
             _Node_4(Leaf_ptr leaf, const byte key_byte, int32_t depth)
                     : _Inner_Node(leaf->_parent, 1, depth) {
+                this->set_leaves(1);
                 keys[0] = key_byte;
                 children[0] = leaf;
                 leaf->_parent = this;
@@ -471,6 +497,7 @@ namespace art {
 
             _Node_4(Node_ptr child, const byte key_byte, int32_t depth)
                     : _Inner_Node(child->_parent, 1, depth) {
+                this->set_leaves(leaves_below(child));
                 keys[0] = key_byte;
                 children[0] = child;
                 child->_parent = this;
@@ -479,6 +506,7 @@ namespace art {
             _Node_4(Node_ptr child, const byte key_byte, int32_t depth,
                     uint16_t prefix_length, std::array<byte, MAX_PREFIX_LENGTH> &prefix)
                     : _Inner_Node(child->_parent, 1, depth, prefix_length, prefix) {
+                this->set_leaves(leaves_below(child));
                 keys[0] = key_byte;
                 children[0] = child;
                 child->_parent = this;
@@ -487,6 +515,7 @@ namespace art {
             // Shrink constructor
             _Node_4(_Node_16 *node)
                     : _Inner_Node(node->_parent, 4, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 std::copy(node->keys.begin(), node->keys.begin() + 4, keys.begin());
                 std::copy(node->children.begin(), node->children.begin() + 4, children.begin());
 
@@ -496,7 +525,7 @@ namespace art {
 
             // Copy constructor
             _Node_4(const _Node_4 &__x)
-                    : _Inner_Node(__x._parent, __x._count, __x._depth, __x._prefix_length, __x._prefix),
+                    : _Inner_Node(__x),
                       keys(__x.keys) {
                 copy_children(__x);
             }
@@ -506,6 +535,8 @@ namespace art {
                 this->_parent = __x._parent;
                 this->_count = __x._count;
                 this->_depth = __x._depth;
+                this->set_leaves(__x.leaves());
+                this->set_summary(__x.summary());
                 this->_prefix_length = __x._prefix_length;
                 this->_prefix = __x._prefix;
                 keys = __x.keys;
@@ -620,8 +651,10 @@ namespace art {
                 for (; pos < this->_count && keys[pos] <= key.chunks[depth]; pos++);
                 if (pos < this->_count)
                     return children[pos]->minimum();
-                else
+                else {
+                    ART_STAT(successor_climbs);
                     return this->_parent->successor(key);
+                }
             }
 
             virtual Const_Base_Leaf_ptr successor(const Key &key) const override {
@@ -630,8 +663,10 @@ namespace art {
                 for (; pos < this->_count && keys[pos] <= key.chunks[depth]; pos++);
                 if (pos < this->_count)
                     return children[pos]->minimum();
-                else
+                else {
+                    ART_STAT(successor_climbs);
                     return this->_parent->successor(key);
+                }
             }
 
             virtual Base_Leaf_ptr predecessor(const Key &key) override {
@@ -640,8 +675,10 @@ namespace art {
                 for (; pos >= 0 && keys[pos] >= key.chunks[depth]; pos--);
                 if (pos >= 0)
                     return children[pos]->maximum();
-                else
+                else {
+                    ART_STAT(predecessor_climbs);
                     return this->_parent->predecessor(key);
+                }
             }
 
             virtual Const_Base_Leaf_ptr predecessor(const Key &key) const override {
@@ -650,8 +687,10 @@ namespace art {
                 for (; pos >= 0 && keys[pos] >= key.chunks[depth]; pos--);
                 if (pos >= 0)
                     return children[pos]->maximum();
-                else
+                else {
+                    ART_STAT(predecessor_climbs);
                     return this->_parent->predecessor(key);
+                }
             }
 
             virtual uint16_t min_size() const override { return 2; }
@@ -688,9 +727,14 @@ namespace art {
             std::array<byte, 16> keys{};
             std::array<Node_ptr, 16> children{};
 
+            // Empty constructor, children are added with insert()
+            _Node_16(Node_ptr parent, int32_t depth)
+                    : _Inner_Node(parent, 0, depth) {}
+
             // Grow constructor
             _Node_16(_Node_4 *node)
                     : _Inner_Node(node->_parent, 4, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 std::copy(node->keys.begin(), node->keys.end(), keys.begin());
                 std::copy(node->children.begin(), node->children.end(), children.begin());
 
@@ -701,6 +745,7 @@ namespace art {
             // Shrink constructor
             _Node_16(_Node_48 *node)
                     : _Inner_Node(node->_parent, 16, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 uint8_t pos = 0;
                 for (uint16_t i = 0; i < 256; i++) {
                     if (node->child_index[i] != EMPTY_MARKER) {
@@ -714,7 +759,7 @@ namespace art {
 
             // Copy constructor
             _Node_16(const _Node_16 &__x)
-                    : _Inner_Node(__x._parent, __x._count, __x._depth, __x._prefix_length, __x._prefix),
+                    : _Inner_Node(__x),
                       keys(__x.keys) {
                 copy_children(__x);
             }
@@ -724,6 +769,8 @@ namespace art {
                 this->_parent = __x._parent;
                 this->_count = __x._count;
                 this->_depth = __x._depth;
+                this->set_leaves(__x.leaves());
+                this->set_summary(__x.summary());
                 this->_prefix_length = __x._prefix_length;
                 this->_prefix = __x._prefix;
                 keys = __x.keys;
@@ -839,8 +886,10 @@ namespace art {
                 for (; pos < this->_count && keys[pos] <= key.chunks[depth]; pos++);
                 if (pos < this->_count)
                     return children[pos]->minimum();
-                else
+                else {
+                    ART_STAT(successor_climbs);
                     return this->_parent->successor(key);
+                }
             }
 
             virtual Const_Base_Leaf_ptr successor(const Key &key) const override {
@@ -849,8 +898,10 @@ namespace art {
                 for (; pos < this->_count && keys[pos] <= key.chunks[depth]; pos++);
                 if (pos < this->_count)
                     return children[pos]->minimum();
-                else
+                else {
+                    ART_STAT(successor_climbs);
                     return this->_parent->successor(key);
+                }
             }
 
             virtual Base_Leaf_ptr predecessor(const Key &key) override {
@@ -859,8 +910,10 @@ namespace art {
                 for (; pos >= 0 && keys[pos] >= key.chunks[depth]; pos--);
                 if (pos >= 0)
                     return children[pos]->maximum();
-                else
+                else {
+                    ART_STAT(predecessor_climbs);
                     return this->_parent->predecessor(key);
+                }
             }
 
             virtual Const_Base_Leaf_ptr predecessor(const Key &key) const override {
@@ -869,8 +922,10 @@ namespace art {
                 for (; pos >= 0 && keys[pos] >= key.chunks[depth]; pos--);
                 if (pos >= 0)
                     return children[pos]->maximum();
-                else
+                else {
+                    ART_STAT(predecessor_climbs);
                     return this->_parent->predecessor(key);
+                }
             }
 
             virtual uint16_t min_size() const override { return 5; }
@@ -906,9 +961,16 @@ namespace art {
             std::array<byte, 256> child_index;
             std::array<Node_ptr, 48> children{};
 
+            // Empty constructor, children are added with insert()
+            _Node_48(Node_ptr parent, int32_t depth)
+                    : _Inner_Node(parent, 0, depth) {
+                std::fill(child_index.begin(), child_index.end(), EMPTY_MARKER);
+            }
+
             // Grow constructor
             _Node_48(_Node_16 *node)
                     : _Inner_Node(node->_parent, 16, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 std::fill(child_index.begin(), child_index.end(), EMPTY_MARKER);
 
                 for (uint8_t i = 0; i < 16; i++) {
@@ -921,6 +983,7 @@ namespace art {
             // Shrink constructor
             _Node_48(_Node_256 *node)
                     : _Inner_Node(node->_parent, 48, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 std::fill(child_index.begin(), child_index.end(), EMPTY_MARKER);
 
                 uint8_t pos = 0;
@@ -936,7 +999,7 @@ namespace art {
 
             // Copy constructor
             _Node_48(const _Node_48 &__x)
-                    : _Inner_Node(__x._parent, __x._count, __x._depth), child_index(__x.child_index) {
+                    : _Inner_Node(__x), child_index(__x.child_index) {
                 copy_children(__x);
             }
 
@@ -945,6 +1008,8 @@ namespace art {
                 this->_parent = __x._parent;
                 this->_count = __x._count;
                 this->_depth = __x._depth;
+                this->set_leaves(__x.leaves());
+                this->set_summary(__x.summary());
                 this->_prefix_length = __x._prefix_length;
                 this->_prefix = __x._prefix;
                 child_index = __x.child_index;
@@ -957,23 +1022,23 @@ namespace art {
                     if (__x.child_index[i] != EMPTY_MARKER) {
                         switch (__x.children[child_index[i]]->get_type()) {
                             case node_type::node_4_t:
-                                children[child_index[i]] = new _Node_4(*static_cast<_Node_4 *>(__x.children[i]));
+                                children[child_index[i]] = new _Node_4(*static_cast<_Node_4 *>(__x.children[__x.child_index[i]]));
                                 children[child_index[i]]->_parent = this;
                                 break;
                             case node_type::node_16_t:
-                                children[child_index[i]] = new _Node_16(*static_cast<_Node_16 *>(__x.children[i]));
+                                children[child_index[i]] = new _Node_16(*static_cast<_Node_16 *>(__x.children[__x.child_index[i]]));
                                 children[child_index[i]]->_parent = this;
                                 break;
                             case node_type::node_48_t:
-                                children[child_index[i]] = new _Node_48(*static_cast<_Node_48 *>(__x.children[i]));
+                                children[child_index[i]] = new _Node_48(*static_cast<_Node_48 *>(__x.children[__x.child_index[i]]));
                                 children[child_index[i]]->_parent = this;
                                 break;
                             case node_type::node_256_t:
-                                children[child_index[i]] = new _Node_256(*static_cast<_Node_256 *>(__x.children[i]));
+                                children[child_index[i]] = new _Node_256(*static_cast<_Node_256 *>(__x.children[__x.child_index[i]]));
                                 children[child_index[i]]->_parent = this;
                                 break;
                             case node_type::_leaf_t:
-                                children[child_index[i]] = new _Leaf(*static_cast<Leaf_ptr>(__x.children[i]));
+                                children[child_index[i]] = new _Leaf(*static_cast<Leaf_ptr>(__x.children[__x.child_index[i]]));
                                 children[child_index[i]]->_parent = this;
                                 break;
                             default:
@@ -1058,6 +1123,7 @@ namespace art {
                     if (child_index[pos] != EMPTY_MARKER)
                         return children[child_index[pos]]->minimum();
 
+                ART_STAT(successor_climbs);
                 return this->_parent->successor(key);
             }
 
@@ -1066,6 +1132,7 @@ namespace art {
                     if (child_index[pos] != EMPTY_MARKER)
                         return children[child_index[pos]]->minimum();
 
+                ART_STAT(successor_climbs);
                 return this->_parent->successor(key);
             }
 
@@ -1074,6 +1141,7 @@ namespace art {
                     if (child_index[pos] != EMPTY_MARKER)
                         return children[child_index[pos]]->maximum();
 
+                ART_STAT(predecessor_climbs);
                 return this->_parent->predecessor(key);
             }
 
@@ -1082,6 +1150,7 @@ namespace art {
                     if (child_index[pos] != EMPTY_MARKER)
                         return children[child_index[pos]]->maximum();
 
+                ART_STAT(predecessor_climbs);
                 return this->_parent->predecessor(key);
             }
 
@@ -1118,9 +1187,14 @@ namespace art {
         public:
             std::array<Node_ptr, 256> children{};
 
+            // Empty constructor, children are added with insert()
+            _Node_256(Node_ptr parent, int32_t depth)
+                    : _Inner_Node(parent, 0, depth) {}
+
             // Grow constructor
             _Node_256(_Node_48 *node)
                     : _Inner_Node(node->_parent, 48, node->_depth, node->_prefix_length, node->_prefix) {
+                this->set_leaves(node->leaves());
                 for (uint16_t i = 0; i < 256; i++) {
                     if (node->child_index[i] != EMPTY_MARKER) {
                         children[i] = node->children[node->child_index[i]];
@@ -1131,7 +1205,7 @@ namespace art {
 
             // Copy constructor
             _Node_256(const _Node_256 &__x)
-                    : _Inner_Node(__x._parent, __x._count, __x._depth, __x._prefix_length, __x._prefix) {
+                    : _Inner_Node(__x) {
                 copy_children(__x);
             }
 
@@ -1140,6 +1214,8 @@ namespace art {
                 this->_parent = __x._parent;
                 this->_count = __x._count;
                 this->_depth = __x._depth;
+                this->set_leaves(__x.leaves());
+                this->set_summary(__x.summary());
                 this->_prefix_length = __x._prefix_length;
                 this->_prefix = __x._prefix;
                 copy_children(__x);
@@ -1248,6 +1324,7 @@ namespace art {
                     if (children[pos] != nullptr)
                         return children[pos]->minimum();
 
+                ART_STAT(successor_climbs);
                 return this->_parent->successor(key);
             }
 
@@ -1256,6 +1333,7 @@ namespace art {
                     if (children[pos] != nullptr)
                         return children[pos]->minimum();
 
+                ART_STAT(successor_climbs);
                 return this->_parent->successor(key);
             }
 
@@ -1264,6 +1342,7 @@ namespace art {
                     if (children[pos] != nullptr)
                         return children[pos]->maximum();
 
+                ART_STAT(predecessor_climbs);
                 return this->_parent->predecessor(key);
             }
 
@@ -1272,6 +1351,7 @@ namespace art {
                     if (children[pos] != nullptr)
                         return children[pos]->maximum();
 
+                ART_STAT(predecessor_climbs);
                 return this->_parent->predecessor(key);
             }
 
@@ -1315,6 +1395,12 @@ namespace art {
         // Necessary as the end marker for iterators
         _Dummy_Node *_M_dummy_node;
 
+        // Whether modifications mark the inner nodes on their paths, see track_changes()
+        bool _M_track_changes = false;
+
+        // Number of change sets collected since track_changes()
+        uint64_t _M_change_epoch = 0;
+
     public:
         // Current root node of the radix tree
         Node_ptr _M_root;
@@ -1351,6 +1437,8 @@ namespace art {
             _M_root = std::move(__x._M_root);
             _M_count = std::move(__x._M_count);
             _M_key_transform = std::move(__x._M_key_transform);
+            _M_track_changes = __x._M_track_changes;
+            _M_change_epoch = __x._M_change_epoch;
 
             _M_dummy_node = new _Dummy_Node();
             if (_M_root != nullptr) {
@@ -1361,6 +1449,7 @@ namespace art {
             // Leaf move source in a valid state
             __x._M_root = nullptr;
             __x._M_count = 0;
+            __x._M_track_changes = false;
         }
 
         // Copy assignment
@@ -1368,6 +1457,7 @@ namespace art {
             if (this != &__x) {
                 // remove old container contents
                 clear();
+                _M_track_changes = false;
 
                 if (__x.empty()) {
                     // Nothing to copy
@@ -1391,6 +1481,8 @@ namespace art {
             _M_root = std::move(__x._M_root);
             _M_count = std::move(__x._M_count);
             _M_key_transform = std::move(__x._M_key_transform);
+            _M_track_changes = __x._M_track_changes;
+            _M_change_epoch = __x._M_change_epoch;
 
             if (_M_root != nullptr) {
                 _M_root->_parent = _M_dummy_node;
@@ -1399,6 +1491,7 @@ namespace art {
 
             __x._M_root = nullptr;
             __x._M_count = 0;
+            __x._M_track_changes = false;
             return *this;
         }
 
@@ -1703,6 +1796,7 @@ namespace art {
                                 if (transformed_key.chunks[j] != existing_key.chunks[j]) {
                                     // once we find a tiebreaker, create a new node with that key byte
                                     // and add the skipped key bytes as a prefix
+                                    ART_STAT(leaf_splits);
                                     Inner_Node_ptr inner = new _Node_4(existing_leaf, existing_key.chunks[j], depth);
                                     update_child_ptr(inner->_parent, inner, existing_key);
                                     inner->_prefix_length = (uint16_t) (j - depth);
@@ -1715,6 +1809,9 @@ namespace art {
 
                                     Leaf_ptr new_leaf = new _Leaf(__x, inner);
                                     inner->insert(transformed_key.chunks[j], new_leaf);
+                                    add_leaves_on_path(inner, 1);
+                                    refresh_summaries(transformed_key);
+                                    mark_path(transformed_key);
                                     _M_count++;
 
                                     return make_pair(iterator(new_leaf), true);
@@ -1748,6 +1845,9 @@ namespace art {
 
                     Leaf_ptr new_leaf = new _Leaf(__x, previous_node);
                     previous_node->insert(transformed_key.chunks[depth - 1], new_leaf);
+                    add_leaves_on_path(previous_node, 1);
+                    refresh_summaries(transformed_key);
+                    mark_path(transformed_key);
                     _M_count++;
 
                     return make_pair(iterator(new_leaf), true);
@@ -1799,6 +1899,70 @@ namespace art {
             }
         }
 
+        /**
+         * @brief Applies a batch of insert/assign/erase operations in one pass over the tree.
+         * @param __first  Forward iterator to the first batch_op<value_type>.
+         * @param __last  Forward iterator past the last operation.
+         *
+         * The operations have to be sorted by their transformed keys. Several operations
+         * on the same key are applied in the given order. Each inner node is visited at most
+         * once and is grown or shrunk at most once to the size it has after the whole batch.
+         */
+        template<typename _ForwardIterator>
+        void apply_sorted_batch(_ForwardIterator __first, _ForwardIterator __last) {
+            std::vector<_Batch_entry> batch;
+            for (; __first != __last; ++__first) {
+                const batch_op<value_type> &op = *__first;
+                batch.push_back({{_M_key_transform(_KeyOfValue()(op.value))}, op.kind, &op.value});
+            }
+            if (batch.empty())
+                return;
+
+            Node_ptr root = merge_batch(_M_root, 0, batch.data(), batch.data() + batch.size());
+            if (root == nullptr && _M_root != nullptr)
+                delete _M_root;
+
+            if (root != nullptr)
+                root->_parent = _M_dummy_node;
+            replace_root(root);
+
+            for (const _Batch_entry &entry : batch)
+                mark_path(entry.key);
+        }
+
+        /**
+         * @brief Replaces the contents by elements sorted by their transformed keys.
+         * @param __first  Input iterator to the first element.
+         * @param __last  Input iterator past the last element.
+         *
+         * The keys have to be distinct. The tree is built bottom-up, every inner node
+         * is created once with its final size, instead of inserting one element after
+         * another.
+         */
+        template<typename _InputIterator>
+        void assign_sorted_unique(_InputIterator __first, _InputIterator __last) {
+            std::vector<Leaf_ptr> leaves;
+            try {
+                for (; __first != __last; ++__first)
+                    leaves.push_back(new _Leaf(*__first));
+            } catch (...) {
+                for (Leaf_ptr leaf : leaves)
+                    delete leaf;
+                throw;
+            }
+
+            clear();
+            if (leaves.empty()) {
+                replace_root(nullptr);
+                return;
+            }
+
+            Node_ptr root = build_subtree(leaves.data(), leaves.data() + leaves.size(), 0);
+            root->_parent = _M_dummy_node;
+            replace_root(root);
+            _M_count = leaves.size();
+        }
+
     private:
         /**
          * @brief Splits the prefix of node into a parent node.
@@ -1809,6 +1973,7 @@ namespace art {
          * Implements a hybrid compression approach, loads key from leaf if necessary.
          */
         Node_ptr split_prefix_into_parent(Inner_Node_ptr node, size_t mismatch_pos) {
+            ART_STAT(prefix_splits);
             Node_ptr parent = node->_parent;
 
             Inner_Node_ptr new_node;
@@ -1827,6 +1992,7 @@ namespace art {
             } else {
                 // optimistic path compression, key has to be loaded
                 // from a leaf and copied to the node's prefix
+                ART_STAT(optimistic_prefix_loads);
                 Key min_key = {_Key_transform()(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node->minimum())->_value))};
 
                 new_node = new _Node_4(node, min_key.chunks[node->_depth + mismatch_pos], node->_depth);
@@ -1940,6 +2106,7 @@ namespace art {
                         } else {
                             for (int32_t j = depth; j < key_size; j++) {
                                 if (__k.chunks[j] != existing_key.chunks[j]) {
+                                    ART_STAT(leaf_splits);
                                     Inner_Node_ptr inner = new _Node_4(existing_leaf, existing_key.chunks[j], depth);
                                     update_child_ptr(inner->_parent, inner, existing_key);
 
@@ -1996,6 +2163,9 @@ namespace art {
             if (parent->get_type() != node_type::_dummy_node_t) {
                 auto inner_parent = static_cast<Inner_Node_ptr>(parent);
                 inner_parent->insert(key.chunks[inner_parent->_depth + inner_parent->_prefix_length], leaf);
+                add_leaves_on_path(inner_parent, 1);
+                refresh_summaries(key);
+                mark_path(key);
             } else {
                 replace_root(leaf);
             }
@@ -2056,10 +2226,13 @@ namespace art {
                     Key existing_key = {_M_key_transform(_KeyOfValue()(existing_leaf->_value))};
                     if (!std::memcmp(&transformed_key, &existing_key, sizeof(transformed_key))) {
                         // Delete the leaf
+                        add_leaves_on_path(current_node, -1);
                         current_node->erase(transformed_key.chunks[depth]);
                         _M_count--;
 
                         fix_after_erase(static_cast<Inner_Node_ptr>(current_node), transformed_key);
+                        refresh_summaries(transformed_key);
+                        mark_path(transformed_key);
 
                         return 1;
                     } else {
@@ -2090,14 +2263,79 @@ namespace art {
             }
 
             Inner_Node_ptr inner_node = static_cast<Inner_Node_ptr>(leaf->_parent);
+            add_leaves_on_path(inner_node, -1);
             inner_node->erase(transformed_key.chunks[inner_node->_depth + inner_node->_prefix_length]);
             _M_count--;
 
             fix_after_erase(inner_node, transformed_key);
+            refresh_summaries(transformed_key);
+            mark_path(transformed_key);
 
             return __result;
         }
 
+        /**
+         * @brief Erases a range [first, last) of elements.
+         * @return The iterator __last.
+         *
+         * Subtrees between the boundaries are freed as a whole, see erase_range().
+         */
+        iterator erase(iterator __first, iterator __last) {
+            if (__first == __last)
+                return __last;
+
+            Key lo = {_M_key_transform(_KeyOfValue()(*__first))};
+            if (__last == end()) {
+                erase_key_range(&lo, nullptr);
+            } else {
+                Key hi = {_M_key_transform(_KeyOfValue()(*__last))};
+                erase_key_range(&lo, &hi);
+            }
+            return __last;
+        }
+
+        /**
+         * @brief Erases all elements with keys in [lo, hi).
+         * @return The number of erased elements.
+         *
+         * Only the nodes on the paths to lo and hi are resized, fully covered
+         * subtrees in between are freed in bulk.
+         */
+        size_type erase_range(const key_type &__lo, const key_type &__hi) {
+            Key lo = {_M_key_transform(__lo)};
+            Key hi = {_M_key_transform(__hi)};
+            return erase_key_range(&lo, &hi);
+        }
+
+        /**
+         * @brief Erases all elements whose transformed keys start with the given bytes.
+         * @param __prefix  Leading bytes of the transformed key.
+         * @param __length  Number of prefix bytes, at most the size of the transformed key.
+         * @return The number of erased elements.
+         *
+         * The subtree holding the matching keys is detached from its parent and freed
+         * as a whole, only the nodes above it are resized if necessary.
+         */
+        size_type erase_prefix(const byte *__prefix, size_t __length) {
+            Node_ptr node = const_cast<Node_ptr>(find_prefix_node(__prefix, __length));
+            if (node == nullptr)
+                return 0;
+
+            Key key = {_M_key_transform(_KeyOfValue()(static_cast<Leaf_ptr>(node->minimum())->_value))};
+            const size_type count = clear_subtree(node);
+            _M_count -= count;
+            add_leaves_on_path(node->_parent, -(ptrdiff_t) count);
+            replace_child(node->_parent, node, nullptr, key);
+            refresh_summaries(key);
+            mark_path(key);
+            return count;
+        }
+
+        size_type erase_prefix(const key_type &__k, size_t __length) {
+            Key key = {_M_key_transform(__k)};
+            return erase_prefix(key.chunks, __length);
+        }
+
     private:
         /**
          * @brief Shrink node if necessary and compress one-way node into node below.
@@ -2118,12 +2356,752 @@ namespace art {
             }
         }
 
+        /**
+         * An operation of a sorted batch with its transformed key.
+         */
+        struct _Batch_entry {
+            Key key;
+            batch_op_kind kind;
+            const value_type *value;
+        };
+
+        /**
+         * A child of an inner node that was added, replaced or removed (nullptr)
+         * while a batch was merged into its subtree.
+         */
+        struct _Child_change {
+            byte key_byte;
+            Node_ptr old_child;
+            Node_ptr new_child;
+        };
+
+        /**
+         * @brief Merges a sorted range of batch operations into a subtree.
+         * @param node  Root of the subtree, may be nullptr or a leaf.
+         * @param depth  Depth of the subtree's root.
+         * @param first  First operation, all operations share the key bytes above depth.
+         * @param last  Past the last operation.
+         * @return The new root of the subtree or nullptr if the subtree became empty. In
+         *         the latter case the old root has not been deleted yet, as its parent
+         *         still has to remove it.
+         */
+        Node_ptr merge_batch(Node_ptr node, int32_t depth, _Batch_entry *first, _Batch_entry *last) {
+            if (node == nullptr || node->is_leaf()) {
+                Leaf_ptr existing_leaf = static_cast<Leaf_ptr>(node);
+                std::vector<Leaf_ptr> leaves;
+                fold_batch(existing_leaf, first, last, leaves);
+
+                if (leaves.empty())
+                    return nullptr;
+
+                // the existing leaf is not part of the subtree anymore
+                if (existing_leaf != nullptr
+                    && std::find(leaves.begin(), leaves.end(), existing_leaf) == leaves.end())
+                    delete existing_leaf;
+
+                return build_subtree(leaves.data(), leaves.data() + leaves.size(), depth);
+            }
+
+            Inner_Node_ptr inner = static_cast<Inner_Node_ptr>(node);
+            if (inner->_prefix_length > 0) {
+                // Keys diverging from the prefix are not in this subtree, erasing them is a no-op.
+                // Inserting them requires to split the prefix at the first divergence.
+                size_t split_pos = inner->_prefix_length;
+                _Batch_entry *match_first = last;
+                _Batch_entry *match_last = last;
+                Key min_key = inner->_prefix_length > MAX_PREFIX_LENGTH
+                              ? Key{_M_key_transform(_KeyOfValue()(static_cast<Leaf_ptr>(inner->minimum())->_value))}
+                              : first->key;
+                for (_Batch_entry *it = first; it != last; it++) {
+                    size_t pos = 0;
+                    for (; pos < inner->_prefix_length; pos++) {
+                        const byte prefix_byte = pos < MAX_PREFIX_LENGTH
+                                                 ? inner->_prefix[pos] : min_key.chunks[inner->_depth + pos];
+                        if (it->key.chunks[inner->_depth + pos] != prefix_byte)
+                            break;
+                    }
+
+                    if (pos == inner->_prefix_length) {
+                        if (match_first == last)
+                            match_first = it;
+                        match_last = it + 1;
+                    } else if (it->kind != batch_op_kind::erase) {
+                        split_pos = std::min(split_pos, pos);
+                    }
+                }
+
+                if (split_pos < inner->_prefix_length)
+                    return merge_batch(split_prefix_into_parent(inner, split_pos), depth, first, last);
+
+                first = match_first;
+                last = match_last;
+            }
+
+            const int32_t key_depth = inner->_depth + inner->_prefix_length;
+            std::vector<_Child_change> changes;
+            while (first != last) {
+                const byte key_byte = first->key.chunks[key_depth];
+                _Batch_entry *group_last = first;
+                while (group_last != last && group_last->key.chunks[key_depth] == key_byte)
+                    group_last++;
+
+                Node_ptr child = inner->find(key_byte);
+                Node_ptr new_child = merge_batch(child, key_depth + 1, first, group_last);
+                if (new_child != child)
+                    changes.push_back({key_byte, child, new_child});
+
+                first = group_last;
+            }
+
+            return compress_one_way(apply_child_changes(inner, changes));
+        }
+
+        /**
+         * @brief Erases all leaves of a subtree whose keys are in [lo, hi).
+         * @param node  Root of the subtree.
+         * @param lo  Inclusive lower bound or nullptr if the subtree is not bounded below.
+         * @param hi  Exclusive upper bound or nullptr if the subtree is not bounded above.
+         * @return The new root of the subtree or nullptr if the subtree became empty,
+         *         same as merge_batch().
+         *
+         * Children that are completely covered by the range are freed in one walk, only
+         * the nodes on the boundary paths of lo and hi are visited and resized.
+         */
+        Node_ptr erase_subtree_range(Node_ptr node, const Key *lo, const Key *hi) {
+            if (node->is_leaf()) {
+                Key key = {_M_key_transform(_KeyOfValue()(static_cast<Leaf_ptr>(node)->_value))};
+                if ((lo == nullptr || std::memcmp(&key, lo, sizeof(Key)) >= 0)
+                    && (hi == nullptr || std::memcmp(&key, hi, sizeof(Key)) < 0)) {
+                    _M_count--;
+                    return nullptr;
+                }
+                return node;
+            }
+
+            Inner_Node_ptr inner = static_cast<Inner_Node_ptr>(node);
+            if (!restrict_bounds(inner, lo, hi))
+                return node;
+
+            if (lo == nullptr && hi == nullptr) {
+                _M_count -= clear_subtree(node);
+                return nullptr;
+            }
+
+            const int32_t key_depth = inner->_depth + inner->_prefix_length;
+            std::vector<_Child_change> changes;
+            for_each_child(inner, [&](byte key_byte, Node_ptr child) {
+                if ((lo != nullptr && key_byte < lo->chunks[key_depth])
+                    || (hi != nullptr && key_byte > hi->chunks[key_depth]))
+                    return;
+
+                const Key *child_lo = lo != nullptr && key_byte == lo->chunks[key_depth] ? lo : nullptr;
+                const Key *child_hi = hi != nullptr && key_byte == hi->chunks[key_depth] ? hi : nullptr;
+                Node_ptr new_child = erase_subtree_range(child, child_lo, child_hi);
+                if (new_child != child)
+                    changes.push_back({key_byte, child, new_child});
+            });
+
+            return compress_one_way(apply_child_changes(inner, changes));
+        }
+
+        /**
+         * @brief Compares the range bounds with the prefix of a node.
+         * @param node  Inner node.
+         * @param lo  Inclusive lower bound or nullptr, set to nullptr if it does not restrict the subtree.
+         * @param hi  Exclusive upper bound or nullptr, set to nullptr if it does not restrict the subtree.
+         * @return False if the whole subtree is outside of the range.
+         *
+         * A bound that differs from the prefix either excludes the whole subtree
+         * or does not restrict it at all.
+         */
+        bool restrict_bounds(Const_Inner_Node_ptr node, const Key *&lo, const Key *&hi) const {
+            if (node->_prefix_length == 0 || (lo == nullptr && hi == nullptr))
+                return true;
+
+            Key min_key = node->_prefix_length > MAX_PREFIX_LENGTH
+                          ? Key{_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node->minimum())->_value))}
+                          : lo != nullptr ? *lo : *hi;
+            for (uint16_t pos = 0; pos < node->_prefix_length && (lo != nullptr || hi != nullptr); pos++) {
+                const int32_t depth = node->_depth + pos;
+                const byte prefix_byte = pos < MAX_PREFIX_LENGTH ? node->_prefix[pos] : min_key.chunks[depth];
+                if (lo != nullptr) {
+                    if (lo->chunks[depth] > prefix_byte)
+                        return false;
+                    if (lo->chunks[depth] < prefix_byte)
+                        lo = nullptr;
+                }
+                if (hi != nullptr) {
+                    if (hi->chunks[depth] < prefix_byte)
+                        return false;
+                    if (hi->chunks[depth] > prefix_byte)
+                        hi = nullptr;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Erases all elements with keys in [lo, hi), unbounded if nullptr.
+         * @return The number of erased elements.
+         */
+        size_type erase_key_range(const Key *lo, const Key *hi) {
+            if (_M_root == nullptr)
+                return 0;
+
+            const size_type old_count = _M_count;
+            Node_ptr root = erase_subtree_range(_M_root, lo, hi);
+            if (root == nullptr)
+                delete _M_root;
+            else
+                root->_parent = _M_dummy_node;
+            replace_root(root);
+
+            // nodes between the boundary paths were freed as a whole
+            if (lo != nullptr)
+                mark_path(*lo);
+            if (hi != nullptr)
+                mark_path(*hi);
+
+            return old_count - _M_count;
+        }
+
+        /**
+         * @brief Compresses a one-way node into its only child.
+         * @param node  Inner node or nullptr.
+         * @return The node or its only child.
+         */
+        Node_ptr compress_one_way(Node_ptr node) {
+            if (node != nullptr && node->size() == 1)
+                return compress_node_into_child(static_cast<_Node_4 *>(node));
+            return node;
+        }
+
+        /**
+         * @brief Replaces (or removes) a child of a node and fixes the nodes above.
+         * @param parent  Parent of the old child, may be the dummy node.
+         * @param old_child  Child to be replaced, deleted (not recursively) if new_child is nullptr.
+         * @param new_child  Replacement or nullptr to remove the old child.
+         * @param key  Any key below the old child, used to locate it in its ancestors.
+         *
+         * Walks up as long as nodes are reallocated by resizing, dropped because they became
+         * empty or compressed because they became one-way nodes.
+         */
+        void replace_child(Node_ptr parent, Node_ptr old_child, Node_ptr new_child, const Key &key) {
+            while (parent->get_type() != node_type::_dummy_node_t) {
+                Inner_Node_ptr parent_inner = static_cast<Inner_Node_ptr>(parent);
+                Node_ptr grandparent = parent->_parent;
+                std::vector<_Child_change> changes;
+                changes.push_back({key.chunks[parent_inner->_depth + parent_inner->_prefix_length], old_child, new_child});
+
+                Node_ptr result = compress_one_way(apply_child_changes(parent_inner, changes));
+                if (result == parent)
+                    return;
+
+                old_child = parent;
+                new_child = result;
+                parent = grandparent;
+            }
+
+            if (new_child == nullptr)
+                delete old_child;
+            else
+                new_child->_parent = _M_dummy_node;
+            replace_root(new_child);
+        }
+
+        /**
+         * @brief Applies a sorted range of batch operations to at most one existing leaf.
+         * @param existing_leaf  Leaf already in the tree, may be nullptr.
+         * @param first  First operation.
+         * @param last  Past the last operation.
+         * @param leaves  Receives the resulting leaves in key order.
+         *
+         * The existing leaf is reused (also for assignments) unless it is erased.
+         */
+        void fold_batch(Leaf_ptr existing_leaf, _Batch_entry *first, _Batch_entry *last,
+                        std::vector<Leaf_ptr> &leaves) {
+            bool existing_pending = existing_leaf != nullptr;
+
+            while (first != last || existing_pending) {
+                Leaf_ptr leaf = nullptr;
+                if (existing_pending) {
+                    Key existing_key = {_M_key_transform(_KeyOfValue()(existing_leaf->_value))};
+                    int cmp = first == last ? -1 : std::memcmp(&existing_key, &first->key, sizeof(Key));
+                    if (cmp <= 0) {
+                        existing_pending = false;
+                        leaf = existing_leaf;
+                    }
+                    if (cmp < 0) {
+                        leaves.push_back(leaf);
+                        continue;
+                    }
+                }
+
+                // apply all operations for the current key in order
+                const Key &key = first->key;
+                for (; first != last && !std::memcmp(&key, &first->key, sizeof(Key)); first++) {
+                    switch (first->kind) {
+                        case batch_op_kind::insert:
+                            if (leaf == nullptr) {
+                                leaf = new _Leaf(*first->value);
+                                _M_count++;
+                            }
+                            break;
+                        case batch_op_kind::assign:
+                            if (leaf == nullptr) {
+                                leaf = new _Leaf(*first->value);
+                                _M_count++;
+                            } else {
+                                // keys are equal, so the leaf's position stays valid
+                                leaf->_value.~value_type();
+                                new(&leaf->_value) value_type(*first->value);
+                            }
+                            break;
+                        case batch_op_kind::erase:
+                            if (leaf != nullptr) {
+                                if (leaf != existing_leaf)
+                                    delete leaf;
+                                leaf = nullptr;
+                                _M_count--;
+                            }
+                            break;
+                    }
+                }
+
+                if (leaf != nullptr)
+                    leaves.push_back(leaf);
+            }
+        }
+
+        /**
+         * @brief Builds a subtree bottom-up from sorted leaves with distinct keys.
+         * @param first  First leaf.
+         * @param last  Past the last leaf.
+         * @param depth  Depth of the subtree's root.
+         * @return The root of the new subtree, its parent pointer is set by the caller.
+         */
+        Node_ptr build_subtree(Leaf_ptr *first, Leaf_ptr *last, int32_t depth) {
+            if (last - first == 1)
+                return *first;
+
+            // keys are sorted, so the common prefix of all keys is the one of the first and last key
+            const Key first_key = {_M_key_transform(_KeyOfValue()((*first)->_value))};
+            const Key last_key = {_M_key_transform(_KeyOfValue()((*(last - 1))->_value))};
+            uint16_t prefix_length = 0;
+            while (first_key.chunks[depth + prefix_length] == last_key.chunks[depth + prefix_length])
+                prefix_length++;
+            const int32_t key_depth = depth + prefix_length;
+
+            // count the distinct key bytes after the prefix to get the final node size
+            size_t count = 0;
+            for (Leaf_ptr *it = first; it != last; count++)
+                it = group_end(it, last, key_depth);
+
+            Inner_Node_ptr node = new_inner_node(count, nullptr, depth);
+            node->_prefix_length = prefix_length;
+            std::copy(std::begin(first_key.chunks) + depth,
+                      std::begin(first_key.chunks) + depth + std::min((size_t) prefix_length, MAX_PREFIX_LENGTH),
+                      node->_prefix.begin());
+
+            for (Leaf_ptr *it = first; it != last;) {
+                Leaf_ptr *group_last = group_end(it, last, key_depth);
+                Key key = {_M_key_transform(_KeyOfValue()((*it)->_value))};
+
+                Node_ptr child = build_subtree(it, group_last, key_depth + 1);
+                child->_parent = node;
+                node->insert(key.chunks[key_depth], child);
+                it = group_last;
+            }
+            return refresh_node(node);
+        }
+
+        /**
+         * @brief Returns the end of the group of leaves sharing the key byte at depth with first.
+         *
+         * The leaves are sorted and share all bytes before depth, so the byte
+         * at depth does not decrease: gallop forward, then binary search the
+         * first leaf with a larger byte. Large groups cost O(log n) key reads
+         * instead of one per leaf.
+         */
+        Leaf_ptr *group_end(Leaf_ptr *first, Leaf_ptr *last, int32_t depth) {
+            const uint8_t byte = key_byte(*first, depth);
+            const ptrdiff_t size = last - first;
+
+            // first[lo] is in the group, first[hi] (if hi < size) is not
+            ptrdiff_t lo = 0, hi = 1;
+            for (ptrdiff_t step = 1; hi < size && key_byte(first[hi], depth) == byte; step *= 2) {
+                lo = hi;
+                hi = lo + step;
+            }
+            hi = std::min(hi, size);
+            while (hi - lo > 1) {
+                const ptrdiff_t mid = lo + (hi - lo) / 2;
+                if (key_byte(first[mid], depth) == byte)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            return first + hi;
+        }
+
+        uint8_t key_byte(Leaf_ptr leaf, int32_t depth) {
+            const Key key = {_M_key_transform(_KeyOfValue()(leaf->_value))};
+            return key.chunks[depth];
+        }
+
+        /**
+         * @brief Creates an empty inner node of the smallest type that holds count children.
+         */
+        Inner_Node_ptr new_inner_node(size_t count, Node_ptr parent, int32_t depth) {
+            if (count <= 4)
+                return new _Node_4(parent, depth);
+            if (count <= 16)
+                return new _Node_16(parent, depth);
+            if (count <= 48)
+                return new _Node_48(parent, depth);
+            return new _Node_256(parent, depth);
+        }
+
+        /**
+         * @brief Calls f(key_byte, child) for all children of an inner node in key order.
+         */
+        template<typename _Function>
+        void for_each_child(Node_ptr node, _Function f) const {
+            switch (node->get_type()) {
+                case node_type::node_4_t: {
+                    _Node_4 *node4 = static_cast<_Node_4 *>(node);
+                    for (unsigned i = 0; i < node4->_count; i++)
+                        f(node4->keys[i], node4->children[i]);
+                    break;
+                }
+                case node_type::node_16_t: {
+                    _Node_16 *node16 = static_cast<_Node_16 *>(node);
+                    for (unsigned i = 0; i < node16->_count; i++)
+                        f(node16->keys[i], node16->children[i]);
+                    break;
+                }
+                case node_type::node_48_t: {
+                    _Node_48 *node48 = static_cast<_Node_48 *>(node);
+                    for (unsigned i = 0; i < 256; i++)
+                        if (node48->child_index[i] != EMPTY_MARKER)
+                            f((byte) i, node48->children[node48->child_index[i]]);
+                    break;
+                }
+                case node_type::node_256_t: {
+                    _Node_256 *node256 = static_cast<_Node_256 *>(node);
+                    for (unsigned i = 0; i < 256; i++)
+                        if (node256->children[i] != nullptr)
+                            f((byte) i, node256->children[i]);
+                    break;
+                }
+                default:
+                    throw;
+            }
+        }
+
+        /**
+         * @brief Appends the (key byte, child) pairs of an inner node in key order.
+         */
+        void collect_children(Node_ptr node, std::vector<pair<byte, Node_ptr> > &children) {
+            for_each_child(node, [&children](byte key_byte, Node_ptr child) {
+                children.push_back(make_pair(key_byte, child));
+            });
+        }
+
+        /**
+         * @brief Deletes all nodes below node and returns the number of deleted leaves.
+         *
+         * A leaf counts itself, the node itself is not deleted.
+         */
+        size_t clear_subtree(Node_ptr node) {
+            if (node->is_leaf())
+                return 1;
+
+            size_t count = 0;
+            for_each_child(node, [this, &count](byte key_byte, Node_ptr child) {
+                count += clear_subtree(child);
+                delete child;
+            });
+            return count;
+        }
+
+        /**
+         * @brief Applies all child changes of an inner node with at most one resize.
+         * @param node  Inner node whose children changed.
+         * @param changes  Added, replaced and removed children in key byte order.
+         * @return The (possibly reallocated) node or nullptr if it has no children left,
+         *         in which case the node itself still has to be deleted by the caller.
+         *
+         * Removed children are deleted (not recursively), the new size of the node is
+         * determined up front so that the node is grown or shrunk only once. The leaf
+         * count and summary of the node are recomputed from its (already updated) children.
+         */
+        Node_ptr apply_child_changes(Inner_Node_ptr node, const std::vector<_Child_change> &changes) {
+            int32_t final_count = node->_count;
+            for (const _Child_change &change : changes) {
+                if (change.old_child == nullptr)
+                    final_count++;
+                else if (change.new_child == nullptr)
+                    final_count--;
+            }
+
+            if (final_count == 0) {
+                for (const _Child_change &change : changes)
+                    delete change.old_child;
+                return nullptr;
+            }
+
+            const bool fits = final_count <= node->max_size()
+                              && (final_count >= node->min_size() || node->get_type() == node_type::node_4_t);
+            if (fits) {
+                for (const _Child_change &change : changes)
+                    if (change.new_child == nullptr)
+                        node->erase(change.key_byte);
+                for (const _Child_change &change : changes) {
+                    if (change.new_child == nullptr)
+                        continue;
+                    change.new_child->_parent = node;
+                    if (change.old_child == nullptr)
+                        node->insert(change.key_byte, change.new_child);
+                    else
+                        node->update_child_ptr(change.key_byte, change.new_child);
+                }
+                return refresh_node(node);
+            }
+
+            std::vector<pair<byte, Node_ptr> > children;
+            collect_children(node, children);
+
+            Inner_Node_ptr new_node = new_inner_node((size_t) final_count, node->_parent, node->_depth);
+            new_node->_prefix_length = node->_prefix_length;
+            new_node->_prefix = node->_prefix;
+            auto change = changes.begin();
+            auto child = children.begin();
+            while (change != changes.end() || child != children.end()) {
+                byte key_byte;
+                Node_ptr new_child;
+                if (change == changes.end() || (child != children.end() && child->first < change->key_byte)) {
+                    key_byte = child->first;
+                    new_child = child->second;
+                    ++child;
+                } else {
+                    if (child != children.end() && child->first == change->key_byte)
+                        ++child;
+                    if (change->new_child == nullptr)
+                        delete change->old_child;
+                    key_byte = change->key_byte;
+                    new_child = change->new_child;
+                    ++change;
+                }
+
+                if (new_child != nullptr) {
+                    new_child->_parent = new_node;
+                    new_node->insert(key_byte, new_child);
+                }
+            }
+
+            delete node;
+            return refresh_node(new_node);
+        }
+
+        /**
+         * @brief Returns the number of leaves below a node, 1 for a leaf.
+         *
+         * Always 0 without order statistics.
+         */
+        static size_t leaves_below(Const_Node_ptr node) {
+            if (!_Order_statistics)
+                return 0;
+            if (node->is_leaf())
+                return 1;
+            return static_cast<Const_Inner_Node_ptr>(node)->leaves();
+        }
+
+        /**
+         * @brief Adds delta to the leaf counts of an inner node and all of its ancestors.
+         */
+        void add_leaves_on_path(Node_ptr node, ptrdiff_t delta) {
+            if (!_Order_statistics)
+                return;
+            for (; node != _M_dummy_node; node = node->_parent)
+                static_cast<Inner_Node_ptr>(node)->add_leaves(delta);
+        }
+
+        /**
+         * @brief Returns the summary of all leaves below a node (or of the leaf itself).
+         */
+        static summary_type summary_below(Const_Node_ptr node) {
+            if (node->is_leaf())
+                return _Aggregate::lift(static_cast<Const_Leaf_ptr>(node)->_value);
+            return static_cast<Const_Inner_Node_ptr>(node)->summary();
+        }
+
+        /**
+         * @brief Whether inner nodes store summaries.
+         */
+        static constexpr bool aggregated() {
+            return !std::is_same<_Aggregate, no_aggregate>::value;
+        }
+
+        /**
+         * @brief Recomputes the leaf count and the summary of an inner node from its children.
+         * @return The node, leaves and nullptr are passed through.
+         */
+        Node_ptr refresh_node(Node_ptr node) {
+            if ((!_Order_statistics && !aggregated()) || node == nullptr || node->is_leaf())
+                return node;
+
+            size_t leaves = 0;
+            summary_type summary = _Aggregate::identity();
+            for_each_child(node, [&leaves, &summary](byte key_byte, Node_ptr child) {
+                leaves += leaves_below(child);
+                if (aggregated())
+                    summary = _Aggregate::combine(summary, summary_below(child));
+            });
+            static_cast<Inner_Node_ptr>(node)->set_leaves(leaves);
+            static_cast<Inner_Node_ptr>(node)->set_summary(summary);
+            return node;
+        }
+
+        /**
+         * @brief Recomputes the summaries of all inner nodes on the path of a key bottom-up.
+         *
+         * Called after a point modification, the path is searched again as the
+         * nodes on it might have been replaced by growing or shrinking.
+         */
+        void refresh_summaries(const Key &key) {
+            if (!aggregated())
+                return;
+
+            // every inner node on the path consumes at least one key byte
+            std::array<Inner_Node_ptr, sizeof(Key)> path;
+            size_t path_length = 0;
+            Node_ptr node = _M_root;
+            while (node != nullptr && !node->is_leaf()) {
+                Inner_Node_ptr inner = static_cast<Inner_Node_ptr>(node);
+                path[path_length++] = inner;
+                node = inner->find(key.chunks[inner->_depth + inner->_prefix_length]);
+            }
+
+            while (path_length > 0) {
+                Inner_Node_ptr inner = path[--path_length];
+                summary_type summary = _Aggregate::identity();
+                for_each_child(inner, [&summary](byte key_byte, Node_ptr child) {
+                    summary = _Aggregate::combine(summary, summary_below(child));
+                });
+                inner->set_summary(summary);
+            }
+        }
+
+        /**
+         * @brief Marks the inner nodes on the path of a key as modified.
+         *
+         * Called after every modification like refresh_summaries(), a no-op
+         * unless changes are tracked. Prefixes are not compared: a node whose
+         * prefix does not match the key took over the position of a removed
+         * one-way node and has to be marked as well.
+         */
+        void mark_path(const Key &key) {
+            if (!_M_track_changes)
+                return;
+
+            Node_ptr node = _M_root;
+            while (node != nullptr && !node->is_leaf()) {
+                Inner_Node_ptr inner = static_cast<Inner_Node_ptr>(node);
+                inner->_dirty = true;
+                node = inner->find(key.chunks[inner->_depth + inner->_prefix_length]);
+            }
+        }
+
+        /**
+         * @brief Clears the modification marks of all inner nodes below (and including) node.
+         */
+        void clear_marks(Node_ptr node) {
+            if (node->is_leaf())
+                return;
+            static_cast<Inner_Node_ptr>(node)->_dirty = false;
+            for_each_child(node, [this](byte key_byte, Node_ptr child) {
+                clear_marks(child);
+            });
+        }
+
+        /**
+         * @brief Reports the region of a modified inner node and recurses into its
+         * modified inner children, see collect_changes().
+         *
+         * The region starts at the node's position in its parent and includes
+         * the keys that diverge from the node's prefix.
+         */
+        template<typename _Function>
+        void collect_node_changes(Inner_Node_ptr node, size_t slot_length, _Function &f) {
+            Key key = {_M_key_transform(_KeyOfValue()(static_cast<Leaf_ptr>(node->minimum())->_value))};
+            const size_t prefix_length = (size_t) node->_depth + node->_prefix_length;
+            detail::key_region region = {key.chunks, slot_length, prefix_length, std::bitset<256>()};
+            std::vector<const value_type *> values;
+            std::vector<Inner_Node_ptr> modified;
+            for_each_child(node, [&](byte key_byte, Node_ptr child) {
+                if (child->is_leaf()) {
+                    values.push_back(&static_cast<Leaf_ptr>(child)->_value);
+                    return;
+                }
+                region.keep.set(key_byte);
+                if (static_cast<Inner_Node_ptr>(child)->_dirty)
+                    modified.push_back(static_cast<Inner_Node_ptr>(child));
+            });
+
+            node->_dirty = false;
+            f(region, values);
+            for (Inner_Node_ptr child : modified)
+                collect_node_changes(child, prefix_length + 1, f);
+        }
+
+        /**
+         * @brief Adds the nodes below (and including) node, which has depth inner
+         * nodes above it, to the statistics.
+         */
+        void collect_memory_stats(Node_ptr node, size_t depth, memory_stats &stats) const {
+            if (node->is_leaf()) {
+                stats.leaves++;
+                stats.leaf_bytes += sizeof(_Leaf);
+                memory_stats::count(stats.depth, depth);
+                return;
+            }
+
+            Inner_Node_ptr inner = static_cast<Inner_Node_ptr>(node);
+            memory_stats::node_stats *node_stats;
+            switch (node->get_type()) {
+                case node_type::node_4_t:
+                    node_stats = &stats.node_4;
+                    node_stats->bytes += sizeof(_Node_4);
+                    break;
+                case node_type::node_16_t:
+                    node_stats = &stats.node_16;
+                    node_stats->bytes += sizeof(_Node_16);
+                    break;
+                case node_type::node_48_t:
+                    node_stats = &stats.node_48;
+                    node_stats->bytes += sizeof(_Node_48);
+                    break;
+                default:
+                    node_stats = &stats.node_256;
+                    node_stats->bytes += sizeof(_Node_256);
+            }
+            node_stats->count++;
+            node_stats->fill[inner->_count]++;
+            memory_stats::count(stats.prefix_length, inner->_prefix_length);
+            for_each_child(node, [this, depth, &stats](byte key_byte, Node_ptr child) {
+                collect_memory_stats(child, depth + 1, stats);
+            });
+        }
+
     public:
         void swap(ar_prefix_tree &__x) {
             std::swap(_M_root, __x._M_root);
             std::swap(_M_count, __x._M_count);
             std::swap(_M_dummy_node, __x._M_dummy_node);
             std::swap(_M_key_transform, __x._M_key_transform);
+            std::swap(_M_track_changes, __x._M_track_changes);
+            std::swap(_M_change_epoch, __x._M_change_epoch);
         }
 
         ////////////
@@ -2132,6 +3110,7 @@ namespace art {
 
         iterator find(const key_type &__k) {
             Key transformed_key = {_M_key_transform(__k)};
+            ART_STAT(lookups);
             const auto key_size = sizeof(transformed_key);
 
             if (_M_root == nullptr)
@@ -2141,6 +3120,7 @@ namespace art {
             for (unsigned depth = 0; depth < key_size + 1; depth++) {
                 if (current_node == nullptr)
                     return end();
+                ART_STAT(lookup_nodes);
 
                 if (current_node->is_leaf()) {
                     Leaf_ptr leaf = static_cast<Leaf_ptr>(current_node);
@@ -2163,6 +3143,7 @@ namespace art {
 
         const_iterator find(const key_type &__k) const {
             Key transformed_key = {_M_key_transform(__k)};
+            ART_STAT(lookups);
             const auto key_size = sizeof(transformed_key);
 
             if (_M_root == nullptr)
@@ -2172,6 +3153,7 @@ namespace art {
             for (unsigned depth = 0; depth < key_size + 1; depth++) {
                 if (current_node == nullptr)
                     return end();
+                ART_STAT(lookup_nodes);
 
                 if (current_node->is_leaf()) {
                     Const_Leaf_ptr leaf = static_cast<Const_Leaf_ptr>(current_node);
@@ -2353,6 +3335,295 @@ namespace art {
             return pair<const_iterator, const_iterator>(lower, upper);
         };
 
+        /**
+         * @brief Finds all elements whose transformed keys start with the given bytes.
+         * @param __prefix  Leading bytes of the transformed key.
+         * @param __length  Number of prefix bytes, at most the size of the transformed key.
+         * @return The range [first, last) of matching elements, (end(), end()) if there is none.
+         *
+         * Descends once to the root of the subtree that holds all matching keys.
+         */
+        pair<iterator, iterator> prefix_range(const byte *__prefix, size_t __length) {
+            Node_ptr node = const_cast<Node_ptr>(find_prefix_node(__prefix, __length));
+            if (node == nullptr)
+                return pair<iterator, iterator>(end(), end());
+
+            iterator last(node->maximum());
+            return pair<iterator, iterator>(iterator(node->minimum()), ++last);
+        }
+
+        pair<const_iterator, const_iterator> prefix_range(const byte *__prefix, size_t __length) const {
+            Const_Node_ptr node = find_prefix_node(__prefix, __length);
+            if (node == nullptr)
+                return pair<const_iterator, const_iterator>(end(), end());
+
+            const_iterator last(node->maximum());
+            return pair<const_iterator, const_iterator>(const_iterator(node->minimum()), ++last);
+        }
+
+        /**
+         * @brief Returns the number of elements whose transformed keys start with the given bytes.
+         *
+         * Counts the leaves of the matching subtree without iterating over it.
+         */
+        size_type count_prefix(const byte *__prefix, size_t __length) const {
+            Const_Node_ptr node = find_prefix_node(__prefix, __length);
+            if (node == nullptr)
+                return 0;
+            return subtree_size(node);
+        }
+
+        /**
+         * @brief Overloads taking the first __length bytes of the transformed key __k as prefix.
+         */
+        pair<iterator, iterator> prefix_range(const key_type &__k, size_t __length) {
+            Key key = {_M_key_transform(__k)};
+            return prefix_range(key.chunks, __length);
+        }
+
+        pair<const_iterator, const_iterator> prefix_range(const key_type &__k, size_t __length) const {
+            Key key = {_M_key_transform(__k)};
+            return prefix_range(key.chunks, __length);
+        }
+
+        size_type count_prefix(const key_type &__k, size_t __length) const {
+            Key key = {_M_key_transform(__k)};
+            return count_prefix(key.chunks, __length);
+        }
+
+        /**
+         * @brief Returns the number of elements with keys less than __k.
+         *
+         * Requires order statistics. Adds up the leaf counts of all children left of
+         * the search path, so only the nodes on that path are visited.
+         */
+        size_type rank(const key_type &__k) const {
+            static_assert(_Order_statistics, "rank() requires a tree with order statistics");
+            Key key = {_M_key_transform(__k)};
+
+            size_type rank = 0;
+            Const_Node_ptr node = _M_root;
+            while (node != nullptr) {
+                if (node->is_leaf()) {
+                    Key leaf_key = {_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node)->_value))};
+                    if (std::memcmp(&leaf_key, &key, sizeof(Key)) < 0)
+                        rank++;
+                    break;
+                }
+
+                // the whole subtree is either left or right of the key if the prefix differs
+                auto inner = static_cast<Const_Inner_Node_ptr>(node);
+                const int cmp = compare_prefix(inner, key);
+                if (cmp != 0) {
+                    if (cmp < 0)
+                        rank += inner->leaves();
+                    break;
+                }
+
+                const byte key_byte = key.chunks[inner->_depth + inner->_prefix_length];
+                Const_Node_ptr next = nullptr;
+                for_each_child(const_cast<Node_ptr>(node), [&](byte child_byte, Node_ptr child) {
+                    if (child_byte < key_byte)
+                        rank += leaves_below(child);
+                    else if (child_byte == key_byte)
+                        next = child;
+                });
+                node = next;
+            }
+            return rank;
+        }
+
+        /**
+         * @brief Returns an iterator to the element with the given rank (0-based).
+         * @return Iterator to the element or end() if __rank >= size().
+         *
+         * Requires order statistics.
+         */
+        iterator select(size_type __rank) {
+            if (__rank >= _M_count)
+                return end();
+            return iterator(const_cast<Base_Leaf_ptr>(select_leaf(__rank)));
+        }
+
+        const_iterator select(size_type __rank) const {
+            if (__rank >= _M_count)
+                return end();
+            return const_iterator(select_leaf(__rank));
+        }
+
+        /**
+         * @brief Returns the number of elements with keys in [lo, hi).
+         *
+         * Requires order statistics, two rank() lookups.
+         */
+        size_type count_range(const key_type &__lo, const key_type &__hi) const {
+            const size_type lo = rank(__lo);
+            const size_type hi = rank(__hi);
+            return hi > lo ? hi - lo : 0;
+        }
+
+        /**
+         * @brief Returns keys that split the elements into __parts ranges of equal size.
+         * @return At most __parts - 1 ascending keys, range i is [key i-1, key i) with
+         *         begin() and end() as the outer bounds. There are fewer keys if there
+         *         are less than __parts elements.
+         *
+         * Requires order statistics, one select() per key.
+         */
+        std::vector<key_type> split_points(size_type __parts) const {
+            std::vector<key_type> points;
+            size_type last_rank = 0;
+            for (size_type i = 1; i < __parts; i++) {
+                const size_type rank = i * _M_count / __parts;
+                if (rank == last_rank)
+                    continue;
+                points.push_back(_KeyOfValue()(static_cast<Const_Leaf_ptr>(select_leaf(rank))->_value));
+                last_rank = rank;
+            }
+            return points;
+        }
+
+        /**
+         * @brief Returns the combined summary of all elements with keys in [lo, hi).
+         *
+         * Requires an aggregate. Subtrees that lie completely within the range contribute
+         * their stored summary, only the nodes on the paths to lo and hi are descended.
+         */
+        summary_type aggregate(const key_type &__lo, const key_type &__hi) const {
+            static_assert(aggregated(), "aggregate() requires a tree with an aggregate");
+            Key lo = {_M_key_transform(__lo)};
+            Key hi = {_M_key_transform(__hi)};
+            if (_M_root == nullptr || std::memcmp(&lo, &hi, sizeof(Key)) >= 0)
+                return _Aggregate::identity();
+            return aggregate_subtree(_M_root, &lo, &hi);
+        }
+
+        /**
+         * @brief Returns the summary of all elements.
+         */
+        summary_type aggregate() const {
+            static_assert(aggregated(), "aggregate() requires a tree with an aggregate");
+            if (_M_root == nullptr)
+                return _Aggregate::identity();
+            return summary_below(_M_root);
+        }
+
+        /**
+         * @brief Recomputes the summaries above an element whose value was modified in place.
+         */
+        void refresh_aggregate(const_iterator __it) {
+            Key key = {_M_key_transform(_KeyOfValue()(*__it))};
+            refresh_summaries(key);
+        }
+
+        //////////////////////
+        // Change tracking  //
+        //////////////////////
+
+        /**
+         * @brief Starts tracking modifications, the current contents are the base
+         * of the first collect_changes().
+         *
+         * Clears the marks of all inner nodes. From now on every modification marks
+         * the inner nodes on the paths of the keys it affects.
+         */
+        void track_changes() {
+            if (_M_root != nullptr)
+                clear_marks(_M_root);
+            _M_track_changes = true;
+            _M_change_epoch = 0;
+        }
+
+        /**
+         * @brief Stops tracking modifications, a new base is needed to resume.
+         */
+        void untrack_changes() {
+            _M_track_changes = false;
+        }
+
+        bool tracks_changes() const noexcept {
+            return _M_track_changes;
+        }
+
+        /**
+         * @brief Returns the number of collect_changes() calls since track_changes().
+         */
+        uint64_t change_epoch() const noexcept {
+            return _M_change_epoch;
+        }
+
+        /**
+         * @brief Marks an element whose value was modified in place.
+         */
+        void mark_changed(const_iterator __it) {
+            Key key = {_M_key_transform(_KeyOfValue()(*__it))};
+            mark_path(key);
+        }
+
+        /**
+         * @brief Reports the modified parts of the tree and clears their marks.
+         * @param __f  Called as __f(region, values) with a detail::key_region and the
+         *             values of the region in key order (a vector of pointers).
+         *
+         * Replacing every reported region of the tree as it was at the previous call
+         * (or at track_changes()) with its values yields the current contents. Only
+         * modified inner nodes are visited. The root is reported as a whole if it
+         * is a leaf or the tree is empty.
+         */
+        template<typename _Function>
+        void collect_changes(_Function __f) {
+            if (_M_root == nullptr || _M_root->is_leaf()) {
+                std::vector<const value_type *> values;
+                if (_M_root != nullptr)
+                    values.push_back(&static_cast<Leaf_ptr>(_M_root)->_value);
+                const byte none = 0;
+                __f(detail::key_region{&none, 0, 0, std::bitset<256>()}, values);
+            } else if (static_cast<Inner_Node_ptr>(_M_root)->_dirty) {
+                collect_node_changes(static_cast<Inner_Node_ptr>(_M_root), 0, __f);
+            }
+            _M_change_epoch++;
+        }
+
+        /**
+         * @brief Replaces the elements of a region reported by collect_changes().
+         * @param __region  Region of the transformed key space, see detail::key_region.
+         * @param __first  Input iterator to the first new element of the region.
+         * @param __last  Input iterator past the last element.
+         */
+        template<typename _InputIterator>
+        void replace_region(const detail::key_region &__region, _InputIterator __first, _InputIterator __last) {
+            __region.for_each_range(sizeof(Key), [this](const byte *lo, const byte *hi) {
+                transformed_key_type bound;
+                std::memcpy(&bound, lo, sizeof(Key));
+                Key lo_key = {bound};
+                if (hi == nullptr) {
+                    erase_key_range(&lo_key, nullptr);
+                } else {
+                    std::memcpy(&bound, hi, sizeof(Key));
+                    Key hi_key = {bound};
+                    erase_key_range(&lo_key, &hi_key);
+                }
+            });
+            for (; __first != __last; ++__first)
+                insert_unique(*__first);
+        }
+
+        ///////////////////////
+        // Memory accounting //
+        ///////////////////////
+
+        /**
+         * @brief Counts the nodes by type, their fill, the depths of the leaves and
+         * the prefix lengths of the inner nodes, in one walk over the tree.
+         */
+        memory_stats memory_usage() const {
+            memory_stats stats;
+            stats.fixed_bytes = sizeof(*this) + sizeof(_Dummy_Node);
+            if (_M_root != nullptr)
+                collect_memory_stats(_M_root, 0, stats);
+            return stats;
+        }
+
         Base_Leaf_ptr minimum() {
             if (_M_root != nullptr)
                 return _M_root->minimum();
@@ -2377,6 +3648,137 @@ namespace art {
             return nullptr;
         }
 
+    private:
+        /**
+         * @brief Returns the root of the subtree with all keys starting with the given bytes.
+         * @return The subtree's root or nullptr if no key starts with the prefix.
+         */
+        Const_Node_ptr find_prefix_node(const byte *prefix, size_t length) const {
+            length = std::min(length, sizeof(Key));
+
+            Const_Node_ptr node = _M_root;
+            size_t depth = 0;
+            while (node != nullptr && depth < length) {
+                if (node->is_leaf()) {
+                    Key key = {_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node)->_value))};
+                    return std::memcmp(key.chunks, prefix, length) ? nullptr : node;
+                }
+
+                auto inner = static_cast<Const_Inner_Node_ptr>(node);
+                const size_t compared = std::min<size_t>(inner->_prefix_length, length - depth);
+                if (compared > MAX_PREFIX_LENGTH) {
+                    // optimistic path compression, the rest of the prefix is only stored in the leaves
+                    ART_STAT(optimistic_prefix_loads);
+                    Key key = {_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(inner->minimum())->_value))};
+                    if (std::memcmp(key.chunks + depth, prefix + depth, compared))
+                        return nullptr;
+                } else if (std::memcmp(inner->_prefix.data(), prefix + depth, compared)) {
+                    return nullptr;
+                }
+
+                if (depth + inner->_prefix_length >= length)
+                    return node;
+
+                depth += inner->_prefix_length;
+                node = node->find(prefix[depth]);
+                depth++;
+            }
+            return node;
+        }
+
+        /**
+         * @brief Returns the number of leaves below a node (a leaf counts itself).
+         */
+        size_t subtree_size(Const_Node_ptr node) const {
+            if (node->is_leaf())
+                return 1;
+            if (_Order_statistics)
+                return leaves_below(node);
+
+            size_t count = 0;
+            for_each_child(const_cast<Node_ptr>(node), [this, &count](byte key_byte, Node_ptr child) {
+                count += subtree_size(child);
+            });
+            return count;
+        }
+
+        /**
+         * @brief Compares the key bytes at the prefix position of a node with its prefix.
+         * @return A negative value if the key is greater, i.e. the whole subtree is less than
+         *         the key, 0 if they match and a positive value otherwise (like memcmp).
+         */
+        int compare_prefix(Const_Inner_Node_ptr node, const Key &key) const {
+            const size_t pessimistic_length = std::min((size_t) node->_prefix_length, MAX_PREFIX_LENGTH);
+            int cmp = std::memcmp(node->_prefix.data(), key.chunks + node->_depth, pessimistic_length);
+            if (cmp == 0 && node->_prefix_length > MAX_PREFIX_LENGTH) {
+                // optimistic path compression, the rest of the prefix is only stored in the leaves
+                ART_STAT(optimistic_prefix_loads);
+                Key min_key = {_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node->minimum())->_value))};
+                const size_t start = node->_depth + MAX_PREFIX_LENGTH;
+                cmp = std::memcmp(min_key.chunks + start, key.chunks + start, node->_prefix_length - MAX_PREFIX_LENGTH);
+            }
+            return cmp;
+        }
+
+        /**
+         * @brief Returns the leaf with the given rank, which has to be less than size().
+         */
+        Const_Base_Leaf_ptr select_leaf(size_type rank) const {
+            static_assert(_Order_statistics, "select() requires a tree with order statistics");
+            Const_Node_ptr node = _M_root;
+            while (!node->is_leaf()) {
+                Const_Node_ptr next = nullptr;
+                for_each_child(const_cast<Node_ptr>(node), [&](byte key_byte, Node_ptr child) {
+                    if (next != nullptr)
+                        return;
+                    const size_t leaves = leaves_below(child);
+                    if (rank < leaves)
+                        next = child;
+                    else
+                        rank -= leaves;
+                });
+                node = next;
+            }
+            return static_cast<Const_Base_Leaf_ptr>(node);
+        }
+
+        /**
+         * @brief Combines the summaries of all leaves of a subtree whose keys are in [lo, hi).
+         * @param node  Root of the subtree.
+         * @param lo  Inclusive lower bound or nullptr if the subtree is not bounded below.
+         * @param hi  Exclusive upper bound or nullptr if the subtree is not bounded above.
+         */
+        summary_type aggregate_subtree(Const_Node_ptr node, const Key *lo, const Key *hi) const {
+            if (node->is_leaf()) {
+                Key key = {_M_key_transform(_KeyOfValue()(static_cast<Const_Leaf_ptr>(node)->_value))};
+                if ((lo == nullptr || std::memcmp(&key, lo, sizeof(Key)) >= 0)
+                    && (hi == nullptr || std::memcmp(&key, hi, sizeof(Key)) < 0))
+                    return summary_below(node);
+                return _Aggregate::identity();
+            }
+
+            auto inner = static_cast<Const_Inner_Node_ptr>(node);
+            if (!restrict_bounds(inner, lo, hi))
+                return _Aggregate::identity();
+
+            if (lo == nullptr && hi == nullptr)
+                return summary_below(node);
+
+            const int32_t key_depth = inner->_depth + inner->_prefix_length;
+            summary_type summary = _Aggregate::identity();
+            for_each_child(const_cast<Node_ptr>(node), [&](byte key_byte, Node_ptr child) {
+                if ((lo != nullptr && key_byte < lo->chunks[key_depth])
+                    || (hi != nullptr && key_byte > hi->chunks[key_depth]))
+                    return;
+
+                const Key *child_lo = lo != nullptr && key_byte == lo->chunks[key_depth] ? lo : nullptr;
+                const Key *child_hi = hi != nullptr && key_byte == hi->chunks[key_depth] ? hi : nullptr;
+                summary = _Aggregate::combine(summary, aggregate_subtree(child, child_lo, child_hi));
+            });
+            return summary;
+        }
+
+    public:
         ~ar_prefix_tree() {
             clear();
             delete _M_dummy_node;
@@ -2389,18 +3791,21 @@ namespace art {
             switch (type) {
                 case node_type::node_4_t: {
                     _Node_4 *node4 = static_cast<_Node_4 *>(old_node);
+                    ART_STAT(grow_4);
                     Node_ptr node = new _Node_16(node4);
                     delete node4;
                     return node;
                 }
                 case node_type::node_16_t: {
                     _Node_16 *node16 = static_cast<_Node_16 *>(old_node);
+                    ART_STAT(grow_16);
                     Node_ptr node = new _Node_48(node16);
                     delete node16;
                     return node;
                 }
                 case node_type::node_48_t: {
                     _Node_48 *node48 = static_cast<_Node_48 *>(old_node);
+                    ART_STAT(grow_48);
                     Node_ptr node = new _Node_256(node48);
                     delete node48;
                     return node;
@@ -2418,6 +3823,7 @@ namespace art {
                     _Node_4 *node4 = static_cast<_Node_4 *>(old_node);
 
                     if (node4->children[0]->is_leaf()) {
+                        ART_STAT(shrink_4);
                         node4->children[0]->_parent = old_node->_parent;
                         Leaf_ptr child = static_cast<Leaf_ptr >(node4->children[0]);
                         delete node4;
@@ -2427,18 +3833,21 @@ namespace art {
                 }
                 case node_type::node_16_t: {
                     _Node_16 *node16 = static_cast<_Node_16 *>(old_node);
+                    ART_STAT(shrink_16);
                     Node_ptr node = new _Node_4(node16);
                     delete node16;
                     return pair<Node_ptr, bool>(node, true);
                 }
                 case node_type::node_48_t: {
                     _Node_48 *node48 = static_cast<_Node_48 *>(old_node);
+                    ART_STAT(shrink_48);
                     Node_ptr node = new _Node_16(node48);
                     delete node48;
                     return pair<Node_ptr, bool>(node, true);
                 }
                 case node_type::node_256_t: {
                     _Node_256 *node256 = static_cast<_Node_256 *>(old_node);
+                    ART_STAT(shrink_256);
                     Node_ptr node = new _Node_48(node256);
                     delete node256;
                     return pair<Node_ptr, bool>(node, true);
@@ -2450,58 +3859,65 @@ namespace art {
         }
     };
 
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
-    const byte ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform>::EMPTY_MARKER = 63;
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
+    const byte ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate>::EMPTY_MARKER = 63;
 
     //////////////////////////
     // Relational Operators //
     //////////////////////////
 
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator==(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &lhs,
-               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &rhs) {
+    operator==(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &lhs,
+               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &rhs) {
         return lhs.size() == rhs.size()
                && std::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
     // Based on operator==
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator!=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &lhs,
-               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &rhs) {
+    operator!=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &lhs,
+               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &rhs) {
         return !(lhs == rhs);
     }
 
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator<(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__x,
-              const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__y) {
+    operator<(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return std::lexicographical_compare(__x.begin(), __x.end(),
                                             __y.begin(), __y.end());
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator>(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__x,
-              const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__y) {
+    operator>(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __y < __x;
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator<=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__x,
-               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__y) {
+    operator<=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__y < __x);
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _KeyOfValue, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator>=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__x,
-               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform> &__y) {
+    operator>=(const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const ar_prefix_tree<_Key, _Tp, _KeyOfValue, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__x < __y);
     }
 
@@ -0,0 +1,33 @@
+#ifndef ART_BATCH_OP_H
+#define ART_BATCH_OP_H
+
+#include <stdint.h>
+
+namespace art {
+    /**
+     * Kind of a single operation in a batch applied with apply_sorted_batch().
+     *
+     *  - insert: inserts the value if its key is not present yet.
+     *  - assign: inserts the value or replaces the value of an existing key.
+     *  - erase:  erases the key if it is present, the rest of the value is ignored.
+     */
+    enum class batch_op_kind : uint8_t {
+        insert = 0, assign = 1, erase = 2
+    };
+
+    /**
+     * @brief A single operation of a sorted batch.
+     *
+     *  @tparam _Value  Value type of the container the batch is applied to.
+     */
+    template<typename _Value>
+    struct batch_op {
+        batch_op_kind kind;
+        _Value value;
+
+        batch_op(batch_op_kind kind, const _Value &value)
+                : kind(kind), value(value) {}
+    };
+}
+
+#endif //ART_BATCH_OP_H
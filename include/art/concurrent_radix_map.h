@@ -0,0 +1,150 @@
+#ifndef ART_CONCURRENT_RADIX_MAP_H
+#define ART_CONCURRENT_RADIX_MAP_H
+
+#include <stdexcept>
+#include <utility>
+#include "olc_tree.h"
+#include "radix_map.h"
+
+namespace art {
+    /**
+     * @brief A map of (key,value) pairs that many threads can read and
+     * modify at the same time.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects, must be copy constructible.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *  @tparam _Single_writer  Only one thread at a time modifies the map. Its
+     *                          lookups then neither lock, validate nor restart,
+     *                          so reads scale with the number of readers.
+     *
+     * Lookups take no locks, modifications lock only the one or two nodes
+     * they change (see olc_tree). Because elements can be replaced or erased
+     * by other threads at any time, there are no iterators and no references
+     * into the map: lookups copy the mapped value out, or hand the element
+     * to a function while it is protected from reclamation.
+     *
+     * The tree has no path compression, so it suits short keys (integers,
+     * pairs of integers) best.
+     */
+    template<typename _Key, typename _T,
+            typename _Key_transform = key_transform<_Key>, bool _Single_writer = false>
+    class concurrent_radix_map {
+
+    public:
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef std::pair<const _Key, _T> value_type;
+        typedef _Key_transform key_transformer_type;
+
+    private:
+        typedef olc_tree<key_type, value_type, detail::Select1st<value_type>, _Key_transform, _Single_writer> _Rep_type;
+
+        _Rep_type _M_t;
+
+    public:
+        typedef typename _Rep_type::size_type size_type;
+
+        /**
+         * @brief  Default constructor creates no elements.
+         */
+        concurrent_radix_map() : _M_t() {}
+
+        concurrent_radix_map(const concurrent_radix_map &) = delete;
+
+        concurrent_radix_map &operator=(const concurrent_radix_map &) = delete;
+
+        // Capacity
+
+        /**
+         * Returns true if the map is empty.
+         */
+        bool empty() const noexcept {
+            return _M_t.empty();
+        }
+
+        /**
+         * Returns the size of the map, exact only while no writer is active.
+         */
+        size_type size() const noexcept {
+            return _M_t.size();
+        }
+
+        // Modifiers
+
+        /**
+         *  @brief Attempts to insert a std::pair into the map.
+         *  @param __x Pair to be inserted.
+         *  @return  Whether the pair was inserted, false if the key existed.
+         */
+        bool insert(const value_type &__x) {
+            return _M_t.insert_unique(__x);
+        }
+
+        /**
+         *  @brief Inserts a std::pair or replaces the mapped value of an
+         *  existing key.
+         *  @return  Whether the pair was inserted rather than assigned.
+         *
+         * Readers see either the old or the new value, never a mix.
+         */
+        bool insert_or_assign(const key_type &__k, const mapped_type &__obj) {
+            return _M_t.insert_or_assign(value_type(__k, __obj));
+        }
+
+        /**
+         *  @brief Attempts to erase the element with the given key (if it exists).
+         *  @param  __k The key to erase.
+         *  @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            return _M_t.erase_unique(__k);
+        }
+
+        // Lookup
+
+        /**
+         *  @brief  Copies the mapped value of key @a __k into @a __obj.
+         *  @return  Whether the key was found, @a __obj is untouched if not.
+         */
+        bool find(const key_type &__k, mapped_type &__obj) const {
+            return _M_t.visit(__k, [&__obj](const value_type &__x) { __obj = __x.second; });
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @return  A copy of the data whose key is @a __k.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        mapped_type at(const key_type &__k) const {
+            mapped_type __obj;
+            if (!find(__k, __obj))
+                throw std::out_of_range("concurrent_radix_map::at");
+            return __obj;
+        }
+
+        /**
+         *  @brief  Calls @a __f with the element of key @a __k.
+         *  @return  Whether the key was found.
+         *
+         * The element stays valid while @a __f runs, even if another thread
+         * erases it meanwhile. @a __f must not keep references to it.
+         */
+        template<typename _Function>
+        bool visit(const key_type &__k, _Function __f) const {
+            return _M_t.visit(__k, __f);
+        }
+
+        /**
+         *  @brief  Finds the number of elements.
+         *  @param  __x  Key to located.
+         *  @return  Number of elements with specified key.
+         */
+        size_type count(const key_type &__x) const {
+            return _M_t.visit(__x, [](const value_type &) {}) ? 1 : 0;
+        }
+    };
+}
+
+#endif //ART_CONCURRENT_RADIX_MAP_H
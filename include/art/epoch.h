@@ -0,0 +1,219 @@
+#ifndef ART_EPOCH_H
+#define ART_EPOCH_H
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#ifndef ART_MAX_THREADS
+#define ART_MAX_THREADS 128
+#endif
+
+namespace art {
+    namespace detail {
+        /**
+         * @brief Hands out small, dense thread indices and recycles them when
+         * a thread exits, so per-thread slots can live in a flat array.
+         */
+        class thread_registry {
+            std::mutex _mutex;
+            std::vector<size_t> _free;
+            size_t _next = 0;
+
+        public:
+            static thread_registry &instance() {
+                static thread_registry registry;
+                return registry;
+            }
+
+            size_t acquire() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_free.empty()) {
+                    size_t index = _free.back();
+                    _free.pop_back();
+                    return index;
+                }
+                return _next++;
+            }
+
+            void release(size_t index) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _free.push_back(index);
+            }
+        };
+
+        struct thread_index_holder {
+            const size_t index;
+
+            thread_index_holder() : index(thread_registry::instance().acquire()) {}
+
+            ~thread_index_holder() { thread_registry::instance().release(index); }
+        };
+
+        /**
+         * @brief Index of the calling thread, unique among the running threads.
+         */
+        inline size_t current_thread_index() {
+            static thread_local thread_index_holder holder;
+            return holder.index;
+        }
+
+        /**
+         * @brief Epoch based reclamation of memory that concurrent readers may
+         * still be looking at.
+         *
+         * Every operation on a shared structure runs inside a guard, which
+         * announces the global epoch the thread started in. Unlinked memory is
+         * retire()d instead of deleted, tagged with the current epoch, and freed
+         * once the global epoch has moved two steps further. The epoch only
+         * advances when every pinned thread has seen the current one, so no
+         * guard that could have reached the memory is still running by then.
+         *
+         * Up to ART_MAX_THREADS threads may use one manager at the same time.
+         */
+        class epoch_manager {
+            static const uint64_t QUIESCENT = UINT64_MAX;
+
+            // retire() tries to advance the epoch every RECLAIM_INTERVAL calls
+            static const size_t RECLAIM_INTERVAL = 64;
+
+            struct retired {
+                void *ptr;
+                void (*deleter)(void *);
+                uint64_t epoch;
+            };
+
+            struct thread_slot {
+                std::atomic<uint64_t> epoch;
+                // only touched by the thread owning the slot
+                unsigned nesting = 0;
+                std::vector<retired> retired_list;
+                // keep the epochs of neighbouring slots on separate cache lines
+                char _pad[64];
+
+                thread_slot() : epoch(QUIESCENT) {}
+            };
+
+            std::atomic<uint64_t> _global_epoch;
+            thread_slot *_slots;
+
+            thread_slot &local_slot() {
+                size_t index = current_thread_index();
+                if (index >= ART_MAX_THREADS)
+                    throw std::length_error("art::detail::epoch_manager: more than ART_MAX_THREADS threads");
+                return _slots[index];
+            }
+
+            void enter(thread_slot &slot) {
+                if (slot.nesting++ > 0)
+                    return;
+                uint64_t epoch = _global_epoch.load();
+                while (true) {
+                    slot.epoch.store(epoch);
+                    uint64_t now = _global_epoch.load();
+                    if (now == epoch)
+                        return;
+                    epoch = now;
+                }
+            }
+
+            void exit(thread_slot &slot) {
+                if (--slot.nesting == 0)
+                    slot.epoch.store(QUIESCENT, std::memory_order_release);
+            }
+
+            void try_advance() {
+                uint64_t epoch = _global_epoch.load();
+                for (size_t i = 0; i < ART_MAX_THREADS; i++) {
+                    uint64_t local = _slots[i].epoch.load();
+                    if (local != QUIESCENT && local != epoch)
+                        return;
+                }
+                _global_epoch.compare_exchange_strong(epoch, epoch + 1);
+            }
+
+            void reclaim(thread_slot &slot) {
+                const uint64_t epoch = _global_epoch.load();
+                auto &list = slot.retired_list;
+                // the list is ordered by epoch, free its safe prefix
+                size_t i = 0;
+                while (i < list.size() && list[i].epoch + 2 <= epoch) {
+                    list[i].deleter(list[i].ptr);
+                    i++;
+                }
+                list.erase(list.begin(), list.begin() + i);
+            }
+
+        public:
+            /**
+             * @brief Pins the calling thread to the current epoch for its lifetime.
+             */
+            class guard {
+                epoch_manager *_manager;
+                thread_slot *_slot;
+
+            public:
+                explicit guard(epoch_manager &manager)
+                        : _manager(&manager), _slot(&manager.local_slot()) {
+                    _manager->enter(*_slot);
+                }
+
+                guard(const guard &) = delete;
+
+                guard &operator=(const guard &) = delete;
+
+                ~guard() { _manager->exit(*_slot); }
+            };
+
+            epoch_manager() : _global_epoch(0), _slots(new thread_slot[ART_MAX_THREADS]) {}
+
+            epoch_manager(const epoch_manager &) = delete;
+
+            epoch_manager &operator=(const epoch_manager &) = delete;
+
+            /**
+             * Frees everything still retired, no thread may be pinned any more.
+             */
+            ~epoch_manager() {
+                for (size_t i = 0; i < ART_MAX_THREADS; i++) {
+                    for (auto &r : _slots[i].retired_list)
+                        r.deleter(r.ptr);
+                }
+                delete[] _slots;
+            }
+
+            /**
+             * @brief  Hands unlinked memory over for deferred deletion.
+             *  @param  ptr  Memory no longer reachable for new guards.
+             *  @param  deleter  Frees @a ptr once no guard can see it any more.
+             *
+             *  Must be called by a pinned thread.
+             */
+            void retire(void *ptr, void (*deleter)(void *)) {
+                thread_slot &slot = local_slot();
+                slot.retired_list.push_back({ptr, deleter, _global_epoch.load()});
+                if (slot.retired_list.size() % RECLAIM_INTERVAL == 0) {
+                    try_advance();
+                    reclaim(slot);
+                }
+            }
+
+            /**
+             * @brief Number of retired but not yet freed objects of all threads.
+             *
+             * Only meaningful while no other thread uses the manager.
+             */
+            size_t pending() const {
+                size_t count = 0;
+                for (size_t i = 0; i < ART_MAX_THREADS; i++)
+                    count += _slots[i].retired_list.size();
+                return count;
+            }
+        };
+    }
+}
+
+#endif //ART_EPOCH_H
@@ -0,0 +1,672 @@
+#ifndef ART_FROZEN_RADIX_MAP_H
+#define ART_FROZEN_RADIX_MAP_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "radix_map.h"
+#include "serialization.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "shared_memory.h"
+#endif
+
+namespace art {
+    /**
+     * @brief An immutable map of (key,value) pairs stored in one contiguous,
+     * position-independent buffer, which can be written to a file and mapped
+     * back into memory without deserialization.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *
+     * Keys and mapped values have to be trivially copyable (or pairs of such
+     * types). The buffer holds a header, the elements as an array in key order
+     * and the inner nodes of a radix tree over them. Nodes refer to their
+     * children by offsets into the buffer and have no parent pointers or
+     * vtables; each is sized for its exact number of children (sorted bytes
+     * for up to 16, a byte index for up to 48, a direct array above). Nodes
+     * skip the bytes all their keys share, lookups compare the full key at
+     * the leaf.
+     *
+     * Iterators are pointers into the element array. A buffer is only valid
+     * on machines with the same byte order and type layouts.
+     *
+     * Copies share the buffer.
+     */
+    template<typename _Key, typename _T,
+            typename _Key_transform = key_transform<_Key> >
+    class frozen_radix_map {
+
+    public:
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef std::pair<const _Key, _T> value_type;
+        typedef _Key_transform key_transformer_type;
+        typedef const value_type &reference;
+        typedef const value_type &const_reference;
+        typedef const value_type *iterator;
+        typedef const value_type *const_iterator;
+        typedef std::reverse_iterator<const_iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+    private:
+        static_assert(detail::is_raw_storable<value_type>::value,
+                      "frozen_radix_map requires trivially copyable keys and values");
+        static_assert(alignof(value_type) <= 8, "elements must not need more than 8 byte alignment");
+
+        typedef decltype(_Key_transform()(_Key())) transformed_key_type;
+
+        union Key {
+            transformed_key_type value;
+            byte chunks[sizeof(transformed_key_type)];
+        };
+
+        static const uint16_t VERSION = 1;
+
+        /*
+         * References to children: leaves are (index << 1) | 1, inner nodes
+         * the (8 byte aligned) offset of the node in the buffer, 0 is none.
+         */
+        static const uint64_t EMPTY = 0;
+
+        struct _Header {
+            char magic[4];
+            uint16_t version;
+            uint8_t little_endian;
+            uint8_t reserved;
+            uint32_t key_size;
+            uint32_t value_size;
+            uint64_t count;
+            uint64_t root;
+            uint64_t leaves;
+            uint64_t size;
+        };
+
+        enum class node_type : uint8_t {
+            sparse = 0, indexed = 1, direct = 2
+        };
+
+        /*
+         * Followed by
+         *  sparse:  byte keys[count] (padded to 8 bytes), uint64_t children[count]
+         *  indexed: byte index[256] (slot + 1, 0 is none), uint64_t children[count]
+         *  direct:  uint64_t children[256]
+         */
+        struct _Node {
+            node_type type;
+            uint8_t reserved;
+            uint16_t count;
+            uint32_t depth;
+            // the node's elements are [leaf_begin, leaf_end)
+            uint64_t leaf_begin;
+            uint64_t leaf_end;
+        };
+
+        static const char *magic() { return "ARTF"; }
+
+        static size_t align8(size_t __n) { return (__n + 7) & ~size_t(7); }
+
+        static bool is_leaf(uint64_t ref) { return ref & 1; }
+
+        static uint64_t leaf_ref(uint64_t index) { return (index << 1) | 1; }
+
+        static size_t node_size(node_type type, size_t count) {
+            switch (type) {
+                case node_type::sparse:
+                    return sizeof(_Node) + align8(count) + count * sizeof(uint64_t);
+                case node_type::indexed:
+                    return sizeof(_Node) + 256 + count * sizeof(uint64_t);
+                default:
+                    return sizeof(_Node) + 256 * sizeof(uint64_t);
+            }
+        }
+
+        // keeps the buffer (or mapping) alive, shared between copies
+        std::shared_ptr<const void> _M_storage;
+        const char *_M_data;
+        const _Header *_M_header;
+        const value_type *_M_leaves;
+        _Key_transform _M_key_transform;
+
+        const _Node *node_at(uint64_t ref) const {
+            return reinterpret_cast<const _Node *>(_M_data + ref);
+        }
+
+        const value_type *leaf_at(uint64_t ref) const {
+            return _M_leaves + (ref >> 1);
+        }
+
+        /**
+         * @brief Returns the child for key byte b, EMPTY if there is none.
+         */
+        static uint64_t child(const _Node *n, byte b) {
+            const char *body = reinterpret_cast<const char *>(n + 1);
+            switch (n->type) {
+                case node_type::sparse: {
+                    const byte *keys = reinterpret_cast<const byte *>(body);
+                    const uint64_t *children = reinterpret_cast<const uint64_t *>(body + align8(n->count));
+                    for (unsigned i = 0; i < n->count && keys[i] <= b; i++) {
+                        if (keys[i] == b)
+                            return children[i];
+                    }
+                    return EMPTY;
+                }
+                case node_type::indexed: {
+                    const byte slot = reinterpret_cast<const byte *>(body)[b];
+                    return slot ? reinterpret_cast<const uint64_t *>(body + 256)[slot - 1] : EMPTY;
+                }
+                default:
+                    return reinterpret_cast<const uint64_t *>(body)[b];
+            }
+        }
+
+        /**
+         * @brief Returns the child with the smallest key byte greater than b, EMPTY if there is none.
+         */
+        static uint64_t next_child(const _Node *n, byte b) {
+            const char *body = reinterpret_cast<const char *>(n + 1);
+            switch (n->type) {
+                case node_type::sparse: {
+                    const byte *keys = reinterpret_cast<const byte *>(body);
+                    const uint64_t *children = reinterpret_cast<const uint64_t *>(body + align8(n->count));
+                    for (unsigned i = 0; i < n->count; i++) {
+                        if (keys[i] > b)
+                            return children[i];
+                    }
+                    return EMPTY;
+                }
+                case node_type::indexed: {
+                    const byte *index = reinterpret_cast<const byte *>(body);
+                    for (unsigned i = b + 1u; i < 256; i++) {
+                        if (index[i])
+                            return reinterpret_cast<const uint64_t *>(body + 256)[index[i] - 1];
+                    }
+                    return EMPTY;
+                }
+                default: {
+                    const uint64_t *children = reinterpret_cast<const uint64_t *>(body);
+                    for (unsigned i = b + 1u; i < 256; i++) {
+                        if (children[i] != EMPTY)
+                            return children[i];
+                    }
+                    return EMPTY;
+                }
+            }
+        }
+
+        uint64_t leaf_begin(uint64_t ref) const {
+            return is_leaf(ref) ? ref >> 1 : node_at(ref)->leaf_begin;
+        }
+
+        Key transformed(const key_type &__k) const {
+            Key key;
+            key.value = _M_key_transform(__k);
+            return key;
+        }
+
+        /**
+         * @brief Index of the first element whose key is not less than the given key.
+         *
+         * Nodes skip shared bytes, so a first descent only finds a leaf with the
+         * longest matching prefix. The first byte where the key differs from it
+         * tells in a second descent on which side of which subtree the key falls.
+         */
+        uint64_t lower_bound_index(const Key &key) const {
+            uint64_t ref = _M_header->root;
+            if (ref == EMPTY)
+                return 0;
+
+            while (!is_leaf(ref)) {
+                const _Node *n = node_at(ref);
+                const uint64_t next = child(n, key.chunks[n->depth]);
+                if (next == EMPTY) {
+                    ref = leaf_ref(n->leaf_begin);
+                    break;
+                }
+                ref = next;
+            }
+
+            const Key leaf_key = transformed(leaf_at(ref)->first);
+            size_t p = 0;
+            while (p < sizeof(Key) && key.chunks[p] == leaf_key.chunks[p])
+                p++;
+            if (p == sizeof(Key))
+                return ref >> 1;
+
+            ref = _M_header->root;
+            while (!is_leaf(ref)) {
+                const _Node *n = node_at(ref);
+                if (n->depth > p)
+                    return key.chunks[p] < leaf_key.chunks[p] ? n->leaf_begin : n->leaf_end;
+                if (n->depth == p) {
+                    const uint64_t next = next_child(n, key.chunks[p]);
+                    return next == EMPTY ? n->leaf_end : leaf_begin(next);
+                }
+                ref = child(n, key.chunks[n->depth]);
+            }
+            return key.chunks[p] < leaf_key.chunks[p] ? ref >> 1 : (ref >> 1) + 1;
+        }
+
+        /**
+         * @brief Appends the node over the sorted keys [lo, hi) to the buffer,
+         * a growable array of words like std::vector<uint64_t>.
+         * @return A reference to it, or to the leaf if there is only one key.
+         */
+        template<typename _Buffer>
+        static uint64_t build_node(_Buffer &buffer, const std::vector<Key> &keys,
+                                   size_t lo, size_t hi, size_t depth) {
+            if (hi - lo == 1)
+                return leaf_ref(lo);
+
+            // keys are sorted, so the bytes all of them share are the ones the first and last share
+            while (keys[lo].chunks[depth] == keys[hi - 1].chunks[depth])
+                depth++;
+
+            std::vector<std::pair<byte, size_t> > groups;
+            for (size_t i = lo; i < hi;) {
+                const byte b = keys[i].chunks[depth];
+                groups.push_back(std::make_pair(b, i));
+                while (i < hi && keys[i].chunks[depth] == b)
+                    i++;
+            }
+
+            const size_t count = groups.size();
+            const node_type type = count <= 16 ? node_type::sparse
+                                               : count <= 48 ? node_type::indexed : node_type::direct;
+            const uint64_t offset = buffer.size() * sizeof(uint64_t);
+            buffer.resize(buffer.size() + node_size(type, count) / sizeof(uint64_t), 0);
+
+            _Node *n = reinterpret_cast<_Node *>(reinterpret_cast<char *>(buffer.data()) + offset);
+            n->type = type;
+            n->count = static_cast<uint16_t>(count);
+            n->depth = static_cast<uint32_t>(depth);
+            n->leaf_begin = lo;
+            n->leaf_end = hi;
+
+            for (size_t g = 0; g < count; g++) {
+                const size_t group_end = g + 1 < count ? groups[g + 1].second : hi;
+                const uint64_t ref = build_node(buffer, keys, groups[g].second, group_end, depth + 1);
+
+                // the buffer may have moved
+                char *body = reinterpret_cast<char *>(buffer.data()) + offset + sizeof(_Node);
+                const byte b = groups[g].first;
+                switch (type) {
+                    case node_type::sparse:
+                        reinterpret_cast<byte *>(body)[g] = b;
+                        reinterpret_cast<uint64_t *>(body + align8(count))[g] = ref;
+                        break;
+                    case node_type::indexed:
+                        reinterpret_cast<byte *>(body)[b] = static_cast<byte>(g + 1);
+                        reinterpret_cast<uint64_t *>(body + 256)[g] = ref;
+                        break;
+                    case node_type::direct:
+                        reinterpret_cast<uint64_t *>(body)[b] = ref;
+                        break;
+                }
+            }
+            return offset;
+        }
+
+        /**
+         * @brief Writes the image of the sorted elements into the empty buffer.
+         */
+        template<typename _Buffer, typename _InputIterator>
+        void build_image(_Buffer &buffer, _InputIterator __first, _InputIterator __last, size_t __count) const {
+            const size_t leaves_offset = align8(sizeof(_Header));
+            const size_t nodes_offset = align8(leaves_offset + __count * sizeof(value_type));
+            buffer.resize(nodes_offset / sizeof(uint64_t), 0);
+
+            std::vector<Key> keys;
+            keys.reserve(__count);
+            char *leaves = reinterpret_cast<char *>(buffer.data()) + leaves_offset;
+            for (size_t i = 0; __first != __last; ++__first, ++i) {
+                new(leaves + i * sizeof(value_type)) value_type(*__first);
+                keys.push_back(transformed(__first->first));
+            }
+
+            const uint64_t root = __count == 0 ? EMPTY : build_node(buffer, keys, 0, __count, 0);
+
+            _Header *header = reinterpret_cast<_Header *>(buffer.data());
+            std::memcpy(header->magic, magic(), sizeof(header->magic));
+            header->version = VERSION;
+            header->little_endian = is_big_endian() ? 0 : 1;
+            header->key_size = sizeof(key_type);
+            header->value_size = sizeof(value_type);
+            header->count = __count;
+            header->root = root;
+            header->leaves = leaves_offset;
+            header->size = buffer.size() * sizeof(uint64_t);
+        }
+
+        template<typename _InputIterator>
+        void build(_InputIterator __first, _InputIterator __last, size_t __count) {
+            std::vector<uint64_t> buffer;
+            build_image(buffer, __first, __last, __count);
+            auto storage = std::make_shared<std::vector<uint64_t> >(std::move(buffer));
+            attach(storage, storage->data(), storage->size() * sizeof(uint64_t));
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+        /**
+         * @brief A word buffer in a shared memory object, growing it geometrically.
+         */
+        class shared_words {
+            shared_memory &_memory;
+            size_t _size;
+
+        public:
+            explicit shared_words(shared_memory &memory) : _memory(memory), _size(0) {}
+
+            uint64_t *data() const {
+                return static_cast<uint64_t *>(_memory.data());
+            }
+
+            size_t size() const {
+                return _size;
+            }
+
+            // new words are zero, the object only grows while building
+            void resize(size_t size, uint64_t) {
+                const size_t capacity = _memory.size() / sizeof(uint64_t);
+                if (size > capacity)
+                    _memory.resize(std::max(size, 2 * capacity) * sizeof(uint64_t));
+                _size = size;
+            }
+        };
+
+#endif
+
+        /**
+         * @brief Validates the header of an image and points the map at it.
+         * @throw serialization_error  If the image does not fit this map type.
+         */
+        void attach(std::shared_ptr<const void> __storage, const void *__data, size_t __size) {
+            const _Header *header = static_cast<const _Header *>(__data);
+            if (__size < sizeof(_Header) || std::memcmp(header->magic, magic(), sizeof(header->magic)) != 0)
+                throw serialization_error("art: not a frozen_radix_map image");
+            if (header->version != VERSION)
+                throw serialization_error("art: unsupported frozen_radix_map version");
+            if (header->little_endian != (is_big_endian() ? 0 : 1))
+                throw serialization_error("art: image written with a different byte order");
+            if (header->key_size != sizeof(key_type) || header->value_size != sizeof(value_type))
+                throw serialization_error("art: image has different key or value sizes");
+            if (header->size != __size || header->leaves % 8 != 0 ||
+                header->leaves + header->count * sizeof(value_type) > __size)
+                throw serialization_error("art: truncated frozen_radix_map image");
+
+            _M_storage = std::move(__storage);
+            _M_data = static_cast<const char *>(__data);
+            _M_header = header;
+            _M_leaves = reinterpret_cast<const value_type *>(_M_data + header->leaves);
+        }
+
+        frozen_radix_map(std::shared_ptr<const void> __storage, const void *__data, size_t __size)
+                : _M_storage(), _M_data(nullptr), _M_header(nullptr), _M_leaves(nullptr), _M_key_transform() {
+            attach(std::move(__storage), __data, __size);
+        }
+
+    public:
+        /**
+         * @brief  Default constructor creates no elements.
+         */
+        frozen_radix_map()
+                : _M_storage(), _M_data(nullptr), _M_header(nullptr), _M_leaves(nullptr), _M_key_transform() {
+            build(static_cast<const value_type *>(nullptr), static_cast<const value_type *>(nullptr), 0);
+        }
+
+        /**
+         * @brief  Builds the image of all elements of a radix_map.
+         */
+        template<bool _Order_statistics, typename _Aggregate>
+        explicit frozen_radix_map(const radix_map<_Key, _T, _Key_transform, _Order_statistics, _Aggregate> &__x)
+                : _M_storage(), _M_data(nullptr), _M_header(nullptr), _M_leaves(nullptr), _M_key_transform() {
+            build(__x.begin(), __x.end(), __x.size());
+        }
+
+        /**
+         *  @brief  A map over an image in memory the caller keeps alive,
+         *  e.g. received from another process or mapped by other means.
+         *  @param  __data  Start of the image, aligned to 8 bytes.
+         *  @param  __size  Size of the image in bytes, see data_size().
+         *  @throw  serialization_error  If the memory is not a valid image.
+         */
+        static frozen_radix_map view(const void *__data, size_t __size) {
+            return frozen_radix_map(std::shared_ptr<const void>(__data, [](const void *) {}), __data, __size);
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+        /**
+         *  @brief  Maps an image file written by write() into memory, read-only
+         *  and shared, so processes opening the same file share the pages.
+         *  @throw  std::system_error  If the file cannot be opened or mapped.
+         *  @throw  serialization_error  If the file is not a valid image.
+         *
+         *  Nothing is read up front, pages are faulted in by the lookups.
+         */
+        static frozen_radix_map open(const char *__path) {
+            const int fd = ::open(__path, O_RDONLY);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), __path);
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), __path);
+            }
+            const size_t size = static_cast<size_t>(st.st_size);
+            void *data = size == 0 ? MAP_FAILED : ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                if (size == 0)
+                    throw serialization_error("art: not a frozen_radix_map image");
+                throw std::system_error(error, std::generic_category(), __path);
+            }
+
+            std::shared_ptr<const void> mapping(data, [size](const void *p) {
+                ::munmap(const_cast<void *>(p), size);
+            });
+            return frozen_radix_map(std::move(mapping), data, size);
+        }
+
+        /**
+         *  @brief  Builds the image of all elements of a radix_map directly
+         *  in a new shared memory object, without a copy on the heap.
+         *  @param  __name  Name of the object, see shared_memory.
+         *  @throw  std::system_error  If the object exists or cannot be created.
+         *
+         *  Other processes map the image with open_shared() and share its
+         *  pages: nodes refer to each other by offsets, so the image works
+         *  at any address. The object stays until remove_shared().
+         */
+        template<bool _Order_statistics, typename _Aggregate>
+        static frozen_radix_map create_shared(const std::string &__name,
+                                              const radix_map<_Key, _T, _Key_transform, _Order_statistics, _Aggregate> &__x) {
+            auto memory = std::make_shared<shared_memory>(shared_memory::create(__name, 0));
+            frozen_radix_map map;
+            try {
+                shared_words buffer(*memory);
+                map.build_image(buffer, __x.begin(), __x.end(), __x.size());
+                memory->resize(buffer.size() * sizeof(uint64_t));
+            } catch (...) {
+                shared_memory::remove(__name);
+                throw;
+            }
+            map.attach(memory, memory->data(), memory->size());
+            return map;
+        }
+
+        /**
+         *  @brief  Maps an image created by create_shared() in another (or
+         *  this) process, read-only.
+         *  @throw  std::system_error  If there is no such object.
+         *  @throw  serialization_error  If the object is not a valid image.
+         */
+        static frozen_radix_map open_shared(const std::string &__name) {
+            auto memory = std::make_shared<shared_memory>(shared_memory::open(__name));
+            if (memory->size() == 0)
+                throw serialization_error("art: not a frozen_radix_map image");
+            return frozen_radix_map(memory, memory->data(), memory->size());
+        }
+
+        /**
+         *  @brief  Removes the shared memory object of an image, mappings
+         *  stay valid until the maps using them are gone.
+         *  @return  false if there was no object of that name.
+         */
+        static bool remove_shared(const std::string &__name) {
+            return shared_memory::remove(__name);
+        }
+
+#endif
+
+        /**
+         *  @brief  Writes the image, byte for byte, e.g. to a file for open().
+         */
+        void write(std::ostream &__os) const {
+            __os.write(_M_data, data_size());
+            if (!__os)
+                throw serialization_error("art: writing the stream failed");
+        }
+
+        /**
+         * Returns the start of the image.
+         */
+        const void *data() const noexcept {
+            return _M_data;
+        }
+
+        /**
+         * Returns the size of the image in bytes.
+         */
+        size_t data_size() const noexcept {
+            return _M_header->size;
+        }
+
+        // Capacity
+
+        bool empty() const noexcept {
+            return _M_header->count == 0;
+        }
+
+        size_type size() const noexcept {
+            return _M_header->count;
+        }
+
+        // Iterators
+
+        const_iterator begin() const noexcept {
+            return _M_leaves;
+        }
+
+        const_iterator end() const noexcept {
+            return _M_leaves + _M_header->count;
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        const_reverse_iterator rbegin() const noexcept {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const noexcept {
+            return const_reverse_iterator(begin());
+        }
+
+        // Lookup
+
+        /**
+         *  @brief Tries to locate an element in a map.
+         *  @param  __k  Key of (key, value) pair to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not found.
+         */
+        const_iterator find(const key_type &__k) const {
+            uint64_t ref = _M_header->root;
+            if (ref == EMPTY)
+                return end();
+
+            const Key key = transformed(__k);
+            while (!is_leaf(ref)) {
+                const _Node *n = node_at(ref);
+                ref = child(n, key.chunks[n->depth]);
+                if (ref == EMPTY)
+                    return end();
+            }
+
+            const Key leaf_key = transformed(leaf_at(ref)->first);
+            return std::memcmp(key.chunks, leaf_key.chunks, sizeof(Key)) == 0 ? leaf_at(ref) : end();
+        }
+
+        size_type count(const key_type &__k) const {
+            return find(__k) == end() ? 0 : 1;
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        const mapped_type &at(const key_type &__k) const {
+            const_iterator it = find(__k);
+            if (it == end())
+                std::__throw_out_of_range("frozen_radix_map::at");
+            return it->second;
+        }
+
+        /**
+         *  @brief Finds the beginning of a subsequence matching given key.
+         *  @return  Iterator pointing to first element not less than key (transformed), or end().
+         */
+        const_iterator lower_bound(const key_type &__k) const {
+            return _M_leaves + lower_bound_index(transformed(__k));
+        }
+
+        /**
+         *  @brief Finds the end of a subsequence matching given key.
+         *  @return  Iterator pointing to the first element greater than key (transformed), or end().
+         */
+        const_iterator upper_bound(const key_type &__k) const {
+            const Key key = transformed(__k);
+            const_iterator it = _M_leaves + lower_bound_index(key);
+            if (it != end()) {
+                const Key found = transformed(it->first);
+                if (std::memcmp(key.chunks, found.chunks, sizeof(Key)) == 0)
+                    ++it;
+            }
+            return it;
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &__k) const {
+            return std::make_pair(lower_bound(__k), upper_bound(__k));
+        }
+    };
+}
+
+#endif //ART_FROZEN_RADIX_MAP_H
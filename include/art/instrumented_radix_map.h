@@ -0,0 +1,332 @@
+#ifndef ART_INSTRUMENTED_RADIX_MAP_H
+#define ART_INSTRUMENTED_RADIX_MAP_H
+
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stddef.h>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include "latency_histogram.h"
+
+namespace art {
+    /**
+     * @brief The operations an instrumented_radix_map times.
+     */
+    enum class timed_operation : unsigned {
+        find, insert, erase, lower_bound,
+        // one increment or decrement of an iterator
+        iteration,
+        _end
+    };
+
+    /**
+     * @brief A radix_map or radix_set that records the latency of its
+     * operations in one latency_histogram per timed_operation.
+     *
+     * Only every sample_interval-th call of an operation is timed, with
+     * std::chrono::steady_clock (clock_gettime(CLOCK_MONOTONIC) on Linux,
+     * served from the vDSO). The other calls cost a decrement and a branch,
+     * so with the default interval of 64 lookups in maps larger than the
+     * caches slow down by less than 2%; in small, cached maps the fixed
+     * cost of a nanosecond or two is a larger share. An interval of 1 times
+     * every call, which also keeps the processor from overlapping the cache
+     * misses of consecutive calls. Latencies are in nanoseconds and include
+     * the clock read itself.
+     *
+     * Operations without a histogram are available on map(). Since even
+     * const operations record, unlike the underlying map an instrumented
+     * map must not be read from several threads at once.
+     *
+     * @tparam _Map  radix_map or radix_set
+     */
+    template<typename _Map>
+    class instrumented_radix_map {
+        typedef std::chrono::steady_clock clock;
+        static const size_t OPERATIONS = static_cast<size_t>(timed_operation::_end);
+
+    public:
+        typedef _Map map_type;
+        typedef typename _Map::key_type key_type;
+        typedef typename _Map::value_type value_type;
+        typedef typename _Map::size_type size_type;
+
+        /**
+         * @brief Iterator of the underlying map whose steps are timed as
+         * timed_operation::iteration.
+         */
+        template<typename _Base>
+        class instrumented_iterator {
+            _Base _M_it;
+            const instrumented_radix_map *_M_owner;
+
+        public:
+            typedef typename std::iterator_traits<_Base>::iterator_category iterator_category;
+            typedef typename std::iterator_traits<_Base>::value_type value_type;
+            typedef typename std::iterator_traits<_Base>::difference_type difference_type;
+            typedef typename std::iterator_traits<_Base>::pointer pointer;
+            typedef typename std::iterator_traits<_Base>::reference reference;
+
+            instrumented_iterator() : _M_it(), _M_owner(nullptr) {}
+
+            instrumented_iterator(_Base __it, const instrumented_radix_map *__owner)
+                    : _M_it(__it), _M_owner(__owner) {}
+
+            // iterator to const_iterator
+            template<typename _Other>
+            instrumented_iterator(const instrumented_iterator<_Other> &__x)
+                    : _M_it(__x.base()), _M_owner(__x.owner()) {}
+
+            reference operator*() const {
+                return *_M_it;
+            }
+
+            pointer operator->() const {
+                return std::addressof(*_M_it);
+            }
+
+            instrumented_iterator &operator++() {
+                _M_owner->timed(timed_operation::iteration, [this]() { ++_M_it; });
+                return *this;
+            }
+
+            instrumented_iterator operator++(int) {
+                instrumented_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            instrumented_iterator &operator--() {
+                _M_owner->timed(timed_operation::iteration, [this]() { --_M_it; });
+                return *this;
+            }
+
+            instrumented_iterator operator--(int) {
+                instrumented_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            bool operator==(const instrumented_iterator &__x) const {
+                return _M_it == __x._M_it;
+            }
+
+            bool operator!=(const instrumented_iterator &__x) const {
+                return _M_it != __x._M_it;
+            }
+
+            /**
+             * Returns the iterator of the underlying map.
+             */
+            const _Base &base() const {
+                return _M_it;
+            }
+
+            const instrumented_radix_map *owner() const {
+                return _M_owner;
+            }
+        };
+
+        typedef instrumented_iterator<typename _Map::iterator> iterator;
+        typedef instrumented_iterator<typename _Map::const_iterator> const_iterator;
+
+    private:
+        _Map _M_map;
+        uint32_t _M_sample_interval;
+        mutable uint32_t _M_countdown[OPERATIONS];
+        mutable latency_histogram _M_latency[OPERATIONS];
+
+        /**
+         * Runs @a __f and, if this call of @a __op is sampled, records its latency.
+         */
+        template<typename _F>
+        auto timed(timed_operation __op, _F __f) const -> decltype(__f()) {
+            const size_t i = static_cast<size_t>(__op);
+            if (--_M_countdown[i] != 0)
+                return __f();
+            _M_countdown[i] = _M_sample_interval;
+            return timed_call(_M_latency[i], __f, std::is_void<decltype(__f())>());
+        }
+
+        template<typename _F>
+        static auto timed_call(latency_histogram &__h, _F &__f, std::false_type) -> decltype(__f()) {
+            const clock::time_point start = clock::now();
+            auto result = __f();
+            record(__h, start);
+            return result;
+        }
+
+        template<typename _F>
+        static void timed_call(latency_histogram &__h, _F &__f, std::true_type) {
+            const clock::time_point start = clock::now();
+            __f();
+            record(__h, start);
+        }
+
+        static void record(latency_histogram &__h, clock::time_point __start) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - __start);
+            __h.record(static_cast<uint64_t>(elapsed.count()));
+        }
+
+    public:
+        /**
+         * @brief Creates an empty map.
+         * @param __sample_interval  Time every n-th call of each operation, at least 1.
+         * @throw  std::invalid_argument  If @a __sample_interval is 0.
+         */
+        explicit instrumented_radix_map(uint32_t __sample_interval = 64) {
+            set_sample_interval(__sample_interval);
+        }
+
+        /**
+         * @brief Creates a map with the elements of @a __map.
+         */
+        explicit instrumented_radix_map(_Map __map, uint32_t __sample_interval = 64)
+                : _M_map(std::move(__map)) {
+            set_sample_interval(__sample_interval);
+        }
+
+        /**
+         * @brief Changes the sampling, the next call of each operation is timed.
+         * @throw  std::invalid_argument  If @a __sample_interval is 0.
+         */
+        void set_sample_interval(uint32_t __sample_interval) {
+            if (__sample_interval == 0)
+                throw std::invalid_argument("instrumented_radix_map: sample interval must be at least 1");
+            _M_sample_interval = __sample_interval;
+            for (size_t i = 0; i < OPERATIONS; i++)
+                _M_countdown[i] = 1;
+        }
+
+        uint32_t sample_interval() const noexcept {
+            return _M_sample_interval;
+        }
+
+        /**
+         * Returns the latencies of the sampled calls of @a __op.
+         */
+        const latency_histogram &latency(timed_operation __op) const {
+            return _M_latency[static_cast<size_t>(__op)];
+        }
+
+        /**
+         * Forgets all recorded latencies.
+         */
+        void reset_latency() {
+            for (size_t i = 0; i < OPERATIONS; i++)
+                _M_latency[i].reset();
+        }
+
+        /**
+         * Returns the name of an operation, e.g. for exporting latencies as metrics.
+         */
+        static const char *name(timed_operation __op) {
+            static const char *const names[OPERATIONS] = {
+                    "find", "insert", "erase", "lower_bound", "iteration"
+            };
+            return names[static_cast<size_t>(__op)];
+        }
+
+        /**
+         * @brief Writes one line per operation with the number of samples and
+         * the 50th, 99th and 99.9th percentile and the maximum in nanoseconds,
+         * e.g. "find samples=1024 p50=48 p99=211 p999=1343 max=5021".
+         */
+        void report(std::ostream &__os) const {
+            for (size_t i = 0; i < OPERATIONS; i++) {
+                const latency_histogram &h = _M_latency[i];
+                __os << name(static_cast<timed_operation>(i)) << " samples=" << h.count()
+                     << " p50=" << h.percentile(50) << " p99=" << h.percentile(99)
+                     << " p999=" << h.percentile(99.9) << " max=" << h.max() << '\n';
+            }
+        }
+
+        /**
+         * Returns the underlying map, operations on it are not timed.
+         */
+        _Map &map() noexcept {
+            return _M_map;
+        }
+
+        const _Map &map() const noexcept {
+            return _M_map;
+        }
+
+        // Capacity
+
+        bool empty() const noexcept {
+            return _M_map.empty();
+        }
+
+        size_type size() const noexcept {
+            return _M_map.size();
+        }
+
+        // Modifiers
+
+        std::pair<iterator, bool> insert(const value_type &__x) {
+            std::pair<typename _Map::iterator, bool> result =
+                    timed(timed_operation::insert, [this, &__x]() { return _M_map.insert(__x); });
+            return std::make_pair(iterator(result.first, this), result.second);
+        }
+
+        size_type erase(const key_type &__k) {
+            return timed(timed_operation::erase, [this, &__k]() { return _M_map.erase(__k); });
+        }
+
+        iterator erase(iterator __position) {
+            return iterator(timed(timed_operation::erase, [this, &__position]() {
+                return _M_map.erase(__position.base());
+            }), this);
+        }
+
+        void clear() {
+            _M_map.clear();
+        }
+
+        // Lookup
+
+        iterator find(const key_type &__k) {
+            return iterator(timed(timed_operation::find, [this, &__k]() { return _M_map.find(__k); }), this);
+        }
+
+        const_iterator find(const key_type &__k) const {
+            return const_iterator(timed(timed_operation::find, [this, &__k]() { return _M_map.find(__k); }), this);
+        }
+
+        iterator lower_bound(const key_type &__k) {
+            return iterator(timed(timed_operation::lower_bound, [this, &__k]() {
+                return _M_map.lower_bound(__k);
+            }), this);
+        }
+
+        const_iterator lower_bound(const key_type &__k) const {
+            return const_iterator(timed(timed_operation::lower_bound, [this, &__k]() {
+                return _M_map.lower_bound(__k);
+            }), this);
+        }
+
+        // Iterators
+
+        iterator begin() noexcept {
+            return iterator(_M_map.begin(), this);
+        }
+
+        const_iterator begin() const noexcept {
+            return const_iterator(_M_map.begin(), this);
+        }
+
+        iterator end() noexcept {
+            return iterator(_M_map.end(), this);
+        }
+
+        const_iterator end() const noexcept {
+            return const_iterator(_M_map.end(), this);
+        }
+    };
+}
+
+#endif //ART_INSTRUMENTED_RADIX_MAP_H
@@ -0,0 +1,110 @@
+#ifndef ART_KEY_REGION_H
+#define ART_KEY_REGION_H
+
+#include <algorithm>
+#include <bitset>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+    namespace detail {
+        /**
+         * @brief A part of the transformed key space below an inner node, as
+         * reported by collect_changes() of the trees.
+         *
+         * The region holds all keys starting with the first slot_length bytes
+         * of the prefix (the position of the node in its parent), except the
+         * keys continuing all prefix_length bytes with a byte in keep. Those
+         * belong to inner children that are reported separately or were not
+         * modified.
+         */
+        struct key_region {
+            const uint8_t *prefix;
+            size_t slot_length;
+            size_t prefix_length;
+            std::bitset<256> keep;
+
+            /**
+             * @brief Calls f(lo, hi) for the maximal ranges [lo, hi) of key_size
+             * byte keys that make up the region, hi is nullptr if unbounded.
+             */
+            template<typename _Function>
+            void for_each_range(size_t key_size, _Function f) const {
+                std::vector<uint8_t> lo, hi;
+                bool open = false;
+                bool bounded = true;
+
+                // appends [from, to), joining it with the previous range if they touch
+                auto add = [&](const std::vector<uint8_t> &from, const std::vector<uint8_t> &to, bool to_bounded) {
+                    if (to_bounded && from == to)
+                        return;
+                    if (!open || !bounded || hi != from) {
+                        if (open)
+                            f(lo.data(), bounded ? hi.data() : nullptr);
+                        lo = from;
+                        open = true;
+                    }
+                    hi = to;
+                    bounded = to_bounded;
+                };
+
+                std::vector<uint8_t> slot_end;
+                const bool slot_bounded = successor(slot_length, key_size, slot_end);
+                std::vector<uint8_t> prefix_end;
+                const bool prefix_bounded = successor(prefix_length, key_size, prefix_end);
+
+                add(padded(slot_length, key_size), padded(prefix_length, key_size), true);
+                for (unsigned b = 0; b < 256;) {
+                    if (keep.test(b)) {
+                        b++;
+                        continue;
+                    }
+                    const unsigned first = b;
+                    while (b < 256 && !keep.test(b))
+                        b++;
+
+                    std::vector<uint8_t> from = padded(prefix_length, key_size);
+                    from[prefix_length] = static_cast<uint8_t>(first);
+                    if (b < 256) {
+                        std::vector<uint8_t> to = padded(prefix_length, key_size);
+                        to[prefix_length] = static_cast<uint8_t>(b);
+                        add(from, to, true);
+                    } else {
+                        add(from, prefix_end, prefix_bounded);
+                    }
+                }
+                if (prefix_bounded)
+                    add(prefix_end, slot_end, slot_bounded);
+
+                if (open)
+                    f(lo.data(), bounded ? hi.data() : nullptr);
+            }
+
+        private:
+            /**
+             * The first length prefix bytes followed by zeros.
+             */
+            std::vector<uint8_t> padded(size_t length, size_t key_size) const {
+                std::vector<uint8_t> key(key_size, 0);
+                std::copy(prefix, prefix + length, key.begin());
+                return key;
+            }
+
+            /**
+             * @brief The smallest key after all keys starting with the first length prefix bytes.
+             * @return false if there is none.
+             */
+            bool successor(size_t length, size_t key_size, std::vector<uint8_t> &key) const {
+                key = padded(length, key_size);
+                for (size_t i = length; i > 0; i--) {
+                    if (++key[i - 1] != 0)
+                        return true;
+                }
+                return false;
+            }
+        };
+    }
+}
+
+#endif //ART_KEY_REGION_H
@@ -125,7 +125,7 @@ namespace art {
     public:
         key_transform() : first(), second() {}
 
-        transformed_type operator()(const std::pair<T1, T2> &key) {
+        transformed_type operator()(const std::pair<T1, T2> &key) const {
             transformed_type transformed_key;
             auto transformed1 = first(key.first);
             auto transformed2 = second(key.second);
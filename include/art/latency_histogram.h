@@ -0,0 +1,176 @@
+#ifndef ART_LATENCY_HISTOGRAM_H
+#define ART_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+    /**
+     * @brief A histogram of non-negative integer values (e.g. latencies in
+     * nanoseconds) with log-scaled buckets, after HdrHistogram.
+     *
+     * Values below 2^precision_bits get a bucket each. Above, every power of
+     * two range is split into 2^precision_bits buckets of equal width, so
+     * a value is known up to a relative error of 2^-precision_bits. The
+     * buckets cover all uint64_t values, recording is a few shifts and an
+     * increment.
+     */
+    class latency_histogram {
+        unsigned _M_precision_bits;
+        std::vector<uint64_t> _M_buckets;
+        uint64_t _M_count;
+        uint64_t _M_min;
+        uint64_t _M_max;
+        double _M_sum;
+
+        static unsigned log2(uint64_t __v) {
+            unsigned result = 0;
+            for (unsigned shift = 32; shift > 0; shift /= 2) {
+                if (__v >> shift) {
+                    __v >>= shift;
+                    result += shift;
+                }
+            }
+            return result;
+        }
+
+        size_t bucket(uint64_t __v) const {
+            const unsigned p = _M_precision_bits;
+            if (__v < (uint64_t(1) << p))
+                return static_cast<size_t>(__v);
+            const unsigned shift = log2(__v) - p;
+            return (size_t(shift) + 1) << p | static_cast<size_t>((__v >> shift) & ((uint64_t(1) << p) - 1));
+        }
+
+        /**
+         * Returns the largest value that falls into bucket @a __b.
+         */
+        uint64_t highest_value(size_t __b) const {
+            const unsigned p = _M_precision_bits;
+            if (__b < (size_t(1) << p))
+                return __b;
+            const unsigned shift = static_cast<unsigned>((__b >> p) - 1);
+            const uint64_t first = (uint64_t(1) << p | (__b & ((size_t(1) << p) - 1))) << shift;
+            return first + ((uint64_t(1) << shift) - 1);
+        }
+
+    public:
+        /**
+         * @brief Creates an empty histogram.
+         * @param __precision_bits  Buckets per power of two as a power of two, 1 to 16.
+         */
+        explicit latency_histogram(unsigned __precision_bits = 5)
+                : _M_precision_bits(__precision_bits), _M_count(0),
+                  _M_min(std::numeric_limits<uint64_t>::max()), _M_max(0), _M_sum(0) {
+            if (__precision_bits < 1 || __precision_bits > 16)
+                throw std::invalid_argument("latency_histogram: precision_bits must be 1 to 16");
+            _M_buckets.assign((size_t(64 - __precision_bits) + 1) << __precision_bits, 0);
+        }
+
+        /**
+         * Records one occurrence of @a __v.
+         */
+        void record(uint64_t __v) {
+            _M_buckets[bucket(__v)]++;
+            _M_count++;
+            _M_min = std::min(_M_min, __v);
+            _M_max = std::max(_M_max, __v);
+            _M_sum += static_cast<double>(__v);
+        }
+
+        /**
+         * @brief Returns the value below or at which @a __percentile percent
+         * of the recorded values lie, up to the precision of the buckets.
+         * @param __percentile  0 to 100, e.g. 99.9. 0 gives min(), 100 max().
+         *
+         * Returns 0 if nothing was recorded.
+         */
+        uint64_t percentile(double __percentile) const {
+            if (_M_count == 0)
+                return 0;
+            if (__percentile <= 0)
+                return _M_min;
+            if (__percentile >= 100)
+                return _M_max;
+
+            // the rank of the value, rounded up
+            uint64_t rank = static_cast<uint64_t>(__percentile / 100 * static_cast<double>(_M_count));
+            if (static_cast<double>(rank) < __percentile / 100 * static_cast<double>(_M_count))
+                rank++;
+            rank = std::max<uint64_t>(rank, 1);
+
+            uint64_t seen = 0;
+            for (size_t b = 0; b < _M_buckets.size(); b++) {
+                seen += _M_buckets[b];
+                if (seen >= rank)
+                    return std::min(highest_value(b), _M_max);
+            }
+            return _M_max;
+        }
+
+        /**
+         * @brief Adds the counts of another histogram.
+         * @throw  std::invalid_argument  If the precisions differ.
+         */
+        latency_histogram &operator+=(const latency_histogram &__x) {
+            if (__x._M_precision_bits != _M_precision_bits)
+                throw std::invalid_argument("latency_histogram: merging histograms of different precision");
+            for (size_t b = 0; b < _M_buckets.size(); b++)
+                _M_buckets[b] += __x._M_buckets[b];
+            _M_count += __x._M_count;
+            _M_min = std::min(_M_min, __x._M_min);
+            _M_max = std::max(_M_max, __x._M_max);
+            _M_sum += __x._M_sum;
+            return *this;
+        }
+
+        /**
+         * Forgets all recorded values.
+         */
+        void reset() {
+            std::fill(_M_buckets.begin(), _M_buckets.end(), 0);
+            _M_count = 0;
+            _M_min = std::numeric_limits<uint64_t>::max();
+            _M_max = 0;
+            _M_sum = 0;
+        }
+
+        /**
+         * Returns the number of recorded values.
+         */
+        uint64_t count() const noexcept {
+            return _M_count;
+        }
+
+        /**
+         * Returns the smallest recorded value, 0 if there is none.
+         */
+        uint64_t min() const noexcept {
+            return _M_count == 0 ? 0 : _M_min;
+        }
+
+        /**
+         * Returns the largest recorded value, 0 if there is none.
+         */
+        uint64_t max() const noexcept {
+            return _M_max;
+        }
+
+        /**
+         * Returns the exact mean of the recorded values, 0 if there are none.
+         */
+        double mean() const noexcept {
+            return _M_count == 0 ? 0.0 : _M_sum / static_cast<double>(_M_count);
+        }
+
+        unsigned precision_bits() const noexcept {
+            return _M_precision_bits;
+        }
+    };
+}
+
+#endif //ART_LATENCY_HISTOGRAM_H
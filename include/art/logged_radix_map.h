@@ -0,0 +1,766 @@
+#ifndef ART_LOGGED_RADIX_MAP_H
+#define ART_LOGGED_RADIX_MAP_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "radix_map.h"
+#include "serialization.h"
+
+namespace art {
+    /**
+     * @brief Group commit settings of a logged_radix_map.
+     */
+    struct log_options {
+        /**
+         * Longest time a logged modification waits for its fsync: the
+         * records arriving in this window are written and synced together.
+         */
+        std::chrono::microseconds commit_latency = std::chrono::milliseconds(2);
+
+        /**
+         * Pending bytes that trigger a commit before the latency budget is used up.
+         */
+        size_t group_bytes = 1 << 20;
+
+        /**
+         * The log file is allocated in steps of this many bytes, so commits
+         * within a step do not change its size.
+         */
+        size_t preallocate = 64 << 20;
+    };
+
+    namespace detail {
+        /*
+         * Operation log: the header of write_header() with LOG_MAGIC, then
+         * records of
+         *   uint8   kind (log_record)
+         *   key     raw bytes, components of pairs one after the other
+         *   mapped  raw bytes, insert and assign only
+         *   uint32  CRC-32C of the record so far, continuing the CRC of the
+         *           previous record (of the header for the first one)
+         *
+         * The preallocated rest of the file is zero. Replay stops at the first
+         * record that is torn or does not continue the chain, which also
+         * rules out stale records behind a torn one.
+         */
+        const char LOG_MAGIC[4] = {'A', 'R', 'T', '\2'};
+
+        enum class log_record : uint8_t {
+            insert = 1, assign = 2, erase = 3, clear = 4
+        };
+
+        /**
+         * @brief CRC-32C (Castagnoli) of a byte range, continuing @a crc.
+         */
+        inline uint32_t crc32c(uint32_t crc, const void *data, size_t size) {
+            struct table_type {
+                uint32_t entries[256];
+
+                table_type() {
+                    for (uint32_t i = 0; i < 256; i++) {
+                        uint32_t x = i;
+                        for (int bit = 0; bit < 8; bit++)
+                            x = (x >> 1) ^ (0x82F63B78u & (0u - (x & 1)));
+                        entries[i] = x;
+                    }
+                }
+            };
+            static const table_type table;
+
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++)
+                crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        /**
+         * @brief Copies objects from and to the raw bytes of log records,
+         * pairs component by component like raw_codec.
+         */
+        template<typename _Tp>
+        struct log_codec {
+            static_assert(std::is_trivially_copyable<_Tp>::value,
+                          "logging requires trivially copyable keys and values (or pairs of them)");
+
+            static const size_t size = sizeof(_Tp);
+
+            static void put(char *out, const _Tp &x) {
+                std::memcpy(out, &x, sizeof(_Tp));
+            }
+
+            static void get(const char *in, _Tp &x) {
+                std::memcpy(&x, in, sizeof(_Tp));
+            }
+        };
+
+        template<typename _T1, typename _T2>
+        struct log_codec<std::pair<_T1, _T2> > {
+            static const size_t size = log_codec<_T1>::size + log_codec<_T2>::size;
+
+            static void put(char *out, const std::pair<_T1, _T2> &x) {
+                log_codec<_T1>::put(out, x.first);
+                log_codec<_T2>::put(out + log_codec<_T1>::size, x.second);
+            }
+
+            static void get(const char *in, std::pair<_T1, _T2> &x) {
+                log_codec<_T1>::get(in, x.first);
+                log_codec<_T2>::get(in + log_codec<_T1>::size, x.second);
+            }
+        };
+    }
+
+    /**
+     * @brief A radix_map whose modifications are appended to an operation
+     * log file and recovered from it on open.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *
+     * Keys and mapped values have to be trivially copyable (or pairs of such
+     * types). Modifications are applied in memory and return right away, a
+     * background thread writes and fsyncs their records in groups (see
+     * log_options): a modification is durable at most commit_latency after
+     * it returned, or once sync() returned. Effective modifications are
+     * logged only, an insert of an existing key writes nothing.
+     *
+     * snapshot() saves the map next to the log and empties the log, so
+     * recovery replays only what came after. Lookups and iteration go to
+     * the map in memory. Modifications must come from one thread at a time.
+     */
+    template<typename _Key, typename _T, typename _Key_transform = key_transform<_Key> >
+    class logged_radix_map {
+
+    public:
+        typedef radix_map<_Key, _T, _Key_transform> map_type;
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef typename map_type::value_type value_type;
+        typedef typename map_type::size_type size_type;
+        typedef typename map_type::const_iterator const_iterator;
+
+    private:
+        typedef detail::log_codec<key_type> _Key_codec;
+        typedef detail::log_codec<mapped_type> _Mapped_codec;
+        typedef std::chrono::steady_clock _Clock;
+
+        static const size_t CHECKSUM_SIZE = sizeof(uint32_t);
+
+        map_type _M_map;
+        const std::string _M_path;
+        const std::string _M_snapshot_path;
+        const log_options _M_options;
+        int _M_fd;
+
+        // header bytes, the CRC of the header seeds the record chain
+        std::string _M_header;
+
+        // owned by the modifying thread
+        uint32_t _M_crc;
+
+        // owned by the flusher while it writes
+        uint64_t _M_offset;
+        uint64_t _M_allocated;
+
+        mutable std::mutex _M_mutex;
+        std::condition_variable _M_work;
+        std::condition_variable _M_durable_changed;
+        std::vector<char> _M_pending;
+        _Clock::time_point _M_first_pending;
+        uint64_t _M_appended;
+        uint64_t _M_durable;
+        uint64_t _M_commits;
+        bool _M_sync_requested;
+        bool _M_stop;
+        std::exception_ptr _M_error;
+        std::thread _M_flusher;
+
+        static size_t record_size(detail::log_record __kind) {
+            switch (__kind) {
+                case detail::log_record::insert:
+                case detail::log_record::assign:
+                    return 1 + _Key_codec::size + _Mapped_codec::size + CHECKSUM_SIZE;
+                case detail::log_record::erase:
+                    return 1 + _Key_codec::size + CHECKSUM_SIZE;
+                case detail::log_record::clear:
+                    return 1 + CHECKSUM_SIZE;
+            }
+            return 0;
+        }
+
+        static void put_checksum(char *__out, uint32_t __crc) {
+            for (size_t i = 0; i < CHECKSUM_SIZE; i++)
+                __out[i] = static_cast<char>((__crc >> (8 * i)) & 0xFF);
+        }
+
+        static uint32_t get_checksum(const char *__in) {
+            uint32_t crc = 0;
+            for (size_t i = 0; i < CHECKSUM_SIZE; i++)
+                crc |= static_cast<uint32_t>(static_cast<unsigned char>(__in[i])) << (8 * i);
+            return crc;
+        }
+
+        static std::string directory_of(const std::string &__path) {
+            const size_t slash = __path.rfind('/');
+            if (slash == std::string::npos)
+                return ".";
+            return slash == 0 ? "/" : __path.substr(0, slash);
+        }
+
+        /**
+         * Makes a new or renamed directory entry of @a __path durable.
+         */
+        static void sync_directory(const std::string &__path) {
+            const std::string dir = directory_of(__path);
+            const int fd = ::open(dir.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), dir);
+            const int result = ::fsync(fd);
+            const int error = errno;
+            ::close(fd);
+            if (result != 0)
+                throw std::system_error(error, std::generic_category(), dir);
+        }
+
+        void sync_file() {
+#if defined(__linux__)
+            // the preallocated size rarely changes, the data is what matters
+            const int result = ::fdatasync(_M_fd);
+#else
+            const int result = ::fsync(_M_fd);
+#endif
+            if (result != 0)
+                throw std::system_error(errno, std::generic_category(), "logged_radix_map: fsync");
+        }
+
+        /**
+         * Grows the file to hold at least @a __size bytes, in steps of preallocate.
+         */
+        void reserve(uint64_t __size) {
+            if (__size <= _M_allocated)
+                return;
+            const uint64_t step = std::max<uint64_t>(_M_options.preallocate, 1);
+            const uint64_t target = _M_allocated + (__size - _M_allocated + step - 1) / step * step;
+#if defined(__linux__)
+            const int error = ::posix_fallocate(_M_fd, static_cast<off_t>(_M_allocated),
+                                                static_cast<off_t>(target - _M_allocated));
+            if (error != 0)
+                throw std::system_error(error, std::generic_category(), "logged_radix_map: posix_fallocate");
+#else
+            if (::ftruncate(_M_fd, static_cast<off_t>(target)) != 0)
+                throw std::system_error(errno, std::generic_category(), "logged_radix_map: ftruncate");
+#endif
+            _M_allocated = target;
+        }
+
+        void write_at(const char *__data, size_t __size, uint64_t __offset) {
+            size_t done = 0;
+            while (done < __size) {
+                const ssize_t n = ::pwrite(_M_fd, __data + done, __size - done,
+                                           static_cast<off_t>(__offset + done));
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "logged_radix_map: pwrite");
+                }
+                done += static_cast<size_t>(n);
+            }
+        }
+
+        /**
+         * Reads up to @a __size bytes, fewer only at the end of the file.
+         */
+        size_t read_at(char *__data, size_t __size, uint64_t __offset) {
+            size_t done = 0;
+            while (done < __size) {
+                const ssize_t n = ::pread(_M_fd, __data + done, __size - done,
+                                          static_cast<off_t>(__offset + done));
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "logged_radix_map: pread");
+                }
+                if (n == 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+            return done;
+        }
+
+        /**
+         * Truncates the log to a fresh header and preallocates the first step.
+         */
+        void reset_log() {
+            if (::ftruncate(_M_fd, 0) != 0)
+                throw std::system_error(errno, std::generic_category(), "logged_radix_map: ftruncate");
+            _M_allocated = 0;
+            reserve(_M_header.size());
+            write_at(_M_header.data(), _M_header.size(), 0);
+            if (::fsync(_M_fd) != 0)
+                throw std::system_error(errno, std::generic_category(), "logged_radix_map: fsync");
+            _M_offset = _M_header.size();
+            _M_crc = detail::crc32c(0, _M_header.data(), _M_header.size());
+        }
+
+        void apply(detail::log_record __kind, const char *__data) {
+            key_type key;
+            mapped_type obj;
+            switch (__kind) {
+                case detail::log_record::insert:
+                case detail::log_record::assign: {
+                    // both replay as assignments, so a log replayed over a
+                    // newer snapshot still ends in the logged state
+                    _Key_codec::get(__data, key);
+                    _Mapped_codec::get(__data + _Key_codec::size, obj);
+                    auto res = _M_map.insert(value_type(key, obj));
+                    if (!res.second)
+                        res.first->second = obj;
+                    break;
+                }
+                case detail::log_record::erase:
+                    _Key_codec::get(__data, key);
+                    _M_map.erase(key);
+                    break;
+                case detail::log_record::clear:
+                    _M_map.clear();
+                    break;
+            }
+        }
+
+        /**
+         * Applies the valid records of the log, the next record goes after them.
+         */
+        void replay(uint64_t __file_size) {
+            static const size_t CHUNK_SIZE = 1 << 20;
+
+            std::vector<char> buffer;
+            size_t pos = 0;
+            uint64_t read_offset = _M_header.size();
+            // makes at least __n unparsed bytes available
+            auto available = [&](size_t __n) -> bool {
+                while (buffer.size() - pos < __n) {
+                    if (read_offset >= __file_size)
+                        return false;
+                    buffer.erase(buffer.begin(), buffer.begin() + pos);
+                    pos = 0;
+                    const size_t old_size = buffer.size();
+                    buffer.resize(old_size + static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, __file_size - read_offset)));
+                    const size_t n = read_at(buffer.data() + old_size, buffer.size() - old_size, read_offset);
+                    buffer.resize(old_size + n);
+                    read_offset = n == 0 ? __file_size : read_offset + n;
+                }
+                return true;
+            };
+
+            uint64_t offset = _M_header.size();
+            while (available(1)) {
+                const detail::log_record kind = static_cast<detail::log_record>(buffer[pos]);
+                const size_t size = record_size(kind);
+                if (size == 0 || !available(size))
+                    break;
+                const uint32_t crc = detail::crc32c(_M_crc, buffer.data() + pos, size - CHECKSUM_SIZE);
+                if (crc != get_checksum(buffer.data() + pos + size - CHECKSUM_SIZE))
+                    break;
+                apply(kind, buffer.data() + pos + 1);
+                _M_crc = crc;
+                pos += size;
+                offset += size;
+            }
+            _M_offset = offset;
+        }
+
+        void open_log() {
+            std::ostringstream header;
+            {
+                detail::stream_writer out(header);
+                detail::write_header<key_type, mapped_type>(out, detail::LOG_MAGIC);
+                out.flush();
+            }
+            _M_header = header.str();
+
+            _M_fd = ::open(_M_path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (_M_fd < 0)
+                throw std::system_error(errno, std::generic_category(), _M_path);
+            try {
+                struct stat st;
+                if (::fstat(_M_fd, &st) != 0)
+                    throw std::system_error(errno, std::generic_category(), _M_path);
+                const uint64_t file_size = static_cast<uint64_t>(st.st_size);
+                _M_allocated = file_size;
+
+                if (file_size < _M_header.size()) {
+                    // new, or the creation did not finish
+                    reset_log();
+                    sync_directory(_M_path);
+                    return;
+                }
+
+                std::string existing(_M_header.size(), '\0');
+                if (read_at(&existing[0], existing.size(), 0) != existing.size())
+                    throw serialization_error("art: unexpected end of stream");
+                std::istringstream is(existing);
+                detail::stream_reader in(is);
+                detail::read_header<key_type, mapped_type>(in, detail::LOG_MAGIC, "art: not an operation log");
+                _M_crc = detail::crc32c(0, _M_header.data(), _M_header.size());
+                replay(file_size);
+            } catch (...) {
+                ::close(_M_fd);
+                throw;
+            }
+        }
+
+        void start() {
+            if (!_M_snapshot_path.empty()) {
+                std::ifstream is(_M_snapshot_path, std::ios::binary);
+                if (is)
+                    _M_map.load(is);
+            }
+            open_log();
+            try {
+                _M_flusher = std::thread(&logged_radix_map::run_flusher, this);
+            } catch (...) {
+                ::close(_M_fd);
+                throw;
+            }
+        }
+
+        void run_flusher() {
+            std::vector<char> batch;
+            std::unique_lock<std::mutex> lock(_M_mutex);
+            for (;;) {
+                _M_work.wait(lock, [this] { return _M_stop || !_M_pending.empty(); });
+                if (_M_pending.empty())
+                    return;
+                // collect more records until the oldest one used up its budget
+                _M_work.wait_until(lock, _M_first_pending + _M_options.commit_latency, [this] {
+                    return _M_stop || _M_sync_requested || _M_pending.size() >= _M_options.group_bytes;
+                });
+                batch.swap(_M_pending);
+                _M_sync_requested = false;
+                const uint64_t target = _M_appended;
+                lock.unlock();
+
+                std::exception_ptr error;
+                try {
+                    reserve(_M_offset + batch.size());
+                    write_at(batch.data(), batch.size(), _M_offset);
+                    sync_file();
+                    _M_offset += batch.size();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                batch.clear();
+
+                lock.lock();
+                if (error) {
+                    _M_error = error;
+                    _M_durable_changed.notify_all();
+                    return;
+                }
+                _M_durable = target;
+                _M_commits++;
+                _M_durable_changed.notify_all();
+            }
+        }
+
+        /**
+         * Appends a record for the flusher, @a __obj is null for erase and clear.
+         */
+        void append(detail::log_record __kind, const key_type *__k, const mapped_type *__obj) {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            if (_M_error)
+                std::rethrow_exception(_M_error);
+
+            const size_t start = _M_pending.size();
+            _M_pending.resize(start + record_size(__kind));
+            char *out = _M_pending.data() + start;
+            out[0] = static_cast<char>(__kind);
+            if (__k != nullptr)
+                _Key_codec::put(out + 1, *__k);
+            if (__obj != nullptr)
+                _Mapped_codec::put(out + 1 + _Key_codec::size, *__obj);
+            const size_t size = _M_pending.size() - start;
+            _M_crc = detail::crc32c(_M_crc, out, size - CHECKSUM_SIZE);
+            put_checksum(out + size - CHECKSUM_SIZE, _M_crc);
+            _M_appended += size;
+
+            if (start == 0) {
+                // starts the latency budget of the group
+                _M_first_pending = _Clock::now();
+                _M_work.notify_one();
+            } else if (_M_pending.size() >= _M_options.group_bytes) {
+                _M_work.notify_one();
+            }
+        }
+
+    public:
+        /**
+         *  @brief  Opens the log at @a __path, creating it if needed, and
+         *  replays its records.
+         *  @throw  std::system_error  If the file cannot be opened or read.
+         *  @throw  serialization_error  If the file is not a log of this map type.
+         *
+         *  Replay stops at the first torn or corrupted record, new records
+         *  continue from there.
+         */
+        explicit logged_radix_map(const std::string &__path, const log_options &__options = log_options())
+                : _M_path(__path), _M_options(__options), _M_fd(-1), _M_crc(0), _M_offset(0), _M_allocated(0),
+                  _M_appended(0), _M_durable(0), _M_commits(0), _M_sync_requested(false), _M_stop(false) {
+            start();
+        }
+
+        /**
+         *  @brief  Loads the snapshot at @a __snapshot_path, if there is one,
+         *  then opens and replays the log at @a __path like above.
+         *  @throw  serialization_error  If the snapshot is not an image of
+         *          this map type.
+         *
+         *  The snapshot is an image as written by radix_map::save(), see snapshot().
+         */
+        logged_radix_map(const std::string &__path, const std::string &__snapshot_path,
+                         const log_options &__options = log_options())
+                : _M_path(__path), _M_snapshot_path(__snapshot_path), _M_options(__options), _M_fd(-1),
+                  _M_crc(0), _M_offset(0), _M_allocated(0), _M_appended(0), _M_durable(0), _M_commits(0),
+                  _M_sync_requested(false), _M_stop(false) {
+            start();
+        }
+
+        logged_radix_map(const logged_radix_map &) = delete;
+
+        logged_radix_map &operator=(const logged_radix_map &) = delete;
+
+        /**
+         *  Commits the pending records and closes the log. Write errors
+         *  cannot be reported here, call sync() before to see them.
+         */
+        ~logged_radix_map() {
+            {
+                std::lock_guard<std::mutex> lock(_M_mutex);
+                _M_stop = true;
+            }
+            _M_work.notify_one();
+            _M_flusher.join();
+            ::close(_M_fd);
+        }
+
+        // Capacity
+
+        /**
+         * Returns true if the map is empty.
+         */
+        bool empty() const noexcept {
+            return _M_map.empty();
+        }
+
+        /**
+         * Returns the size of the map.
+         */
+        size_type size() const noexcept {
+            return _M_map.size();
+        }
+
+        // Modifiers
+
+        /**
+         *  @brief Attempts to insert a std::pair into the map.
+         *  @param __x Pair to be inserted.
+         *  @return  Whether the pair was inserted, false if the key existed.
+         *  @throw  std::system_error  If an earlier commit failed, the
+         *          modification is applied in memory but not logged then.
+         */
+        bool insert(const value_type &__x) {
+            if (!_M_map.insert(__x).second)
+                return false;
+            append(detail::log_record::insert, &__x.first, &__x.second);
+            return true;
+        }
+
+        /**
+         *  @brief Inserts a std::pair or replaces the mapped value of an
+         *  existing key.
+         *  @return  Whether the pair was inserted rather than assigned.
+         */
+        bool insert_or_assign(const key_type &__k, const mapped_type &__obj) {
+            auto res = _M_map.insert(value_type(__k, __obj));
+            if (!res.second)
+                res.first->second = __obj;
+            append(res.second ? detail::log_record::insert : detail::log_record::assign, &__k, &__obj);
+            return res.second;
+        }
+
+        /**
+         *  @brief Attempts to erase the element with the given key (if it exists).
+         *  @param  __k The key to erase.
+         *  @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            if (_M_map.erase(__k) == 0)
+                return 0;
+            append(detail::log_record::erase, &__k, nullptr);
+            return 1;
+        }
+
+        /**
+         *  Erases all elements.
+         */
+        void clear() {
+            _M_map.clear();
+            append(detail::log_record::clear, nullptr, nullptr);
+        }
+
+        // Durability
+
+        /**
+         *  @brief  Waits until all modifications so far are durable.
+         *  @throw  std::system_error  If writing or syncing the log failed.
+         */
+        void sync() {
+            std::unique_lock<std::mutex> lock(_M_mutex);
+            const uint64_t target = _M_appended;
+            if (_M_durable < target && !_M_error) {
+                _M_sync_requested = true;
+                _M_work.notify_one();
+                _M_durable_changed.wait(lock, [this, target] { return _M_durable >= target || _M_error; });
+            }
+            if (_M_error)
+                std::rethrow_exception(_M_error);
+        }
+
+        /**
+         *  @brief  Saves the map to the snapshot file and empties the log.
+         *  @throw  std::logic_error  If the map was opened without a snapshot path.
+         *  @throw  std::system_error  If a file operation fails.
+         *
+         *  The image is written to a temporary file next to the snapshot,
+         *  synced and renamed over it, so a crash leaves either snapshot
+         *  and a log that recovers the map. The log is truncated after
+         *  the rename, replaying the old log over the new snapshot is
+         *  harmless. Blocks modifications for the duration of a save().
+         */
+        void snapshot() {
+            if (_M_snapshot_path.empty())
+                throw std::logic_error("logged_radix_map::snapshot without a snapshot path");
+            sync();
+
+            const std::string temporary = _M_snapshot_path + ".tmp";
+            {
+                std::ofstream os(temporary, std::ios::binary | std::ios::trunc);
+                if (!os)
+                    throw std::system_error(errno, std::generic_category(), temporary);
+                _M_map.save(os);
+                os.close();
+                if (!os)
+                    throw serialization_error("art: writing the stream failed");
+            }
+            const int fd = ::open(temporary.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), temporary);
+            const int result = ::fsync(fd);
+            const int error = errno;
+            ::close(fd);
+            if (result != 0)
+                throw std::system_error(error, std::generic_category(), temporary);
+            if (std::rename(temporary.c_str(), _M_snapshot_path.c_str()) != 0)
+                throw std::system_error(errno, std::generic_category(), _M_snapshot_path);
+            sync_directory(_M_snapshot_path);
+
+            // nothing is pending after sync(), the flusher is idle
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            reset_log();
+        }
+
+        /**
+         * Returns the number of group commits (fsyncs of the log) so far.
+         */
+        uint64_t commits() const {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            return _M_commits;
+        }
+
+        /**
+         * Returns the number of record bytes logged since the map was opened.
+         */
+        uint64_t logged_bytes() const {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            return _M_appended;
+        }
+
+        // Lookup
+
+        /**
+         *  @brief  Tries to locate an element in the map.
+         *  @return  Iterator pointing to the sought-after element, or end()
+         *           if not found.
+         */
+        const_iterator find(const key_type &__k) const {
+            return _M_map.find(__k);
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        const mapped_type &at(const key_type &__k) const {
+            const_iterator res = _M_map.find(__k);
+            if (res == _M_map.end())
+                std::__throw_out_of_range("logged_radix_map::at");
+            return res->second;
+        }
+
+        /**
+         *  @brief  Finds the number of elements.
+         *  @param  __x  Key to located.
+         *  @return  Number of elements with specified key.
+         */
+        size_type count(const key_type &__x) const {
+            return _M_map.count(__x);
+        }
+
+        /**
+         * Returns the map in memory.
+         */
+        const map_type &map() const noexcept {
+            return _M_map;
+        }
+
+        // Iterators
+
+        /**
+         *  Returns a read-only (constant) iterator that points to the first pair
+         *  in the map. Iteration is done in ascending order according to the keys.
+         */
+        const_iterator begin() const noexcept {
+            return _M_map.begin();
+        }
+
+        /**
+         *  Returns a read-only (constant) iterator that points one past the last
+         *  pair in the map.
+         */
+        const_iterator end() const noexcept {
+            return _M_map.end();
+        }
+    };
+}
+
+#endif //ART_LOGGED_RADIX_MAP_H
@@ -0,0 +1,93 @@
+#ifndef ART_MEMORY_STATS_H
+#define ART_MEMORY_STATS_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace art {
+    /**
+     * @brief Memory used by the nodes of a radix tree, as reported by
+     * radix_map::memory_stats() and radix_set::memory_stats().
+     *
+     * Bytes are the sizes of the node objects the tree allocates, without
+     * the overhead of the allocator. The histograms are indexed by the
+     * value they count, e.g. depth[3] is the number of leaves below three
+     * inner nodes.
+     */
+    struct memory_stats {
+        /**
+         * @brief Nodes of one inner node type.
+         */
+        struct node_stats {
+            size_t count;
+            size_t bytes;
+
+            // fill[i] is the number of nodes with i children, 0 to the capacity of the type
+            std::vector<size_t> fill;
+
+            explicit node_stats(size_t capacity = 0) : count(0), bytes(0), fill(capacity + 1, 0) {}
+
+            /**
+             * Returns the average number of children per node over the capacity, 0 without nodes.
+             */
+            double fill_factor() const {
+                size_t children = 0;
+                for (size_t i = 0; i < fill.size(); i++)
+                    children += i * fill[i];
+                return count == 0 ? 0.0 : double(children) / double(count * (fill.size() - 1));
+            }
+        };
+
+        node_stats node_4;
+        node_stats node_16;
+        node_stats node_48;
+        node_stats node_256;
+
+        size_t leaves;
+        size_t leaf_bytes;
+
+        // bytes of the tree object and its sentinel
+        size_t fixed_bytes;
+
+        // leaves by the number of inner nodes above them
+        std::vector<size_t> depth;
+
+        // inner nodes by the length of their compressed prefix
+        std::vector<size_t> prefix_length;
+
+        memory_stats()
+                : node_4(4), node_16(16), node_48(48), node_256(256), leaves(0), leaf_bytes(0), fixed_bytes(0) {}
+
+        /**
+         * Returns the number of inner nodes.
+         */
+        size_t inner_nodes() const {
+            return node_4.count + node_16.count + node_48.count + node_256.count;
+        }
+
+        /**
+         * Returns the bytes of all inner nodes.
+         */
+        size_t inner_bytes() const {
+            return node_4.bytes + node_16.bytes + node_48.bytes + node_256.bytes;
+        }
+
+        /**
+         * Returns the bytes of all nodes and the tree itself.
+         */
+        size_t total_bytes() const {
+            return inner_bytes() + leaf_bytes + fixed_bytes;
+        }
+
+        /**
+         * @brief Counts one occurrence of @a value in a histogram, growing it as needed.
+         */
+        static void count(std::vector<size_t> &histogram, size_t value) {
+            if (histogram.size() <= value)
+                histogram.resize(value + 1, 0);
+            histogram[value]++;
+        }
+    };
+}
+
+#endif //ART_MEMORY_STATS_H
@@ -0,0 +1,769 @@
+#ifndef ART_OLC_TREE_H
+#define ART_OLC_TREE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stddef.h>
+#include <utility>
+#include "epoch.h"
+#include "key_transform.h"
+
+namespace art {
+    typedef uint8_t byte;
+
+    /**
+     * @brief Adaptive radix tree synchronized with optimistic lock coupling.
+     *
+     * Every inner node carries a version word: bit 0 marks the node obsolete,
+     * bit 1 locked, the rest counts modifications. Readers never write shared
+     * memory: they remember the version of a node, read from it and validate
+     * the version before trusting what they read, restarting from the root if
+     * a writer got in between. Writers follow the same protocol and upgrade
+     * to a write lock only on the nodes they modify, i.e. the node itself and,
+     * when it is replaced by grow or shrink, its parent.
+     *
+     * Leaves are immutable once published, an update swaps the leaf. Nodes
+     * and leaves that are unlinked are reclaimed by an epoch_manager.
+     *
+     * With _Single_writer only one thread modifies the tree and readers skip
+     * versions altogether: they never validate or restart. The writer then
+     * publishes every change with a single release store: new nodes are
+     * completely built before they are linked, node 4/16 only ever append in
+     * place and are copied on erase, node 48 stores the child before its
+     * index. A reader racing with an erase may miss the erased element, it
+     * never finds an element that was not there.
+     *
+     * Like ar_tree, the tree has no path compression and expands lazily:
+     * a subtree with a single element is stored as a leaf. The root is a
+     * node 256 that is never replaced.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam _Value  Type of the elements.
+     *  @tparam _KeyOfValue  Extracts the key from an element.
+     *  @tparam _Key_transform  Key transformation function object type.
+     *  @tparam _Single_writer  At most one thread modifies the tree at a time.
+     */
+    template<typename _Key, typename _Value, typename _KeyOfValue,
+            typename _Key_transform = key_transform<_Key>, bool _Single_writer = false>
+    struct olc_tree {
+    public:
+        struct _Node;
+        struct _Inner_Node;
+        struct _Leaf;
+        template<uint16_t _Capacity>
+        struct _Node_small;
+        struct _Node_48;
+        struct _Node_256;
+
+        typedef _Node_small<4> _Node_4;
+        typedef _Node_small<16> _Node_16;
+
+        typedef _Key key_type;
+        typedef _Value value_type;
+        typedef size_t size_type;
+
+    private:
+        typedef _Node *Node_ptr;
+        typedef _Inner_Node *Inner_Node_ptr;
+        typedef const _Inner_Node *Const_Inner_Node_ptr;
+        typedef _Leaf *Leaf_ptr;
+        typedef const _Leaf *Const_Leaf_ptr;
+
+        static const byte EMPTY_MARKER = 48;
+
+        _Key_transform _M_key_transform;
+
+        typedef decltype(_M_key_transform(key_type())) transformed_key_type;
+
+    public:
+        union Key {
+            const transformed_key_type value;
+            const byte chunks[sizeof(transformed_key_type)];
+        };
+
+        struct _Node {
+            virtual ~_Node() {}
+
+            virtual bool is_leaf() const { return false; }
+        };
+
+        struct _Leaf : public _Node {
+            const value_type _value;
+
+            explicit _Leaf(const value_type &__x) : _value(__x) {}
+
+            bool is_leaf() const override { return true; }
+        };
+
+        struct _Inner_Node : public _Node {
+            static const uint64_t OBSOLETE = 1;
+            static const uint64_t LOCKED = 2;
+
+            std::atomic<uint64_t> _version;
+            std::atomic<uint16_t> _count;
+
+            _Inner_Node() : _version(0), _count(0) {}
+
+            /**
+             * @brief Starts an optimistic read, fails on locked or obsolete nodes.
+             */
+            uint64_t read_lock_or_restart(bool &need_restart) const {
+                if (_Single_writer)
+                    return 0;
+                uint64_t version = _version.load(std::memory_order_acquire);
+                if (version & (OBSOLETE | LOCKED))
+                    need_restart = true;
+                return version;
+            }
+
+            /**
+             * @brief Validates everything read from the node since @a version.
+             */
+            void check_or_restart(uint64_t version, bool &need_restart) const {
+                if (_Single_writer)
+                    return;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (_version.load(std::memory_order_relaxed) != version)
+                    need_restart = true;
+            }
+
+            /**
+             * @brief Locks the node, fails if it changed since @a version.
+             */
+            void upgrade_to_write_lock_or_restart(uint64_t version, bool &need_restart) {
+                if (_Single_writer)
+                    return;
+                if (!_version.compare_exchange_strong(version, version + LOCKED, std::memory_order_acquire)) {
+                    need_restart = true;
+                    return;
+                }
+                // readers that see any of the following writes also see the lock
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+
+            void write_unlock() {
+                if (!_Single_writer)
+                    _version.fetch_add(LOCKED, std::memory_order_release);
+            }
+
+            void write_unlock_obsolete() {
+                if (!_Single_writer)
+                    _version.fetch_add(LOCKED + OBSOLETE, std::memory_order_release);
+            }
+
+            uint16_t size() const { return _count.load(std::memory_order_relaxed); }
+
+            bool is_full() const { return size() == max_size(); }
+
+            virtual uint16_t min_size() const = 0;
+
+            virtual uint16_t max_size() const = 0;
+
+            virtual Node_ptr find(const byte key_byte) const = 0;
+
+            // The following require the write lock or an unpublished node.
+
+            virtual void insert(const byte key_byte, Node_ptr node) = 0;
+
+            virtual void erase(const byte key_byte) = 0;
+
+            virtual void update_child_ptr(const byte key_byte, Node_ptr node) = 0;
+
+            /**
+             * @brief Any child other than the one at @a key_byte.
+             */
+            virtual Node_ptr other_child(const byte key_byte) const = 0;
+
+            /**
+             * @brief Inserts all children into @a dest, except the one at
+             * @a except if it is a valid byte.
+             */
+            virtual void copy_to(_Inner_Node &dest, int except) const = 0;
+
+            virtual Inner_Node_ptr grow() const = 0;
+
+            /**
+             * @brief Copy of the same node type without the child at @a key_byte.
+             */
+            virtual Inner_Node_ptr copy_without(const byte key_byte) const = 0;
+
+            /**
+             * @brief Copy into the next smaller node type without the child
+             * at @a key_byte.
+             */
+            virtual Inner_Node_ptr shrink(const byte key_byte) const = 0;
+
+            /**
+             * @brief Deletes all children recursively, single threaded only.
+             */
+            virtual void destroy_children() = 0;
+        };
+
+        /**
+         * @brief Node 4 and node 16, unsorted keys and children in parallel arrays.
+         *
+         * Keys are appended and the last key moves into the gap on erase, which
+         * keeps writes to a few words; readers validate the version anyway.
+         */
+        template<uint16_t _Capacity>
+        struct _Node_small : public _Inner_Node {
+            std::atomic<byte> keys[_Capacity];
+            std::atomic<Node_ptr> children[_Capacity];
+
+            _Node_small() : _Inner_Node() {}
+
+            virtual uint16_t min_size() const override { return _Capacity == 4 ? 0 : 5; }
+
+            virtual uint16_t max_size() const override { return _Capacity; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                const uint16_t count = std::min(this->_count.load(std::memory_order_acquire), _Capacity);
+                for (uint16_t i = 0; i < count; i++) {
+                    if (keys[i].load(std::memory_order_relaxed) == key_byte)
+                        return children[i].load(std::memory_order_acquire);
+                }
+                return nullptr;
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                const uint16_t count = this->size();
+                keys[count].store(key_byte, std::memory_order_relaxed);
+                children[count].store(node, std::memory_order_relaxed);
+                // publishes the new entry to readers that do not validate
+                this->_count.store(count + 1, std::memory_order_release);
+            }
+
+            virtual void erase(const byte key_byte) override {
+                const uint16_t count = this->size();
+                for (uint16_t i = 0; i < count; i++) {
+                    if (keys[i].load(std::memory_order_relaxed) == key_byte) {
+                        keys[i].store(keys[count - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        children[i].store(children[count - 1].load(std::memory_order_relaxed),
+                                          std::memory_order_release);
+                        this->_count.store(count - 1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+
+            virtual void update_child_ptr(const byte key_byte, Node_ptr node) override {
+                for (uint16_t i = 0; i < this->size(); i++) {
+                    if (keys[i].load(std::memory_order_relaxed) == key_byte) {
+                        children[i].store(node, std::memory_order_release);
+                        return;
+                    }
+                }
+            }
+
+            virtual Node_ptr other_child(const byte key_byte) const override {
+                for (uint16_t i = 0; i < this->size(); i++) {
+                    if (keys[i].load(std::memory_order_relaxed) != key_byte)
+                        return children[i].load(std::memory_order_relaxed);
+                }
+                return nullptr;
+            }
+
+            virtual void copy_to(_Inner_Node &dest, int except) const override {
+                for (uint16_t i = 0; i < this->size(); i++) {
+                    byte key_byte = keys[i].load(std::memory_order_relaxed);
+                    if (key_byte != except)
+                        dest.insert(key_byte, children[i].load(std::memory_order_relaxed));
+                }
+            }
+
+            virtual Inner_Node_ptr grow() const override {
+                Inner_Node_ptr node;
+                if (_Capacity == 4)
+                    node = new _Node_16();
+                else
+                    node = new _Node_48();
+                copy_to(*node, -1);
+                return node;
+            }
+
+            virtual Inner_Node_ptr copy_without(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_small();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual Inner_Node_ptr shrink(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_4();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual void destroy_children() override {
+                for (uint16_t i = 0; i < this->size(); i++)
+                    destroy(children[i].load(std::memory_order_relaxed));
+            }
+        };
+
+        struct _Node_48 : public _Inner_Node {
+            std::atomic<byte> child_index[256];
+            std::atomic<Node_ptr> children[48];
+
+            _Node_48() : _Inner_Node() {
+                for (unsigned i = 0; i < 256; i++)
+                    child_index[i].store(EMPTY_MARKER, std::memory_order_relaxed);
+                for (unsigned i = 0; i < 48; i++)
+                    children[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            virtual uint16_t min_size() const override { return 17; }
+
+            virtual uint16_t max_size() const override { return 48; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                byte index = child_index[key_byte].load(std::memory_order_acquire);
+                if (index == EMPTY_MARKER)
+                    return nullptr;
+                return children[index].load(std::memory_order_acquire);
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                byte pos = 0;
+                while (children[pos].load(std::memory_order_relaxed) != nullptr)
+                    pos++;
+                children[pos].store(node, std::memory_order_release);
+                child_index[key_byte].store(pos, std::memory_order_release);
+                this->_count.store(this->size() + 1, std::memory_order_relaxed);
+            }
+
+            virtual void erase(const byte key_byte) override {
+                byte index = child_index[key_byte].load(std::memory_order_relaxed);
+                child_index[key_byte].store(EMPTY_MARKER, std::memory_order_relaxed);
+                children[index].store(nullptr, std::memory_order_relaxed);
+                this->_count.store(this->size() - 1, std::memory_order_relaxed);
+            }
+
+            virtual void update_child_ptr(const byte key_byte, Node_ptr node) override {
+                children[child_index[key_byte].load(std::memory_order_relaxed)].store(node, std::memory_order_release);
+            }
+
+            virtual Node_ptr other_child(const byte key_byte) const override {
+                for (unsigned i = 0; i < 256; i++) {
+                    byte index = child_index[i].load(std::memory_order_relaxed);
+                    if (i != key_byte && index != EMPTY_MARKER)
+                        return children[index].load(std::memory_order_relaxed);
+                }
+                return nullptr;
+            }
+
+            virtual void copy_to(_Inner_Node &dest, int except) const override {
+                for (unsigned i = 0; i < 256; i++) {
+                    byte index = child_index[i].load(std::memory_order_relaxed);
+                    if (index != EMPTY_MARKER && (int) i != except)
+                        dest.insert(i, children[index].load(std::memory_order_relaxed));
+                }
+            }
+
+            virtual Inner_Node_ptr grow() const override {
+                Inner_Node_ptr node = new _Node_256();
+                copy_to(*node, -1);
+                return node;
+            }
+
+            virtual Inner_Node_ptr copy_without(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_48();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual Inner_Node_ptr shrink(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_16();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual void destroy_children() override {
+                for (unsigned i = 0; i < 48; i++)
+                    destroy(children[i].load(std::memory_order_relaxed));
+            }
+        };
+
+        struct _Node_256 : public _Inner_Node {
+            std::atomic<Node_ptr> children[256];
+
+            _Node_256() : _Inner_Node() {
+                for (unsigned i = 0; i < 256; i++)
+                    children[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            virtual uint16_t min_size() const override { return 49; }
+
+            virtual uint16_t max_size() const override { return 256; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                return children[key_byte].load(std::memory_order_acquire);
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                children[key_byte].store(node, std::memory_order_release);
+                this->_count.store(this->size() + 1, std::memory_order_relaxed);
+            }
+
+            virtual void erase(const byte key_byte) override {
+                children[key_byte].store(nullptr, std::memory_order_relaxed);
+                this->_count.store(this->size() - 1, std::memory_order_relaxed);
+            }
+
+            virtual void update_child_ptr(const byte key_byte, Node_ptr node) override {
+                children[key_byte].store(node, std::memory_order_release);
+            }
+
+            virtual Node_ptr other_child(const byte key_byte) const override {
+                for (unsigned i = 0; i < 256; i++) {
+                    Node_ptr child = children[i].load(std::memory_order_relaxed);
+                    if (i != key_byte && child != nullptr)
+                        return child;
+                }
+                return nullptr;
+            }
+
+            virtual void copy_to(_Inner_Node &dest, int except) const override {
+                for (unsigned i = 0; i < 256; i++) {
+                    Node_ptr child = children[i].load(std::memory_order_relaxed);
+                    if (child != nullptr && (int) i != except)
+                        dest.insert(i, child);
+                }
+            }
+
+            virtual Inner_Node_ptr grow() const override { return nullptr; }
+
+            virtual Inner_Node_ptr copy_without(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_256();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual Inner_Node_ptr shrink(const byte key_byte) const override {
+                Inner_Node_ptr node = new _Node_48();
+                copy_to(*node, key_byte);
+                return node;
+            }
+
+            virtual void destroy_children() override {
+                for (unsigned i = 0; i < 256; i++)
+                    destroy(children[i].load(std::memory_order_relaxed));
+            }
+        };
+
+    private:
+        _Node_256 *_M_root;
+        std::atomic<size_type> _M_count;
+        mutable detail::epoch_manager _M_epochs;
+
+        typedef detail::epoch_manager::guard epoch_guard;
+
+        static void destroy(Node_ptr node) {
+            if (node == nullptr)
+                return;
+            if (!node->is_leaf())
+                static_cast<Inner_Node_ptr>(node)->destroy_children();
+            delete node;
+        }
+
+        static void delete_node(void *node) {
+            delete static_cast<Node_ptr>(node);
+        }
+
+        void retire(Node_ptr node) const {
+            _M_epochs.retire(node, &olc_tree::delete_node);
+        }
+
+        Key transform(const value_type &__x) const {
+            return {_M_key_transform(_KeyOfValue()(__x))};
+        }
+
+        static bool same_key(const Key &lhs, const Key &rhs) {
+            return std::memcmp(lhs.chunks, rhs.chunks, sizeof(transformed_key_type)) == 0;
+        }
+
+        /**
+         * Builds the subtree that replaces @a existing at @a depth once @a leaf
+         * is added: a chain of node 4s down to the first byte in which the two
+         * keys differ.
+         */
+        Node_ptr split_leaf(Const_Leaf_ptr existing, Leaf_ptr leaf, const Key &key, unsigned depth) const {
+            Key existing_key = transform(existing->_value);
+            unsigned mismatch = depth;
+            while (existing_key.chunks[mismatch] == key.chunks[mismatch])
+                mismatch++;
+
+            Inner_Node_ptr node = new _Node_4();
+            node->insert(existing_key.chunks[mismatch], const_cast<Leaf_ptr>(existing));
+            node->insert(key.chunks[mismatch], leaf);
+            while (mismatch > depth) {
+                mismatch--;
+                Inner_Node_ptr parent = new _Node_4();
+                parent->insert(key.chunks[mismatch], node);
+                node = parent;
+            }
+            return node;
+        }
+
+        /**
+         * Inserts @a leaf, replaces an existing element only if @a assign.
+         * @return Whether there was no element with the same key.
+         */
+        bool insert_leaf(Leaf_ptr leaf, bool assign) {
+            epoch_guard guard(_M_epochs);
+            const Key key = transform(leaf->_value);
+
+            while (true) {
+                bool need_restart = false;
+                Inner_Node_ptr parent = nullptr;
+                uint64_t parent_version = 0;
+                byte parent_byte = 0;
+
+                Inner_Node_ptr node = _M_root;
+                uint64_t version = node->read_lock_or_restart(need_restart);
+                if (need_restart)
+                    continue;
+
+                for (unsigned depth = 0; !need_restart; depth++) {
+                    const byte key_byte = key.chunks[depth];
+                    Node_ptr child = node->find(key_byte);
+                    node->check_or_restart(version, need_restart);
+                    if (need_restart)
+                        break;
+
+                    if (child == nullptr) {
+                        if (node->is_full()) {
+                            // grow: replace the node in its parent
+                            parent->upgrade_to_write_lock_or_restart(parent_version, need_restart);
+                            if (need_restart)
+                                break;
+                            node->upgrade_to_write_lock_or_restart(version, need_restart);
+                            if (need_restart) {
+                                parent->write_unlock();
+                                break;
+                            }
+                            Inner_Node_ptr bigger = node->grow();
+                            bigger->insert(key_byte, leaf);
+                            parent->update_child_ptr(parent_byte, bigger);
+                            node->write_unlock_obsolete();
+                            parent->write_unlock();
+                            retire(node);
+                        } else {
+                            node->upgrade_to_write_lock_or_restart(version, need_restart);
+                            if (need_restart)
+                                break;
+                            node->insert(key_byte, leaf);
+                            node->write_unlock();
+                        }
+                        _M_count.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    }
+
+                    if (child->is_leaf()) {
+                        Leaf_ptr existing = static_cast<Leaf_ptr>(child);
+                        if (same_key(transform(existing->_value), key)) {
+                            if (!assign) {
+                                delete leaf;
+                                return false;
+                            }
+                            node->upgrade_to_write_lock_or_restart(version, need_restart);
+                            if (need_restart)
+                                break;
+                            node->update_child_ptr(key_byte, leaf);
+                            node->write_unlock();
+                            retire(existing);
+                            return false;
+                        }
+
+                        node->upgrade_to_write_lock_or_restart(version, need_restart);
+                        if (need_restart)
+                            break;
+                        node->update_child_ptr(key_byte, split_leaf(existing, leaf, key, depth + 1));
+                        node->write_unlock();
+                        _M_count.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    }
+
+                    parent = node;
+                    parent_version = version;
+                    parent_byte = key_byte;
+                    node = static_cast<Inner_Node_ptr>(child);
+                    version = node->read_lock_or_restart(need_restart);
+                }
+            }
+        }
+
+    public:
+        olc_tree() : _M_root(new _Node_256()), _M_count(0) {}
+
+        olc_tree(const olc_tree &) = delete;
+
+        olc_tree &operator=(const olc_tree &) = delete;
+
+        /**
+         * No other thread may use the tree any more.
+         */
+        ~olc_tree() {
+            destroy(_M_root);
+        }
+
+        /**
+         *  @return Number of elements, exact only while no writer is active.
+         */
+        size_type size() const noexcept {
+            return _M_count.load(std::memory_order_relaxed);
+        }
+
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         *  @brief Inserts @a __x unless an element with the same key exists.
+         *  @return Whether @a __x was inserted.
+         */
+        bool insert_unique(const value_type &__x) {
+            return insert_leaf(new _Leaf(__x), false);
+        }
+
+        /**
+         *  @brief Inserts @a __x or replaces the element with the same key.
+         *  @return Whether @a __x was inserted rather than assigned.
+         */
+        bool insert_or_assign(const value_type &__x) {
+            return insert_leaf(new _Leaf(__x), true);
+        }
+
+        /**
+         *  @brief Finds the element with key @a __k.
+         *  @param  __f  Called with the element while it is protected from
+         *               reclamation, must not store references to it.
+         *  @return Whether the element exists.
+         */
+        template<typename _Function>
+        bool visit(const key_type &__k, _Function __f) const {
+            epoch_guard guard(_M_epochs);
+            const Key key = {_M_key_transform(__k)};
+
+            while (true) {
+                bool need_restart = false;
+                Const_Inner_Node_ptr node = _M_root;
+                uint64_t version = node->read_lock_or_restart(need_restart);
+
+                for (unsigned depth = 0; !need_restart; depth++) {
+                    Node_ptr child = node->find(key.chunks[depth]);
+                    node->check_or_restart(version, need_restart);
+                    if (need_restart)
+                        break;
+
+                    if (child == nullptr)
+                        return false;
+
+                    if (child->is_leaf()) {
+                        Const_Leaf_ptr leaf = static_cast<Const_Leaf_ptr>(child);
+                        if (!same_key(transform(leaf->_value), key))
+                            return false;
+                        __f(leaf->_value);
+                        return true;
+                    }
+
+                    node = static_cast<Const_Inner_Node_ptr>(child);
+                    version = node->read_lock_or_restart(need_restart);
+                }
+            }
+        }
+
+        /**
+         *  @brief Erases the element with key @a __k.
+         *  @return Number of erased elements.
+         */
+        size_type erase_unique(const key_type &__k) {
+            epoch_guard guard(_M_epochs);
+            const Key key = {_M_key_transform(__k)};
+
+            while (true) {
+                bool need_restart = false;
+                Inner_Node_ptr parent = nullptr;
+                uint64_t parent_version = 0;
+                byte parent_byte = 0;
+
+                Inner_Node_ptr node = _M_root;
+                uint64_t version = node->read_lock_or_restart(need_restart);
+
+                for (unsigned depth = 0; !need_restart; depth++) {
+                    const byte key_byte = key.chunks[depth];
+                    Node_ptr child = node->find(key_byte);
+                    node->check_or_restart(version, need_restart);
+                    if (need_restart)
+                        break;
+
+                    if (child == nullptr)
+                        return 0;
+
+                    if (!child->is_leaf()) {
+                        parent = node;
+                        parent_version = version;
+                        parent_byte = key_byte;
+                        node = static_cast<Inner_Node_ptr>(child);
+                        version = node->read_lock_or_restart(need_restart);
+                        continue;
+                    }
+
+                    if (!same_key(transform(static_cast<Const_Leaf_ptr>(child)->_value), key))
+                        return 0;
+
+                    const uint16_t count = node->size();
+                    Node_ptr remaining = count == 2 ? node->other_child(key_byte) : nullptr;
+                    node->check_or_restart(version, need_restart);
+                    if (need_restart)
+                        break;
+
+                    if (parent != nullptr && count == 2 && node->max_size() == 4 && remaining->is_leaf()) {
+                        // collapse: the last leaf takes the place of the node
+                        parent->upgrade_to_write_lock_or_restart(parent_version, need_restart);
+                        if (need_restart)
+                            break;
+                        node->upgrade_to_write_lock_or_restart(version, need_restart);
+                        if (need_restart) {
+                            parent->write_unlock();
+                            break;
+                        }
+                        parent->update_child_ptr(parent_byte, remaining);
+                        node->write_unlock_obsolete();
+                        parent->write_unlock();
+                        retire(node);
+                    } else if (parent != nullptr && count - 1 < node->min_size()) {
+                        // shrink: replace the node in its parent
+                        parent->upgrade_to_write_lock_or_restart(parent_version, need_restart);
+                        if (need_restart)
+                            break;
+                        node->upgrade_to_write_lock_or_restart(version, need_restart);
+                        if (need_restart) {
+                            parent->write_unlock();
+                            break;
+                        }
+                        Inner_Node_ptr smaller = node->shrink(key_byte);
+                        parent->update_child_ptr(parent_byte, smaller);
+                        node->write_unlock_obsolete();
+                        parent->write_unlock();
+                        retire(node);
+                    } else if (_Single_writer && parent != nullptr && node->max_size() <= 16) {
+                        // node 4/16 cannot close the gap in place without validating readers
+                        parent->update_child_ptr(parent_byte, node->copy_without(key_byte));
+                        retire(node);
+                    } else {
+                        node->upgrade_to_write_lock_or_restart(version, need_restart);
+                        if (need_restart)
+                            break;
+                        node->erase(key_byte);
+                        node->write_unlock();
+                    }
+                    retire(child);
+                    _M_count.fetch_sub(1, std::memory_order_relaxed);
+                    return 1;
+                }
+            }
+        }
+    };
+}
+
+#endif //ART_OLC_TREE_H
@@ -0,0 +1,188 @@
+#ifndef ART_PAGED_RADIX_MAP_H
+#define ART_PAGED_RADIX_MAP_H
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "paged_tree.h"
+#include "radix_map.h"
+
+namespace art {
+    /**
+     * @brief A map of (key,value) pairs that can grow larger than memory:
+     * its pages are cached by a buffer pool of a fixed size and spill to a file.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *  @tparam _Page_size  Size of pages in bytes, defaults to 4096.
+     *
+     * Keys and mapped values have to be trivially copyable (or pairs of such
+     * types). See paged_tree for the page layout, pointer swizzling and
+     * eviction. Pages that are not resident are read on demand, so lookups
+     * touching them cost a pread each.
+     *
+     * Elements move between memory and the file, so there are no iterators
+     * and no references into the map: lookups copy the mapped value out,
+     * for_each() visits all elements in key order.
+     */
+    template<typename _Key, typename _T,
+            typename _Key_transform = key_transform<_Key>, size_t _Page_size = 4096>
+    class paged_radix_map {
+
+    public:
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef std::pair<const _Key, _T> value_type;
+        typedef _Key_transform key_transformer_type;
+
+    private:
+        typedef paged_tree<key_type, value_type, detail::Select1st<value_type>, _Key_transform, _Page_size> _Rep_type;
+
+        _Rep_type _M_t;
+
+    public:
+        typedef typename _Rep_type::size_type size_type;
+
+        /**
+         * @brief  Creates an empty map paging to an anonymous temporary file.
+         * @param  __buffer_pages  Number of pages kept in memory.
+         */
+        explicit paged_radix_map(size_t __buffer_pages = 1024) : _M_t(__buffer_pages) {}
+
+        /**
+         * @brief  Creates an empty map paging to a new file at @a __path,
+         * which is truncated and removed again with the map.
+         * @param  __buffer_pages  Number of pages kept in memory.
+         */
+        paged_radix_map(const std::string &__path, size_t __buffer_pages) : _M_t(__path, __buffer_pages) {}
+
+        paged_radix_map(const paged_radix_map &) = delete;
+
+        paged_radix_map &operator=(const paged_radix_map &) = delete;
+
+        // Capacity
+
+        /**
+         * Returns true if the map is empty.
+         */
+        bool empty() const noexcept {
+            return _M_t.empty();
+        }
+
+        /**
+         * Returns the size of the map.
+         */
+        size_type size() const noexcept {
+            return _M_t.size();
+        }
+
+        // Modifiers
+
+        /**
+         *  @brief Attempts to insert a std::pair into the map.
+         *  @param __x Pair to be inserted.
+         *  @return  Whether the pair was inserted, false if the key existed.
+         */
+        bool insert(const value_type &__x) {
+            return _M_t.insert(__x, false);
+        }
+
+        /**
+         *  @brief Inserts a std::pair or replaces the mapped value of an
+         *  existing key.
+         *  @return  Whether the pair was inserted rather than assigned.
+         */
+        bool insert_or_assign(const key_type &__k, const mapped_type &__obj) {
+            return _M_t.insert(value_type(__k, __obj), true);
+        }
+
+        /**
+         *  @brief Attempts to erase the element with the given key (if it exists).
+         *  @param  __k The key to erase.
+         *  @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            return _M_t.erase(__k);
+        }
+
+        /**
+         *  Erases all elements and truncates the file.
+         */
+        void clear() {
+            _M_t.clear();
+        }
+
+        // Lookup
+
+        /**
+         *  @brief  Copies the mapped value of key @a __k into @a __obj.
+         *  @return  Whether the key was found, @a __obj is untouched if not.
+         */
+        bool find(const key_type &__k, mapped_type &__obj) {
+            const value_type *__x = _M_t.find(__k);
+            if (__x == nullptr)
+                return false;
+            __obj = __x->second;
+            return true;
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @return  A copy of the data whose key is @a __k.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        mapped_type at(const key_type &__k) {
+            const value_type *__x = _M_t.find(__k);
+            if (__x == nullptr)
+                std::__throw_out_of_range("paged_radix_map::at");
+            return __x->second;
+        }
+
+        /**
+         *  @brief  Finds the number of elements.
+         *  @param  __x  Key to located.
+         *  @return  Number of elements with specified key.
+         */
+        size_type count(const key_type &__x) {
+            return _M_t.find(__x) == nullptr ? 0 : 1;
+        }
+
+        // Iteration
+
+        /**
+         *  @brief  Calls @a __f with every element in key order, reading
+         *  pages as needed. @a __f must not modify the map.
+         */
+        template<typename _Function>
+        void for_each(_Function __f) {
+            _M_t.for_each(__f);
+        }
+
+        // Buffer pool
+
+        /**
+         * Returns the number of pages read from the file so far.
+         */
+        uint64_t page_reads() const noexcept {
+            return _M_t.page_reads();
+        }
+
+        /**
+         * Returns the number of pages written to the file so far.
+         */
+        uint64_t page_writes() const noexcept {
+            return _M_t.page_writes();
+        }
+
+        /**
+         * Returns the number of pages in memory.
+         */
+        size_t resident_pages() const noexcept {
+            return _M_t.resident_pages();
+        }
+    };
+}
+
+#endif //ART_PAGED_RADIX_MAP_H
@@ -0,0 +1,614 @@
+#ifndef ART_PAGED_TREE_H
+#define ART_PAGED_TREE_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <stddef.h>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "key_transform.h"
+#include "serialization.h"
+
+namespace art {
+    typedef uint8_t byte;
+
+    /**
+     * @brief Radix tree whose nodes live in fixed-size pages of a file,
+     * cached by a buffer pool of a fixed number of frames.
+     *
+     * Inner pages are 256-way radix nodes, one level per key byte. Elements
+     * are kept in leaf pages, sorted arrays of the elements sharing the key
+     * bytes of the path to the page. A full leaf page bursts into an inner
+     * page with a leaf page per distinct next key byte, so leaf pages hold
+     * many elements instead of one per allocation. (Adaptive node sizes do
+     * not save anything within a fixed-size page.)
+     *
+     * A child reference (swip) is the address of the frame while the page is
+     * resident and its page id otherwise, so a lookup through resident pages
+     * only follows pointers. Resolving a page id reads the page into a frame
+     * (pread) and swizzles the reference. When no frame is free, a clock
+     * sweep evicts a page that was not used since the last sweep, writes it
+     * back if it is dirty and replaces the reference in its parent by the page
+     * id again. Only pages without resident children are evicted, so that
+     * every resident page is reachable through swizzled references and knows
+     * its parent; the root page stays resident.
+     *
+     * The file only extends memory: it is scratch space removed with the tree,
+     * not a durable copy of the tree.
+     *
+     * Not thread-safe. Pointers to elements are valid until the next operation.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam _Value  Type of the elements, trivially copyable (or pairs).
+     *  @tparam _KeyOfValue  Extracts the key from an element.
+     *  @tparam _Key_transform  Key transformation function object type.
+     *  @tparam _Page_size  Size of pages and frames in bytes.
+     */
+    template<typename _Key, typename _Value, typename _KeyOfValue,
+            typename _Key_transform = key_transform<_Key>, size_t _Page_size = 4096>
+    class paged_tree {
+    public:
+        typedef _Key key_type;
+        typedef _Value value_type;
+        typedef size_t size_type;
+
+    private:
+        static_assert(detail::is_raw_storable<value_type>::value,
+                      "paged_tree requires trivially copyable keys and values");
+        static_assert(alignof(value_type) <= 8, "elements must not need more than 8 byte alignment");
+
+        typedef decltype(_Key_transform()(_Key())) transformed_key_type;
+
+        union Key {
+            transformed_key_type value;
+            byte chunks[sizeof(transformed_key_type)];
+        };
+
+        // swizzled: address of the frame, unswizzled: (page id << 1) | 1, 0: no child
+        typedef uint64_t swip_type;
+        static const swip_type EMPTY = 0;
+
+        enum class page_type : uint8_t {
+            inner = 0, leaf = 1
+        };
+
+        struct _Page_header {
+            page_type type;
+            uint8_t reserved;
+            // non-empty children of inner pages, elements of leaf pages
+            uint16_t count;
+            // inner pages branch on key byte depth, leaf pages share the bytes before it
+            uint32_t depth;
+        };
+
+        struct _Inner_page {
+            _Page_header header;
+            swip_type children[256];
+        };
+
+        static const size_t LEAF_CAPACITY = (_Page_size - sizeof(_Page_header)) / sizeof(value_type);
+
+        static_assert(sizeof(_Inner_page) <= _Page_size, "pages must hold 256 child references");
+        static_assert(LEAF_CAPACITY >= 2, "pages must hold at least two elements");
+
+        struct _Frame {
+            char data[_Page_size];
+            uint64_t page_id;
+            // frame holding the swip of this page and its index there, nullptr for the root
+            _Frame *parent;
+            unsigned slot;
+            unsigned swizzled_children;
+            unsigned pins;
+            bool referenced;
+            bool dirty;
+            bool used;
+        };
+
+        static _Page_header *header(_Frame *f) {
+            return reinterpret_cast<_Page_header *>(f->data);
+        }
+
+        static swip_type *children(_Frame *f) {
+            return reinterpret_cast<_Inner_page *>(f->data)->children;
+        }
+
+        static value_type *entries(_Frame *f) {
+            return reinterpret_cast<value_type *>(f->data + sizeof(_Page_header));
+        }
+
+        static bool is_leaf(_Frame *f) {
+            return header(f)->type == page_type::leaf;
+        }
+
+        static swip_type page_swip(uint64_t page_id) {
+            return (page_id << 1) | 1;
+        }
+
+        static swip_type frame_swip(_Frame *f) {
+            return reinterpret_cast<swip_type>(f);
+        }
+
+        _Key_transform _M_key_transform;
+        size_type _M_count;
+
+        // buffer pool
+        std::unique_ptr<_Frame[]> _M_frames;
+        size_t _M_frame_count;
+        std::vector<_Frame *> _M_free_frames;
+        size_t _M_clock_hand;
+        _Frame *_M_root;
+
+        // page file
+        std::string _M_path;
+        int _M_fd;
+        uint64_t _M_next_page;
+        std::vector<uint64_t> _M_free_pages;
+        uint64_t _M_reads;
+        uint64_t _M_writes;
+
+        Key transform(const value_type &__x) const {
+            Key key;
+            key.value = _M_key_transform(_KeyOfValue()(__x));
+            return key;
+        }
+
+        void read_page(uint64_t page_id, char *data) {
+            size_t done = 0;
+            while (done < _Page_size) {
+                const ssize_t n = ::pread(_M_fd, data + done, _Page_size - done,
+                                          static_cast<off_t>(page_id * _Page_size + done));
+                if (n <= 0)
+                    throw std::system_error(n == 0 ? EIO : errno, std::generic_category(), "paged_tree: pread");
+                done += n;
+            }
+            _M_reads++;
+        }
+
+        void write_page(uint64_t page_id, const char *data) {
+            size_t done = 0;
+            while (done < _Page_size) {
+                const ssize_t n = ::pwrite(_M_fd, data + done, _Page_size - done,
+                                           static_cast<off_t>(page_id * _Page_size + done));
+                if (n < 0)
+                    throw std::system_error(errno, std::generic_category(), "paged_tree: pwrite");
+                done += n;
+            }
+            _M_writes++;
+        }
+
+        /**
+         * @brief Evicts the first unpinned page without resident children
+         * whose reference bit is clear, clearing the bits it passes.
+         */
+        _Frame *evict() {
+            for (size_t scanned = 0; scanned < 2 * _M_frame_count; scanned++) {
+                _Frame *f = &_M_frames[_M_clock_hand];
+                _M_clock_hand = (_M_clock_hand + 1) % _M_frame_count;
+                if (!f->used || f == _M_root || f->pins > 0 || f->swizzled_children > 0)
+                    continue;
+                if (f->referenced) {
+                    f->referenced = false;
+                    continue;
+                }
+
+                if (f->dirty)
+                    write_page(f->page_id, f->data);
+                children(f->parent)[f->slot] = page_swip(f->page_id);
+                f->parent->swizzled_children--;
+                f->used = false;
+                return f;
+            }
+            throw std::runtime_error("paged_tree: no buffer frame can be evicted");
+        }
+
+        _Frame *allocate_frame(_Frame *parent) {
+            if (!_M_free_frames.empty()) {
+                _Frame *f = _M_free_frames.back();
+                _M_free_frames.pop_back();
+                return f;
+            }
+            // the parent might have no resident children yet
+            parent->pins++;
+            _Frame *f = evict();
+            parent->pins--;
+            return f;
+        }
+
+        void attach(_Frame *f, _Frame *parent, unsigned slot, uint64_t page_id, bool dirty) {
+            f->page_id = page_id;
+            f->parent = parent;
+            f->slot = slot;
+            f->swizzled_children = 0;
+            f->pins = 0;
+            f->referenced = true;
+            f->dirty = dirty;
+            f->used = true;
+            children(parent)[slot] = frame_swip(f);
+            parent->swizzled_children++;
+        }
+
+        /**
+         * @brief Returns the frame of the child in a slot of an inner page,
+         * reading the page first if it is not resident, nullptr if there is none.
+         */
+        _Frame *child(_Frame *parent, unsigned slot) {
+            const swip_type swip = children(parent)[slot];
+            if (swip == EMPTY)
+                return nullptr;
+            if (!(swip & 1)) {
+                _Frame *f = reinterpret_cast<_Frame *>(swip);
+                f->referenced = true;
+                return f;
+            }
+
+            _Frame *f = allocate_frame(parent);
+            read_page(swip >> 1, f->data);
+            attach(f, parent, slot, swip >> 1, false);
+            return f;
+        }
+
+        /**
+         * @brief Creates an empty page in an empty slot of an inner page.
+         */
+        _Frame *new_page(_Frame *parent, unsigned slot, page_type type, uint32_t depth) {
+            _Frame *f = allocate_frame(parent);
+            uint64_t page_id;
+            if (_M_free_pages.empty()) {
+                page_id = _M_next_page++;
+            } else {
+                page_id = _M_free_pages.back();
+                _M_free_pages.pop_back();
+            }
+            attach(f, parent, slot, page_id, true);
+            init_page(f, type, depth);
+            header(parent)->count++;
+            parent->dirty = true;
+            return f;
+        }
+
+        static void init_page(_Frame *f, page_type type, uint32_t depth) {
+            if (type == page_type::inner)
+                std::memset(f->data, 0, sizeof(_Inner_page));
+            header(f)->type = type;
+            header(f)->count = 0;
+            header(f)->depth = depth;
+        }
+
+        /**
+         * @brief Frees a resident page, which is empty, and removes it from its parent.
+         */
+        void release(_Frame *f) {
+            _Frame *parent = f->parent;
+            children(parent)[f->slot] = EMPTY;
+            header(parent)->count--;
+            parent->swizzled_children--;
+            parent->dirty = true;
+
+            _M_free_pages.push_back(f->page_id);
+            f->used = false;
+            _M_free_frames.push_back(f);
+        }
+
+        /**
+         * @brief Index of the first element of a leaf page not less than key.
+         */
+        size_t leaf_lower_bound(_Frame *f, const Key &key) const {
+            const value_type *elements = entries(f);
+            size_t lo = 0, hi = header(f)->count;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                const Key other = transform(elements[mid]);
+                if (std::memcmp(other.chunks, key.chunks, sizeof(Key)) < 0)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo;
+        }
+
+        bool matches(_Frame *f, size_t i, const Key &key) const {
+            if (i == header(f)->count)
+                return false;
+            const Key other = transform(entries(f)[i]);
+            return std::memcmp(other.chunks, key.chunks, sizeof(Key)) == 0;
+        }
+
+        /**
+         * @brief Descends to the leaf page of key, nullptr if there is none.
+         */
+        _Frame *find_leaf(const Key &key) {
+            _Frame *f = _M_root;
+            while (f != nullptr && !is_leaf(f))
+                f = child(f, key.chunks[header(f)->depth]);
+            return f;
+        }
+
+        /**
+         * @brief Fills an empty inner page with the sorted elements [first, last),
+         * which share the bytes before the page's depth.
+         */
+        void fill(_Frame *f, const value_type *first, const value_type *last) {
+            const uint32_t depth = header(f)->depth;
+            f->pins++;
+            while (first != last) {
+                const byte b = transform(*first).chunks[depth];
+                const value_type *group_last = first + 1;
+                while (group_last != last && transform(*group_last).chunks[depth] == b)
+                    group_last++;
+
+                const size_t count = group_last - first;
+                if (count <= LEAF_CAPACITY) {
+                    _Frame *leaf = new_page(f, b, page_type::leaf, depth + 1);
+                    std::memcpy(static_cast<void *>(entries(leaf)), first, count * sizeof(value_type));
+                    header(leaf)->count = static_cast<uint16_t>(count);
+                } else {
+                    fill(new_page(f, b, page_type::inner, depth + 1), first, group_last);
+                }
+                first = group_last;
+            }
+            f->pins--;
+        }
+
+        /**
+         * @brief Turns a full leaf page into an inner page over its elements and __x.
+         */
+        void burst(_Frame *f, size_t pos, const value_type &__x) {
+            const size_t count = header(f)->count;
+            std::vector<char> buffer((count + 1) * sizeof(value_type));
+            value_type *elements = reinterpret_cast<value_type *>(buffer.data());
+            std::memcpy(static_cast<void *>(elements), entries(f), pos * sizeof(value_type));
+            new(elements + pos) value_type(__x);
+            std::memcpy(static_cast<void *>(elements + pos + 1), entries(f) + pos, (count - pos) * sizeof(value_type));
+
+            init_page(f, page_type::inner, header(f)->depth);
+            f->dirty = true;
+            fill(f, elements, elements + count + 1);
+        }
+
+        template<typename _Function>
+        void for_each_below(_Frame *f, _Function &__f) {
+            f->pins++;
+            if (is_leaf(f)) {
+                for (size_t i = 0; i < header(f)->count; i++)
+                    __f(static_cast<const value_type &>(entries(f)[i]));
+            } else {
+                for (unsigned slot = 0; slot < 256; slot++) {
+                    _Frame *next = child(f, slot);
+                    if (next != nullptr)
+                        for_each_below(next, __f);
+                }
+            }
+            f->pins--;
+        }
+
+        void open_file(const std::string &__path) {
+            _M_fd = ::open(__path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if (_M_fd < 0)
+                throw std::system_error(errno, std::generic_category(), __path);
+            _M_path = __path;
+        }
+
+        void init_pool(size_t __buffer_pages) {
+            // a descent pins at most one page per key byte, plus the root
+            if (__buffer_pages < sizeof(Key) + 2)
+                throw std::invalid_argument("paged_tree: buffer pool too small for the key length");
+
+            _M_frames.reset(new _Frame[__buffer_pages]);
+            _M_frame_count = __buffer_pages;
+            for (size_t i = __buffer_pages; i-- > 1;) {
+                _M_frames[i].used = false;
+                _M_free_frames.push_back(&_M_frames[i]);
+            }
+
+            _M_root = &_M_frames[0];
+            _M_root->page_id = 0;
+            _M_root->parent = nullptr;
+            _M_root->swizzled_children = 0;
+            _M_root->pins = 1;
+            _M_root->referenced = true;
+            _M_root->dirty = true;
+            _M_root->used = true;
+            init_page(_M_root, page_type::inner, 0);
+        }
+
+    public:
+        /**
+         * @brief Creates an empty tree paging to a new file at __path.
+         * @param __buffer_pages  Number of pages kept in memory.
+         */
+        paged_tree(const std::string &__path, size_t __buffer_pages)
+                : _M_key_transform(), _M_count(0), _M_frame_count(0), _M_clock_hand(0), _M_root(nullptr),
+                  _M_fd(-1), _M_next_page(1), _M_reads(0), _M_writes(0) {
+            open_file(__path);
+            try {
+                init_pool(__buffer_pages);
+            } catch (...) {
+                ::close(_M_fd);
+                ::unlink(_M_path.c_str());
+                throw;
+            }
+        }
+
+        /**
+         * @brief Creates an empty tree paging to an anonymous temporary file.
+         */
+        explicit paged_tree(size_t __buffer_pages)
+                : _M_key_transform(), _M_count(0), _M_frame_count(0), _M_clock_hand(0), _M_root(nullptr),
+                  _M_fd(-1), _M_next_page(1), _M_reads(0), _M_writes(0) {
+            const char *dir = std::getenv("TMPDIR");
+            std::string pattern = std::string(dir != nullptr ? dir : "/tmp") + "/art-paged-XXXXXX";
+            std::vector<char> path(pattern.begin(), pattern.end());
+            path.push_back('\0');
+            _M_fd = ::mkstemp(path.data());
+            if (_M_fd < 0)
+                throw std::system_error(errno, std::generic_category(), pattern);
+            // the file disappears with the descriptor
+            ::unlink(path.data());
+            try {
+                init_pool(__buffer_pages);
+            } catch (...) {
+                ::close(_M_fd);
+                throw;
+            }
+        }
+
+        paged_tree(const paged_tree &) = delete;
+
+        paged_tree &operator=(const paged_tree &) = delete;
+
+        ~paged_tree() {
+            ::close(_M_fd);
+            if (!_M_path.empty())
+                ::unlink(_M_path.c_str());
+        }
+
+        bool empty() const noexcept { return _M_count == 0; }
+
+        size_type size() const noexcept { return _M_count; }
+
+        /**
+         * @brief Returns the element with the given key, nullptr if there is none.
+         *
+         * The pointer is valid until the next operation on the tree.
+         */
+        const value_type *find(const key_type &__k) {
+            Key key;
+            key.value = _M_key_transform(__k);
+            _Frame *f = find_leaf(key);
+            if (f == nullptr)
+                return nullptr;
+            const size_t i = leaf_lower_bound(f, key);
+            return matches(f, i, key) ? entries(f) + i : nullptr;
+        }
+
+        /**
+         * @brief Inserts __x, or replaces the element with its key if __assign is set.
+         * @return Whether __x was inserted.
+         */
+        bool insert(const value_type &__x, bool __assign) {
+            const Key key = transform(__x);
+            _Frame *f = _M_root;
+            while (!is_leaf(f)) {
+                const unsigned slot = key.chunks[header(f)->depth];
+                _Frame *next = child(f, slot);
+                if (next == nullptr) {
+                    next = new_page(f, slot, page_type::leaf, header(f)->depth + 1);
+                    new(entries(next)) value_type(__x);
+                    header(next)->count = 1;
+                    _M_count++;
+                    return true;
+                }
+                f = next;
+            }
+
+            const size_t i = leaf_lower_bound(f, key);
+            if (matches(f, i, key)) {
+                if (__assign) {
+                    new(entries(f) + i) value_type(__x);
+                    f->dirty = true;
+                }
+                return false;
+            }
+
+            const size_t count = header(f)->count;
+            if (count < LEAF_CAPACITY) {
+                std::memmove(static_cast<void *>(entries(f) + i + 1), entries(f) + i,
+                             (count - i) * sizeof(value_type));
+                new(entries(f) + i) value_type(__x);
+                header(f)->count++;
+                f->dirty = true;
+            } else {
+                burst(f, i, __x);
+            }
+            _M_count++;
+            return true;
+        }
+
+        /**
+         * @brief Erases the element with the given key, freeing pages that become empty.
+         * @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            Key key;
+            key.value = _M_key_transform(__k);
+            _Frame *f = find_leaf(key);
+            if (f == nullptr)
+                return 0;
+            const size_t i = leaf_lower_bound(f, key);
+            if (!matches(f, i, key))
+                return 0;
+
+            const size_t count = header(f)->count;
+            std::memmove(static_cast<void *>(entries(f) + i), entries(f) + i + 1,
+                         (count - i - 1) * sizeof(value_type));
+            header(f)->count--;
+            f->dirty = true;
+            _M_count--;
+
+            // the whole path is resident, as every page on it has a swizzled child
+            while (f != _M_root && header(f)->count == 0) {
+                _Frame *parent = f->parent;
+                release(f);
+                f = parent;
+            }
+            return 1;
+        }
+
+        /**
+         * @brief Calls __f with every element in key order.
+         *
+         * __f must not modify the tree.
+         */
+        template<typename _Function>
+        void for_each(_Function __f) {
+            for_each_below(_M_root, __f);
+        }
+
+        /**
+         * @brief Erases all elements and truncates the file.
+         */
+        void clear() {
+            for (size_t i = 1; i < _M_frame_count; i++) {
+                if (_M_frames[i].used) {
+                    _M_frames[i].used = false;
+                    _M_free_frames.push_back(&_M_frames[i]);
+                }
+            }
+            init_page(_M_root, page_type::inner, 0);
+            _M_root->swizzled_children = 0;
+            _M_root->dirty = true;
+            _M_free_pages.clear();
+            _M_next_page = 1;
+            if (::ftruncate(_M_fd, 0) != 0)
+                throw std::system_error(errno, std::generic_category(), "paged_tree: ftruncate");
+            _M_count = 0;
+        }
+
+        /**
+         * Returns the number of pages read from the file so far.
+         */
+        uint64_t page_reads() const noexcept { return _M_reads; }
+
+        /**
+         * Returns the number of pages written to the file so far.
+         */
+        uint64_t page_writes() const noexcept { return _M_writes; }
+
+        /**
+         * Returns the number of pages in memory.
+         */
+        size_t resident_pages() const noexcept { return _M_frame_count - _M_free_frames.size(); }
+
+        static constexpr size_t page_size() { return _Page_size; }
+    };
+}
+
+#endif //ART_PAGED_TREE_H
@@ -0,0 +1,207 @@
+#ifndef ART_PERSISTENT_RADIX_MAP_H
+#define ART_PERSISTENT_RADIX_MAP_H
+
+#include <stdexcept>
+#include <utility>
+#include "persistent_tree.h"
+#include "radix_map.h"
+
+namespace art {
+    /**
+     * @brief A map of (key,value) pairs with constant time copies and
+     * snapshots, nodes are shared between versions and copied on write.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *
+     * Elements are immutable once inserted; insert_or_assign() replaces them.
+     * A modification copies the shared nodes on the path to the changed leaf,
+     * which costs O(k) node copies while snapshots are alive and nothing extra
+     * otherwise.
+     *
+     * A snapshot can be read by another thread while the map keeps being
+     * modified. The map itself is not thread-safe: snapshot() has to be called
+     * by the thread modifying the map (or synchronized with it).
+     *
+     * Iterators are forward only.
+     */
+    template<typename _Key, typename _T,
+            typename _Key_transform = key_transform<_Key> >
+    class persistent_radix_map {
+
+    public:
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef std::pair<const _Key, _T> value_type;
+        typedef _Key_transform key_transformer_type;
+        typedef const value_type &reference;
+        typedef const value_type &const_reference;
+
+    private:
+        typedef persistent_tree<key_type, value_type, detail::Select1st<value_type>, _Key_transform> _Rep_type;
+
+        _Rep_type _M_t;
+
+    public:
+        typedef typename _Rep_type::const_iterator iterator;
+        typedef typename _Rep_type::const_iterator const_iterator;
+        typedef typename _Rep_type::size_type size_type;
+        typedef typename _Rep_type::difference_type difference_type;
+
+        /**
+         * @brief  Read-only view of a map at the time snapshot() was called.
+         */
+        class snapshot_type {
+            friend class persistent_radix_map;
+
+            _Rep_type _M_t;
+
+            explicit snapshot_type(const _Rep_type &__t) : _M_t(__t) {}
+
+        public:
+            bool empty() const noexcept { return _M_t.empty(); }
+
+            size_type size() const noexcept { return _M_t.size(); }
+
+            const_iterator begin() const { return _M_t.begin(); }
+
+            const_iterator end() const { return _M_t.end(); }
+
+            const_iterator find(const key_type &__k) const { return _M_t.find(__k); }
+
+            size_type count(const key_type &__k) const { return _M_t.count(__k); }
+
+            const mapped_type &at(const key_type &__k) const {
+                const value_type *__x = _M_t.find_value(__k);
+                if (__x == nullptr)
+                    std::__throw_out_of_range("persistent_radix_map::snapshot_type::at");
+                return __x->second;
+            }
+        };
+
+        /**
+         * @brief  Default constructor creates no elements.
+         */
+        persistent_radix_map() : _M_t() {}
+
+        /**
+         * @brief  Map copy constructor, shares all nodes with @a __x.
+         */
+        persistent_radix_map(const persistent_radix_map &__x) : _M_t(__x._M_t) {}
+
+        persistent_radix_map(persistent_radix_map &&__x) : _M_t(std::move(__x._M_t)) {}
+
+        /**
+         *  @brief  Builds a map from an initializer_list.
+         */
+        persistent_radix_map(std::initializer_list<value_type> __l) : _M_t() {
+            for (auto &__x : __l)
+                _M_t.insert_unique(__x);
+        }
+
+        persistent_radix_map &operator=(const persistent_radix_map &__x) {
+            _M_t = __x._M_t;
+            return *this;
+        }
+
+        persistent_radix_map &operator=(persistent_radix_map &&__x) = default;
+
+        /**
+         *  @brief  Constant time read-only view of the current elements,
+         *  unaffected by later modifications of the map.
+         */
+        snapshot_type snapshot() const {
+            return snapshot_type(_M_t);
+        }
+
+        // Capacity
+
+        /**
+         * Returns true if the map is empty.
+         */
+        bool empty() const noexcept {
+            return _M_t.empty();
+        }
+
+        /**
+         * Returns the size of the map.
+         */
+        size_type size() const noexcept {
+            return _M_t.size();
+        }
+
+        // Iterators
+
+        const_iterator begin() const {
+            return _M_t.begin();
+        }
+
+        const_iterator end() const {
+            return _M_t.end();
+        }
+
+        // Modifiers
+
+        /**
+         *  @brief Attempts to insert a std::pair into the map.
+         *  @param __x Pair to be inserted.
+         *  @return  Whether the pair was inserted, false if the key existed.
+         */
+        bool insert(const value_type &__x) {
+            return _M_t.insert_unique(__x);
+        }
+
+        /**
+         *  @brief Inserts a std::pair or replaces the element of an existing key.
+         *  @return  Whether the pair was inserted rather than assigned.
+         */
+        bool insert_or_assign(const key_type &__k, const mapped_type &__obj) {
+            return _M_t.insert_or_assign(value_type(__k, __obj));
+        }
+
+        /**
+         *  @brief Attempts to erase the element with the given key (if it exists).
+         *  @param  __k The key to erase.
+         *  @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            return _M_t.erase_unique(__k);
+        }
+
+        /**
+         *  Erases all elements, snapshots keep theirs.
+         */
+        void clear() noexcept {
+            _M_t.clear();
+        }
+
+        void swap(persistent_radix_map &__x) noexcept {
+            _M_t.swap(__x._M_t);
+        }
+
+        // Lookup
+
+        const_iterator find(const key_type &__k) const {
+            return _M_t.find(__k);
+        }
+
+        size_type count(const key_type &__k) const {
+            return _M_t.count(__k);
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        const mapped_type &at(const key_type &__k) const {
+            const value_type *__x = _M_t.find_value(__k);
+            if (__x == nullptr)
+                std::__throw_out_of_range("persistent_radix_map::at");
+            return __x->second;
+        }
+    };
+}
+
+#endif //ART_PERSISTENT_RADIX_MAP_H
@@ -0,0 +1,722 @@
+#ifndef ART_PERSISTENT_TREE_H
+#define ART_PERSISTENT_TREE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+#include "key_transform.h"
+
+namespace art {
+    typedef uint8_t byte;
+
+    /**
+     * @brief Adaptive radix tree whose nodes are shared between versions.
+     *
+     * Nodes are reference counted and have no parent pointers, so a node can
+     * belong to any number of trees. Copying a tree only takes a reference to
+     * the root. A modification copies every shared node on the path from the
+     * root to the changed leaf (path copying) and changes nodes it owns alone
+     * in place, so other versions never observe it.
+     *
+     * Reference counts are atomic: versions can be read and destroyed in other
+     * threads than the one modifying a tree, as long as every single tree
+     * object is used by one thread at a time.
+     *
+     * Like ar_tree, the tree has no path compression and expands lazily.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam _Value  Type of the elements.
+     *  @tparam _KeyOfValue  Extracts the key from an element.
+     *  @tparam _Key_transform  Key transformation function object type.
+     */
+    template<typename _Key, typename _Value, typename _KeyOfValue,
+            typename _Key_transform = key_transform<_Key> >
+    struct persistent_tree {
+    public:
+        struct _Node;
+        struct _Inner_Node;
+        struct _Leaf;
+        template<uint16_t _Capacity>
+        struct _Node_sorted;
+        struct _Node_48;
+        struct _Node_256;
+
+        typedef _Node_sorted<4> _Node_4;
+        typedef _Node_sorted<16> _Node_16;
+
+        typedef _Key key_type;
+        typedef _Value value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+    private:
+        typedef _Node *Node_ptr;
+        typedef const _Node *Const_Node_ptr;
+        typedef _Inner_Node *Inner_Node_ptr;
+        typedef const _Inner_Node *Const_Inner_Node_ptr;
+        typedef _Leaf *Leaf_ptr;
+        typedef const _Leaf *Const_Leaf_ptr;
+
+        static const byte EMPTY_MARKER;
+
+        // returned by _Inner_Node::next() when there is no further child
+        static const int NO_CHILD = 256;
+
+        _Key_transform _M_key_transform;
+
+        typedef decltype(_M_key_transform(key_type())) transformed_key_type;
+
+    public:
+        union Key {
+            const transformed_key_type value;
+            const byte chunks[sizeof(transformed_key_type)];
+        };
+
+        struct _Node {
+            // number of parents and trees referencing the node
+            mutable std::atomic<uint32_t> _refs;
+
+            _Node() : _refs(1) {}
+
+            virtual ~_Node() {}
+
+            virtual bool is_leaf() const { return false; }
+        };
+
+        struct _Leaf : public _Node {
+            const value_type _value;
+
+            explicit _Leaf(const value_type &__x) : _Node(), _value(__x) {}
+
+            bool is_leaf() const override { return true; }
+        };
+
+        struct _Inner_Node : public _Node {
+            uint16_t _count = 0;
+
+            uint16_t size() const { return _count; }
+
+            bool is_full() const { return _count == max_size(); }
+
+            virtual uint16_t min_size() const = 0;
+
+            virtual uint16_t max_size() const = 0;
+
+            virtual Node_ptr find(const byte key_byte) const = 0;
+
+            /**
+             * @return Slot of the child at @a key_byte, nullptr if there is none.
+             */
+            virtual Node_ptr *find_slot(const byte key_byte) = 0;
+
+            /**
+             * @return Smallest byte greater than @a after with a child, or NO_CHILD.
+             */
+            virtual int next(int after) const = 0;
+
+            // The following change the node, it must not be shared.
+
+            virtual void insert(const byte key_byte, Node_ptr node) = 0;
+
+            virtual void erase(const byte key_byte) = 0;
+
+            /**
+             * @brief Copy of the node referencing the same children.
+             */
+            virtual Inner_Node_ptr clone() const = 0;
+
+            virtual Inner_Node_ptr grow() const = 0;
+
+            virtual Inner_Node_ptr shrink() const = 0;
+
+            /**
+             * @brief Drops the references to all children.
+             */
+            virtual void release_children() = 0;
+
+            /**
+             * @brief Inserts all children into @a dest, taking a reference to each.
+             */
+            void copy_to(_Inner_Node &dest) const {
+                for (int b = next(-1); b != NO_CHILD; b = next(b)) {
+                    Node_ptr child = find(b);
+                    retain(child);
+                    dest.insert(b, child);
+                }
+            }
+        };
+
+        /**
+         * @brief Node 4 and node 16, sorted keys and children in parallel arrays.
+         */
+        template<uint16_t _Capacity>
+        struct _Node_sorted : public _Inner_Node {
+            byte keys[_Capacity];
+            Node_ptr children[_Capacity];
+
+            virtual uint16_t min_size() const override { return _Capacity == 4 ? 1 : 5; }
+
+            virtual uint16_t max_size() const override { return _Capacity; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                for (uint16_t i = 0; i < this->_count; i++) {
+                    if (keys[i] == key_byte)
+                        return children[i];
+                }
+                return nullptr;
+            }
+
+            virtual Node_ptr *find_slot(const byte key_byte) override {
+                for (uint16_t i = 0; i < this->_count; i++) {
+                    if (keys[i] == key_byte)
+                        return &children[i];
+                }
+                return nullptr;
+            }
+
+            virtual int next(int after) const override {
+                for (uint16_t i = 0; i < this->_count; i++) {
+                    if (keys[i] > after)
+                        return keys[i];
+                }
+                return NO_CHILD;
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                uint16_t pos = 0;
+                while (pos < this->_count && keys[pos] < key_byte)
+                    pos++;
+                std::memmove(keys + pos + 1, keys + pos, this->_count - pos);
+                std::memmove(children + pos + 1, children + pos, (this->_count - pos) * sizeof(Node_ptr));
+                keys[pos] = key_byte;
+                children[pos] = node;
+                this->_count++;
+            }
+
+            virtual void erase(const byte key_byte) override {
+                for (uint16_t pos = 0; pos < this->_count; pos++) {
+                    if (keys[pos] == key_byte) {
+                        std::memmove(keys + pos, keys + pos + 1, this->_count - pos - 1);
+                        std::memmove(children + pos, children + pos + 1,
+                                     (this->_count - pos - 1) * sizeof(Node_ptr));
+                        this->_count--;
+                        return;
+                    }
+                }
+            }
+
+            virtual Inner_Node_ptr clone() const override {
+                Inner_Node_ptr node = new _Node_sorted();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual Inner_Node_ptr grow() const override {
+                Inner_Node_ptr node;
+                if (_Capacity == 4)
+                    node = new _Node_16();
+                else
+                    node = new _Node_48();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual Inner_Node_ptr shrink() const override {
+                Inner_Node_ptr node = new _Node_4();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual void release_children() override {
+                for (uint16_t i = 0; i < this->_count; i++)
+                    release(children[i]);
+            }
+        };
+
+        struct _Node_48 : public _Inner_Node {
+            byte child_index[256];
+            Node_ptr children[48];
+
+            _Node_48() {
+                std::fill(child_index, child_index + 256, EMPTY_MARKER);
+                std::fill(children, children + 48, nullptr);
+            }
+
+            virtual uint16_t min_size() const override { return 17; }
+
+            virtual uint16_t max_size() const override { return 48; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                if (child_index[key_byte] == EMPTY_MARKER)
+                    return nullptr;
+                return children[child_index[key_byte]];
+            }
+
+            virtual Node_ptr *find_slot(const byte key_byte) override {
+                if (child_index[key_byte] == EMPTY_MARKER)
+                    return nullptr;
+                return &children[child_index[key_byte]];
+            }
+
+            virtual int next(int after) const override {
+                for (int b = after + 1; b < 256; b++) {
+                    if (child_index[b] != EMPTY_MARKER)
+                        return b;
+                }
+                return NO_CHILD;
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                byte pos = 0;
+                while (children[pos] != nullptr)
+                    pos++;
+                children[pos] = node;
+                child_index[key_byte] = pos;
+                this->_count++;
+            }
+
+            virtual void erase(const byte key_byte) override {
+                children[child_index[key_byte]] = nullptr;
+                child_index[key_byte] = EMPTY_MARKER;
+                this->_count--;
+            }
+
+            virtual Inner_Node_ptr clone() const override {
+                Inner_Node_ptr node = new _Node_48();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual Inner_Node_ptr grow() const override {
+                Inner_Node_ptr node = new _Node_256();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual Inner_Node_ptr shrink() const override {
+                Inner_Node_ptr node = new _Node_16();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual void release_children() override {
+                for (unsigned i = 0; i < 48; i++)
+                    release(children[i]);
+            }
+        };
+
+        struct _Node_256 : public _Inner_Node {
+            Node_ptr children[256];
+
+            _Node_256() {
+                std::fill(children, children + 256, nullptr);
+            }
+
+            virtual uint16_t min_size() const override { return 49; }
+
+            virtual uint16_t max_size() const override { return 256; }
+
+            virtual Node_ptr find(const byte key_byte) const override {
+                return children[key_byte];
+            }
+
+            virtual Node_ptr *find_slot(const byte key_byte) override {
+                return children[key_byte] == nullptr ? nullptr : &children[key_byte];
+            }
+
+            virtual int next(int after) const override {
+                for (int b = after + 1; b < 256; b++) {
+                    if (children[b] != nullptr)
+                        return b;
+                }
+                return NO_CHILD;
+            }
+
+            virtual void insert(const byte key_byte, Node_ptr node) override {
+                children[key_byte] = node;
+                this->_count++;
+            }
+
+            virtual void erase(const byte key_byte) override {
+                children[key_byte] = nullptr;
+                this->_count--;
+            }
+
+            virtual Inner_Node_ptr clone() const override {
+                Inner_Node_ptr node = new _Node_256();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual Inner_Node_ptr grow() const override { return nullptr; }
+
+            virtual Inner_Node_ptr shrink() const override {
+                Inner_Node_ptr node = new _Node_48();
+                this->copy_to(*node);
+                return node;
+            }
+
+            virtual void release_children() override {
+                for (unsigned i = 0; i < 256; i++)
+                    release(children[i]);
+            }
+        };
+
+        /**
+         * @brief Forward iterator, keeps the path from the root to the leaf.
+         */
+        struct _Tree_iterator {
+            typedef typename persistent_tree::value_type value_type;
+            typedef const value_type &reference;
+            typedef const value_type *pointer;
+            typedef std::forward_iterator_tag iterator_category;
+            typedef ptrdiff_t difference_type;
+
+            typedef _Tree_iterator _Self;
+
+            // inner nodes on the path with the byte of the child taken
+            std::vector<std::pair<Const_Inner_Node_ptr, int> > _path;
+            Const_Leaf_ptr _leaf = nullptr;
+
+            _Tree_iterator() {}
+
+            reference operator*() const noexcept {
+                return _leaf->_value;
+            }
+
+            pointer operator->() const noexcept {
+                return &_leaf->_value;
+            }
+
+            _Self &operator++() noexcept {
+                _leaf = nullptr;
+                while (!_path.empty()) {
+                    auto &top = _path.back();
+                    top.second = top.first->next(top.second);
+                    if (top.second == NO_CHILD) {
+                        _path.pop_back();
+                        continue;
+                    }
+                    descend_leftmost(top.first->find(top.second));
+                    return *this;
+                }
+                return *this;
+            }
+
+            _Self operator++(int) noexcept {
+                _Self __tmp = *this;
+                ++*this;
+                return __tmp;
+            }
+
+            void descend_leftmost(Const_Node_ptr node) {
+                while (!node->is_leaf()) {
+                    Const_Inner_Node_ptr inner = static_cast<Const_Inner_Node_ptr>(node);
+                    int first = inner->next(-1);
+                    _path.push_back(std::make_pair(inner, first));
+                    node = inner->find(first);
+                }
+                _leaf = static_cast<Const_Leaf_ptr>(node);
+            }
+
+            friend bool operator==(const _Self &__x, const _Self &__y) noexcept {
+                return __x._leaf == __y._leaf;
+            }
+
+            friend bool operator!=(const _Self &__x, const _Self &__y) noexcept {
+                return __x._leaf != __y._leaf;
+            }
+        };
+
+        typedef _Tree_iterator const_iterator;
+        typedef _Tree_iterator iterator;
+
+    private:
+        Node_ptr _M_root;
+        size_type _M_count;
+
+        static void retain(Const_Node_ptr node) {
+            if (node != nullptr)
+                node->_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static void release(Node_ptr node) {
+            if (node == nullptr || node->_refs.fetch_sub(1, std::memory_order_release) != 1)
+                return;
+            // see the writes of the threads that released their references before
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!node->is_leaf())
+                static_cast<Inner_Node_ptr>(node)->release_children();
+            delete node;
+        }
+
+        /**
+         * Replaces the node in @a slot by a private copy if it is shared.
+         * The parent owning @a slot must not be shared.
+         */
+        static Inner_Node_ptr make_exclusive(Node_ptr *slot) {
+            Inner_Node_ptr node = static_cast<Inner_Node_ptr>(*slot);
+            if (node->_refs.load(std::memory_order_acquire) != 1) {
+                Inner_Node_ptr copy = node->clone();
+                release(node);
+                *slot = copy;
+                return copy;
+            }
+            return node;
+        }
+
+        Key transform(const value_type &__x) const {
+            return {_M_key_transform(_KeyOfValue()(__x))};
+        }
+
+        static bool same_key(const Key &lhs, const Key &rhs) {
+            return std::memcmp(lhs.chunks, rhs.chunks, sizeof(transformed_key_type)) == 0;
+        }
+
+        Const_Leaf_ptr find_leaf(const Key &key) const {
+            Const_Node_ptr node = _M_root;
+            for (unsigned depth = 0; node != nullptr && !node->is_leaf(); depth++)
+                node = static_cast<Const_Inner_Node_ptr>(node)->find(key.chunks[depth]);
+            if (node == nullptr)
+                return nullptr;
+            Const_Leaf_ptr leaf = static_cast<Const_Leaf_ptr>(node);
+            return same_key(transform(leaf->_value), key) ? leaf : nullptr;
+        }
+
+        /**
+         * Chain of node 4s down to the first byte in which the keys of
+         * @a existing and @a leaf differ, takes over the reference to @a existing.
+         */
+        Node_ptr split_leaf(Leaf_ptr existing, Leaf_ptr leaf, const Key &key, unsigned depth) const {
+            Key existing_key = transform(existing->_value);
+            unsigned mismatch = depth;
+            while (existing_key.chunks[mismatch] == key.chunks[mismatch])
+                mismatch++;
+
+            Inner_Node_ptr node = new _Node_4();
+            node->insert(existing_key.chunks[mismatch], existing);
+            node->insert(key.chunks[mismatch], leaf);
+            while (mismatch > depth) {
+                mismatch--;
+                Inner_Node_ptr parent = new _Node_4();
+                parent->insert(key.chunks[mismatch], node);
+                node = parent;
+            }
+            return node;
+        }
+
+        /**
+         * Puts @a leaf in place of the element with the same key or adds it,
+         * copying shared nodes on the way.
+         */
+        void insert_leaf(Leaf_ptr leaf) {
+            const Key key = transform(leaf->_value);
+            Node_ptr *slot = &_M_root;
+
+            for (unsigned depth = 0;; depth++) {
+                if (*slot == nullptr) {
+                    *slot = leaf;
+                    _M_count++;
+                    return;
+                }
+
+                if ((*slot)->is_leaf()) {
+                    Leaf_ptr existing = static_cast<Leaf_ptr>(*slot);
+                    if (same_key(transform(existing->_value), key)) {
+                        *slot = leaf;
+                        release(existing);
+                    } else {
+                        *slot = split_leaf(existing, leaf, key, depth);
+                        _M_count++;
+                    }
+                    return;
+                }
+
+                Inner_Node_ptr node = make_exclusive(slot);
+                Node_ptr *child_slot = node->find_slot(key.chunks[depth]);
+                if (child_slot == nullptr) {
+                    if (node->is_full()) {
+                        Inner_Node_ptr bigger = node->grow();
+                        release(node);
+                        *slot = node = bigger;
+                    }
+                    node->insert(key.chunks[depth], leaf);
+                    _M_count++;
+                    return;
+                }
+                slot = child_slot;
+            }
+        }
+
+        /**
+         * Removes the existing leaf of @a key below the inner node in @a slot,
+         * copying shared nodes on the way. Nodes left empty are removed and a
+         * node left with a single leaf is replaced by it, all the way up.
+         */
+        void erase_below(Node_ptr *slot, const Key &key, unsigned depth) {
+            Inner_Node_ptr node = make_exclusive(slot);
+            const byte key_byte = key.chunks[depth];
+            Node_ptr *child_slot = node->find_slot(key_byte);
+
+            if ((*child_slot)->is_leaf()) {
+                release(*child_slot);
+                node->erase(key_byte);
+                _M_count--;
+            } else {
+                erase_below(child_slot, key, depth + 1);
+                if (*child_slot == nullptr)
+                    node->erase(key_byte);
+            }
+
+            if (node->size() == 0) {
+                *slot = nullptr;
+                release(node);
+            } else if (node->size() == 1 && node->find(node->next(-1))->is_leaf()) {
+                Node_ptr last = node->find(node->next(-1));
+                retain(last);
+                *slot = last;
+                release(node);
+            } else if (node->size() < node->min_size()) {
+                Inner_Node_ptr smaller = node->shrink();
+                release(node);
+                *slot = smaller;
+            }
+        }
+
+    public:
+        persistent_tree() : _M_root(nullptr), _M_count(0) {}
+
+        /**
+         * Shares all nodes with @a __x, constant time.
+         */
+        persistent_tree(const persistent_tree &__x) : _M_root(__x._M_root), _M_count(__x._M_count) {
+            retain(_M_root);
+        }
+
+        persistent_tree(persistent_tree &&__x) noexcept : _M_root(__x._M_root), _M_count(__x._M_count) {
+            __x._M_root = nullptr;
+            __x._M_count = 0;
+        }
+
+        ~persistent_tree() {
+            release(_M_root);
+        }
+
+        persistent_tree &operator=(const persistent_tree &__x) {
+            retain(__x._M_root);
+            release(_M_root);
+            _M_root = __x._M_root;
+            _M_count = __x._M_count;
+            return *this;
+        }
+
+        persistent_tree &operator=(persistent_tree &&__x) noexcept {
+            std::swap(_M_root, __x._M_root);
+            std::swap(_M_count, __x._M_count);
+            return *this;
+        }
+
+        size_type size() const noexcept { return _M_count; }
+
+        bool empty() const noexcept { return _M_count == 0; }
+
+        void clear() {
+            release(_M_root);
+            _M_root = nullptr;
+            _M_count = 0;
+        }
+
+        void swap(persistent_tree &__x) noexcept {
+            std::swap(_M_root, __x._M_root);
+            std::swap(_M_count, __x._M_count);
+        }
+
+        const_iterator begin() const {
+            const_iterator it;
+            if (_M_root != nullptr)
+                it.descend_leftmost(_M_root);
+            return it;
+        }
+
+        const_iterator end() const {
+            return const_iterator();
+        }
+
+        const_iterator find(const key_type &__k) const {
+            const Key key = {_M_key_transform(__k)};
+            const_iterator it;
+            Const_Node_ptr node = _M_root;
+            for (unsigned depth = 0; node != nullptr && !node->is_leaf(); depth++) {
+                Const_Inner_Node_ptr inner = static_cast<Const_Inner_Node_ptr>(node);
+                it._path.push_back(std::make_pair(inner, (int) key.chunks[depth]));
+                node = inner->find(key.chunks[depth]);
+            }
+            if (node == nullptr || !same_key(transform(static_cast<Const_Leaf_ptr>(node)->_value), key))
+                return end();
+            it._leaf = static_cast<Const_Leaf_ptr>(node);
+            return it;
+        }
+
+        size_type count(const key_type &__k) const {
+            return find_leaf({_M_key_transform(__k)}) != nullptr ? 1 : 0;
+        }
+
+        /**
+         *  @return  The element with key @a __k or nullptr, valid until the
+         *           element is replaced or erased in this tree.
+         */
+        const value_type *find_value(const key_type &__k) const {
+            Const_Leaf_ptr leaf = find_leaf({_M_key_transform(__k)});
+            return leaf != nullptr ? &leaf->_value : nullptr;
+        }
+
+        /**
+         *  @return  Whether @a __x was inserted, nothing changes if its key exists.
+         */
+        bool insert_unique(const value_type &__x) {
+            if (find_leaf(transform(__x)) != nullptr)
+                return false;
+            insert_leaf(new _Leaf(__x));
+            return true;
+        }
+
+        /**
+         *  @return  Whether @a __x was inserted rather than assigned.
+         */
+        bool insert_or_assign(const value_type &__x) {
+            const size_type before = _M_count;
+            insert_leaf(new _Leaf(__x));
+            return _M_count != before;
+        }
+
+        size_type erase_unique(const key_type &__k) {
+            const Key key = {_M_key_transform(__k)};
+            if (find_leaf(key) == nullptr)
+                return 0;
+            if (_M_root->is_leaf()) {
+                release(_M_root);
+                _M_root = nullptr;
+                _M_count--;
+            } else {
+                erase_below(&_M_root, key, 0);
+            }
+            return 1;
+        }
+
+        /**
+         *  @return  Whether both trees share the same root, i.e. are the same version.
+         */
+        bool shares_root(const persistent_tree &__x) const noexcept {
+            return _M_root == __x._M_root;
+        }
+    };
+
+    template<typename _Key, typename _Value, typename _KeyOfValue, typename _Key_transform>
+    const byte persistent_tree<_Key, _Value, _KeyOfValue, _Key_transform>::EMPTY_MARKER = 48;
+}
+
+#endif //ART_PERSISTENT_TREE_H
@@ -2,8 +2,11 @@
 #define REFERENCE_ART_MAP_H
 
 #include <type_traits>
+#include "aggregate.h"
+#include "batch_op.h"
 #include "ar_prefix_tree.h"
 #include "ar_tree.h"
+#include "serialization.h"
 
 namespace art {
     namespace detail {
@@ -28,6 +31,12 @@ namespace art {
      *  @tparam  _Tp  Type of mapped objects.
      *  @tparam _Key_transform  Key transformation function object type,
      *                          defaults to key_transform<_Key>.
+     *  @tparam _Order_statistics  Keep the number of elements below every inner
+     *                             node, required for rank(), select(),
+     *                             count_range() and split_points().
+     *  @tparam _Aggregate  Monoid over the mapped values whose summary is kept
+     *                      in every inner node, required for aggregate().
+     *                      Defaults to no_aggregate, see aggregate.h.
      *
      *  Meets the requirements of a <a href="tables.html#65">container</a>, a
      *  <a href="tables.html#66">reversible container</a>, and an
@@ -36,7 +45,8 @@ namespace art {
      *  Maps support bidirectional iterators.
      */
     template<typename _Key, typename _T,
-            typename _Key_transform = key_transform<_Key> >
+            typename _Key_transform = key_transform<_Key>, bool _Order_statistics = false,
+            typename _Aggregate = no_aggregate>
     class radix_map {
 
     public:
@@ -51,6 +61,9 @@ namespace art {
     private:
         //typedef typename _Alloc::value_type _Alloc_value_type;
 
+        typedef typename std::conditional<std::is_same<_Aggregate, no_aggregate>::value,
+                no_aggregate, detail::mapped_aggregate<_Aggregate, value_type> >::type _Node_aggregate;
+
         /**
          * Switch between art implementation with and without path compression
          * (prefixes in nodes) based on (transformed) key length. For short keys,
@@ -58,9 +71,9 @@ namespace art {
          */
         typedef typename std::conditional<sizeof(decltype(_Key_transform()(_Key()))) <= 6,
                 ar_tree<key_type, value_type,
-                        detail::Select1st<value_type>, _Key_transform>,
+                        detail::Select1st<value_type>, _Key_transform, _Order_statistics, _Node_aggregate>,
                 ar_prefix_tree<key_type, value_type,
-                        detail::Select1st<value_type>, _Key_transform>>::type _Rep_type;
+                        detail::Select1st<value_type>, _Key_transform, _Order_statistics, _Node_aggregate>>::type _Rep_type;
 
         _Rep_type _M_t;
 
@@ -75,11 +88,13 @@ namespace art {
         typedef typename _Rep_type::difference_type difference_type;
         typedef typename _Rep_type::reverse_iterator reverse_iterator;
         typedef typename _Rep_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename _Rep_type::summary_type summary_type;
+        typedef art::batch_op<value_type> batch_op_type;
 
 
         class value_compare : public std::binary_function<value_type, value_type, bool> {
 
-            friend class radix_map<_Key, _T, _Key_transform>;
+            friend class radix_map<_Key, _T, _Key_transform, _Order_statistics, _Aggregate>;
 
         protected:
             _Key_transform key_transformer;
@@ -192,6 +207,17 @@ namespace art {
             return _M_t.max_size();
         }
 
+        /**
+         *  @brief  Returns the bytes and counts of the nodes by type, their
+         *  fill, and the distributions of leaf depths and prefix lengths.
+         *
+         *  Walks the whole tree once, in linear time in the number of
+         *  nodes. See art::memory_stats.
+         */
+        art::memory_stats memory_stats() const {
+            return _M_t.memory_usage();
+        }
+
         // Modifiers
 
         /**
@@ -286,10 +312,167 @@ namespace art {
          * in any way.
          */
         iterator erase(iterator __first, iterator __last) {
-            while (__first != __last)
-                _M_t.erase(__first++);
+            return _M_t.erase(__first, __last);
+        }
+
+        /**
+         * @brief Erases all elements with keys in [lo, hi) from a map.
+         * @param __lo  Inclusive lower bound of the keys to be erased.
+         * @param __hi  Exclusive upper bound of the keys to be erased.
+         * @return The number of erased elements.
+         *
+         * Subtrees that lie completely within the range are freed as a whole,
+         * only the nodes on the paths to the two bounds are resized. The bounds
+         * are compared by their transformed keys.
+         */
+        size_type erase_range(const key_type &__lo, const key_type &__hi) {
+            return _M_t.erase_range(__lo, __hi);
+        }
+
+        /**
+         * @brief Erases all elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         * @return The number of erased elements.
+         *
+         * For compound keys the prefix are the leading components, e.g. the first
+         * 4 bytes of a std::pair<uint32_t, uint32_t>. For strings it is the first
+         * __length characters. The matching subtree is freed as a whole.
+         */
+        size_type erase_prefix(const key_type &__k, size_type __length) {
+            return _M_t.erase_prefix(__k, __length);
+        }
+
+        /**
+         *  @brief Applies a batch of insert, assign and erase operations.
+         *  @param  __first  Forward iterator to the first batch_op_type.
+         *  @param  __last  Forward iterator past the last operation.
+         *
+         *  The operations have to be sorted in ascending order of the
+         *  transformed keys (the iteration order of the map). Operations on the
+         *  same key are applied in the given order. The tree is traversed once
+         *  for the whole batch and every touched node is resized at most once,
+         *  instead of one descent (and possibly several resizes) per operation.
+         */
+        template<typename _ForwardIterator>
+        void apply_sorted_batch(_ForwardIterator __first, _ForwardIterator __last) {
+            _M_t.apply_sorted_batch(__first, __last);
+        }
+
+        // Serialization
+
+        /**
+         *  @brief  Writes all elements to @a __os in a versioned binary format.
+         *  @throw  serialization_error  If the stream fails.
+         *
+         *  Keys (or the components of pair keys) and mapped values have to
+         *  be trivially copyable. Elements are written in iteration order,
+         *  integer keys as varint deltas to the previous key. The image can
+         *  only be loaded on a machine with the same byte order, by a map
+         *  with the same key transformation.
+         */
+        void save(std::ostream &__os) const {
+            detail::save_sorted<key_type, mapped_type>(__os, begin(), end(), size());
+        }
+
+        /**
+         *  @brief  Replaces all elements with the ones of an image written by save().
+         *  @throw  serialization_error  If the stream is not a valid image,
+         *          the map is left unchanged then.
+         *
+         *  The elements arrive in key order, so the tree is built bottom-up
+         *  with every node allocated once at its final size.
+         */
+        void load(std::istream &__is) {
+            detail::sorted_loader<key_type, mapped_type, _Key_transform> loader(__is);
+            _M_t.assign_sorted_unique(loader.begin(), loader.end());
+        }
+
+        /**
+         *  @brief  Writes a full image like save() and makes it the base of
+         *  the following incremental checkpoints.
+         *
+         *  From now on, modifications mark the inner nodes on their paths.
+         *  The flag fits into the padding of the nodes, so they do not grow.
+         */
+        void checkpoint(std::ostream &__os) {
+            save(__os);
+            _M_t.track_changes();
+        }
+
+        /**
+         *  @brief  Writes the changes since the previous checkpoint.
+         *  @throw  std::logic_error  If there is no base, see checkpoint().
+         *  @throw  serialization_error  If the stream fails, the next
+         *          checkpoint has to be a full one then.
+         *
+         *  Only subtrees that were modified are visited and written: the
+         *  region of the key space below every modified inner node, without
+         *  the inner children that were not modified. Checkpoint size and
+         *  cost grow with the number of modified keys, not with size().
+         *
+         *  Mapped values changed through references (operator[], at() or
+         *  iterators) are only written after mark_changed().
+         */
+        void checkpoint_incremental(std::ostream &__os) {
+            if (!_M_t.tracks_changes())
+                throw std::logic_error("radix_map::checkpoint_incremental without a base checkpoint");
+
+            try {
+                detail::checkpoint_writer<key_type, mapped_type> out(__os, _M_t.change_epoch() + 1, size());
+                _M_t.collect_changes([&out](const detail::key_region &region,
+                                            const std::vector<const value_type *> &values) {
+                    out.region(region, values);
+                });
+                out.finish();
+            } catch (...) {
+                _M_t.untrack_changes();
+                throw;
+            }
+        }
+
+        /**
+         *  @brief  Marks an element whose mapped value was changed in place
+         *  for the next incremental checkpoint.
+         */
+        void mark_changed(const_iterator __position) {
+            _M_t.mark_changed(__position);
+        }
+
+        /**
+         *  @brief  Loads an image written by checkpoint() (or save()) as the
+         *  base for replay().
+         *  @throw  serialization_error  If the stream is not a valid image.
+         */
+        void restore(std::istream &__is) {
+            load(__is);
+            _M_t.track_changes();
+        }
+
+        /**
+         *  @brief  Applies the next incremental checkpoint after restore().
+         *  @throw  std::logic_error  If there is no base, see restore().
+         *  @throw  serialization_error  If the checkpoint is malformed, out
+         *          of sequence or does not fit the base. The map is left in
+         *          a valid but unspecified state then.
+         *
+         *  Checkpoints have to be replayed in the order they were written.
+         *  The map can continue the chain with checkpoint_incremental().
+         */
+        void replay(std::istream &__is) {
+            if (!_M_t.tracks_changes())
+                throw std::logic_error("radix_map::replay without a restored base");
+
+            detail::checkpoint_reader<key_type, mapped_type, _Key_transform> in(__is);
+            if (in.sequence() != _M_t.change_epoch() + 1)
+                throw serialization_error("art: incremental checkpoint out of sequence");
+            while (in.next())
+                _M_t.replace_region(in.region(), in.values().begin(), in.values().end());
 
-            return __last;
+            // the replayed changes are part of the base now
+            _M_t.collect_changes([](const detail::key_region &, const std::vector<const value_type *> &) {});
+            if (size() != in.size())
+                throw serialization_error("art: incremental checkpoint does not fit the base");
         }
 
         /**
@@ -414,6 +597,122 @@ namespace art {
             return _M_t.equal_range(__k);
         }
 
+        /**
+         * @brief Finds all elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         * @return Pair of iterators delimiting the matching elements.
+         *
+         * Requires a single descent of at most __length levels instead of a
+         * lower_bound and an upper_bound lookup.
+         */
+        std::pair<iterator, iterator> prefix_range(const key_type &__k, size_type __length) {
+            return _M_t.prefix_range(__k, __length);
+        }
+
+        std::pair<const_iterator, const_iterator> prefix_range(const key_type &__k, size_type __length) const {
+            return _M_t.prefix_range(__k, __length);
+        }
+
+        /**
+         * @brief Returns the number of elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         */
+        size_type count_prefix(const key_type &__k, size_type __length) const {
+            return _M_t.count_prefix(__k, __length);
+        }
+
+        //////////////////////
+        // Order statistics //
+        //////////////////////
+
+        /**
+         *  @brief Returns the number of elements with keys less than the given key.
+         *  @param  __k  Key to be ranked, does not have to be in the map.
+         *
+         *  Only available with _Order_statistics. Requires O(k) node visits,
+         *  the element counts of all subtrees left of the search path are added up.
+         */
+        size_type rank(const key_type &__k) const {
+            return _M_t.rank(__k);
+        }
+
+        /**
+         *  @brief Finds the element with the given rank.
+         *  @param  __rank  Zero-based position of the element in iteration order.
+         *  @return Iterator pointing to the element or end() if __rank >= size().
+         *
+         *  Only available with _Order_statistics. Requires O(k) node visits.
+         */
+        iterator select(size_type __rank) {
+            return _M_t.select(__rank);
+        }
+
+        const_iterator select(size_type __rank) const {
+            return _M_t.select(__rank);
+        }
+
+        /**
+         *  @brief Returns the number of elements with keys in [lo, hi).
+         *
+         *  Only available with _Order_statistics. Unlike
+         *  std::distance(lower_bound(lo), lower_bound(hi)) the elements in the
+         *  range are not iterated.
+         */
+        size_type count_range(const key_type &__lo, const key_type &__hi) const {
+            return _M_t.count_range(__lo, __hi);
+        }
+
+        /**
+         *  @brief Returns keys that partition the map into ranges of equal size.
+         *  @param  __parts  Number of ranges.
+         *  @return At most __parts - 1 ascending keys. The i-th range starts at
+         *          the (i-1)-th key (begin() for the first range) and ends before
+         *          the i-th key (end() for the last range).
+         *
+         *  Only available with _Order_statistics. Useful to split work on the
+         *  map between threads.
+         */
+        std::vector<key_type> split_points(size_type __parts) const {
+            return _M_t.split_points(__parts);
+        }
+
+        //////////////////////
+        // Range aggregates //
+        //////////////////////
+
+        /**
+         *  @brief Combines the mapped values of all elements with keys in [lo, hi).
+         *  @return The summary of the range, _Aggregate::identity() if it is empty.
+         *
+         *  Only available with an _Aggregate. Subtrees within the range
+         *  contribute the summary stored in their root, only the nodes on the
+         *  paths to lo and hi are descended, O(k) node visits.
+         */
+        summary_type aggregate(const key_type &__lo, const key_type &__hi) const {
+            return _M_t.aggregate(__lo, __hi);
+        }
+
+        /**
+         *  @brief Combines the mapped values of all elements.
+         */
+        summary_type aggregate() const {
+            return _M_t.aggregate();
+        }
+
+        /**
+         *  @brief Updates the summaries after the mapped value of an element was changed.
+         *  @param  __position  Iterator pointing to the changed element.
+         *
+         *  insert, emplace, erase and apply_sorted_batch keep the summaries up
+         *  to date. Mapped values changed through references (operator[], at()
+         *  or iterators) are only reflected in aggregate() after this call.
+         */
+        void refresh_aggregate(const_iterator __position) {
+            _M_t.refresh_aggregate(__position);
+        }
+
         // Iterators
 
         /**
@@ -534,13 +833,13 @@ namespace art {
             return value_compare(_M_t.key_trans());
         }
 
-        template<typename _K1, typename _T1, typename _C1>
-        friend bool operator==(const radix_map<_K1, _T1, _C1> &,
-                               const radix_map<_K1, _T1, _C1> &);
+        template<typename _K1, typename _T1, typename _C1, bool _O1, typename _A1>
+        friend bool operator==(const radix_map<_K1, _T1, _C1, _O1, _A1> &,
+                               const radix_map<_K1, _T1, _C1, _O1, _A1> &);
 
-        template<typename _K1, typename _T1, typename _C1>
-        friend bool operator<(const radix_map<_K1, _T1, _C1> &,
-                              const radix_map<_K1, _T1, _C1> &);
+        template<typename _K1, typename _T1, typename _C1, bool _O1, typename _A1>
+        friend bool operator<(const radix_map<_K1, _T1, _C1, _O1, _A1> &,
+                              const radix_map<_K1, _T1, _C1, _O1, _A1> &);
     };
 
     // Relational Operators
@@ -555,10 +854,11 @@ namespace art {
      *  maps.  Maps are considered equivalent if their sizes are equal,
      *  and if corresponding elements compare equal.
     */
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator==(const radix_map<_Key, _Tp, _Key_transform> &__x,
-               const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator==(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __x._M_t == __y._M_t;
     }
 
@@ -573,50 +873,56 @@ namespace art {
      *
      *  See std::lexicographical_compare() for how the determination is made.
     */
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator<(const radix_map<_Key, _Tp, _Key_transform> &__x,
-              const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator<(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __x._M_t < __y._M_t;
     }
 
     // Based on operator==
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator!=(const radix_map<_Key, _Tp, _Key_transform> &__x,
-               const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator!=(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__x == __y);
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator>(const radix_map<_Key, _Tp, _Key_transform> &__x,
-              const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator>(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __y < __x;
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator<=(const radix_map<_Key, _Tp, _Key_transform> &__x,
-               const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator<=(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__y < __x);
     }
 
     // Based on operator<
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline bool
-    operator>=(const radix_map<_Key, _Tp, _Key_transform> &__x,
-               const radix_map<_Key, _Tp, _Key_transform> &__y) {
+    operator>=(const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__x < __y);
     }
 
     // See radix_map::swap()
-    template<typename _Key, typename _Tp, typename _Key_transform>
+    template<typename _Key, typename _Tp, typename _Key_transform, bool _Order_statistics,
+            typename _Aggregate>
     inline void
-    swap(radix_map<_Key, _Tp, _Key_transform> &__x,
-         radix_map<_Key, _Tp, _Key_transform> &__y) {
+    swap(radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__x,
+         radix_map<_Key, _Tp, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         __x.swap(__y);
     }
 }
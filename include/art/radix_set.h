@@ -4,6 +4,7 @@
 #include <type_traits>
 #include "art/ar_prefix_tree.h"
 #include "art/ar_tree.h"
+#include "art/serialization.h"
 
 namespace art {
     namespace detail {
@@ -27,6 +28,12 @@ namespace art {
      *  @tparam _Key  Type of key objects.
      *  @tparam _Key_transform  Key transformation function object type,
      *                          defaults to key_transform<_Key>.
+     *  @tparam _Order_statistics  Keep the number of elements below every inner
+     *                             node, required for rank(), select(),
+     *                             count_range() and split_points().
+     *  @tparam _Aggregate  Monoid over the keys whose summary is kept in every
+     *                      inner node, required for aggregate(). Defaults to
+     *                      no_aggregate, see aggregate.h.
      *
      * Meets the requirements of a <a href="tables.html#65">container</a>, a
      *  <a href="tables.html#66">reversible container</a>, and an
@@ -35,7 +42,8 @@ namespace art {
      *  Sets support bidirectional iterators.
      */
     template<typename _Key,
-            typename _Key_transform = key_transform<_Key> >
+            typename _Key_transform = key_transform<_Key>, bool _Order_statistics = false,
+            typename _Aggregate = no_aggregate>
     class radix_set {
     public:
         typedef _Key key_type;
@@ -52,9 +60,9 @@ namespace art {
          */
         typedef typename std::conditional<sizeof(decltype(_Key_transform()(_Key()))) <= 6,
                 ar_tree<key_type, value_type,
-                        detail::Identity<value_type>, _Key_transform>,
+                        detail::Identity<value_type>, _Key_transform, _Order_statistics, _Aggregate>,
                 ar_prefix_tree<key_type, value_type,
-                        detail::Identity<value_type>, _Key_transform>>::type _Rep_type;
+                        detail::Identity<value_type>, _Key_transform, _Order_statistics, _Aggregate>>::type _Rep_type;
 
         _Rep_type _M_t;
 
@@ -66,6 +74,7 @@ namespace art {
         typedef typename _Rep_type::difference_type difference_type;
         typedef typename _Rep_type::reverse_iterator reverse_iterator;
         typedef typename _Rep_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename _Rep_type::summary_type summary_type;
 
         /**
          * @brief  Default constructor creates no elements.
@@ -156,6 +165,17 @@ namespace art {
             return _M_t.max_size();
         }
 
+        /**
+         *  @brief  Returns the bytes and counts of the nodes by type, their
+         *  fill, and the distributions of leaf depths and prefix lengths.
+         *
+         *  Walks the whole tree once, in linear time in the number of
+         *  nodes. See art::memory_stats.
+         */
+        art::memory_stats memory_stats() const {
+            return _M_t.memory_usage();
+        }
+
         // Modifiers
 
         /**
@@ -163,6 +183,85 @@ namespace art {
          */
         void clear() { _M_t.clear(); }
 
+        /**
+         *  @brief  Writes all elements to @a __os in a versioned binary format.
+         *  @throw  serialization_error  If the stream fails.
+         *
+         *  Keys (or the components of pair keys) have to be trivially
+         *  copyable, see radix_map::save().
+         */
+        void save(std::ostream &__os) const {
+            detail::save_sorted<key_type, void>(__os, begin(), end(), size());
+        }
+
+        /**
+         *  @brief  Replaces all elements with the ones of an image written by save().
+         *  @throw  serialization_error  If the stream is not a valid image,
+         *          the set is left unchanged then.
+         */
+        void load(std::istream &__is) {
+            detail::sorted_loader<key_type, void, _Key_transform> loader(__is);
+            _M_t.assign_sorted_unique(loader.begin(), loader.end());
+        }
+
+        /**
+         *  @brief  Writes a full image like save() and makes it the base of
+         *  the following incremental checkpoints, see radix_map::checkpoint().
+         */
+        void checkpoint(std::ostream &__os) {
+            save(__os);
+            _M_t.track_changes();
+        }
+
+        /**
+         *  @brief  Writes the changes since the previous checkpoint, see
+         *  radix_map::checkpoint_incremental().
+         */
+        void checkpoint_incremental(std::ostream &__os) {
+            if (!_M_t.tracks_changes())
+                throw std::logic_error("radix_set::checkpoint_incremental without a base checkpoint");
+
+            try {
+                detail::checkpoint_writer<key_type, void> out(__os, _M_t.change_epoch() + 1, size());
+                _M_t.collect_changes([&out](const detail::key_region &region,
+                                            const std::vector<const key_type *> &values) {
+                    out.region(region, values);
+                });
+                out.finish();
+            } catch (...) {
+                _M_t.untrack_changes();
+                throw;
+            }
+        }
+
+        /**
+         *  @brief  Loads an image written by checkpoint() (or save()) as the
+         *  base for replay().
+         */
+        void restore(std::istream &__is) {
+            load(__is);
+            _M_t.track_changes();
+        }
+
+        /**
+         *  @brief  Applies the next incremental checkpoint after restore(),
+         *  see radix_map::replay().
+         */
+        void replay(std::istream &__is) {
+            if (!_M_t.tracks_changes())
+                throw std::logic_error("radix_set::replay without a restored base");
+
+            detail::checkpoint_reader<key_type, void, _Key_transform> in(__is);
+            if (in.sequence() != _M_t.change_epoch() + 1)
+                throw serialization_error("art: incremental checkpoint out of sequence");
+            while (in.next())
+                _M_t.replace_region(in.region(), in.values().begin(), in.values().end());
+
+            _M_t.collect_changes([](const detail::key_region &, const std::vector<const key_type *> &) {});
+            if (size() != in.size())
+                throw serialization_error("art: incremental checkpoint does not fit the base");
+        }
+
         /**
          *  @brief Attempts to insert an element into the set.
 
@@ -250,10 +349,35 @@ namespace art {
          * in any way.
          */
         iterator erase(iterator __first, iterator __last) {
-            while (__first != __last)
-                _M_t.erase(__first++);
+            return _M_t.erase(__first, __last);
+        }
 
-            return __last;
+        /**
+         * @brief Erases all elements with keys in [lo, hi) from a set.
+         * @param __lo  Inclusive lower bound of the keys to be erased.
+         * @param __hi  Exclusive upper bound of the keys to be erased.
+         * @return The number of erased elements.
+         *
+         * Subtrees that lie completely within the range are freed as a whole,
+         * only the nodes on the paths to the two bounds are resized. The bounds
+         * are compared by their transformed keys.
+         */
+        size_type erase_range(const key_type &__lo, const key_type &__hi) {
+            return _M_t.erase_range(__lo, __hi);
+        }
+
+        /**
+         * @brief Erases all elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         * @return The number of erased elements.
+         *
+         * For compound keys the prefix are the leading components, e.g. the first
+         * 4 bytes of a std::pair<uint32_t, uint32_t>. For strings it is the first
+         * __length characters. The matching subtree is freed as a whole.
+         */
+        size_type erase_prefix(const key_type &__k, size_type __length) {
+            return _M_t.erase_prefix(__k, __length);
         }
 
         /**
@@ -338,6 +462,110 @@ namespace art {
             return _M_t.equal_range(__k);
         }
 
+        /**
+         * @brief Finds all elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         * @return Pair of iterators delimiting the matching elements.
+         *
+         * Requires a single descent of at most __length levels instead of a
+         * lower_bound and an upper_bound lookup.
+         */
+        std::pair<iterator, iterator> prefix_range(const key_type &__k, size_type __length) {
+            return _M_t.prefix_range(__k, __length);
+        }
+
+        std::pair<const_iterator, const_iterator> prefix_range(const key_type &__k, size_type __length) const {
+            return _M_t.prefix_range(__k, __length);
+        }
+
+        /**
+         * @brief Returns the number of elements whose keys share a prefix with the given key.
+         * @param __k  Key whose transformed form starts with the prefix.
+         * @param __length  Number of leading bytes of the transformed key that have to match.
+         */
+        size_type count_prefix(const key_type &__k, size_type __length) const {
+            return _M_t.count_prefix(__k, __length);
+        }
+
+        //////////////////////
+        // Order statistics //
+        //////////////////////
+
+        /**
+         *  @brief Returns the number of elements with keys less than the given key.
+         *  @param  __k  Key to be ranked, does not have to be in the set.
+         *
+         *  Only available with _Order_statistics. Requires O(k) node visits,
+         *  the element counts of all subtrees left of the search path are added up.
+         */
+        size_type rank(const key_type &__k) const {
+            return _M_t.rank(__k);
+        }
+
+        /**
+         *  @brief Finds the element with the given rank.
+         *  @param  __rank  Zero-based position of the element in iteration order.
+         *  @return Iterator pointing to the element or end() if __rank >= size().
+         *
+         *  Only available with _Order_statistics. Requires O(k) node visits.
+         */
+        iterator select(size_type __rank) {
+            return _M_t.select(__rank);
+        }
+
+        const_iterator select(size_type __rank) const {
+            return _M_t.select(__rank);
+        }
+
+        /**
+         *  @brief Returns the number of elements with keys in [lo, hi).
+         *
+         *  Only available with _Order_statistics. Unlike
+         *  std::distance(lower_bound(lo), lower_bound(hi)) the elements in the
+         *  range are not iterated.
+         */
+        size_type count_range(const key_type &__lo, const key_type &__hi) const {
+            return _M_t.count_range(__lo, __hi);
+        }
+
+        /**
+         *  @brief Returns keys that partition the set into ranges of equal size.
+         *  @param  __parts  Number of ranges.
+         *  @return At most __parts - 1 ascending keys. The i-th range starts at
+         *          the (i-1)-th key (begin() for the first range) and ends before
+         *          the i-th key (end() for the last range).
+         *
+         *  Only available with _Order_statistics. Useful to split work on the
+         *  set between threads.
+         */
+        std::vector<key_type> split_points(size_type __parts) const {
+            return _M_t.split_points(__parts);
+        }
+
+        //////////////////////
+        // Range aggregates //
+        //////////////////////
+
+        /**
+         *  @brief Combines the keys of all elements with keys in [lo, hi).
+         *  @return The summary of the range, _Aggregate::identity() if it is empty.
+         *
+         *  Only available with an _Aggregate. Subtrees within the range
+         *  contribute the summary stored in their root, only the nodes on the
+         *  paths to lo and hi are descended, O(k) node visits.
+         */
+        summary_type aggregate(const key_type &__lo, const key_type &__hi) const {
+            return _M_t.aggregate(__lo, __hi);
+        }
+
+        /**
+         *  @brief Combines the keys of all elements.
+         */
+        summary_type aggregate() const {
+            return _M_t.aggregate();
+        }
+
         // Iterators
 
         /**
@@ -458,13 +686,13 @@ namespace art {
             return _M_t.key_trans();
         }
 
-        template<typename _K1, typename _T1>
-        friend bool operator==(const radix_set<_K1, _T1> &,
-                               const radix_set<_K1, _T1> &);
+        template<typename _K1, typename _T1, bool _O1, typename _A1>
+        friend bool operator==(const radix_set<_K1, _T1, _O1, _A1> &,
+                               const radix_set<_K1, _T1, _O1, _A1> &);
 
-        template<typename _K1, typename _T1>
-        friend bool operator<(const radix_set<_K1, _T1> &,
-                              const radix_set<_K1, _T1> &);
+        template<typename _K1, typename _T1, bool _O1, typename _A1>
+        friend bool operator<(const radix_set<_K1, _T1, _O1, _A1> &,
+                              const radix_set<_K1, _T1, _O1, _A1> &);
     };
 
     // Relational Operators
@@ -479,10 +707,10 @@ namespace art {
      *  sets.  Sets are considered equivalent if their sizes are equal,
      *  and if corresponding elements compare equal.
     */
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator==(const radix_set<_Key, _Key_transform> &__x,
-               const radix_set<_Key, _Key_transform> &__y) {
+    operator==(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __x._M_t == __y._M_t;
     }
 
@@ -497,50 +725,50 @@ namespace art {
      *
      *  See std::lexicographical_compare() for how the determination is made.
     */
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator<(const radix_set<_Key, _Key_transform> &__x,
-              const radix_set<_Key, _Key_transform> &__y) {
+    operator<(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __x._M_t < __y._M_t;
     }
 
     // Based on operator==
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator!=(const radix_set<_Key, _Key_transform> &__x,
-               const radix_set<_Key, _Key_transform> &__y) {
+    operator!=(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__x == __y);
     }
 
     // Based on operator<
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator>(const radix_set<_Key, _Key_transform> &__x,
-              const radix_set<_Key, _Key_transform> &__y) {
+    operator>(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+              const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return __y < __x;
     }
 
     // Based on operator<
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator<=(const radix_set<_Key, _Key_transform> &__x,
-               const radix_set<_Key, _Key_transform> &__y) {
+    operator<=(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__y < __x);
     }
 
     // Based on operator<
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline bool
-    operator>=(const radix_set<_Key, _Key_transform> &__x,
-               const radix_set<_Key, _Key_transform> &__y) {
+    operator>=(const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+               const radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         return !(__x < __y);
     }
 
     // See radix_set::swap()
-    template<typename _Key, typename _Key_transform>
+    template<typename _Key, typename _Key_transform, bool _Order_statistics, typename _Aggregate>
     inline void
-    swap(radix_set<_Key, _Key_transform> &__x,
-         radix_set<_Key, _Key_transform> &__y) {
+    swap(radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__x,
+         radix_set<_Key, _Key_transform, _Order_statistics, _Aggregate> &__y) {
         __x.swap(__y);
     }
 }
@@ -0,0 +1,183 @@
+#ifndef ART_RECORDING_RADIX_MAP_H
+#define ART_RECORDING_RADIX_MAP_H
+
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include "trace.h"
+
+namespace art {
+    /**
+     * @brief A radix_map or radix_set that writes the keys of its lookups and
+     * modifications to a trace, which the replay benchmark runs against
+     * radix_map and the other containers.
+     *
+     * The trace starts with a trace_op::load record per element the map
+     * holds at construction, then has one record per call of find, insert,
+     * erase, lower_bound and scan, in call order. Values are not recorded,
+     * so traces of maps with confidential values can be shared. Iteration
+     * apart from scan() and operations on map() are not recorded.
+     *
+     * Records are buffered, see flush(). Since lookups write to the trace
+     * too they are non-const, and a recording map must not be used from
+     * several threads at once.
+     *
+     * @tparam _Map  radix_map or radix_set
+     */
+    template<typename _Map>
+    class recording_radix_map {
+    public:
+        typedef _Map map_type;
+        typedef typename _Map::key_type key_type;
+        typedef typename _Map::value_type value_type;
+        typedef typename _Map::size_type size_type;
+        typedef typename _Map::iterator iterator;
+        typedef typename _Map::const_iterator const_iterator;
+
+    private:
+        _Map _M_map;
+        trace_writer<key_type> _M_trace;
+
+        static const key_type &key_of(const value_type &__x, std::true_type) {
+            return __x;
+        }
+
+        template<typename _Pair>
+        static const key_type &key_of(const _Pair &__x, std::false_type) {
+            return __x.first;
+        }
+
+        static const key_type &key_of(const value_type &__x) {
+            return key_of(__x, std::is_same<key_type, value_type>());
+        }
+
+    public:
+        /**
+         * @brief Creates an empty map that writes its trace to @a __os.
+         * @throw  serialization_error  If writing the trace header fails.
+         */
+        explicit recording_radix_map(std::ostream &__os) : _M_trace(__os) {}
+
+        /**
+         * @brief Creates a map with the elements of @a __map, which the trace
+         * starts with as trace_op::load records.
+         * @throw  serialization_error  If writing the trace fails.
+         */
+        recording_radix_map(_Map __map, std::ostream &__os) : _M_map(std::move(__map)), _M_trace(__os) {
+            for (const value_type &x : _M_map)
+                _M_trace.record(trace_op::load, key_of(x));
+        }
+
+        recording_radix_map(const recording_radix_map &) = delete;
+
+        recording_radix_map &operator=(const recording_radix_map &) = delete;
+
+        /**
+         * Returns the underlying map, operations on it are not recorded.
+         */
+        _Map &map() noexcept {
+            return _M_map;
+        }
+
+        const _Map &map() const noexcept {
+            return _M_map;
+        }
+
+        /**
+         * Returns the number of records written so far, including loads.
+         */
+        uint64_t records() const noexcept {
+            return _M_trace.records();
+        }
+
+        /**
+         * @brief Writes the buffered records to the stream.
+         * @throw  serialization_error  If the stream fails.
+         */
+        void flush() {
+            _M_trace.flush();
+        }
+
+        /**
+         * @brief Ends the trace, the destructor does so if it was not called.
+         * No operations may be recorded afterwards.
+         * @throw  serialization_error  If the stream fails.
+         */
+        void close() {
+            _M_trace.close();
+        }
+
+        // Capacity
+
+        bool empty() const noexcept {
+            return _M_map.empty();
+        }
+
+        size_type size() const noexcept {
+            return _M_map.size();
+        }
+
+        // Modifiers
+
+        std::pair<iterator, bool> insert(const value_type &__x) {
+            _M_trace.record(trace_op::insert, key_of(__x));
+            return _M_map.insert(__x);
+        }
+
+        size_type erase(const key_type &__k) {
+            _M_trace.record(trace_op::erase, __k);
+            return _M_map.erase(__k);
+        }
+
+        // Lookup
+
+        iterator find(const key_type &__k) {
+            _M_trace.record(trace_op::find, __k);
+            return _M_map.find(__k);
+        }
+
+        iterator lower_bound(const key_type &__k) {
+            _M_trace.record(trace_op::lower_bound, __k);
+            return _M_map.lower_bound(__k);
+        }
+
+        /**
+         * @brief Calls @a __f with up to @a __length elements in key order,
+         * starting at lower_bound(@a __k).
+         * @return  The number of elements visited.
+         */
+        template<typename _F>
+        size_type scan(const key_type &__k, size_type __length, _F __f) {
+            _M_trace.record(trace_op::scan, __k, __length);
+            const _Map &m = _M_map;
+            size_type visited = 0;
+            for (const_iterator it = m.lower_bound(__k); visited < __length && it != m.end(); ++it) {
+                __f(*it);
+                visited++;
+            }
+            return visited;
+        }
+
+        // Iterators, not recorded
+
+        iterator begin() noexcept {
+            return _M_map.begin();
+        }
+
+        const_iterator begin() const noexcept {
+            return _M_map.begin();
+        }
+
+        iterator end() noexcept {
+            return _M_map.end();
+        }
+
+        const_iterator end() const noexcept {
+            return _M_map.end();
+        }
+    };
+}
+
+#endif //ART_RECORDING_RADIX_MAP_H
@@ -0,0 +1,85 @@
+#ifndef ART_RW_LOCK_H
+#define ART_RW_LOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace art {
+    namespace detail {
+        /**
+         * @brief Reader-writer spin lock, C++11 has no std::shared_mutex.
+         *
+         * Writers are preferred: a waiting writer keeps new readers out, so a
+         * steady stream of readers cannot starve it. Meets the Lockable and
+         * SharedLockable requirements (lock/unlock, lock_shared/unlock_shared).
+         */
+        class rw_lock {
+            static const uint32_t WRITER = 1u << 31;
+            static const uint32_t WRITER_WAITING = 1u << 30;
+            // the lower bits count the readers
+
+            std::atomic<uint32_t> _state;
+
+        public:
+            rw_lock() : _state(0) {}
+
+            rw_lock(const rw_lock &) = delete;
+
+            rw_lock &operator=(const rw_lock &) = delete;
+
+            void lock() {
+                while (true) {
+                    uint32_t state = _state.load(std::memory_order_relaxed);
+                    if ((state & ~WRITER_WAITING) == 0) {
+                        if (_state.compare_exchange_weak(state, WRITER, std::memory_order_acquire))
+                            return;
+                        continue;
+                    }
+                    if (!(state & WRITER_WAITING))
+                        _state.fetch_or(WRITER_WAITING, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+            }
+
+            void unlock() {
+                // keeps the waiting flag of other writers
+                _state.fetch_and(~WRITER, std::memory_order_release);
+            }
+
+            void lock_shared() {
+                while (true) {
+                    uint32_t state = _state.load(std::memory_order_relaxed);
+                    if (!(state & (WRITER | WRITER_WAITING))) {
+                        if (_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+                            return;
+                        continue;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+
+            void unlock_shared() {
+                _state.fetch_sub(1, std::memory_order_release);
+            }
+        };
+
+        /**
+         * @brief RAII shared ownership of an rw_lock, std::shared_lock is C++14.
+         */
+        class shared_guard {
+            rw_lock &_lock;
+
+        public:
+            explicit shared_guard(rw_lock &lock) : _lock(lock) { _lock.lock_shared(); }
+
+            shared_guard(const shared_guard &) = delete;
+
+            shared_guard &operator=(const shared_guard &) = delete;
+
+            ~shared_guard() { _lock.unlock_shared(); }
+        };
+    }
+}
+
+#endif //ART_RW_LOCK_H
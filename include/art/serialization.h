@@ -0,0 +1,635 @@
+#ifndef ART_SERIALIZATION_H
+#define ART_SERIALIZATION_H
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "key_region.h"
+#include "key_transform.h"
+
+namespace art {
+    /**
+     * @brief Thrown by load() for streams that are not a valid image of the container.
+     */
+    struct serialization_error : public std::runtime_error {
+        explicit serialization_error(const char *what) : std::runtime_error(what) {}
+    };
+
+    namespace detail {
+        /*
+         * Binary format, version 1 (all header integers little endian):
+         *
+         *   "ART" 0x00           magic
+         *   uint16  version
+         *   uint8   is_set       1 for radix_set, 0 for radix_map
+         *   uint8   encoding     0: raw key bytes, 1: varint deltas of integer keys
+         *   uint8   little_endian  byte order of raw keys and mapped values
+         *   uint8   reserved[3]
+         *   uint32  sizeof(key_type)
+         *   uint32  sizeof(mapped_type), 0 for sets
+         *   uint64  number of elements
+         *
+         * followed by the elements in the order of their transformed keys: the
+         * key, then for maps the raw bytes of the mapped value. Integer keys are
+         * stored as the LEB128 varint of the difference to the previous key
+         * (the first one relative to the smallest value of the type), other keys
+         * as raw bytes, pairs component by component. Sorted order lets load() build the tree bottom-up.
+         *
+         * Incremental checkpoints share the header up to the value size, with
+         * the magic "ART" 0x01, followed by
+         *
+         *   uint64  sequence number, 1 for the first checkpoint after the image
+         *   uint64  number of elements after replaying it
+         *
+         * and the modified regions (see key_region), each as
+         *
+         *   uint8   1
+         *   varint  slot length, varint prefix length
+         *   bytes   transformed key prefix
+         *   uint8   kept key bytes[32], a bitmap
+         *   varint  number of elements, then the elements as above with the
+         *           key deltas restarting at every region
+         *
+         * terminated by a uint8 0.
+         */
+        const char SERIALIZATION_MAGIC[4] = {'A', 'R', 'T', '\0'};
+        const char CHECKPOINT_MAGIC[4] = {'A', 'R', 'T', '\1'};
+        const uint16_t SERIALIZATION_VERSION = 1;
+
+        enum class key_encoding : uint8_t {
+            raw = 0, delta_varint = 1
+        };
+
+        /**
+         * @brief Buffers small writes to an ostream.
+         */
+        class stream_writer {
+            static const size_t BUFFER_SIZE = 1 << 16;
+
+            std::ostream &_os;
+            std::vector<char> _buffer;
+
+        public:
+            explicit stream_writer(std::ostream &os) : _os(os) {
+                _buffer.reserve(BUFFER_SIZE);
+            }
+
+            void put(const void *data, size_t size) {
+                const char *bytes = static_cast<const char *>(data);
+                _buffer.insert(_buffer.end(), bytes, bytes + size);
+                if (_buffer.size() >= BUFFER_SIZE)
+                    flush();
+            }
+
+            template<typename _Tp>
+            void put_le(_Tp value) {
+                for (size_t i = 0; i < sizeof(_Tp); i++) {
+                    char b = static_cast<char>((value >> (8 * i)) & 0xFF);
+                    put(&b, 1);
+                }
+            }
+
+            void put_varint(uint64_t value) {
+                char bytes[10];
+                size_t size = 0;
+                while (value >= 0x80) {
+                    bytes[size++] = static_cast<char>((value & 0x7F) | 0x80);
+                    value >>= 7;
+                }
+                bytes[size++] = static_cast<char>(value);
+                put(bytes, size);
+            }
+
+            void flush() {
+                _os.write(_buffer.data(), _buffer.size());
+                _buffer.clear();
+                if (!_os)
+                    throw serialization_error("art: writing the stream failed");
+            }
+        };
+
+        /**
+         * @brief Buffers small reads from an istream.
+         */
+        class stream_reader {
+            static const size_t BUFFER_SIZE = 1 << 16;
+
+            std::istream &_is;
+            std::vector<char> _buffer;
+            size_t _pos = 0;
+            size_t _end = 0;
+
+            void fill() {
+                _is.read(_buffer.data(), _buffer.size());
+                _pos = 0;
+                _end = static_cast<size_t>(_is.gcount());
+                if (_end == 0)
+                    throw serialization_error("art: unexpected end of stream");
+            }
+
+        public:
+            explicit stream_reader(std::istream &is) : _is(is), _buffer(BUFFER_SIZE) {}
+
+            void get(void *data, size_t size) {
+                char *bytes = static_cast<char *>(data);
+                if (size <= _end - _pos) {
+                    std::memcpy(bytes, _buffer.data() + _pos, size);
+                    _pos += size;
+                    return;
+                }
+                while (size > 0) {
+                    if (_pos == _end)
+                        fill();
+                    size_t chunk = std::min(size, _end - _pos);
+                    std::memcpy(bytes, _buffer.data() + _pos, chunk);
+                    _pos += chunk;
+                    bytes += chunk;
+                    size -= chunk;
+                }
+            }
+
+            template<typename _Tp>
+            _Tp get_le() {
+                _Tp value = 0;
+                for (size_t i = 0; i < sizeof(_Tp); i++) {
+                    unsigned char b;
+                    get(&b, 1);
+                    value |= static_cast<_Tp>(b) << (8 * i);
+                }
+                return value;
+            }
+
+            uint64_t get_varint() {
+                uint64_t value = 0;
+                if (_end - _pos >= 10) {
+                    // the whole varint is buffered, no need to check for refills
+                    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_buffer.data() + _pos);
+                    for (unsigned i = 0; i < 10; i++) {
+                        value |= static_cast<uint64_t>(bytes[i] & 0x7F) << (7 * i);
+                        if (!(bytes[i] & 0x80)) {
+                            _pos += i + 1;
+                            return value;
+                        }
+                    }
+                    throw serialization_error("art: malformed varint");
+                }
+                for (unsigned shift = 0; shift < 64; shift += 7) {
+                    if (_pos == _end)
+                        fill();
+                    const unsigned char b = static_cast<unsigned char>(_buffer[_pos++]);
+                    value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80))
+                        return value;
+                }
+                throw serialization_error("art: malformed varint");
+            }
+        };
+
+        /**
+         * @brief Whether objects of a type can be stored in and read back from
+         * raw bytes: trivially copyable types and pairs of them.
+         */
+        template<typename _Tp>
+        struct is_raw_storable : std::is_trivially_copyable<_Tp> {};
+
+        template<typename _T1, typename _T2>
+        struct is_raw_storable<std::pair<_T1, _T2> >
+                : std::integral_constant<bool, is_raw_storable<typename std::remove_const<_T1>::type>::value &&
+                                               is_raw_storable<typename std::remove_const<_T2>::type>::value> {};
+
+        /**
+         * @brief Writes trivially copyable objects as raw bytes, pairs
+         * (the compound keys of key_transform) component by component.
+         */
+        template<typename _Tp>
+        struct raw_codec {
+            static_assert(std::is_trivially_copyable<_Tp>::value,
+                          "serialization requires trivially copyable keys (or pairs of them)");
+
+            static void encode(stream_writer &out, const _Tp &x) {
+                out.put(&x, sizeof(_Tp));
+            }
+
+            static _Tp decode(stream_reader &in) {
+                _Tp x;
+                in.get(&x, sizeof(_Tp));
+                return x;
+            }
+        };
+
+        template<typename _T1, typename _T2>
+        struct raw_codec<std::pair<_T1, _T2> > {
+            static void encode(stream_writer &out, const std::pair<_T1, _T2> &x) {
+                raw_codec<_T1>::encode(out, x.first);
+                raw_codec<_T2>::encode(out, x.second);
+            }
+
+            static std::pair<_T1, _T2> decode(stream_reader &in) {
+                _T1 first = raw_codec<_T1>::decode(in);
+                return std::pair<_T1, _T2>(first, raw_codec<_T2>::decode(in));
+            }
+        };
+
+        /**
+         * @brief Encodes keys as raw bytes.
+         */
+        template<typename _Key, bool = std::is_integral<_Key>::value && !std::is_same<_Key, bool>::value>
+        struct key_codec {
+            static const key_encoding encoding = key_encoding::raw;
+
+            void encode(stream_writer &out, const _Key &key) {
+                raw_codec<_Key>::encode(out, key);
+            }
+
+            _Key decode(stream_reader &in) {
+                return raw_codec<_Key>::decode(in);
+            }
+        };
+
+        /**
+         * @brief Encodes integer keys as varint deltas to the previous key.
+         *
+         * Keys arrive in increasing order, the difference is taken modulo 2^n,
+         * so even a key_transform that orders them differently round-trips.
+         */
+        template<typename _Key>
+        struct key_codec<_Key, true> {
+            typedef typename std::make_unsigned<_Key>::type unsigned_type;
+
+            static const key_encoding encoding = key_encoding::delta_varint;
+
+            unsigned_type _previous = static_cast<unsigned_type>(std::numeric_limits<_Key>::min());
+
+            void encode(stream_writer &out, const _Key &key) {
+                const unsigned_type value = static_cast<unsigned_type>(key);
+                out.put_varint(static_cast<unsigned_type>(value - _previous));
+                _previous = value;
+            }
+
+            _Key decode(stream_reader &in) {
+                _previous = static_cast<unsigned_type>(_previous + static_cast<unsigned_type>(in.get_varint()));
+                return static_cast<_Key>(_previous);
+            }
+        };
+
+        /**
+         * @brief Element layout of maps, sets use _Mapped = void.
+         */
+        template<typename _Key, typename _Mapped>
+        struct record_traits {
+            static_assert(std::is_trivially_copyable<_Mapped>::value,
+                          "serialization requires a trivially copyable mapped type");
+
+            typedef std::pair<const _Key, _Mapped> value_type;
+
+            static const bool is_set = false;
+
+            static const _Key &key(const value_type &__x) { return __x.first; }
+
+            static void write_mapped(stream_writer &out, const value_type &__x) {
+                out.put(&__x.second, sizeof(_Mapped));
+            }
+
+            static value_type read(const _Key &key, stream_reader &in) {
+                _Mapped mapped;
+                in.get(&mapped, sizeof(_Mapped));
+                return value_type(key, mapped);
+            }
+
+            static uint32_t mapped_size() { return sizeof(_Mapped); }
+        };
+
+        template<typename _Key>
+        struct record_traits<_Key, void> {
+            typedef _Key value_type;
+
+            static const bool is_set = true;
+
+            static const _Key &key(const value_type &__x) { return __x; }
+
+            static void write_mapped(stream_writer &, const value_type &) {}
+
+            static value_type read(const _Key &key, stream_reader &) { return key; }
+
+            static uint32_t mapped_size() { return 0; }
+        };
+
+        /**
+         * @brief Lexicographic comparison of transformed keys. Neighbours in
+         * key order share long prefixes, an inline loop beats calling memcmp.
+         */
+        inline bool bytes_less(const void *a, const void *b, size_t size) {
+            const unsigned char *x = static_cast<const unsigned char *>(a);
+            const unsigned char *y = static_cast<const unsigned char *>(b);
+            for (size_t i = 0; i < size; i++) {
+                if (x[i] != y[i])
+                    return x[i] < y[i];
+            }
+            return false;
+        }
+
+        inline bool host_is_little_endian() {
+            return !is_big_endian();
+        }
+
+        /**
+         * @brief Writes the header fields up to the value size.
+         */
+        template<typename _Key, typename _Mapped>
+        void write_header(stream_writer &out, const char *magic) {
+            typedef record_traits<_Key, _Mapped> traits;
+
+            out.put(magic, sizeof(SERIALIZATION_MAGIC));
+            out.put_le<uint16_t>(SERIALIZATION_VERSION);
+            out.put_le<uint8_t>(traits::is_set ? 1 : 0);
+            out.put_le<uint8_t>(static_cast<uint8_t>(key_codec<_Key>::encoding));
+            out.put_le<uint8_t>(host_is_little_endian() ? 1 : 0);
+            const char reserved[3] = {0, 0, 0};
+            out.put(reserved, sizeof(reserved));
+            out.put_le<uint32_t>(sizeof(_Key));
+            out.put_le<uint32_t>(traits::mapped_size());
+        }
+
+        /**
+         * @brief Reads and checks the header fields written by write_header().
+         * @throw  serialization_error  If they do not match the container.
+         */
+        template<typename _Key, typename _Mapped>
+        void read_header(stream_reader &in, const char *magic, const char *what) {
+            typedef record_traits<_Key, _Mapped> traits;
+
+            char header_magic[sizeof(SERIALIZATION_MAGIC)];
+            in.get(header_magic, sizeof(header_magic));
+            if (std::memcmp(header_magic, magic, sizeof(header_magic)) != 0)
+                throw serialization_error(what);
+            if (in.get_le<uint16_t>() != SERIALIZATION_VERSION)
+                throw serialization_error("art: unsupported image version");
+            if (in.get_le<uint8_t>() != (traits::is_set ? 1 : 0))
+                throw serialization_error("art: image of a different container kind");
+            if (in.get_le<uint8_t>() != static_cast<uint8_t>(key_codec<_Key>::encoding))
+                throw serialization_error("art: image uses a different key encoding");
+            if (in.get_le<uint8_t>() != (host_is_little_endian() ? 1 : 0))
+                throw serialization_error("art: image written with a different byte order");
+            char reserved[3];
+            in.get(reserved, sizeof(reserved));
+            if (in.get_le<uint32_t>() != sizeof(_Key) || in.get_le<uint32_t>() != traits::mapped_size())
+                throw serialization_error("art: image has different key or value sizes");
+        }
+
+        /**
+         * @brief Writes a range of elements, sorted by transformed key, as an image.
+         */
+        template<typename _Key, typename _Mapped, typename _InputIterator>
+        void save_sorted(std::ostream &__os, _InputIterator __first, _InputIterator __last, uint64_t __count) {
+            typedef record_traits<_Key, _Mapped> traits;
+
+            stream_writer out(__os);
+            key_codec<_Key> codec;
+
+            write_header<_Key, _Mapped>(out, SERIALIZATION_MAGIC);
+            out.put_le<uint64_t>(__count);
+
+            for (; __first != __last; ++__first) {
+                codec.encode(out, traits::key(*__first));
+                traits::write_mapped(out, *__first);
+            }
+            out.flush();
+        }
+
+        /**
+         * @brief Reads an image written by save_sorted() and hands out its
+         * elements through an input iterator, checking that they are sorted.
+         */
+        template<typename _Key, typename _Mapped, typename _Key_transform>
+        class sorted_loader {
+            typedef record_traits<_Key, _Mapped> traits;
+            typedef decltype(_Key_transform()(_Key())) transformed_key_type;
+
+        public:
+            typedef typename traits::value_type value_type;
+
+        private:
+            stream_reader _in;
+            key_codec<_Key> _codec;
+            _Key_transform _key_transform;
+            uint64_t _count;
+
+            // the element the iterator points to, trivially destructible
+            uint64_t _read = 0;
+            typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type _current;
+            transformed_key_type _previous_key;
+
+            const value_type *current() const {
+                return reinterpret_cast<const value_type *>(&_current);
+            }
+
+            void read_next() {
+                const _Key key = _codec.decode(_in);
+                const transformed_key_type transformed = _key_transform(key);
+                if (_read > 0 && !bytes_less(&_previous_key, &transformed, sizeof(transformed)))
+                    throw serialization_error("art: elements are not sorted by the container's key_transform");
+                _previous_key = transformed;
+
+                new(&_current) value_type(traits::read(key, _in));
+                _read++;
+            }
+
+        public:
+            explicit sorted_loader(std::istream &__is) : _in(__is), _previous_key() {
+                read_header<_Key, _Mapped>(_in, SERIALIZATION_MAGIC, "art: not a container image");
+                _count = _in.get_le<uint64_t>();
+            }
+
+            uint64_t size() const { return _count; }
+
+            struct iterator {
+                typedef std::input_iterator_tag iterator_category;
+                typedef typename traits::value_type value_type;
+                typedef ptrdiff_t difference_type;
+                typedef const value_type *pointer;
+                typedef const value_type &reference;
+
+                sorted_loader *_loader;
+                uint64_t _index;
+
+                reference operator*() const { return *_loader->current(); }
+
+                pointer operator->() const { return _loader->current(); }
+
+                iterator &operator++() {
+                    if (++_index < _loader->_count)
+                        _loader->read_next();
+                    return *this;
+                }
+
+                bool operator==(const iterator &__x) const { return _index == __x._index; }
+
+                bool operator!=(const iterator &__x) const { return _index != __x._index; }
+            };
+
+            /**
+             * Reads the first element, call at most once.
+             */
+            iterator begin() {
+                if (_count > 0)
+                    read_next();
+                return iterator{this, 0};
+            }
+
+            iterator end() {
+                return iterator{this, _count};
+            }
+        };
+
+        /**
+         * @brief Writes an incremental checkpoint, one region at a time.
+         */
+        template<typename _Key, typename _Mapped>
+        class checkpoint_writer {
+            typedef record_traits<_Key, _Mapped> traits;
+
+            stream_writer _out;
+
+        public:
+            checkpoint_writer(std::ostream &__os, uint64_t __sequence, uint64_t __count) : _out(__os) {
+                write_header<_Key, _Mapped>(_out, CHECKPOINT_MAGIC);
+                _out.put_le<uint64_t>(__sequence);
+                _out.put_le<uint64_t>(__count);
+            }
+
+            /**
+             * @brief Writes a region and its values (pointers to elements in key order).
+             */
+            template<typename _Value>
+            void region(const key_region &__region, const std::vector<const _Value *> &__values) {
+                _out.put_le<uint8_t>(1);
+                _out.put_varint(__region.slot_length);
+                _out.put_varint(__region.prefix_length);
+                _out.put(__region.prefix, __region.prefix_length);
+
+                uint8_t keep[32] = {};
+                for (unsigned b = 0; b < 256; b++)
+                    if (__region.keep.test(b))
+                        keep[b / 8] |= static_cast<uint8_t>(1 << (b % 8));
+                _out.put(keep, sizeof(keep));
+
+                key_codec<_Key> codec;
+                _out.put_varint(__values.size());
+                for (const _Value *value : __values) {
+                    codec.encode(_out, traits::key(*value));
+                    traits::write_mapped(_out, *value);
+                }
+            }
+
+            void finish() {
+                _out.put_le<uint8_t>(0);
+                _out.flush();
+            }
+        };
+
+        /**
+         * @brief Reads an incremental checkpoint written by checkpoint_writer,
+         * one region at a time.
+         */
+        template<typename _Key, typename _Mapped, typename _Key_transform>
+        class checkpoint_reader {
+            typedef record_traits<_Key, _Mapped> traits;
+            typedef decltype(_Key_transform()(_Key())) transformed_key_type;
+
+        public:
+            typedef typename traits::value_type value_type;
+
+        private:
+            stream_reader _in;
+            _Key_transform _key_transform;
+            uint64_t _sequence;
+            uint64_t _count;
+
+            uint8_t _prefix[sizeof(transformed_key_type)];
+            key_region _region;
+            std::vector<value_type> _values;
+
+        public:
+            explicit checkpoint_reader(std::istream &__is) : _in(__is) {
+                read_header<_Key, _Mapped>(_in, CHECKPOINT_MAGIC, "art: not an incremental checkpoint");
+                _sequence = _in.get_le<uint64_t>();
+                _count = _in.get_le<uint64_t>();
+            }
+
+            uint64_t sequence() const { return _sequence; }
+
+            /**
+             * Returns the number of elements after replaying the checkpoint.
+             */
+            uint64_t size() const { return _count; }
+
+            /**
+             * @brief Reads the next region.
+             * @return false after the last one.
+             * @throw  serialization_error  If the region is malformed or its
+             *         elements are not sorted or outside of it.
+             */
+            bool next() {
+                if (_in.get_le<uint8_t>() == 0)
+                    return false;
+
+                const uint64_t slot_length = _in.get_varint();
+                const uint64_t prefix_length = _in.get_varint();
+                if (slot_length > prefix_length || prefix_length >= sizeof(transformed_key_type))
+                    throw serialization_error("art: malformed checkpoint region");
+                _in.get(_prefix, prefix_length);
+
+                uint8_t keep[32];
+                _in.get(keep, sizeof(keep));
+                _region = key_region{_prefix, slot_length, prefix_length, std::bitset<256>()};
+                for (unsigned b = 0; b < 256; b++)
+                    if (keep[b / 8] & (1 << (b % 8)))
+                        _region.keep.set(b);
+
+                key_codec<_Key> codec;
+                const uint64_t count = _in.get_varint();
+                _values.clear();
+                transformed_key_type previous_key;
+                for (uint64_t i = 0; i < count; i++) {
+                    const _Key key = codec.decode(_in);
+                    const transformed_key_type transformed = _key_transform(key);
+                    if (i > 0 && !bytes_less(&previous_key, &transformed, sizeof(transformed)))
+                        throw serialization_error("art: elements are not sorted by the container's key_transform");
+                    if (!contains(transformed))
+                        throw serialization_error("art: checkpoint element outside of its region");
+                    previous_key = transformed;
+                    _values.push_back(traits::read(key, _in));
+                }
+                return true;
+            }
+
+            const key_region &region() const { return _region; }
+
+            const std::vector<value_type> &values() const { return _values; }
+
+        private:
+            /**
+             * Whether a transformed key belongs to the current region.
+             */
+            bool contains(const transformed_key_type &key) const {
+                const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&key);
+                if (std::memcmp(bytes, _prefix, _region.slot_length) != 0)
+                    return false;
+                return std::memcmp(bytes, _prefix, _region.prefix_length) != 0
+                       || !_region.keep.test(bytes[_region.prefix_length]);
+            }
+        };
+    }
+}
+
+#endif //ART_SERIALIZATION_H
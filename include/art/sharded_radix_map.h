@@ -0,0 +1,272 @@
+#ifndef ART_SHARDED_RADIX_MAP_H
+#define ART_SHARDED_RADIX_MAP_H
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include "radix_map.h"
+#include "rw_lock.h"
+
+namespace art {
+    /**
+     * @brief A map of (key,value) pairs split into independently locked
+     * radix_maps, so that threads working on different shards do not contend.
+     *
+     *  @tparam _Key  Type of key objects.
+     *  @tparam  _T  Type of mapped objects.
+     *  @tparam _Shards  Number of shards, a power of two of at most 256.
+     *  @tparam _Key_transform  Key transformation function object type,
+     *                          defaults to key_transform<_Key>.
+     *
+     * The shard of a key is given by the leading bits of its transformed key,
+     * so the shards partition the key space into consecutive ranges and
+     * visiting them in order yields all elements in key order. Keys that are
+     * dense in a small range end up in few shards; scattered keys spread evenly.
+     *
+     * Each shard has its own reader-writer lock, lookups share it, all
+     * modifications hold it exclusively. Since the lock is released on return,
+     * lookups copy the mapped value out or call a function under the lock.
+     */
+    template<typename _Key, typename _T, size_t _Shards = 64,
+            typename _Key_transform = key_transform<_Key> >
+    class sharded_radix_map {
+        static_assert(_Shards > 0 && _Shards <= 256 && (_Shards & (_Shards - 1)) == 0,
+                      "number of shards must be a power of two of at most 256");
+
+    public:
+        typedef _Key key_type;
+        typedef _T mapped_type;
+        typedef std::pair<const _Key, _T> value_type;
+        typedef _Key_transform key_transformer_type;
+        typedef radix_map<_Key, _T, _Key_transform> shard_type;
+        typedef typename shard_type::size_type size_type;
+
+    private:
+        typedef typename ar_prefix_tree<_Key, value_type, detail::Select1st<value_type>,
+                _Key_transform>::Key transformed_key_type;
+
+        // padded to a cache line so that the locks of neighbours do not share one
+        struct alignas(64) _Shard {
+            mutable detail::rw_lock lock;
+            shard_type map;
+        };
+
+        _Key_transform _M_key_transform;
+        std::array<_Shard, _Shards> _M_shards;
+
+        static size_t shard_bits() {
+            size_t bits = 0;
+            while ((size_t(1) << bits) < _Shards)
+                bits++;
+            return bits;
+        }
+
+        _Shard &shard_of(const key_type &__k) {
+            return _M_shards[shard_index(__k)];
+        }
+
+        const _Shard &shard_of(const key_type &__k) const {
+            return _M_shards[shard_index(__k)];
+        }
+
+    public:
+        /**
+         * @brief  Default constructor creates no elements.
+         */
+        sharded_radix_map() : _M_key_transform(), _M_shards() {}
+
+        sharded_radix_map(const sharded_radix_map &) = delete;
+
+        sharded_radix_map &operator=(const sharded_radix_map &) = delete;
+
+        /**
+         *  @return  Index of the shard holding key @a __k, taken from the
+         *           leading bits of the transformed key.
+         */
+        size_t shard_index(const key_type &__k) const {
+            transformed_key_type key = {_M_key_transform(__k)};
+            return key.chunks[0] >> (8 - shard_bits());
+        }
+
+        // Capacity
+
+        /**
+         * Returns true if the map is empty.
+         */
+        bool empty() const {
+            return size() == 0;
+        }
+
+        /**
+         * Returns the size of the map, the shards are counted one after another.
+         */
+        size_type size() const {
+            size_type count = 0;
+            for (auto &shard : _M_shards) {
+                detail::shared_guard guard(shard.lock);
+                count += shard.map.size();
+            }
+            return count;
+        }
+
+        // Modifiers
+
+        /**
+         *  @brief Attempts to insert a std::pair into the map.
+         *  @param __x Pair to be inserted.
+         *  @return  Whether the pair was inserted, false if the key existed.
+         */
+        bool insert(const value_type &__x) {
+            _Shard &shard = shard_of(__x.first);
+            std::lock_guard<detail::rw_lock> guard(shard.lock);
+            return shard.map.insert(__x).second;
+        }
+
+        /**
+         *  @brief Inserts a std::pair or replaces the mapped value of an
+         *  existing key.
+         *  @return  Whether the pair was inserted rather than assigned.
+         */
+        bool insert_or_assign(const key_type &__k, const mapped_type &__obj) {
+            _Shard &shard = shard_of(__k);
+            std::lock_guard<detail::rw_lock> guard(shard.lock);
+            auto res = shard.map.insert(value_type(__k, __obj));
+            if (!res.second)
+                res.first->second = __obj;
+            return res.second;
+        }
+
+        /**
+         *  @brief Attempts to erase the element with the given key (if it exists).
+         *  @param  __k The key to erase.
+         *  @return The number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &__k) {
+            _Shard &shard = shard_of(__k);
+            std::lock_guard<detail::rw_lock> guard(shard.lock);
+            return shard.map.erase(__k);
+        }
+
+        /**
+         *  Erases all elements, shard by shard.
+         */
+        void clear() {
+            for (auto &shard : _M_shards) {
+                std::lock_guard<detail::rw_lock> guard(shard.lock);
+                shard.map.clear();
+            }
+        }
+
+        // Lookup
+
+        /**
+         *  @brief  Copies the mapped value of key @a __k into @a __obj.
+         *  @return  Whether the key was found, @a __obj is untouched if not.
+         */
+        bool find(const key_type &__k, mapped_type &__obj) const {
+            const _Shard &shard = shard_of(__k);
+            detail::shared_guard guard(shard.lock);
+            auto it = shard.map.find(__k);
+            if (it == shard.map.end())
+                return false;
+            __obj = it->second;
+            return true;
+        }
+
+        /**
+         *  @brief  Access to map data.
+         *  @return  A copy of the data whose key is @a __k.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        mapped_type at(const key_type &__k) const {
+            const _Shard &shard = shard_of(__k);
+            detail::shared_guard guard(shard.lock);
+            auto it = shard.map.find(__k);
+            if (it == shard.map.end())
+                std::__throw_out_of_range("sharded_radix_map::at");
+            return it->second;
+        }
+
+        /**
+         *  @brief  Finds the number of elements.
+         *  @param  __x  Key to located.
+         *  @return  Number of elements with specified key.
+         */
+        size_type count(const key_type &__x) const {
+            const _Shard &shard = shard_of(__x);
+            detail::shared_guard guard(shard.lock);
+            return shard.map.count(__x);
+        }
+
+        /**
+         *  @brief  Calls @a __f with the element of key @a __k under the
+         *  shard's shared lock.
+         *  @return  Whether the key was found.
+         */
+        template<typename _Function>
+        bool visit(const key_type &__k, _Function __f) const {
+            const _Shard &shard = shard_of(__k);
+            detail::shared_guard guard(shard.lock);
+            auto it = shard.map.find(__k);
+            if (it == shard.map.end())
+                return false;
+            __f(*it);
+            return true;
+        }
+
+        // Iteration
+
+        /**
+         *  @brief  Calls @a __f with every element in key order.
+         *
+         * Every shard is consistent while it is visited under its shared lock,
+         * the map as a whole is not a snapshot: shards visited earlier may
+         * change while later ones are visited.
+         */
+        template<typename _Function>
+        void for_each(_Function __f) const {
+            for (auto &shard : _M_shards) {
+                detail::shared_guard guard(shard.lock);
+                for (auto &x : shard.map)
+                    __f(x);
+            }
+        }
+
+        /**
+         *  @brief  Calls @a __f with every element whose key is in [lo, hi),
+         *  in key order, only locking the shards overlapping the range.
+         */
+        template<typename _Function>
+        void for_each(const key_type &__lo, const key_type &__hi, _Function __f) const {
+            transformed_key_type lo = {_M_key_transform(__lo)};
+            transformed_key_type hi = {_M_key_transform(__hi)};
+            if (std::memcmp(lo.chunks, hi.chunks, sizeof(lo)) >= 0)
+                return;
+
+            const size_t last = shard_index(__hi);
+            for (size_t i = shard_index(__lo); i <= last; i++) {
+                const _Shard &shard = _M_shards[i];
+                detail::shared_guard guard(shard.lock);
+                for (auto it = shard.map.lower_bound(__lo), end = shard.map.lower_bound(__hi); it != end; ++it)
+                    __f(*it);
+            }
+        }
+
+        /**
+         *  @brief  Calls @a __f with the radix_map of shard @a __i under its
+         *  exclusive lock, e.g. for bulk operations on one range of keys.
+         */
+        template<typename _Function>
+        void with_shard(size_t __i, _Function __f) {
+            _Shard &shard = _M_shards[__i];
+            std::lock_guard<detail::rw_lock> guard(shard.lock);
+            __f(shard.map);
+        }
+
+        static constexpr size_t shards() { return _Shards; }
+    };
+}
+
+#endif //ART_SHARDED_RADIX_MAP_H
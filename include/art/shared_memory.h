@@ -0,0 +1,177 @@
+#ifndef ART_SHARED_MEMORY_H
+#define ART_SHARED_MEMORY_H
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace art {
+    /**
+     * @brief A POSIX shared memory object (shm_open) mapped into the address
+     * space of the process.
+     *
+     * One process creates the object and fills it, the others open it
+     * read-only and map the same physical pages. The object outlives the
+     * processes until remove() is called for its name. Names start with a
+     * slash and contain no other one, e.g. "/art-index".
+     *
+     * Movable, not copyable; the mapping ends with the object.
+     */
+    class shared_memory {
+        std::string _M_name;
+        int _M_fd;
+        void *_M_data;
+        size_t _M_size;
+        bool _M_writable;
+
+        shared_memory(const std::string &__name, int __fd, bool __writable)
+                : _M_name(__name), _M_fd(__fd), _M_data(nullptr), _M_size(0), _M_writable(__writable) {}
+
+        void map(size_t __size) {
+            if (_M_data != nullptr)
+                ::munmap(_M_data, _M_size);
+            _M_data = nullptr;
+            _M_size = 0;
+            if (__size == 0)
+                return;
+            void *data = ::mmap(nullptr, __size, _M_writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                                MAP_SHARED, _M_fd, 0);
+            if (data == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), _M_name);
+            _M_data = data;
+            _M_size = __size;
+        }
+
+        void release() noexcept {
+            if (_M_data != nullptr)
+                ::munmap(_M_data, _M_size);
+            if (_M_fd >= 0)
+                ::close(_M_fd);
+            _M_data = nullptr;
+            _M_size = 0;
+            _M_fd = -1;
+        }
+
+    public:
+        /**
+         *  @brief  Creates a new object of @a __size zero bytes, mapped
+         *  for reading and writing.
+         *  @throw  std::system_error  If the name exists or the object
+         *          cannot be created.
+         */
+        static shared_memory create(const std::string &__name, size_t __size) {
+            const int fd = ::shm_open(__name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), __name);
+            shared_memory memory(__name, fd, true);
+            try {
+                memory.resize(__size);
+            } catch (...) {
+                ::shm_unlink(__name.c_str());
+                throw;
+            }
+            return memory;
+        }
+
+        /**
+         *  @brief  Maps an existing object read-only, with the size it has now.
+         *  @throw  std::system_error  If there is no such object.
+         */
+        static shared_memory open(const std::string &__name) {
+            const int fd = ::shm_open(__name.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), __name);
+            shared_memory memory(__name, fd, false);
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+                throw std::system_error(errno, std::generic_category(), __name);
+            memory.map(static_cast<size_t>(st.st_size));
+            return memory;
+        }
+
+        /**
+         *  @brief  Removes the name, the memory is freed once the last
+         *  mapping of it ends.
+         *  @return  false if there was no object of that name.
+         */
+        static bool remove(const std::string &__name) {
+            if (::shm_unlink(__name.c_str()) == 0)
+                return true;
+            if (errno == ENOENT)
+                return false;
+            throw std::system_error(errno, std::generic_category(), __name);
+        }
+
+        shared_memory(shared_memory &&__x) noexcept
+                : _M_name(std::move(__x._M_name)), _M_fd(__x._M_fd), _M_data(__x._M_data), _M_size(__x._M_size),
+                  _M_writable(__x._M_writable) {
+            __x._M_fd = -1;
+            __x._M_data = nullptr;
+            __x._M_size = 0;
+        }
+
+        shared_memory &operator=(shared_memory &&__x) noexcept {
+            if (this != &__x) {
+                release();
+                _M_name = std::move(__x._M_name);
+                _M_fd = __x._M_fd;
+                _M_data = __x._M_data;
+                _M_size = __x._M_size;
+                _M_writable = __x._M_writable;
+                __x._M_fd = -1;
+                __x._M_data = nullptr;
+                __x._M_size = 0;
+            }
+            return *this;
+        }
+
+        shared_memory(const shared_memory &) = delete;
+
+        shared_memory &operator=(const shared_memory &) = delete;
+
+        ~shared_memory() {
+            release();
+        }
+
+        /**
+         *  @brief  Grows or shrinks an object created by this process, new
+         *  bytes are zero. The mapping may move.
+         *  @throw  std::system_error  If the object cannot be resized.
+         */
+        void resize(size_t __size) {
+            if (!_M_writable)
+                throw std::system_error(EPERM, std::generic_category(), _M_name);
+            if (::ftruncate(_M_fd, static_cast<off_t>(__size)) != 0)
+                throw std::system_error(errno, std::generic_category(), _M_name);
+            map(__size);
+        }
+
+        /**
+         * Returns the start of the mapping, nullptr if the object is empty.
+         */
+        void *data() const noexcept {
+            return _M_data;
+        }
+
+        /**
+         * Returns the size of the mapping in bytes.
+         */
+        size_t size() const noexcept {
+            return _M_size;
+        }
+
+        /**
+         * Returns the name of the object.
+         */
+        const std::string &name() const noexcept {
+            return _M_name;
+        }
+    };
+}
+
+#endif //ART_SHARED_MEMORY_H
@@ -0,0 +1,180 @@
+#ifndef ART_STATS_H
+#define ART_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+    /**
+     * @brief Operation counters of the radix trees, see stats::collect().
+     *
+     * The trees only count if the translation unit defines ART_STATS before
+     * including any art header, otherwise the counting compiles to nothing
+     * and all counters stay 0.
+     */
+    enum class counter : unsigned {
+        // find() calls and the nodes they visited, leaves included
+        lookups, lookup_nodes,
+        // node replaced by the next larger type, by the type that was full
+        grow_4, grow_16, grow_48,
+        // node replaced by the next smaller type (a Node4 by its only leaf)
+        shrink_4, shrink_16, shrink_48, shrink_256,
+        // inserts that hit a leaf with another key and split it into a Node4
+        leaf_splits,
+        // inserts that split a compressed prefix
+        prefix_splits,
+        // prefix comparisons beyond the stored bytes that load a leaf with minimum()
+        optimistic_prefix_loads,
+        // steps to the parent while looking for the successor or predecessor
+        successor_climbs, predecessor_climbs,
+        _end
+    };
+
+    /**
+     * @brief A set of counter values, indexed by counter.
+     */
+    struct operation_stats {
+        static const size_t SIZE = static_cast<size_t>(counter::_end);
+
+        uint64_t values[SIZE];
+
+        operation_stats() {
+            std::fill(values, values + SIZE, 0);
+        }
+
+        uint64_t operator[](counter __s) const {
+            return values[static_cast<size_t>(__s)];
+        }
+
+        operation_stats &operator+=(const operation_stats &__x) {
+            for (size_t i = 0; i < SIZE; i++)
+                values[i] += __x.values[i];
+            return *this;
+        }
+
+        /**
+         * Returns the name of a counter, e.g. for exporting them as metrics.
+         */
+        static const char *name(counter __s) {
+            static const char *const names[SIZE] = {
+                    "lookups", "lookup_nodes",
+                    "grow_4", "grow_16", "grow_48",
+                    "shrink_4", "shrink_16", "shrink_48", "shrink_256",
+                    "leaf_splits", "prefix_splits", "optimistic_prefix_loads",
+                    "successor_climbs", "predecessor_climbs"
+            };
+            return names[static_cast<size_t>(__s)];
+        }
+    };
+
+    namespace detail {
+        struct thread_stats;
+
+        /**
+         * @brief The counters of all threads: live ones are summed on demand,
+         * the counts of finished threads are kept in retired.
+         */
+        struct stats_registry {
+            std::mutex mutex;
+            std::vector<thread_stats *> threads;
+            operation_stats retired;
+        };
+
+        inline stats_registry &registry() {
+            static stats_registry instance;
+            return instance;
+        }
+
+        /**
+         * @brief Counters of one thread. Only the owner writes them, with relaxed
+         * loads and stores rather than read-modify-writes, others read them.
+         */
+        struct thread_stats {
+            std::atomic<uint64_t> values[operation_stats::SIZE];
+
+            thread_stats() {
+                for (auto &value : values)
+                    value.store(0, std::memory_order_relaxed);
+                stats_registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.threads.push_back(this);
+            }
+
+            ~thread_stats() {
+                stats_registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.retired += read();
+                r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+            }
+
+            void add(counter __s, uint64_t __n) {
+                std::atomic<uint64_t> &value = values[static_cast<size_t>(__s)];
+                value.store(value.load(std::memory_order_relaxed) + __n, std::memory_order_relaxed);
+            }
+
+            operation_stats read() const {
+                operation_stats stats;
+                for (size_t i = 0; i < operation_stats::SIZE; i++)
+                    stats.values[i] = values[i].load(std::memory_order_relaxed);
+                return stats;
+            }
+
+            void reset() {
+                for (auto &value : values)
+                    value.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        inline thread_stats &local_stats() {
+            static thread_local thread_stats instance;
+            return instance;
+        }
+    }
+
+    namespace stats {
+        /**
+         * Returns the counters of the calling thread.
+         */
+        inline operation_stats local() {
+            return detail::local_stats().read();
+        }
+
+        /**
+         * Returns the sum of the counters of all threads, including finished ones.
+         */
+        inline operation_stats collect() {
+            detail::stats_registry &r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            operation_stats stats = r.retired;
+            for (const detail::thread_stats *thread : r.threads)
+                stats += thread->read();
+            return stats;
+        }
+
+        /**
+         * @brief Sets the counters of all threads to 0.
+         *
+         * Counts of other threads that are in the middle of an operation may
+         * survive the reset or get lost.
+         */
+        inline void reset() {
+            detail::stats_registry &r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.retired = operation_stats();
+            for (detail::thread_stats *thread : r.threads)
+                thread->reset();
+        }
+    }
+}
+
+#ifdef ART_STATS
+#define ART_STAT(name) ::art::detail::local_stats().add(::art::counter::name, 1)
+#else
+#define ART_STAT(name) ((void) 0)
+#endif
+
+#endif //ART_STATS_H
@@ -0,0 +1,37 @@
+#ifndef ART_SUBTREE_COUNT_H
+#define ART_SUBTREE_COUNT_H
+
+#include <stddef.h>
+
+namespace art {
+    namespace detail {
+        /**
+         * @brief Number of leaves below an inner node.
+         *
+         *  @tparam _Enabled  Whether the count is stored at all. Without order
+         *                    statistics the holder is empty and all updates are
+         *                    no-ops, so inner nodes do not grow.
+         */
+        template<bool _Enabled>
+        struct subtree_count {
+            size_t leaves() const { return 0; }
+
+            void set_leaves(size_t) {}
+
+            void add_leaves(ptrdiff_t) {}
+        };
+
+        template<>
+        struct subtree_count<true> {
+            size_t _leaves = 0;
+
+            size_t leaves() const { return _leaves; }
+
+            void set_leaves(size_t leaves) { _leaves = leaves; }
+
+            void add_leaves(ptrdiff_t delta) { _leaves += delta; }
+        };
+    }
+}
+
+#endif //ART_SUBTREE_COUNT_H
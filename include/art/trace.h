@@ -0,0 +1,176 @@
+#ifndef ART_TRACE_H
+#define ART_TRACE_H
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include "serialization.h"
+
+namespace art {
+    namespace detail {
+        /*
+         * Operation trace: the header of write_header() with TRACE_MAGIC and
+         * no mapped type, then one record per operation
+         *
+         *   uint8   trace_op
+         *   key     as in images, integer keys as varint deltas to the key
+         *           of the previous record
+         *   varint  number of elements, scans only
+         *
+         * terminated by a uint8 0. Values are not recorded.
+         */
+        const char TRACE_MAGIC[4] = {'A', 'R', 'T', '\3'};
+    }
+
+    /**
+     * @brief The operations of a trace.
+     */
+    enum class trace_op : uint8_t {
+        find = 1, insert, erase, lower_bound,
+        // lower_bound, then visiting up to length elements
+        scan,
+        // an element the map held when the recording started
+        load
+    };
+
+    /**
+     * @brief One record of a trace.
+     */
+    template<typename _Key>
+    struct trace_event {
+        trace_op op;
+        _Key key;
+        // elements visited by a scan, 0 for other operations
+        uint64_t length;
+    };
+
+    /**
+     * @brief Writes a trace of map operations to a stream, see recording_radix_map.
+     *
+     * Records are buffered, flush() hands them to the stream. The trace is
+     * only complete after close(), which the destructor calls if needed.
+     */
+    template<typename _Key>
+    class trace_writer {
+        detail::stream_writer _M_out;
+        detail::key_codec<_Key> _M_codec;
+        uint64_t _M_records;
+        bool _M_closed;
+
+    public:
+        /**
+         * @throw  serialization_error  If writing the header fails.
+         */
+        explicit trace_writer(std::ostream &__os) : _M_out(__os), _M_records(0), _M_closed(false) {
+            detail::write_header<_Key, void>(_M_out, detail::TRACE_MAGIC);
+        }
+
+        trace_writer(const trace_writer &) = delete;
+
+        trace_writer &operator=(const trace_writer &) = delete;
+
+        ~trace_writer() {
+            if (!_M_closed) {
+                try {
+                    close();
+                } catch (const serialization_error &) {
+                    // nowhere to report it, the trace ends at the last flush
+                }
+            }
+        }
+
+        /**
+         * @brief Appends one operation.
+         * @param __length  Elements visited, for trace_op::scan.
+         * @throw  serialization_error  If the stream fails.
+         */
+        void record(trace_op __op, const _Key &__key, uint64_t __length = 0) {
+            _M_out.put_le<uint8_t>(static_cast<uint8_t>(__op));
+            _M_codec.encode(_M_out, __key);
+            if (__op == trace_op::scan)
+                _M_out.put_varint(__length);
+            _M_records++;
+        }
+
+        /**
+         * @brief Writes the buffered records to the stream.
+         * @throw  serialization_error  If the stream fails.
+         */
+        void flush() {
+            _M_out.flush();
+        }
+
+        /**
+         * @brief Terminates the trace and flushes it, no records may follow.
+         * @throw  serialization_error  If the stream fails.
+         */
+        void close() {
+            _M_closed = true;
+            _M_out.put_le<uint8_t>(0);
+            _M_out.flush();
+        }
+
+        uint64_t records() const noexcept {
+            return _M_records;
+        }
+    };
+
+    /**
+     * @brief Reads a trace written by trace_writer<_Key>.
+     */
+    template<typename _Key>
+    class trace_reader {
+        detail::stream_reader _M_in;
+        detail::key_codec<_Key> _M_codec;
+        bool _M_done;
+
+    public:
+        /**
+         * @throw  serialization_error  If the stream is not a trace of _Key keys.
+         */
+        explicit trace_reader(std::istream &__is) : _M_in(__is), _M_done(false) {
+            detail::read_header<_Key, void>(_M_in, detail::TRACE_MAGIC, "art: not an operation trace");
+        }
+
+        /**
+         * @brief Reads the next record into @a __event.
+         * @return  false at the end of the trace.
+         * @throw  serialization_error  If the trace is truncated or corrupt.
+         */
+        bool next(trace_event<_Key> &__event) {
+            if (_M_done)
+                return false;
+            const uint8_t op = _M_in.get_le<uint8_t>();
+            if (op == 0) {
+                _M_done = true;
+                return false;
+            }
+            if (op > static_cast<uint8_t>(trace_op::load))
+                throw serialization_error("art: unknown trace operation");
+            __event.op = static_cast<trace_op>(op);
+            __event.key = _M_codec.decode(_M_in);
+            __event.length = __event.op == trace_op::scan ? _M_in.get_varint() : 0;
+            return true;
+        }
+    };
+
+    /**
+     * @brief Returns the key size of the trace in @a __is, e.g. to pick the
+     * key type of a trace_reader. Consumes the header.
+     * @throw  serialization_error  If the stream is not a trace.
+     */
+    inline uint32_t trace_key_size(std::istream &__is) {
+        detail::stream_reader in(__is);
+        char magic[sizeof(detail::TRACE_MAGIC)];
+        in.get(magic, sizeof(magic));
+        if (std::memcmp(magic, detail::TRACE_MAGIC, sizeof(magic)) != 0)
+            throw serialization_error("art: not an operation trace");
+        // version, kind, key encoding, byte order, reserved
+        char skipped[8];
+        in.get(skipped, sizeof(skipped));
+        return in.get_le<uint32_t>();
+    }
+}
+
+#endif //ART_TRACE_H
@@ -0,0 +1,185 @@
+#include <map>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "art/concurrent_radix_map.h"
+
+namespace {
+    template<typename _Key>
+    void check_against_map(_Key min_key, _Key max_key, size_t operations) {
+        art::concurrent_radix_map<_Key, int> m;
+        std::map<_Key, int> reference;
+
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<_Key> key_dis(min_key, max_key);
+        std::uniform_int_distribution<int> kind_dis(0, 3);
+
+        for (size_t i = 0; i < operations; i++) {
+            _Key key = key_dis(gen);
+            int value = static_cast<int>(i);
+            switch (kind_dis(gen)) {
+                case 0:
+                    REQUIRE(m.insert(std::make_pair(key, value)) == reference.insert(std::make_pair(key, value)).second);
+                    break;
+                case 1: {
+                    bool inserted = reference.find(key) == reference.end();
+                    reference[key] = value;
+                    REQUIRE(m.insert_or_assign(key, value) == inserted);
+                    break;
+                }
+                case 2:
+                    REQUIRE(m.erase(key) == reference.erase(key));
+                    break;
+                default: {
+                    int found = -1;
+                    auto it = reference.find(key);
+                    REQUIRE(m.find(key, found) == (it != reference.end()));
+                    if (it != reference.end())
+                        REQUIRE(found == it->second);
+                    break;
+                }
+            }
+        }
+
+        REQUIRE(m.size() == reference.size());
+        for (auto &p : reference)
+            REQUIRE(m.at(p.first) == p.second);
+        for (auto &p : reference)
+            REQUIRE(m.erase(p.first) == 1);
+        REQUIRE(m.empty());
+    }
+}
+
+TEST_CASE("Concurrent radix map single threaded", "[concurrent_radix_map]") {
+    SECTION("Dense uint64 keys") {
+        check_against_map<uint64_t>(0, 2000, 50000);
+    }
+
+    SECTION("Sparse uint64 keys") {
+        check_against_map<uint64_t>(0, std::numeric_limits<uint64_t>::max(), 50000);
+    }
+
+    SECTION("Signed int32 keys") {
+        check_against_map<int32_t>(-5000, 5000, 50000);
+    }
+
+    SECTION("Pair keys") {
+        art::concurrent_radix_map<std::pair<int32_t, uint32_t>, int> m;
+        for (int32_t tenant = -3; tenant < 3; tenant++)
+            for (uint32_t id = 0; id < 300; id++)
+                REQUIRE(m.insert(std::make_pair(std::make_pair(tenant, id), tenant * 1000 + (int) id)));
+        REQUIRE(m.size() == 1800);
+        REQUIRE(m.at(std::make_pair(-2, 17u)) == -1983);
+        REQUIRE(m.count(std::make_pair(3, 0u)) == 0);
+        REQUIRE_THROWS_AS(m.at(std::make_pair(3, 0u)), std::out_of_range);
+    }
+
+    SECTION("Visit") {
+        art::concurrent_radix_map<int, std::string> m;
+        m.insert(std::make_pair(7, std::string("seven")));
+        size_t length = 0;
+        REQUIRE(m.visit(7, [&length](const std::pair<const int, std::string> &x) { length = x.second.size(); }));
+        REQUIRE(length == 5);
+        REQUIRE_FALSE(m.visit(8, [&length](const std::pair<const int, std::string> &) { length = 0; }));
+        REQUIRE(length == 5);
+    }
+}
+
+TEST_CASE("Concurrent radix map multi threaded", "[concurrent_radix_map]") {
+    const unsigned threads = 8;
+    const uint64_t per_thread = 20000;
+
+    SECTION("Disjoint inserts and erases") {
+        art::concurrent_radix_map<uint64_t, uint64_t> m;
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(std::thread([&m, t, per_thread]() {
+                // interleaved keys, so threads share nodes at every level
+                for (uint64_t i = 0; i < per_thread; i++)
+                    m.insert(std::make_pair(i * threads + t, i));
+                for (uint64_t i = 0; i < per_thread; i += 2)
+                    m.erase(i * threads + t);
+            }));
+        }
+        for (auto &w : workers)
+            w.join();
+
+        REQUIRE(m.size() == threads * per_thread / 2);
+        for (uint64_t key = 0; key < threads * per_thread; key++) {
+            uint64_t value;
+            bool odd = (key / threads) % 2 == 1;
+            REQUIRE(m.find(key, value) == odd);
+            if (odd)
+                REQUIRE(value == key / threads);
+        }
+    }
+
+    SECTION("Readers see complete values while writers update") {
+        art::concurrent_radix_map<uint32_t, std::pair<uint64_t, uint64_t> > m;
+        const uint32_t keys = 4096;
+        for (uint32_t k = 0; k < keys; k++)
+            m.insert(std::make_pair(k, std::make_pair(0, 0)));
+
+        std::atomic<bool> stop(false);
+        std::atomic<size_t> torn(0);
+        std::atomic<size_t> missing(0);
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads / 2; t++) {
+            workers.push_back(std::thread([&, t]() {
+                std::mt19937 gen(t);
+                for (uint64_t i = 1; i < per_thread; i++) {
+                    uint32_t k = gen() % keys;
+                    m.insert_or_assign(k, std::make_pair(i, i));
+                    // extra keys above the stable range force grow and shrink
+                    uint32_t extra = keys + gen() % keys;
+                    if (i % 2)
+                        m.insert(std::make_pair(extra, std::make_pair(i, i)));
+                    else
+                        m.erase(extra);
+                }
+            }));
+        }
+        for (unsigned t = 0; t < threads / 2; t++) {
+            workers.push_back(std::thread([&, t]() {
+                std::mt19937 gen(t + 100);
+                while (!stop.load()) {
+                    std::pair<uint64_t, uint64_t> value;
+                    if (!m.find(gen() % keys, value))
+                        missing++;
+                    else if (value.first != value.second)
+                        torn++;
+                }
+            }));
+        }
+        for (unsigned t = 0; t < threads / 2; t++)
+            workers[t].join();
+        stop.store(true);
+        for (unsigned t = threads / 2; t < threads; t++)
+            workers[t].join();
+
+        REQUIRE(torn.load() == 0);
+        REQUIRE(missing.load() == 0);
+    }
+
+    SECTION("Contended inserts of the same keys") {
+        art::concurrent_radix_map<uint64_t, unsigned> m;
+        std::atomic<size_t> inserted(0);
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(std::thread([&m, &inserted, t, per_thread]() {
+                for (uint64_t i = 0; i < per_thread; i++) {
+                    if (m.insert(std::make_pair(i * 0x9E3779B97F4A7C15ULL, t)))
+                        inserted++;
+                }
+            }));
+        }
+        for (auto &w : workers)
+            w.join();
+
+        REQUIRE(inserted.load() == per_thread);
+        REQUIRE(m.size() == per_thread);
+    }
+}
@@ -0,0 +1,58 @@
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "art/concurrent_radix_map.h"
+
+TEST_CASE("Single writer radix map", "[concurrent_radix_map]") {
+    typedef art::concurrent_radix_map<uint64_t, std::pair<uint64_t, uint64_t>,
+            art::key_transform<uint64_t>, true> map_type;
+    map_type m;
+
+    // stable keys are only ever reassigned, volatile ones come and go
+    const uint64_t stable = 5000;
+    for (uint64_t k = 0; k < stable; k++)
+        REQUIRE(m.insert(std::make_pair(k * 3, std::make_pair(0, 0))));
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> torn(0);
+    std::atomic<size_t> missing(0);
+    std::atomic<size_t> phantom(0);
+
+    std::vector<std::thread> readers;
+    for (unsigned t = 0; t < 4; t++) {
+        readers.push_back(std::thread([&, t]() {
+            std::mt19937_64 gen(t);
+            std::pair<uint64_t, uint64_t> value;
+            while (!stop.load()) {
+                uint64_t k = gen() % stable;
+                if (!m.find(k * 3, value))
+                    missing++;
+                else if (value.first != value.second)
+                    torn++;
+                // keys 1 mod 3 are never inserted
+                if (m.count(k * 3 + 1) != 0)
+                    phantom++;
+            }
+        }));
+    }
+
+    std::mt19937_64 gen(42);
+    for (uint64_t i = 1; i < 100000; i++) {
+        m.insert_or_assign((gen() % stable) * 3, std::make_pair(i, i));
+        // volatile keys of every density make nodes grow, shrink and collapse
+        uint64_t key = (i % 4 == 0 ? gen() : gen() % 512) * 3 + 2;
+        if (gen() % 2)
+            m.insert(std::make_pair(key, std::make_pair(i, i)));
+        else
+            m.erase(key);
+    }
+    stop.store(true);
+    for (auto &r : readers)
+        r.join();
+
+    REQUIRE(torn.load() == 0);
+    REQUIRE(missing.load() == 0);
+    REQUIRE(phantom.load() == 0);
+    for (uint64_t k = 0; k < stable; k++)
+        REQUIRE(m.count(k * 3) == 1);
+}
@@ -0,0 +1,209 @@
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include "art/frozen_radix_map.h"
+
+namespace {
+    // Compares find, lower_bound, upper_bound and iteration with std::map for random probes
+    template<typename _Key, typename _Frozen, typename _Generator, typename _Distribution>
+    void check_against(const _Frozen &frozen, const std::map<_Key, int> &reference,
+                       _Generator &gen, _Distribution &dis) {
+        REQUIRE(frozen.size() == reference.size());
+        REQUIRE(std::equal(reference.begin(), reference.end(), frozen.begin()));
+
+        for (auto &x : reference) {
+            REQUIRE(frozen.find(x.first) != frozen.end());
+            REQUIRE(frozen.at(x.first) == x.second);
+        }
+
+        for (int i = 0; i < 20000; i++) {
+            const _Key key = dis(gen);
+            auto expected = reference.lower_bound(key);
+            auto it = frozen.lower_bound(key);
+            if (expected == reference.end()) {
+                REQUIRE(it == frozen.end());
+            } else {
+                REQUIRE(it != frozen.end());
+                REQUIRE(it->first == expected->first);
+            }
+
+            REQUIRE(frozen.upper_bound(key) - frozen.begin() ==
+                    std::distance(reference.begin(), reference.upper_bound(key)));
+            REQUIRE(frozen.count(key) == reference.count(key));
+        }
+    }
+}
+
+TEST_CASE("Frozen map lookups", "[frozen_radix_map]") {
+    std::mt19937 gen(13);
+
+    SECTION("empty") {
+        art::frozen_radix_map<uint32_t, int> frozen;
+        REQUIRE(frozen.empty());
+        REQUIRE(frozen.begin() == frozen.end());
+        REQUIRE(frozen.find(1) == frozen.end());
+        REQUIRE(frozen.lower_bound(1) == frozen.end());
+        REQUIRE_THROWS_AS(frozen.at(1), std::out_of_range);
+    }
+
+    SECTION("single element") {
+        art::radix_map<uint32_t, int> map;
+        map.insert(std::make_pair(100, 1));
+        art::frozen_radix_map<uint32_t, int> frozen(map);
+        REQUIRE(frozen.find(100)->second == 1);
+        REQUIRE(frozen.find(101) == frozen.end());
+        REQUIRE(frozen.lower_bound(5) == frozen.begin());
+        REQUIRE(frozen.lower_bound(101) == frozen.end());
+        REQUIRE(frozen.upper_bound(100) == frozen.end());
+    }
+
+    SECTION("sparse unsigned keys") {
+        std::uniform_int_distribution<uint32_t> dis;
+        art::radix_map<uint32_t, int> map;
+        std::map<uint32_t, int> reference;
+        for (int i = 0; i < 50000; i++) {
+            const uint32_t key = dis(gen);
+            map.insert(std::make_pair(key, i));
+            reference.insert(std::make_pair(key, i));
+        }
+        art::frozen_radix_map<uint32_t, int> frozen(map);
+        check_against(frozen, reference, gen, dis);
+    }
+
+    SECTION("signed keys with long shared prefixes") {
+        // few distinct leading bytes: nodes skip many bytes
+        std::uniform_int_distribution<int64_t> dis(-3000, 3000);
+        art::radix_map<int64_t, int> map;
+        std::map<int64_t, int> reference;
+        for (int i = 0; i < 2000; i++) {
+            const int64_t key = dis(gen) * 1000003;
+            map.insert(std::make_pair(key, i));
+            reference.insert(std::make_pair(key, i));
+        }
+        art::frozen_radix_map<int64_t, int> frozen(map);
+        std::uniform_int_distribution<int64_t> probe(-3001 * 1000003LL, 3001 * 1000003LL);
+        check_against(frozen, reference, gen, probe);
+    }
+
+    SECTION("dense keys use direct nodes") {
+        art::radix_map<uint64_t, int> map;
+        std::map<uint64_t, int> reference;
+        for (int i = 0; i < 100000; i += 3) {
+            map.insert(std::make_pair(i, i));
+            reference.insert(std::make_pair(i, i));
+        }
+        art::frozen_radix_map<uint64_t, int> frozen(map);
+        std::uniform_int_distribution<uint64_t> probe(0, 100010);
+        check_against(frozen, reference, gen, probe);
+    }
+}
+
+TEST_CASE("Frozen map images", "[frozen_radix_map]") {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<uint32_t> dis(0, 1000000);
+    art::radix_map<uint32_t, int> map;
+    std::map<uint32_t, int> reference;
+    for (int i = 0; i < 10000; i++) {
+        const uint32_t key = dis(gen);
+        map.insert(std::make_pair(key, i));
+        reference.insert(std::make_pair(key, i));
+    }
+    art::frozen_radix_map<uint32_t, int> frozen(map);
+
+    SECTION("view over a copy of the buffer") {
+        std::vector<uint64_t> copy(frozen.data_size() / sizeof(uint64_t));
+        std::memcpy(copy.data(), frozen.data(), frozen.data_size());
+        auto view = art::frozen_radix_map<uint32_t, int>::view(copy.data(), frozen.data_size());
+        check_against(view, reference, gen, dis);
+    }
+
+    SECTION("written to a file and mapped") {
+        const char *path = "frozen_radix_map_test.bin";
+        {
+            std::ofstream file(path, std::ios::binary);
+            frozen.write(file);
+        }
+        {
+            auto mapped = art::frozen_radix_map<uint32_t, int>::open(path);
+            auto copy = mapped;
+            check_against(copy, reference, gen, dis);
+        }
+        std::remove(path);
+    }
+
+    SECTION("built in shared memory and opened by another process") {
+        const std::string name = "/art-frozen-test-" + std::to_string(::getpid());
+        art::frozen_radix_map<uint32_t, int>::remove_shared(name);
+        {
+            auto shared = art::frozen_radix_map<uint32_t, int>::create_shared(name, map);
+            REQUIRE(shared.data_size() == frozen.data_size());
+            REQUIRE(std::memcmp(shared.data(), frozen.data(), frozen.data_size()) == 0);
+            REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, int>::create_shared(name, map)), std::system_error);
+        }
+
+        const pid_t child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            // no Catch assertions in the child, its exit status is the result
+            bool same = false;
+            try {
+                auto opened = art::frozen_radix_map<uint32_t, int>::open_shared(name);
+                same = opened.size() == reference.size() &&
+                       std::equal(reference.begin(), reference.end(), opened.begin());
+                for (auto &x : reference)
+                    same = same && opened.at(x.first) == x.second;
+            } catch (...) {
+            }
+            ::_exit(same ? 0 : 1);
+        }
+        int status = 0;
+        REQUIRE(::waitpid(child, &status, 0) == child);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+
+        auto opened = art::frozen_radix_map<uint32_t, int>::open_shared(name);
+        REQUIRE(art::frozen_radix_map<uint32_t, int>::remove_shared(name));
+        REQUIRE_FALSE(art::frozen_radix_map<uint32_t, int>::remove_shared(name));
+        // the mapping outlives the name
+        check_against(opened, reference, gen, dis);
+        REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, int>::open_shared(name)), std::system_error);
+    }
+
+    SECTION("invalid images") {
+        std::vector<uint64_t> copy(frozen.data_size() / sizeof(uint64_t));
+        std::memcpy(copy.data(), frozen.data(), frozen.data_size());
+        REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, int>::view(copy.data(), frozen.data_size() - 8)),
+                          art::serialization_error);
+        REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, double>::view(copy.data(), frozen.data_size())),
+                          art::serialization_error);
+        reinterpret_cast<char *>(copy.data())[0] = 'X';
+        REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, int>::view(copy.data(), frozen.data_size())),
+                          art::serialization_error);
+        REQUIRE_THROWS_AS((art::frozen_radix_map<uint32_t, int>::open("does/not/exist")), std::system_error);
+    }
+}
+
+TEST_CASE("Frozen map with compound keys", "[frozen_radix_map]") {
+    std::mt19937 gen(19);
+    std::uniform_int_distribution<int32_t> dis(-50, 50);
+    art::radix_map<std::pair<int32_t, int32_t>, int> map;
+    for (int i = 0; i < 3000; i++)
+        map.insert(std::make_pair(std::make_pair(dis(gen), dis(gen)), i));
+
+    art::frozen_radix_map<std::pair<int32_t, int32_t>, int> frozen(map);
+    REQUIRE(frozen.size() == map.size());
+    REQUIRE(std::equal(map.begin(), map.end(), frozen.begin()));
+    for (int i = 0; i < 5000; i++) {
+        const std::pair<int32_t, int32_t> key(dis(gen), dis(gen));
+        REQUIRE(frozen.count(key) == map.count(key));
+        auto expected = map.lower_bound(key);
+        auto it = frozen.lower_bound(key);
+        REQUIRE((it == frozen.end()) == (expected == map.end()));
+        if (expected != map.end())
+            REQUIRE(it->first == expected->first);
+    }
+}
@@ -0,0 +1,209 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include "catch.hpp"
+#include "art/logged_radix_map.h"
+
+namespace {
+    const char *LOG_PATH = "logged_radix_map_test.log";
+    const char *SNAPSHOT_PATH = "logged_radix_map_test.snapshot";
+
+    art::log_options small_log() {
+        art::log_options options;
+        options.preallocate = 1 << 16;
+        return options;
+    }
+
+    template<typename _Map, typename _Key>
+    void check_equal(const _Map &map, const std::map<_Key, int> &reference) {
+        REQUIRE(map.size() == reference.size());
+        REQUIRE(std::equal(reference.begin(), reference.end(), map.begin()));
+    }
+
+    std::string read_file(const char *path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const char *path, const std::string &contents) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size());
+    }
+
+    void remove_files() {
+        std::remove(LOG_PATH);
+        std::remove(SNAPSHOT_PATH);
+    }
+}
+
+TEST_CASE("Logged map recovery", "[logged_radix_map]") {
+    std::mt19937 gen(39);
+    remove_files();
+
+    SECTION("modifications are replayed on open") {
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+            REQUIRE(map.empty());
+            REQUIRE(map.insert(std::make_pair(5, 1)));
+            REQUIRE_FALSE(map.insert(std::make_pair(5, 2)));
+            REQUIRE_FALSE(map.insert_or_assign(5, 3));
+            REQUIRE(map.insert_or_assign(6, 4));
+            REQUIRE(map.insert(std::make_pair(7, 5)));
+            REQUIRE(map.erase(7) == 1);
+            REQUIRE(map.erase(7) == 0);
+            REQUIRE(map.at(5) == 3);
+            REQUIRE_THROWS_AS(map.at(7), std::out_of_range);
+        }
+        art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+        REQUIRE(map.size() == 2);
+        REQUIRE(map.at(5) == 3);
+        REQUIRE(map.at(6) == 4);
+        REQUIRE(map.count(7) == 0);
+    }
+
+    SECTION("random operations over several sessions") {
+        std::uniform_int_distribution<uint64_t> dis(0, 20000);
+        std::uniform_int_distribution<int> op(0, 9);
+        std::map<uint64_t, int> reference;
+
+        for (int session = 0; session < 5; session++) {
+            art::logged_radix_map<uint64_t, int> map(LOG_PATH, small_log());
+            check_equal(map, reference);
+            for (int i = 0; i < 20000; i++) {
+                const uint64_t key = dis(gen);
+                switch (op(gen)) {
+                    case 0:
+                    case 1:
+                        REQUIRE(map.erase(key) == reference.erase(key));
+                        break;
+                    case 2:
+                        REQUIRE(map.insert_or_assign(key, i) == (reference.count(key) == 0));
+                        reference[key] = i;
+                        break;
+                    default:
+                        REQUIRE(map.insert(std::make_pair(key, i)) == reference.insert(std::make_pair(key, i)).second);
+                }
+            }
+            if (session == 3) {
+                map.clear();
+                reference.clear();
+                map.insert(std::make_pair(1, 1));
+                reference.insert(std::make_pair(1, 1));
+            }
+        }
+
+        art::logged_radix_map<uint64_t, int> map(LOG_PATH, small_log());
+        check_equal(map, reference);
+    }
+
+    SECTION("fsyncs are shared by groups of modifications") {
+        art::log_options options = small_log();
+        options.commit_latency = std::chrono::milliseconds(50);
+        art::logged_radix_map<uint32_t, int> map(LOG_PATH, options);
+        for (uint32_t i = 0; i < 100000; i++)
+            map.insert(std::make_pair(i, (int) i));
+        map.sync();
+        REQUIRE(map.commits() >= 1);
+        REQUIRE(map.commits() < 100);
+        REQUIRE(map.logged_bytes() == 100000 * 13);
+
+        // the log outgrew several preallocation steps
+        REQUIRE(read_file(LOG_PATH).size() >= 20 + 100000 * 13);
+    }
+
+    SECTION("replay stops at a torn record") {
+        std::map<uint32_t, int> reference;
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+            for (int i = 0; i < 100; i++)
+                map.insert(std::make_pair(i * 3, i));
+        }
+
+        // a 20 byte header and 13 byte insert records: corrupt the 61st
+        std::string log = read_file(LOG_PATH);
+        log[20 + 60 * 13 + 7] ^= 1;
+        write_file(LOG_PATH, log);
+        for (int i = 0; i < 60; i++)
+            reference.insert(std::make_pair(i * 3, i));
+
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+            check_equal(map, reference);
+            map.insert(std::make_pair(1000, 1));
+            reference.insert(std::make_pair(1000, 1));
+        }
+
+        // the intact records behind the new one do not continue the chain
+        art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+        check_equal(map, reference);
+    }
+
+    SECTION("snapshots truncate the log") {
+        std::uniform_int_distribution<uint32_t> dis;
+        std::map<uint32_t, int> reference;
+        std::string old_log, old_snapshot;
+        std::map<uint32_t, int> at_snapshot;
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, SNAPSHOT_PATH, small_log());
+            for (int i = 0; i < 50000; i++) {
+                const uint32_t key = dis(gen);
+                map.insert(std::make_pair(key, i));
+                reference.insert(std::make_pair(key, i));
+            }
+            map.sync();
+            old_log = read_file(LOG_PATH);
+
+            map.snapshot();
+            REQUIRE(read_file(LOG_PATH).size() == (1 << 16));
+            old_snapshot = read_file(SNAPSHOT_PATH);
+            at_snapshot = reference;
+
+            for (int i = 0; i < 100; i++) {
+                const uint32_t key = dis(gen);
+                REQUIRE(map.erase(key) == reference.erase(key));
+                map.insert_or_assign(reference.begin()->first, -i);
+                reference.begin()->second = -i;
+            }
+        }
+
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, SNAPSHOT_PATH, small_log());
+            check_equal(map, reference);
+        }
+
+        // a crash between the rename and the truncation leaves the old log
+        write_file(SNAPSHOT_PATH, old_snapshot);
+        write_file(LOG_PATH, old_log);
+        art::logged_radix_map<uint32_t, int> map(LOG_PATH, SNAPSHOT_PATH, small_log());
+        check_equal(map, at_snapshot);
+    }
+
+    SECTION("pair keys") {
+        typedef std::pair<uint32_t, uint64_t> key_type;
+        std::map<key_type, int> reference;
+        {
+            art::logged_radix_map<key_type, int> map(LOG_PATH, small_log());
+            for (int i = 0; i < 1000; i++) {
+                const key_type key(i % 7, i * 1000003ull);
+                map.insert(std::make_pair(key, i));
+                reference.insert(std::make_pair(key, i));
+            }
+        }
+        art::logged_radix_map<key_type, int> map(LOG_PATH, small_log());
+        check_equal(map, reference);
+    }
+
+    SECTION("misuse is detected") {
+        {
+            art::logged_radix_map<uint32_t, int> map(LOG_PATH, small_log());
+            REQUIRE_THROWS_AS(map.snapshot(), std::logic_error);
+            map.insert(std::make_pair(1, 1));
+        }
+        REQUIRE_THROWS_AS((art::logged_radix_map<uint64_t, int>(LOG_PATH, small_log())), art::serialization_error);
+        REQUIRE_THROWS_AS((art::logged_radix_map<uint32_t, int>("no_such_directory/log", small_log())),
+                          std::system_error);
+    }
+
+    remove_files();
+}
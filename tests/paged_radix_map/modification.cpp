@@ -0,0 +1,119 @@
+#include <map>
+#include "catch.hpp"
+#include "art/paged_radix_map.h"
+
+namespace {
+    struct same_element {
+        template<typename _Pair1, typename _Pair2>
+        bool operator()(const _Pair1 &x, const _Pair2 &y) const {
+            return x.first == y.first && x.second == y.second;
+        }
+    };
+
+    template<typename _Map, typename _Key>
+    void check_equal(_Map &map, const std::map<_Key, int> &reference) {
+        REQUIRE(map.size() == reference.size());
+        std::vector<std::pair<_Key, int> > elements;
+        map.for_each([&elements](const std::pair<const _Key, int> &x) { elements.push_back(x); });
+        REQUIRE(elements.size() == reference.size());
+        REQUIRE(std::equal(reference.begin(), reference.end(), elements.begin(), same_element()));
+    }
+}
+
+TEST_CASE("Paged map modifications", "[paged_radix_map]") {
+    std::mt19937 gen(23);
+
+    SECTION("small map stays in memory") {
+        art::paged_radix_map<uint32_t, int> map(64);
+        REQUIRE(map.empty());
+        REQUIRE(map.insert(std::make_pair(5, 1)));
+        REQUIRE_FALSE(map.insert(std::make_pair(5, 2)));
+        REQUIRE(map.at(5) == 1);
+        REQUIRE_FALSE(map.insert_or_assign(5, 3));
+        REQUIRE(map.at(5) == 3);
+        REQUIRE(map.insert_or_assign(6, 4));
+        REQUIRE(map.count(6) == 1);
+        REQUIRE(map.count(7) == 0);
+        REQUIRE_THROWS_AS(map.at(7), std::out_of_range);
+        REQUIRE(map.erase(5) == 1);
+        REQUIRE(map.erase(5) == 0);
+        REQUIRE(map.size() == 1);
+        REQUIRE(map.page_reads() == 0);
+    }
+
+    SECTION("random operations with a buffer pool much smaller than the map") {
+        std::uniform_int_distribution<uint64_t> dis(0, 400000);
+        std::uniform_int_distribution<int> op(0, 9);
+        art::paged_radix_map<uint64_t, int> map(16);
+        std::map<uint64_t, int> reference;
+
+        for (int i = 0; i < 200000; i++) {
+            const uint64_t key = dis(gen);
+            switch (op(gen)) {
+                case 0:
+                case 1:
+                    REQUIRE(map.erase(key) == reference.erase(key));
+                    break;
+                case 2:
+                    REQUIRE(map.insert_or_assign(key, i) == (reference.count(key) == 0));
+                    reference[key] = i;
+                    break;
+                case 3: {
+                    int value = -1;
+                    const bool found = map.find(key, value);
+                    REQUIRE(found == (reference.count(key) == 1));
+                    if (found)
+                        REQUIRE(value == reference[key]);
+                    break;
+                }
+                default:
+                    REQUIRE(map.insert(std::make_pair(key, i)) == reference.insert(std::make_pair(key, i)).second);
+            }
+        }
+
+        REQUIRE(map.resident_pages() <= 16);
+        REQUIRE(map.page_writes() > 0);
+        REQUIRE(map.page_reads() > 0);
+        check_equal(map, reference);
+
+        for (auto &x : reference)
+            REQUIRE(map.at(x.first) == x.second);
+
+        // erasing everything frees all pages but the root
+        for (auto &x : reference)
+            REQUIRE(map.erase(x.first) == 1);
+        REQUIRE(map.empty());
+        REQUIRE(map.resident_pages() == 1);
+    }
+
+    SECTION("keys sharing long prefixes burst into deep pages") {
+        art::paged_radix_map<std::pair<uint32_t, uint32_t>, int> map(24);
+        std::map<std::pair<uint32_t, uint32_t>, int> reference;
+        for (int i = 0; i < 20000; i++) {
+            const std::pair<uint32_t, uint32_t> key(7, static_cast<uint32_t>(i * 13));
+            map.insert(std::make_pair(key, i));
+            reference.insert(std::make_pair(key, i));
+        }
+        REQUIRE(map.size() == reference.size());
+        std::vector<std::pair<std::pair<uint32_t, uint32_t>, int> > elements;
+        map.for_each([&elements](const std::pair<const std::pair<uint32_t, uint32_t>, int> &x) {
+            elements.push_back(x);
+        });
+        REQUIRE(std::equal(reference.begin(), reference.end(), elements.begin(), same_element()));
+    }
+
+    SECTION("clear") {
+        art::paged_radix_map<uint32_t, int> map(16);
+        for (uint32_t i = 0; i < 50000; i++)
+            map.insert(std::make_pair(i * 31, (int) i));
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(map.count(31) == 0);
+        map.insert(std::make_pair(31, 1));
+        REQUIRE(map.at(31) == 1);
+    }
+
+    SECTION("buffer pool too small for the key length") {
+        REQUIRE_THROWS_AS((art::paged_radix_map<uint64_t, int>(4)), std::invalid_argument);
+    }
+}
@@ -0,0 +1,147 @@
+#include <map>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "art/persistent_radix_map.h"
+
+namespace {
+    template<typename _Map, typename _Reference>
+    bool same_elements(const _Map &m, const _Reference &reference) {
+        if (m.size() != reference.size())
+            return false;
+        auto it = m.begin();
+        for (auto &p : reference) {
+            if (it == m.end() || it->first != p.first || it->second != p.second)
+                return false;
+            ++it;
+        }
+        return it == m.end();
+    }
+}
+
+TEST_CASE("Persistent radix map modifications", "[persistent_radix_map]") {
+    art::persistent_radix_map<int32_t, int> m;
+    std::map<int32_t, int> reference;
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<int32_t> key_dis(-3000, 3000);
+    std::uniform_int_distribution<int> kind_dis(0, 2);
+
+    for (int i = 0; i < 30000; i++) {
+        int32_t key = key_dis(gen);
+        switch (kind_dis(gen)) {
+            case 0:
+                REQUIRE(m.insert(std::make_pair(key, i)) == reference.insert(std::make_pair(key, i)).second);
+                break;
+            case 1: {
+                bool inserted = reference.find(key) == reference.end();
+                reference[key] = i;
+                REQUIRE(m.insert_or_assign(key, i) == inserted);
+                break;
+            }
+            default:
+                REQUIRE(m.erase(key) == reference.erase(key));
+        }
+    }
+    REQUIRE(same_elements(m, reference));
+
+    for (auto &p : reference) {
+        REQUIRE(m.at(p.first) == p.second);
+        REQUIRE(m.find(p.first)->second == p.second);
+    }
+    REQUIRE(m.count(3001) == 0);
+    REQUIRE(m.find(3001) == m.end());
+    REQUIRE_THROWS_AS(m.at(3001), std::out_of_range);
+
+    SECTION("Iteration continues after find") {
+        auto it = m.find(reference.begin()->first);
+        auto ref_it = reference.begin();
+        for (; it != m.end(); ++it, ++ref_it)
+            REQUIRE(it->first == ref_it->first);
+        REQUIRE(ref_it == reference.end());
+    }
+}
+
+TEST_CASE("Persistent radix map snapshots", "[persistent_radix_map]") {
+    typedef art::persistent_radix_map<uint64_t, uint64_t> map_type;
+    map_type m;
+    std::map<uint64_t, uint64_t> reference;
+
+    std::mt19937_64 gen(std::random_device{}());
+    std::vector<map_type::snapshot_type> snapshots;
+    std::vector<std::map<uint64_t, uint64_t> > expected;
+
+    for (uint64_t i = 0; i < 20000; i++) {
+        // dense low keys share nodes between snapshots, sparse high ones do not
+        uint64_t key = i % 3 == 0 ? gen() : gen() % 4096;
+        if (gen() % 3 == 0) {
+            m.erase(key);
+            reference.erase(key);
+        } else {
+            m.insert_or_assign(key, i);
+            reference[key] = i;
+        }
+        if (i % 2000 == 0) {
+            snapshots.push_back(m.snapshot());
+            expected.push_back(reference);
+        }
+    }
+
+    REQUIRE(same_elements(m, reference));
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        REQUIRE(same_elements(snapshots[i], expected[i]));
+        for (auto &p : expected[i])
+            REQUIRE(snapshots[i].at(p.first) == p.second);
+    }
+
+    SECTION("Copies are independent") {
+        map_type copy(m);
+        copy.clear();
+        REQUIRE(copy.empty());
+        REQUIRE(same_elements(m, reference));
+
+        map_type other = m;
+        for (auto &p : reference)
+            other.erase(p.first);
+        REQUIRE(other.empty());
+        REQUIRE(same_elements(m, reference));
+        REQUIRE(same_elements(snapshots.back(), expected.back()));
+    }
+
+    SECTION("Snapshot outlives the map") {
+        map_type::snapshot_type last = m.snapshot();
+        m = map_type();
+        REQUIRE(same_elements(last, reference));
+    }
+}
+
+TEST_CASE("Persistent radix map snapshot read by another thread", "[persistent_radix_map]") {
+    art::persistent_radix_map<uint32_t, uint32_t> m;
+    for (uint32_t i = 0; i < 50000; i++)
+        m.insert(std::make_pair(i * 7, i));
+    auto snapshot = m.snapshot();
+
+    std::thread reader([&snapshot]() {
+        for (int round = 0; round < 5; round++) {
+            uint32_t expected = 0;
+            for (auto &x : snapshot) {
+                if (x.first != expected * 7 || x.second != expected)
+                    FAIL("snapshot changed");
+                expected++;
+            }
+            if (expected != 50000)
+                FAIL("snapshot changed");
+        }
+    });
+
+    // the writer rewrites and erases everything while the reader scans
+    for (uint32_t i = 0; i < 50000; i++) {
+        m.insert_or_assign(i * 7, i + 1);
+        if (i % 2)
+            m.erase(i * 7);
+    }
+    reader.join();
+
+    REQUIRE(m.size() == 25000);
+    REQUIRE(snapshot.size() == 50000);
+}
@@ -0,0 +1,163 @@
+#include <map>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+
+namespace {
+    // Not commutative, checks that summaries are combined in key order
+    struct concat_aggregate {
+        typedef std::string summary_type;
+
+        static summary_type identity() { return ""; }
+
+        static summary_type lift(char c) { return std::string(1, c); }
+
+        static summary_type combine(const summary_type &a, const summary_type &b) { return a + b; }
+    };
+
+    template<typename _Map, typename _Reference>
+    void require_sums(const _Map &radix_map, const _Reference &reference, int64_t min_key, int64_t max_key) {
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<int64_t> key_dis(min_key, max_key);
+
+        int64_t total = 0;
+        for (auto &p : reference)
+            total += p.second;
+        REQUIRE(radix_map.aggregate() == total);
+
+        for (int i = 0; i < 500; i++) {
+            int64_t lo = key_dis(gen), hi = key_dis(gen);
+            int64_t expected = 0;
+            for (auto it = reference.lower_bound(lo); it != reference.end() && it->first < hi; ++it)
+                expected += it->second;
+            REQUIRE(radix_map.aggregate(lo, hi) == expected);
+        }
+    }
+}
+
+TEST_CASE("Range sums", "[radix-map]") {
+    typedef art::radix_map<int64_t, int64_t, art::key_transform<int64_t>, false,
+            art::sum_aggregate<int64_t> > map_type;
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<int64_t> key_dis(-1000000, 1000000);
+    std::uniform_int_distribution<int64_t> value_dis(-1000, 1000);
+
+    map_type radix_map;
+    std::map<int64_t, int64_t> reference;
+    REQUIRE(radix_map.aggregate() == 0);
+    REQUIRE(radix_map.aggregate(-5, 5) == 0);
+
+    for (int i = 0; i < 20000; i++) {
+        auto p = std::make_pair(key_dis(gen), value_dis(gen));
+        radix_map.insert(p);
+        reference.insert(p);
+    }
+    require_sums(radix_map, reference, -1000000, 1000000);
+    REQUIRE(radix_map.aggregate(5, -5) == 0);
+
+    SECTION ("after erase") {
+        for (int i = 0; i < 20000; i++) {
+            int64_t k = key_dis(gen);
+            radix_map.erase(k);
+            reference.erase(k);
+        }
+        require_sums(radix_map, reference, -1000000, 1000000);
+    }
+
+    SECTION ("after bulk operations") {
+        radix_map.erase_range(-500000, 0);
+        reference.erase(reference.lower_bound(-500000), reference.lower_bound(0));
+        require_sums(radix_map, reference, -1000000, 1000000);
+
+        std::vector<map_type::batch_op_type> batch;
+        for (int64_t k = 0; k < 1000000; k += 997) {
+            auto kind = static_cast<art::batch_op_kind>(k % 3);
+            batch.push_back(map_type::batch_op_type(kind, std::make_pair(k, k % 100)));
+            if (kind == art::batch_op_kind::erase)
+                reference.erase(k);
+            else if (kind == art::batch_op_kind::assign)
+                reference[k] = k % 100;
+            else
+                reference.insert(std::make_pair(k, k % 100));
+        }
+        radix_map.apply_sorted_batch(batch.begin(), batch.end());
+        require_sums(radix_map, reference, -1000000, 1000000);
+
+        // all keys in [0x20000, 0x30000)
+        radix_map.erase_prefix(0x20000, 6);
+        reference.erase(reference.lower_bound(0x20000), reference.lower_bound(0x30000));
+        require_sums(radix_map, reference, -1000000, 1000000);
+
+        map_type copy(radix_map);
+        require_sums(copy, reference, -1000000, 1000000);
+    }
+
+    SECTION ("values changed in place are refreshed") {
+        auto it = radix_map.begin();
+        std::advance(it, 100);
+        it->second += 5000;
+        reference[it->first] += 5000;
+        radix_map.refresh_aggregate(it);
+        require_sums(radix_map, reference, -1000000, 1000000);
+    }
+}
+
+TEST_CASE("Range minimum and maximum", "[radix-map]") {
+    art::radix_map<int32_t, int, art::key_transform<int32_t>, false, art::min_aggregate<int> > min_map;
+    art::radix_map<int32_t, int, art::key_transform<int32_t>, false, art::max_aggregate<int> > max_map;
+    for (int32_t k = 0; k < 10000; k++) {
+        int value = (k * 7919) % 10007;
+        min_map.insert(std::make_pair(k, value));
+        max_map.insert(std::make_pair(k, value));
+    }
+
+    REQUIRE(min_map.aggregate() == 0);
+    REQUIRE(max_map.aggregate() == 10006);
+    REQUIRE(min_map.aggregate(1, 2) == 7919);
+    REQUIRE(min_map.aggregate(20000, 30000) == std::numeric_limits<int>::max());
+
+    for (int32_t lo = 0; lo < 10000; lo += 313) {
+        int32_t hi = lo + 1000;
+        int expected_min = std::numeric_limits<int>::max(), expected_max = std::numeric_limits<int>::lowest();
+        for (int32_t k = lo; k < hi && k < 10000; k++) {
+            expected_min = std::min(expected_min, (k * 7919) % 10007);
+            expected_max = std::max(expected_max, (k * 7919) % 10007);
+        }
+        REQUIRE(min_map.aggregate(lo, hi) == expected_min);
+        REQUIRE(max_map.aggregate(lo, hi) == expected_max);
+    }
+
+    min_map.erase(0);
+    REQUIRE(min_map.aggregate() == 1);
+}
+
+TEST_CASE("Aggregates are combined in key order", "[radix-map]") {
+    art::radix_map<std::string, char, art::key_transform<std::string>, false, concat_aggregate> radix_map;
+    std::string letters = "the quick brown fox jumps over the lazy dog";
+    std::map<std::string, char> reference;
+    for (size_t i = 0; i < letters.size(); i++) {
+        std::string key = "key " + std::to_string(i * 37 % 1000);
+        radix_map.insert(std::make_pair(key, letters[i]));
+        reference.insert(std::make_pair(key, letters[i]));
+    }
+
+    std::string expected;
+    for (auto &p : reference)
+        expected += p.second;
+    REQUIRE(radix_map.aggregate() == expected);
+
+    expected.clear();
+    for (auto it = reference.lower_bound("key 2"); it != reference.lower_bound("key 6"); ++it)
+        expected += it->second;
+    REQUIRE(radix_map.aggregate("key 2", "key 6") == expected);
+}
+
+TEST_CASE("Aggregates over set keys", "[radix-set]") {
+    art::radix_set<int32_t, art::key_transform<int32_t>, false, art::sum_aggregate<int32_t> > radix_set;
+    for (int32_t k = -500; k < 500; k++)
+        radix_set.insert(k * 3);
+
+    REQUIRE(radix_set.aggregate() == -1500);
+    REQUIRE(radix_set.aggregate(0, 30) == 135);
+    REQUIRE(radix_set.aggregate(-3, 1) == -3);
+}
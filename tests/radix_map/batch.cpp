@@ -0,0 +1,132 @@
+#include <map>
+#include "catch.hpp"
+#include "art/radix_map.h"
+
+namespace {
+    template<typename _Key>
+    struct batch_test {
+        typedef art::radix_map<_Key, int> map_type;
+        typedef typename map_type::batch_op_type op_type;
+
+        std::mt19937 gen;
+        std::uniform_int_distribution<_Key> key_dis;
+        std::uniform_int_distribution<int> kind_dis;
+
+        batch_test(_Key min_key, _Key max_key)
+                : gen(std::random_device()()), key_dis(min_key, max_key), kind_dis(0, 2) {}
+
+        // Builds a sorted batch (possibly with repeated keys) and applies it to std::map as reference
+        std::vector<op_type> make_batch(size_t size, std::map<_Key, int> &reference) {
+            std::vector<std::pair<_Key, int> > keys;
+            for (size_t i = 0; i < size; i++)
+                keys.push_back(std::make_pair(key_dis(gen), (int) i));
+            std::sort(keys.begin(), keys.end());
+
+            std::vector<op_type> batch;
+            for (auto &k : keys) {
+                art::batch_op_kind kind = static_cast<art::batch_op_kind>(kind_dis(gen));
+                batch.push_back(op_type(kind, std::make_pair(k.first, k.second)));
+
+                switch (kind) {
+                    case art::batch_op_kind::insert:
+                        reference.insert(std::make_pair(k.first, k.second));
+                        break;
+                    case art::batch_op_kind::assign:
+                        reference[k.first] = k.second;
+                        break;
+                    case art::batch_op_kind::erase:
+                        reference.erase(k.first);
+                        break;
+                }
+            }
+            return batch;
+        }
+    };
+
+    template<typename _Key>
+    void require_equal(const art::radix_map<_Key, int> &radix_map, const std::map<_Key, int> &reference) {
+        REQUIRE(radix_map.size() == reference.size());
+        REQUIRE(std::equal(reference.begin(), reference.end(), radix_map.begin()));
+        REQUIRE(std::equal(reference.rbegin(), reference.rend(), radix_map.rbegin()));
+    }
+}
+
+TEST_CASE("Sorted batch on an empty map", "[radix-map]") {
+    art::radix_map<int, int> radix_map;
+    typedef art::radix_map<int, int>::batch_op_type op_type;
+
+    std::vector<op_type> batch = {
+            op_type(art::batch_op_kind::insert, {-5, 1}),
+            op_type(art::batch_op_kind::insert, {3, 2}),
+            op_type(art::batch_op_kind::insert, {3, 7}),
+            op_type(art::batch_op_kind::erase, {4, 0}),
+            op_type(art::batch_op_kind::assign, {9, 3}),
+            op_type(art::batch_op_kind::assign, {9, 4})
+    };
+    radix_map.apply_sorted_batch(batch.begin(), batch.end());
+
+    REQUIRE(radix_map.size() == 3);
+    REQUIRE(radix_map.at(-5) == 1);
+    REQUIRE(radix_map.at(3) == 2);
+    REQUIRE(radix_map.at(9) == 4);
+    REQUIRE(radix_map.find(4) == radix_map.end());
+
+    SECTION ("assign keeps the element, erasing everything empties the map") {
+        auto it = radix_map.find(3);
+        std::vector<op_type> update = {op_type(art::batch_op_kind::assign, {3, 42})};
+        radix_map.apply_sorted_batch(update.begin(), update.end());
+        REQUIRE(it->second == 42);
+
+        std::vector<op_type> erase_all = {
+                op_type(art::batch_op_kind::erase, {-5, 0}),
+                op_type(art::batch_op_kind::erase, {3, 0}),
+                op_type(art::batch_op_kind::erase, {9, 0})
+        };
+        radix_map.apply_sorted_batch(erase_all.begin(), erase_all.end());
+        REQUIRE(radix_map.empty());
+        REQUIRE(radix_map.begin() == radix_map.end());
+    }
+}
+
+TEST_CASE("Sorted batches equal std::map (32 bit keys)", "[radix-map]") {
+    batch_test<int32_t> test(-20000, 20000);
+    art::radix_map<int32_t, int> radix_map;
+    std::map<int32_t, int> reference;
+
+    for (int round = 0; round < 20; round++) {
+        auto batch = test.make_batch(5000, reference);
+        radix_map.apply_sorted_batch(batch.begin(), batch.end());
+        require_equal(radix_map, reference);
+    }
+
+    SECTION ("single operations still work on the merged tree") {
+        for (int32_t k = -20000; k < 20000; k += 7) {
+            REQUIRE(radix_map.erase(k) == reference.erase(k));
+            REQUIRE(radix_map.insert(std::make_pair(k + 3, k)).second
+                    == reference.insert(std::make_pair(k + 3, k)).second);
+        }
+        require_equal(radix_map, reference);
+    }
+}
+
+TEST_CASE("Sorted batches equal std::map (64 bit keys)", "[radix-map]") {
+    batch_test<uint64_t> dense(0, 50000);
+    batch_test<uint64_t> sparse(0, std::numeric_limits<uint64_t>::max());
+    art::radix_map<uint64_t, int> radix_map;
+    std::map<uint64_t, int> reference;
+
+    for (int round = 0; round < 20; round++) {
+        auto batch = (round % 2 ? sparse : dense).make_batch(5000, reference);
+        radix_map.apply_sorted_batch(batch.begin(), batch.end());
+        require_equal(radix_map, reference);
+    }
+
+    SECTION ("single operations still work on the merged tree") {
+        for (uint64_t k = 0; k < 50000; k += 7) {
+            REQUIRE(radix_map.erase(k) == reference.erase(k));
+            REQUIRE(radix_map.insert(std::make_pair(k + 3, (int) k)).second
+                    == reference.insert(std::make_pair(k + 3, (int) k)).second);
+        }
+        require_equal(radix_map, reference);
+    }
+}
@@ -0,0 +1,220 @@
+#include <map>
+#include <memory>
+#include <sstream>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+
+namespace {
+    /**
+     * Restores the base and replays all deltas into a new container.
+     */
+    template<typename _Container>
+    void restore_all(_Container &restored, const std::string &base, const std::vector<std::string> &deltas) {
+        std::stringstream base_stream(base);
+        restored.restore(base_stream);
+        for (const std::string &delta : deltas) {
+            std::stringstream delta_stream(delta);
+            restored.replay(delta_stream);
+        }
+    }
+
+    template<typename _Key>
+    void random_rounds(std::mt19937 &gen, _Key max_key) {
+        std::uniform_int_distribution<_Key> dis(0, max_key);
+        std::uniform_int_distribution<int> op(0, 9);
+        art::radix_map<_Key, int> map;
+        std::map<_Key, int> reference;
+        for (int i = 0; i < 20000; i++) {
+            const _Key key = dis(gen);
+            map.insert(std::make_pair(key, i));
+            reference.insert(std::make_pair(key, i));
+        }
+
+        std::stringstream base;
+        map.checkpoint(base);
+        std::vector<std::string> deltas;
+
+        for (int round = 0; round < 20; round++) {
+            const int operations = round % 5 == 0 ? 2000 : 50;
+            for (int i = 0; i < operations; i++) {
+                const _Key key = dis(gen);
+                switch (op(gen)) {
+                    case 0:
+                    case 1:
+                    case 2:
+                        REQUIRE(map.erase(key) == reference.erase(key));
+                        break;
+                    case 3: {
+                        auto it = map.find(key);
+                        if (it != map.end()) {
+                            it->second = -i;
+                            map.mark_changed(it);
+                            reference[key] = -i;
+                        }
+                        break;
+                    }
+                    case 4: {
+                        const _Key hi = key + std::min<_Key>(max_key - key, max_key / 1000);
+                        map.erase_range(key, hi);
+                        reference.erase(reference.lower_bound(key), reference.lower_bound(hi));
+                        break;
+                    }
+                    default:
+                        map.insert(std::make_pair(key, i));
+                        reference.insert(std::make_pair(key, i));
+                }
+            }
+
+            std::stringstream delta;
+            map.checkpoint_incremental(delta);
+            deltas.push_back(delta.str());
+        }
+
+        REQUIRE(map.size() == reference.size());
+        REQUIRE(std::equal(reference.begin(), reference.end(), map.begin()));
+
+        art::radix_map<_Key, int> restored;
+        restore_all(restored, base.str(), deltas);
+        REQUIRE(restored == map);
+    }
+}
+
+TEST_CASE("Incremental checkpoints", "[radix_map]") {
+    std::mt19937 gen(38);
+
+    SECTION("random modifications, without path compression") {
+        random_rounds<uint32_t>(gen, 100000);
+    }
+
+    SECTION("random modifications, with path compression") {
+        random_rounds<uint64_t>(gen, 100000);
+        random_rounds<uint64_t>(gen, std::numeric_limits<uint64_t>::max());
+    }
+
+    SECTION("checkpoints grow with the number of modified keys") {
+        std::uniform_int_distribution<uint64_t> dis;
+        art::radix_map<uint64_t, uint64_t> map;
+        for (int i = 0; i < 200000; i++)
+            map.insert(std::make_pair(dis(gen), i));
+
+        std::stringstream base;
+        map.checkpoint(base);
+
+        std::stringstream empty;
+        map.checkpoint_incremental(empty);
+        REQUIRE(empty.str().size() < 64);
+
+        std::vector<std::string> deltas(1, empty.str());
+        for (int i = 0; i < 100; i++)
+            map.insert(std::make_pair(dis(gen), i));
+        map.erase(map.begin()->first);
+        std::stringstream delta;
+        map.checkpoint_incremental(delta);
+        deltas.push_back(delta.str());
+        REQUIRE(delta.str().size() * 20 < base.str().size());
+
+        art::radix_map<uint64_t, uint64_t> restored;
+        restore_all(restored, base.str(), deltas);
+        REQUIRE(restored == map);
+    }
+
+    SECTION("clear, batches and prefixes") {
+        art::radix_map<uint32_t, int> map;
+        for (uint32_t i = 0; i < 5000; i++)
+            map.insert(std::make_pair(i * 7, (int) i));
+
+        std::stringstream base;
+        map.checkpoint(base);
+        std::vector<std::string> deltas;
+        auto checkpoint = [&]() {
+            std::stringstream delta;
+            map.checkpoint_incremental(delta);
+            deltas.push_back(delta.str());
+        };
+
+        map.erase_prefix(0x100u, 3);
+        checkpoint();
+
+        std::vector<art::batch_op<std::pair<const uint32_t, int> > > batch;
+        for (uint32_t i = 0; i < 1000; i++)
+            batch.emplace_back(i % 3 ? art::batch_op_kind::assign : art::batch_op_kind::erase,
+                               std::make_pair(i * 5, (int) i));
+        map.apply_sorted_batch(batch.begin(), batch.end());
+        checkpoint();
+
+        map.clear();
+        checkpoint();
+
+        map.insert(std::make_pair(42, 1));
+        checkpoint();
+
+        for (uint32_t i = 0; i < 100; i++)
+            map.insert(std::make_pair(i << 24, (int) i));
+        checkpoint();
+
+        art::radix_map<uint32_t, int> restored;
+        restore_all(restored, base.str(), deltas);
+        REQUIRE(restored == map);
+
+        // the restored map continues the chain
+        std::stringstream next;
+        restored.erase(42);
+        restored.checkpoint_incremental(next);
+        deltas.push_back(next.str());
+
+        art::radix_map<uint32_t, int> again;
+        restore_all(again, base.str(), deltas);
+        REQUIRE(again == restored);
+    }
+
+    SECTION("sets") {
+        std::uniform_int_distribution<int64_t> dis(-50000, 50000);
+        art::radix_set<int64_t> set;
+        for (int i = 0; i < 10000; i++)
+            set.insert(dis(gen));
+
+        std::stringstream base;
+        set.checkpoint(base);
+        std::vector<std::string> deltas;
+        for (int round = 0; round < 5; round++) {
+            for (int i = 0; i < 500; i++) {
+                set.erase(dis(gen));
+                set.insert(dis(gen));
+            }
+            std::stringstream delta;
+            set.checkpoint_incremental(delta);
+            deltas.push_back(delta.str());
+        }
+
+        art::radix_set<int64_t> restored;
+        restore_all(restored, base.str(), deltas);
+        REQUIRE(restored.size() == set.size());
+        REQUIRE(std::equal(set.begin(), set.end(), restored.begin()));
+    }
+
+    SECTION("misuse is detected") {
+        art::radix_map<uint32_t, int> map;
+        std::stringstream stream;
+        REQUIRE_THROWS_AS(map.checkpoint_incremental(stream), std::logic_error);
+
+        std::stringstream base;
+        map.insert(std::make_pair(1, 1));
+        map.checkpoint(base);
+        std::stringstream first, second;
+        map.insert(std::make_pair(2, 2));
+        map.checkpoint_incremental(first);
+        map.insert(std::make_pair(3, 3));
+        map.checkpoint_incremental(second);
+
+        art::radix_map<uint32_t, int> restored;
+        REQUIRE_THROWS_AS(restored.replay(first), std::logic_error);
+        restored.restore(base);
+        REQUIRE_THROWS_AS(restored.replay(second), art::serialization_error);
+
+        // an image is not a checkpoint
+        std::stringstream image;
+        map.save(image);
+        REQUIRE_THROWS_AS(restored.replay(image), art::serialization_error);
+    }
+}
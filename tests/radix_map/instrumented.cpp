@@ -0,0 +1,127 @@
+#include <sstream>
+#include "catch.hpp"
+#include "art/instrumented_radix_map.h"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+
+TEST_CASE("Latency histogram", "[radix_map]") {
+    SECTION("empty histogram") {
+        art::latency_histogram h;
+        REQUIRE(h.count() == 0);
+        REQUIRE(h.percentile(50) == 0);
+        REQUIRE(h.min() == 0);
+        REQUIRE(h.max() == 0);
+        REQUIRE(h.mean() == 0.0);
+        REQUIRE_THROWS_AS(art::latency_histogram(0), std::invalid_argument);
+    }
+
+    SECTION("small values are exact") {
+        art::latency_histogram h(5);
+        for (uint64_t v = 1; v <= 20; v++)
+            h.record(v);
+        REQUIRE(h.count() == 20);
+        REQUIRE(h.percentile(50) == 10);
+        REQUIRE(h.percentile(100) == 20);
+        REQUIRE(h.percentile(0) == 1);
+        REQUIRE(h.mean() == 10.5);
+    }
+
+    SECTION("percentiles within the relative error") {
+        art::latency_histogram h(5);
+        for (uint64_t v = 1; v <= 100000; v++)
+            h.record(v * 37);
+        const double targets[] = {50, 99, 99.9};
+        for (double p : targets) {
+            const double exact = p / 100 * 100000 * 37;
+            const double reported = double(h.percentile(p));
+            REQUIRE(reported >= exact);
+            REQUIRE(reported <= exact * (1 + 1.0 / 32) + 37);
+        }
+        REQUIRE(h.max() == 3700000);
+    }
+
+    SECTION("extreme values and merging") {
+        art::latency_histogram a, b;
+        a.record(0);
+        b.record(UINT64_MAX);
+        a += b;
+        REQUIRE(a.count() == 2);
+        REQUIRE(a.percentile(50) == 0);
+        REQUIRE(a.percentile(99) == UINT64_MAX);
+        a.reset();
+        REQUIRE(a.count() == 0);
+
+        art::latency_histogram coarse(3);
+        REQUIRE_THROWS_AS(a += coarse, std::invalid_argument);
+    }
+}
+
+TEST_CASE("Instrumented radix map", "[radix_map]") {
+    typedef art::instrumented_radix_map<art::radix_map<uint64_t, int> > map_type;
+
+    SECTION("operations are forwarded and every call timed") {
+        map_type map(1);
+        for (int i = 0; i < 100; i++)
+            REQUIRE(map.insert(std::make_pair(uint64_t(i * 2), i)).second);
+        REQUIRE_FALSE(map.insert(std::make_pair(uint64_t(0), 5)).second);
+        REQUIRE(map.size() == 100);
+
+        REQUIRE(map.find(10)->second == 5);
+        REQUIRE(map.find(11) == map.end());
+        REQUIRE(map.lower_bound(11)->first == 12);
+        REQUIRE(map.erase(12) == 1);
+        REQUIRE(map.erase(12) == 0);
+
+        size_t visited = 0;
+        for (map_type::const_iterator it = map.begin(); it != map.end(); ++it)
+            visited++;
+        REQUIRE(visited == 99);
+
+        REQUIRE(map.latency(art::timed_operation::insert).count() == 101);
+        REQUIRE(map.latency(art::timed_operation::find).count() == 2);
+        REQUIRE(map.latency(art::timed_operation::lower_bound).count() == 1);
+        REQUIRE(map.latency(art::timed_operation::erase).count() == 2);
+        REQUIRE(map.latency(art::timed_operation::iteration).count() == 99);
+
+        map.reset_latency();
+        REQUIRE(map.latency(art::timed_operation::insert).count() == 0);
+    }
+
+    SECTION("sampling") {
+        map_type map(16);
+        for (int i = 0; i < 1600; i++)
+            map.insert(std::make_pair(uint64_t(i), i));
+        REQUIRE(map.latency(art::timed_operation::insert).count() == 100);
+
+        auto it = map.begin();
+        for (int i = 0; i < 800; i++)
+            it = map.erase(it);
+        REQUIRE(map.latency(art::timed_operation::erase).count() == 50);
+        REQUIRE(map.size() == 800);
+        REQUIRE(map.begin()->first == 800);
+
+        REQUIRE_THROWS_AS(map.set_sample_interval(0), std::invalid_argument);
+    }
+
+    SECTION("report") {
+        map_type map(1);
+        map.insert(std::make_pair(uint64_t(1), 1));
+        map.find(1);
+        std::ostringstream os;
+        map.report(os);
+        REQUIRE(os.str().find("find samples=1 p50=") == 0);
+        REQUIRE(os.str().find("insert samples=1 ") != std::string::npos);
+        REQUIRE(os.str().find("iteration samples=0 p50=0 p99=0 p999=0 max=0\n") != std::string::npos);
+    }
+
+    SECTION("sets") {
+        art::instrumented_radix_map<art::radix_set<int32_t> > set(1);
+        for (int32_t i = -50; i < 50; i++)
+            set.insert(i);
+        REQUIRE(*set.lower_bound(-60) == -50);
+        REQUIRE(set.find(7) != set.end());
+        const auto &const_set = set;
+        REQUIRE(const_set.find(100) == const_set.end());
+        REQUIRE(set.latency(art::timed_operation::find).count() == 2);
+    }
+}
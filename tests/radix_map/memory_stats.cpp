@@ -0,0 +1,88 @@
+#include <numeric>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+
+namespace {
+    size_t sum(const std::vector<size_t> &histogram) {
+        return std::accumulate(histogram.begin(), histogram.end(), size_t(0));
+    }
+
+    size_t children(const art::memory_stats::node_stats &stats) {
+        size_t count = 0;
+        for (size_t i = 0; i < stats.fill.size(); i++)
+            count += i * stats.fill[i];
+        return count;
+    }
+
+    // Invariants every tree with at least two elements has to satisfy
+    void check_consistent(const art::memory_stats &stats, size_t size) {
+        REQUIRE(stats.leaves == size);
+        REQUIRE(sum(stats.depth) == size);
+        REQUIRE(sum(stats.prefix_length) == stats.inner_nodes());
+        for (const art::memory_stats::node_stats *type : {&stats.node_4, &stats.node_16, &stats.node_48,
+                                                          &stats.node_256})
+            REQUIRE(sum(type->fill) == type->count);
+
+        // every node but the root is the child of one inner node
+        const size_t all_children = children(stats.node_4) + children(stats.node_16) +
+                                    children(stats.node_48) + children(stats.node_256);
+        REQUIRE(all_children == stats.inner_nodes() + stats.leaves - 1);
+        REQUIRE(stats.total_bytes() == stats.inner_bytes() + stats.leaf_bytes + stats.fixed_bytes);
+    }
+}
+
+TEST_CASE("Memory statistics", "[radix_map]") {
+    std::mt19937 gen(41);
+
+    SECTION("empty map") {
+        art::radix_map<uint64_t, int> map;
+        const art::memory_stats stats = map.memory_stats();
+        REQUIRE(stats.leaves == 0);
+        REQUIRE(stats.inner_nodes() == 0);
+        REQUIRE(stats.total_bytes() == stats.fixed_bytes);
+        REQUIRE(stats.fixed_bytes > 0);
+        REQUIRE(stats.node_4.fill_factor() == 0.0);
+    }
+
+    SECTION("dense keys fill the lower levels") {
+        art::radix_map<uint32_t, int> map;
+        for (uint32_t i = 0; i < 65536; i++)
+            map.insert(std::make_pair(i, (int) i));
+        const art::memory_stats stats = map.memory_stats();
+        check_consistent(stats, map.size());
+        REQUIRE(stats.node_256.fill[256] == 257);
+        REQUIRE(stats.node_256.fill_factor() == 1.0);
+        REQUIRE(stats.depth.size() > 1);
+        REQUIRE(stats.depth.back() == 65536);
+    }
+
+    SECTION("random keys, with path compression") {
+        std::uniform_int_distribution<uint64_t> dis;
+        art::radix_map<uint64_t, int> map;
+        for (int i = 0; i < 100000; i++)
+            map.insert(std::make_pair(dis(gen), i));
+        const art::memory_stats stats = map.memory_stats();
+        check_consistent(stats, map.size());
+        // keys diverge in the first bytes, deeper nodes skip the bytes their keys share
+        REQUIRE(stats.prefix_length[0] < stats.inner_nodes());
+        REQUIRE(stats.node_256.count >= 1);
+        REQUIRE(stats.node_4.count > 0);
+
+        // shrinking the map shrinks the nodes
+        auto it = map.begin();
+        for (int i = 0; i < 90000; i++)
+            it = map.erase(it);
+        const art::memory_stats shrunk = map.memory_stats();
+        check_consistent(shrunk, map.size());
+        REQUIRE(shrunk.total_bytes() * 5 < stats.total_bytes());
+    }
+
+    SECTION("sets") {
+        std::uniform_int_distribution<int32_t> dis(-100000, 100000);
+        art::radix_set<int32_t> set;
+        for (int i = 0; i < 20000; i++)
+            set.insert(dis(gen));
+        check_consistent(set.memory_stats(), set.size());
+    }
+}
@@ -221,6 +221,68 @@ TEST_CASE("Erase with iterators", "[radix-map]") {
         REQUIRE(radix_map.find(54) == radix_map.end());
         REQUIRE(radix_map.find(241) == radix_map.end());
     }
+
+    SECTION ("Erase ranges up to the end") {
+        map.erase(map.find(9000), map.end());
+        auto it = radix_map.erase(radix_map.find(9000), radix_map.end());
+        REQUIRE(it == radix_map.end());
+        REQUIRE(map.size() == radix_map.size());
+        REQUIRE((--radix_map.end())->first == 8999);
+    }
+}
+
+template<typename _Key>
+void erase_random_ranges(_Key min_key, _Key max_key) {
+    std::map<_Key, int> map;
+    art::radix_map<_Key, int> radix_map;
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<_Key> dis(min_key, max_key);
+
+    for (int i = 0; i < 20000; i++) {
+        auto k = dis(gen);
+        map.insert(std::make_pair(k, i));
+        radix_map.insert(std::make_pair(k, i));
+    }
+
+    while (!map.empty()) {
+        _Key lo = dis(gen);
+        _Key hi = lo + (max_key - min_key) / 50;
+        if (hi < lo)
+            hi = max_key;
+
+        size_t expected = std::distance(map.lower_bound(lo), map.lower_bound(hi));
+        map.erase(map.lower_bound(lo), map.lower_bound(hi));
+        REQUIRE(radix_map.erase_range(lo, hi) == expected);
+        REQUIRE(radix_map.size() == map.size());
+        REQUIRE(std::equal(map.begin(), map.end(), radix_map.begin()));
+        REQUIRE(std::equal(map.rbegin(), map.rend(), radix_map.rbegin()));
+
+        if (map.size() < 1000) {
+            map.clear();
+            radix_map.erase(radix_map.begin(), radix_map.end());
+            REQUIRE(radix_map.empty());
+        }
+    }
+
+    // the tree is still usable afterwards
+    radix_map.insert(std::make_pair(min_key, 1));
+    REQUIRE(radix_map.size() == 1);
+    REQUIRE(radix_map.begin()->first == min_key);
+}
+
+TEST_CASE("Erase key ranges", "[radix-map]") {
+    SECTION ("32 bit keys") {
+        erase_random_ranges<int32_t>(-100000, 100000);
+    }
+
+    SECTION ("64 bit keys") {
+        erase_random_ranges<uint64_t>(0, std::numeric_limits<uint64_t>::max());
+    }
+
+    SECTION ("dense 64 bit keys") {
+        erase_random_ranges<uint64_t>(0, 40000);
+    }
 }
 
 TEST_CASE("Operator[]", "[radix-map]") {
@@ -0,0 +1,144 @@
+#include <map>
+#include "catch.hpp"
+#include "art/radix_map.h"
+
+namespace {
+    // Checks rank() and select() of every element and count_range() of random ranges
+    template<typename _Map, typename _Reference>
+    void require_order_statistics(const _Map &radix_map, const _Reference &reference) {
+        REQUIRE(radix_map.size() == reference.size());
+
+        size_t rank = 0;
+        for (auto it = reference.begin(); it != reference.end(); ++it, ++rank) {
+            REQUIRE(radix_map.rank(it->first) == rank);
+            REQUIRE(*radix_map.select(rank) == *it);
+        }
+        REQUIRE(radix_map.select(reference.size()) == radix_map.end());
+    }
+
+    template<typename _Key>
+    void random_order_statistics(_Key min_key, _Key max_key) {
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<_Key> key_dis(min_key, max_key);
+        art::radix_map<_Key, int, art::key_transform<_Key>, true> radix_map;
+        std::map<_Key, int> reference;
+
+        for (int i = 0; i < 20000; i++) {
+            _Key k = key_dis(gen);
+            REQUIRE(radix_map.insert(std::make_pair(k, i)).second == reference.insert(std::make_pair(k, i)).second);
+        }
+        require_order_statistics(radix_map, reference);
+
+        SECTION ("rank of keys not in the map and count_range") {
+            for (int i = 0; i < 2000; i++) {
+                _Key lo = key_dis(gen), hi = key_dis(gen);
+                REQUIRE(radix_map.rank(lo) == (size_t) std::distance(reference.begin(), reference.lower_bound(lo)));
+                size_t expected = lo < hi ? std::distance(reference.lower_bound(lo), reference.lower_bound(hi)) : 0;
+                REQUIRE(radix_map.count_range(lo, hi) == expected);
+            }
+        }
+
+        SECTION ("counts stay correct after erase") {
+            for (int i = 0; i < 20000; i++) {
+                _Key k = key_dis(gen);
+                REQUIRE(radix_map.erase(k) == reference.erase(k));
+            }
+            auto it = radix_map.begin();
+            for (int i = 0; i < 100 && it != radix_map.end(); i++) {
+                reference.erase(it->first);
+                it = radix_map.erase(it);
+            }
+            require_order_statistics(radix_map, reference);
+        }
+
+        SECTION ("counts stay correct after bulk operations") {
+            auto lo = std::next(reference.begin(), reference.size() / 4)->first;
+            auto hi = std::next(reference.begin(), reference.size() / 2)->first;
+            const size_t in_range = radix_map.count_range(lo, hi);
+            REQUIRE(radix_map.erase_range(lo, hi) == in_range);
+            reference.erase(reference.lower_bound(lo), reference.lower_bound(hi));
+            require_order_statistics(radix_map, reference);
+
+            typedef typename art::radix_map<_Key, int, art::key_transform<_Key>, true>::batch_op_type op_type;
+            std::vector<op_type> batch;
+            std::map<_Key, int> batch_keys;
+            for (int i = 0; i < 5000; i++)
+                batch_keys[key_dis(gen)] = i;
+            for (auto &p : batch_keys) {
+                auto kind = static_cast<art::batch_op_kind>(p.second % 3);
+                batch.push_back(op_type(kind, p));
+                if (kind == art::batch_op_kind::erase)
+                    reference.erase(p.first);
+                else if (kind == art::batch_op_kind::assign)
+                    reference[p.first] = p.second;
+                else
+                    reference.insert(p);
+            }
+            radix_map.apply_sorted_batch(batch.begin(), batch.end());
+            require_order_statistics(radix_map, reference);
+
+            _Key prefix = reference.rbegin()->first;
+            radix_map.erase_prefix(prefix, sizeof(_Key) - 1);
+            for (auto it = reference.begin(); it != reference.end();) {
+                art::key_transform<_Key> transform;
+                auto a = transform(it->first), b = transform(prefix);
+                if (!std::memcmp(&a, &b, sizeof(_Key) - 1))
+                    it = reference.erase(it);
+                else
+                    ++it;
+            }
+            require_order_statistics(radix_map, reference);
+
+            art::radix_map<_Key, int, art::key_transform<_Key>, true> copy(radix_map);
+            require_order_statistics(copy, reference);
+        }
+    }
+}
+
+TEST_CASE("Order statistics (32 bit keys)", "[radix-map]") {
+    random_order_statistics<int32_t>(-100000, 100000);
+}
+
+TEST_CASE("Order statistics (64 bit keys)", "[radix-map]") {
+    SECTION ("dense") {
+        random_order_statistics<uint64_t>(0, 100000);
+    }
+    SECTION ("sparse") {
+        random_order_statistics<uint64_t>(0, std::numeric_limits<uint64_t>::max());
+    }
+}
+
+TEST_CASE("Order statistics with long common prefixes", "[radix-map]") {
+    // keys share more bytes than fit into a node prefix
+    art::radix_map<std::string, int, art::key_transform<std::string>, true> radix_map;
+    std::map<std::string, int> reference;
+    const std::string common = "a long common prefix of all keys ";
+    for (int i = 0; i < 1000; i++) {
+        std::string key = common + std::to_string(i * 7919 % 1000);
+        radix_map.insert(std::make_pair(key, i));
+        reference.insert(std::make_pair(key, i));
+    }
+    require_order_statistics(radix_map, reference);
+
+    REQUIRE(radix_map.rank("a") == 0);
+    REQUIRE(radix_map.rank(common) == 0);
+    REQUIRE(radix_map.rank("a long common prefix of all keyz") == reference.size());
+    REQUIRE(radix_map.rank("b") == reference.size());
+    REQUIRE(radix_map.count_range(common + "5", common + "6") == 111);
+}
+
+TEST_CASE("Split points", "[radix-map]") {
+    art::radix_map<int, int, art::key_transform<int>, true> radix_map;
+    REQUIRE(radix_map.split_points(4).empty());
+
+    for (int i = 0; i < 1000; i++)
+        radix_map.insert(std::make_pair(i * 3, i));
+
+    auto points = radix_map.split_points(4);
+    REQUIRE(points == std::vector<int>({750, 1500, 2250}));
+    REQUIRE(radix_map.count_range(0, points[0]) == 250);
+
+    REQUIRE(radix_map.split_points(1).empty());
+    REQUIRE(radix_map.split_points(1000).size() == 999);
+    REQUIRE(radix_map.split_points(5000).size() == 999);
+}
@@ -0,0 +1,125 @@
+#include <map>
+#include "catch.hpp"
+#include "art/radix_map.h"
+
+namespace {
+    typedef std::pair<uint32_t, uint32_t> tenant_key;
+
+    // Reference count of keys in [lo, hi) of a std::map
+    template<typename _Map>
+    size_t count_between(const _Map &map, const typename _Map::key_type &lo, const typename _Map::key_type &hi) {
+        return std::distance(map.lower_bound(lo), map.lower_bound(hi));
+    }
+}
+
+TEST_CASE("Prefix operations on compound keys", "[radix-map]") {
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<uint32_t> tenant_dis(0, 50);
+    std::uniform_int_distribution<uint32_t> id_dis(0, 100000);
+
+    art::radix_map<tenant_key, int> radix_map;
+    std::map<tenant_key, int> reference;
+    for (int i = 0; i < 20000; i++) {
+        tenant_key k(tenant_dis(gen), id_dis(gen));
+        radix_map.insert(std::make_pair(k, i));
+        reference.insert(std::make_pair(k, i));
+    }
+
+    SECTION ("prefix_range and count_prefix select one tenant") {
+        const auto &const_map = radix_map;
+        for (uint32_t tenant = 0; tenant <= 51; tenant++) {
+            auto lo = reference.lower_bound(tenant_key(tenant, 0));
+            auto hi = reference.lower_bound(tenant_key(tenant + 1, 0));
+            auto range = radix_map.prefix_range(tenant_key(tenant, 0), 4);
+            REQUIRE(std::distance(range.first, range.second) == std::distance(lo, hi));
+            REQUIRE(std::equal(lo, hi, range.first));
+            REQUIRE(const_map.count_prefix(tenant_key(tenant, 123), 4) == (size_t) std::distance(lo, hi));
+
+            auto const_range = const_map.prefix_range(tenant_key(tenant, 0), 4);
+            REQUIRE(const_range.first == range.first);
+            REQUIRE(const_range.second == range.second);
+        }
+    }
+
+    SECTION ("full length prefix matches a single key") {
+        for (auto &p : reference) {
+            REQUIRE(radix_map.count_prefix(p.first, 8) == 1);
+            REQUIRE(radix_map.prefix_range(p.first, 8).first->second == p.second);
+        }
+        REQUIRE(radix_map.count_prefix(tenant_key(100, 0), 8) == 0);
+        REQUIRE(radix_map.count_prefix(tenant_key(100, 0), 0) == reference.size());
+    }
+
+    SECTION ("erase_prefix drops whole tenants") {
+        for (uint32_t tenant = 0; tenant <= 51; tenant += 3) {
+            size_t expected = count_between(reference, tenant_key(tenant, 0), tenant_key(tenant + 1, 0));
+            reference.erase(reference.lower_bound(tenant_key(tenant, 0)),
+                            reference.lower_bound(tenant_key(tenant + 1, 0)));
+            REQUIRE(radix_map.erase_prefix(tenant_key(tenant, 0), 4) == expected);
+            REQUIRE(radix_map.size() == reference.size());
+        }
+        REQUIRE(std::equal(reference.begin(), reference.end(), radix_map.begin()));
+        REQUIRE(std::equal(reference.rbegin(), reference.rend(), radix_map.rbegin()));
+
+        REQUIRE(radix_map.erase_prefix(tenant_key(0, 0), 0) == reference.size());
+        REQUIRE(radix_map.empty());
+        REQUIRE(radix_map.begin() == radix_map.end());
+    }
+}
+
+TEST_CASE("Prefix operations on string keys", "[radix-map]") {
+    art::radix_map<std::string, int> radix_map;
+    std::map<std::string, int> reference;
+    std::vector<std::string> words = {"a", "ab", "abc", "abcd", "abd", "abdominal", "b", "ba", "banana",
+                                      "band", "bandana", "bandwidth", "c", "cat", "catalog", "category"};
+    for (size_t i = 0; i < words.size(); i++) {
+        radix_map.insert(std::make_pair(words[i], (int) i));
+        reference.insert(std::make_pair(words[i], (int) i));
+    }
+
+    for (const std::string prefix : {"a", "ab", "abd", "band", "cat", "catx", "d", "bandwidth"}) {
+        auto lo = reference.lower_bound(prefix);
+        auto hi = lo;
+        while (hi != reference.end() && hi->first.compare(0, prefix.size(), prefix) == 0)
+            ++hi;
+
+        auto range = radix_map.prefix_range(prefix, prefix.size());
+        REQUIRE(std::distance(range.first, range.second) == std::distance(lo, hi));
+        REQUIRE(std::equal(lo, hi, range.first));
+        REQUIRE(radix_map.count_prefix(prefix, prefix.size()) == (size_t) std::distance(lo, hi));
+    }
+
+    REQUIRE(radix_map.erase_prefix(std::string("band"), 4) == 3);
+    REQUIRE(radix_map.erase_prefix(std::string("ab"), 2) == 5);
+    REQUIRE(radix_map.erase_prefix(std::string("ab"), 2) == 0);
+    REQUIRE(radix_map.size() == words.size() - 8);
+    REQUIRE(radix_map.count_prefix(std::string("a"), 1) == 1);
+    REQUIRE(radix_map.count_prefix(std::string("b"), 1) == 3);
+    REQUIRE(radix_map.find("banana") != radix_map.end());
+    REQUIRE(radix_map.find("bandana") == radix_map.end());
+}
+
+TEST_CASE("Prefix operations on integer keys", "[radix-map]") {
+    // the transformed keys are big endian, so a prefix selects a block of consecutive keys
+    art::radix_map<uint32_t, int> radix_map;
+    std::map<uint32_t, int> reference;
+    for (uint32_t k = 0; k < 300000; k += 3) {
+        radix_map.insert(std::make_pair(k, (int) k));
+        reference.insert(std::make_pair(k, (int) k));
+    }
+
+    for (uint32_t block = 0; block < 6; block++) {
+        uint32_t lo = block << 16;
+        REQUIRE(radix_map.count_prefix(lo, 2) == count_between(reference, lo, lo + 0x10000));
+    }
+    REQUIRE(radix_map.count_prefix(0x1200u, 3) == count_between(reference, 0x1200u, 0x1300u));
+
+    REQUIRE(radix_map.erase_prefix(0x20000u, 2) == count_between(reference, 0x20000u, 0x30000u));
+    REQUIRE(radix_map.erase_prefix(0x1234u, 4) == 0);
+    REQUIRE(radix_map.erase_prefix(0x1233u, 4) == 1);
+    reference.erase(reference.lower_bound(0x20000u), reference.lower_bound(0x30000u));
+    reference.erase(0x1233u);
+    REQUIRE(radix_map.size() == reference.size());
+    REQUIRE(std::equal(reference.begin(), reference.end(), radix_map.begin()));
+    REQUIRE(std::equal(reference.rbegin(), reference.rend(), radix_map.rbegin()));
+}
@@ -0,0 +1,157 @@
+#include <map>
+#include <sstream>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+
+namespace {
+    template<typename _Map>
+    void round_trip(const _Map &map) {
+        std::stringstream stream;
+        map.save(stream);
+
+        _Map loaded;
+        loaded.load(stream);
+        REQUIRE(loaded.size() == map.size());
+        REQUIRE(std::equal(map.begin(), map.end(), loaded.begin()));
+        REQUIRE(loaded == map);
+    }
+}
+
+TEST_CASE("Save and load maps", "[radix_map]") {
+    std::mt19937 gen(42);
+
+    SECTION("empty map") {
+        round_trip(art::radix_map<uint32_t, int>());
+    }
+
+    SECTION("unsigned keys, without path compression") {
+        std::uniform_int_distribution<uint32_t> dis;
+        art::radix_map<uint32_t, int> map;
+        for (int i = 0; i < 100000; i++)
+            map.insert(std::make_pair(dis(gen), i));
+        map.insert(std::make_pair(0, -1));
+        map.insert(std::make_pair(std::numeric_limits<uint32_t>::max(), -2));
+        round_trip(map);
+    }
+
+    SECTION("signed keys, with path compression") {
+        std::uniform_int_distribution<int64_t> dis(-1000000, 1000000);
+        art::radix_map<int64_t, double> map;
+        for (int i = 0; i < 100000; i++)
+            map.insert(std::make_pair(dis(gen), i * 0.5));
+        map.insert(std::make_pair(std::numeric_limits<int64_t>::min(), 1.0));
+        map.insert(std::make_pair(std::numeric_limits<int64_t>::max(), 2.0));
+        round_trip(map);
+    }
+
+    SECTION("compound keys are stored raw") {
+        std::uniform_int_distribution<int32_t> dis(-100, 100);
+        art::radix_map<std::pair<int32_t, int32_t>, int> map;
+        for (int i = 0; i < 10000; i++)
+            map.insert(std::make_pair(std::make_pair(dis(gen), dis(gen)), i));
+        round_trip(map);
+    }
+
+    SECTION("dense keys take about a byte each") {
+        art::radix_map<uint64_t, uint8_t> map;
+        for (uint64_t i = 0; i < 10000; i++)
+            map.insert(std::make_pair(1000000 + i, (uint8_t) i));
+
+        std::stringstream stream;
+        map.save(stream);
+        REQUIRE(stream.str().size() < 28 + 2 * 10000 + 8);
+        round_trip(map);
+    }
+
+    SECTION("loaded maps keep order statistics and can be modified") {
+        art::radix_map<uint32_t, int, art::key_transform<uint32_t>, true> map;
+        for (uint32_t i = 0; i < 5000; i++)
+            map.insert(std::make_pair(i * 7, (int) i));
+
+        std::stringstream stream;
+        map.save(stream);
+        decltype(map) loaded;
+        loaded.insert(std::make_pair(3, 3));
+        loaded.load(stream);
+
+        REQUIRE(loaded.count(3) == 0);
+        REQUIRE(loaded.rank(700) == 100);
+        REQUIRE(loaded.select(4999)->first == 4999 * 7);
+        loaded.insert(std::make_pair(3, 3));
+        loaded.erase(0);
+        REQUIRE(loaded.size() == 5000);
+        REQUIRE(loaded.rank(700) == 100);
+    }
+}
+
+TEST_CASE("Save and load sets", "[radix_set]") {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint64_t> dis;
+    art::radix_set<uint64_t> set;
+    for (int i = 0; i < 50000; i++)
+        set.insert(dis(gen));
+
+    std::stringstream stream;
+    set.save(stream);
+    art::radix_set<uint64_t> loaded;
+    loaded.load(stream);
+    REQUIRE(loaded.size() == set.size());
+    REQUIRE(std::equal(set.begin(), set.end(), loaded.begin()));
+}
+
+TEST_CASE("Loading invalid images", "[radix_map]") {
+    art::radix_map<uint32_t, int> map;
+    for (uint32_t i = 0; i < 1000; i++)
+        map.insert(std::make_pair(i * 3, (int) i));
+    std::stringstream stream;
+    map.save(stream);
+    const std::string image = stream.str();
+
+    art::radix_map<uint32_t, int> target;
+    target.insert(std::make_pair(1, 1));
+
+    SECTION("truncated image leaves the map unchanged") {
+        std::stringstream truncated(image.substr(0, image.size() - 5));
+        REQUIRE_THROWS_AS(target.load(truncated), art::serialization_error);
+        REQUIRE(target.size() == 1);
+        REQUIRE(target.at(1) == 1);
+    }
+
+    SECTION("wrong magic") {
+        std::string broken = image;
+        broken[0] = 'X';
+        std::stringstream in(broken);
+        REQUIRE_THROWS_AS(target.load(in), art::serialization_error);
+    }
+
+    SECTION("different value type") {
+        std::stringstream in(image);
+        art::radix_map<uint32_t, double> other;
+        REQUIRE_THROWS_AS(other.load(in), art::serialization_error);
+    }
+
+    SECTION("map image into a set") {
+        std::stringstream in(image);
+        art::radix_set<uint32_t> set;
+        REQUIRE_THROWS_AS(set.load(in), art::serialization_error);
+    }
+
+    SECTION("keys out of order") {
+        art::radix_map<uint32_t, int> two;
+        two.insert(std::make_pair(5, 0));
+        two.insert(std::make_pair(6, 0));
+        std::stringstream in;
+        two.save(in);
+
+        // 28 byte header, delta 5, mapped value, then delta 1 to the second key:
+        // replace it by 2^32 - 1 so that the second key decodes to 4
+        std::string descending = in.str();
+        const size_t second_delta = 28 + 1 + sizeof(int);
+        REQUIRE(descending[second_delta] == 1);
+        descending.replace(second_delta, 1, std::string("\xFF\xFF\xFF\xFF\x0F", 5));
+        std::stringstream broken(descending);
+        REQUIRE_THROWS_AS(target.load(broken), art::serialization_error);
+        REQUIRE(target.size() == 1);
+    }
+}
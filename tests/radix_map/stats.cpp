@@ -0,0 +1,83 @@
+// the counters are compiled in per translation unit, so the maps below use
+// their own key transformations to get instantiations of their own
+#define ART_STATS
+
+#include <thread>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/stats.h"
+
+namespace {
+    template<typename _Key>
+    struct counting_transform : art::key_transform<_Key> {
+    };
+
+    uint64_t get(art::counter s) {
+        return art::stats::local()[s];
+    }
+}
+
+TEST_CASE("Operation counters", "[radix_map]") {
+    art::stats::reset();
+    REQUIRE(art::stats::collect()[art::counter::lookups] == 0);
+
+    SECTION("growing, lookups, iteration and shrinking") {
+        art::radix_map<uint32_t, int, counting_transform<uint32_t> > map;
+        for (uint32_t i = 0; i < 1000; i++)
+            map.insert(std::make_pair(i, (int) i));
+        REQUIRE(get(art::counter::leaf_splits) > 0);
+        REQUIRE(get(art::counter::grow_4) > 0);
+        REQUIRE(get(art::counter::grow_16) > 0);
+        REQUIRE(get(art::counter::grow_48) > 0);
+        REQUIRE(get(art::counter::lookups) == 0);
+
+        for (uint32_t i = 0; i < 100; i++)
+            REQUIRE(map.find(i * 7) != map.end());
+        REQUIRE(get(art::counter::lookups) == 100);
+        REQUIRE(get(art::counter::lookup_nodes) >= 200);
+
+        size_t visited = 0;
+        for (auto it = map.begin(); it != map.end(); ++it)
+            visited++;
+        REQUIRE(visited == 1000);
+        REQUIRE(get(art::counter::successor_climbs) > 0);
+
+        for (uint32_t i = 0; i < 1000; i++)
+            map.erase(i);
+        REQUIRE(get(art::counter::shrink_256) > 0);
+        REQUIRE(get(art::counter::shrink_48) > 0);
+        REQUIRE(get(art::counter::shrink_16) > 0);
+    }
+
+    SECTION("long shared prefixes") {
+        typedef std::pair<uint64_t, uint64_t> key_type;
+        art::radix_map<key_type, int, counting_transform<key_type> > map;
+        for (uint64_t i = 0; i < 1000; i++)
+            map.insert(std::make_pair(key_type(7, i * 1000), (int) i));
+        map.insert(std::make_pair(key_type(7, uint64_t(1) << 40), -1));
+        REQUIRE(get(art::counter::prefix_splits) > 0);
+        REQUIRE(get(art::counter::optimistic_prefix_loads) > 0);
+    }
+
+    SECTION("counters are per thread and merged") {
+        art::radix_map<uint32_t, int, counting_transform<uint32_t> > map;
+        map.insert(std::make_pair(1, 1));
+
+        uint64_t worker_lookups = 0;
+        std::thread worker([&map, &worker_lookups]() {
+            for (int i = 0; i < 50; i++)
+                map.find(1);
+            worker_lookups = art::stats::local()[art::counter::lookups];
+        });
+        worker.join();
+        REQUIRE(worker_lookups == 50);
+
+        map.find(1);
+        REQUIRE(get(art::counter::lookups) == 1);
+        REQUIRE(art::stats::collect()[art::counter::lookups] == 51);
+
+        art::stats::reset();
+        REQUIRE(art::stats::collect()[art::counter::lookups] == 0);
+        REQUIRE(std::string(art::operation_stats::name(art::counter::successor_climbs)) == "successor_climbs");
+    }
+}
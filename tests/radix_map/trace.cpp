@@ -0,0 +1,133 @@
+#include <sstream>
+#include <vector>
+#include "catch.hpp"
+#include "art/radix_map.h"
+#include "art/radix_set.h"
+#include "art/recording_radix_map.h"
+
+namespace {
+    template<typename _Key>
+    std::vector<art::trace_event<_Key> > read_all(const std::string &trace) {
+        std::istringstream in(trace);
+        art::trace_reader<_Key> reader(in);
+        std::vector<art::trace_event<_Key> > events;
+        art::trace_event<_Key> event;
+        while (reader.next(event))
+            events.push_back(event);
+        return events;
+    }
+}
+
+TEST_CASE("Operation trace", "[radix_map]") {
+    SECTION("round trip") {
+        std::ostringstream out;
+        {
+            art::trace_writer<int64_t> writer(out);
+            writer.record(art::trace_op::insert, 42);
+            writer.record(art::trace_op::find, -7);
+            writer.record(art::trace_op::scan, INT64_MIN, 100);
+            writer.record(art::trace_op::erase, INT64_MAX);
+            REQUIRE(writer.records() == 4);
+        }
+        const auto events = read_all<int64_t>(out.str());
+        REQUIRE(events.size() == 4);
+        REQUIRE(events[0].op == art::trace_op::insert);
+        REQUIRE(events[0].key == 42);
+        REQUIRE(events[1].op == art::trace_op::find);
+        REQUIRE(events[1].key == -7);
+        REQUIRE(events[2].op == art::trace_op::scan);
+        REQUIRE(events[2].key == INT64_MIN);
+        REQUIRE(events[2].length == 100);
+        REQUIRE(events[3].op == art::trace_op::erase);
+        REQUIRE(events[3].key == INT64_MAX);
+        REQUIRE(events[3].length == 0);
+
+        std::istringstream in(out.str());
+        REQUIRE(art::trace_key_size(in) == sizeof(int64_t));
+    }
+
+    SECTION("nearby keys take few bytes") {
+        std::ostringstream out;
+        {
+            art::trace_writer<uint64_t> writer(out);
+            for (uint64_t k = 1000000; k < 1010000; k++)
+                writer.record(art::trace_op::find, k);
+        }
+        // header, a byte for the operation and one for the delta, terminator
+        REQUIRE(out.str().size() <= 20 + 10000 * 2 + 8);
+    }
+
+    SECTION("invalid traces") {
+        std::ostringstream out;
+        {
+            art::trace_writer<uint32_t> writer(out);
+            writer.record(art::trace_op::insert, 1);
+            writer.record(art::trace_op::insert, 2);
+        }
+        const std::string trace = out.str();
+        REQUIRE_THROWS_AS(read_all<uint64_t>(trace), art::serialization_error);
+        REQUIRE_THROWS_AS(read_all<uint32_t>(trace.substr(0, trace.size() - 1)), art::serialization_error);
+        REQUIRE_THROWS_AS(read_all<uint32_t>("ART\2 definitely not a trace"), art::serialization_error);
+
+        std::istringstream in("not a trace at all");
+        REQUIRE_THROWS_AS(art::trace_key_size(in), art::serialization_error);
+
+        std::string corrupt = trace;
+        corrupt[20] = 99;
+        REQUIRE_THROWS_AS(read_all<uint32_t>(corrupt), art::serialization_error);
+    }
+}
+
+TEST_CASE("Recording radix map", "[radix_map]") {
+    SECTION("records every operation in call order") {
+        art::radix_map<uint64_t, int> initial;
+        initial.insert(std::make_pair(10u, 1));
+        initial.insert(std::make_pair(5u, 2));
+
+        std::ostringstream out;
+        {
+            art::recording_radix_map<art::radix_map<uint64_t, int> > m(initial, out);
+            REQUIRE(m.records() == 2);
+            REQUIRE(m.insert(std::make_pair(20u, 3)).second);
+            REQUIRE(m.find(10)->second == 1);
+            REQUIRE(m.find(11) == m.end());
+            REQUIRE(m.lower_bound(6)->first == 10);
+            std::vector<uint64_t> seen;
+            REQUIRE(m.scan(6, 5, [&](const std::pair<const uint64_t, int> &x) { seen.push_back(x.first); }) == 2);
+            REQUIRE(seen == std::vector<uint64_t>({10, 20}));
+            REQUIRE(m.erase(5) == 1);
+            REQUIRE(m.size() == 2);
+            // not recorded
+            m.map().insert(std::make_pair(30u, 4));
+            REQUIRE(m.records() == 8);
+        }
+
+        const auto events = read_all<uint64_t>(out.str());
+        const art::trace_op ops[] = {
+                art::trace_op::load, art::trace_op::load, art::trace_op::insert, art::trace_op::find,
+                art::trace_op::find, art::trace_op::lower_bound, art::trace_op::scan, art::trace_op::erase
+        };
+        const uint64_t keys[] = {5, 10, 20, 10, 11, 6, 6, 5};
+        REQUIRE(events.size() == 8);
+        for (size_t i = 0; i < events.size(); i++) {
+            REQUIRE(events[i].op == ops[i]);
+            REQUIRE(events[i].key == keys[i]);
+        }
+        REQUIRE(events[6].length == 5);
+    }
+
+    SECTION("sets") {
+        std::ostringstream out;
+        {
+            art::recording_radix_map<art::radix_set<int32_t> > s(out);
+            s.insert(-3);
+            s.insert(8);
+            REQUIRE(s.find(-3) != s.end());
+            s.close();
+        }
+        const auto events = read_all<int32_t>(out.str());
+        REQUIRE(events.size() == 3);
+        REQUIRE(events[0].key == -3);
+        REQUIRE(events[2].op == art::trace_op::find);
+    }
+}
@@ -0,0 +1,116 @@
+#include <map>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "art/sharded_radix_map.h"
+
+TEST_CASE("Sharded radix map single threaded", "[sharded_radix_map]") {
+    art::sharded_radix_map<int32_t, int, 16> m;
+    std::map<int32_t, int> reference;
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<int32_t> key_dis(std::numeric_limits<int32_t>::min(),
+                                                   std::numeric_limits<int32_t>::max());
+    std::uniform_int_distribution<int> kind_dis(0, 2);
+
+    for (int i = 0; i < 30000; i++) {
+        int32_t key = key_dis(gen);
+        switch (kind_dis(gen)) {
+            case 0:
+                REQUIRE(m.insert(std::make_pair(key, i)) == reference.insert(std::make_pair(key, i)).second);
+                break;
+            case 1: {
+                bool inserted = reference.find(key) == reference.end();
+                reference[key] = i;
+                REQUIRE(m.insert_or_assign(key, i) == inserted);
+                break;
+            }
+            default:
+                if (!reference.empty() && i % 2) {
+                    auto it = reference.lower_bound(key);
+                    if (it == reference.end())
+                        --it;
+                    key = it->first;
+                }
+                REQUIRE(m.erase(key) == reference.erase(key));
+        }
+    }
+    REQUIRE(m.size() == reference.size());
+
+    SECTION("Lookup") {
+        for (auto &p : reference) {
+            int value = -1;
+            REQUIRE(m.find(p.first, value));
+            REQUIRE(value == p.second);
+            REQUIRE(m.count(p.first) == 1);
+        }
+        REQUIRE_THROWS_AS(m.at(reference.empty() ? 0 : reference.begin()->first - 1), std::out_of_range);
+    }
+
+    SECTION("Shards are consecutive key ranges") {
+        REQUIRE(m.shard_index(std::numeric_limits<int32_t>::min()) == 0);
+        REQUIRE(m.shard_index(-1) == 7);
+        REQUIRE(m.shard_index(0) == 8);
+        REQUIRE(m.shard_index(std::numeric_limits<int32_t>::max()) == 15);
+    }
+
+    SECTION("Ordered iteration over all shards") {
+        std::vector<std::pair<const int32_t, int> > visited;
+        m.for_each([&visited](const std::pair<const int32_t, int> &x) { visited.push_back(x); });
+        REQUIRE(visited.size() == reference.size());
+        REQUIRE(std::equal(visited.begin(), visited.end(), reference.begin()));
+    }
+
+    SECTION("Ordered iteration of a range") {
+        const int32_t lo = -200000000, hi = 900000000;
+        std::vector<std::pair<const int32_t, int> > visited;
+        m.for_each(lo, hi, [&visited](const std::pair<const int32_t, int> &x) { visited.push_back(x); });
+        REQUIRE(std::equal(visited.begin(), visited.end(), reference.lower_bound(lo)));
+        REQUIRE(visited.size() == (size_t) std::distance(reference.lower_bound(lo), reference.lower_bound(hi)));
+
+        size_t calls = 0;
+        m.for_each(hi, lo, [&calls](const std::pair<const int32_t, int> &) { calls++; });
+        REQUIRE(calls == 0);
+    }
+
+    SECTION("Clear") {
+        m.clear();
+        REQUIRE(m.empty());
+    }
+}
+
+TEST_CASE("Sharded radix map multi threaded", "[sharded_radix_map]") {
+    const unsigned threads = 8;
+    const uint64_t per_thread = 20000;
+    art::sharded_radix_map<uint64_t, uint64_t, 64> m;
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&m, t, per_thread]() {
+            for (uint64_t i = 0; i < per_thread; i++) {
+                // scattered keys, so every thread writes to every shard
+                uint64_t key = (i * threads + t) * 0x9E3779B97F4A7C15ULL;
+                m.insert(std::make_pair(key, i));
+                uint64_t value;
+                if (!m.find(key, value) || value != i)
+                    m.insert_or_assign(key, ~0ULL);
+                if (i % 2 == 0)
+                    m.erase(key);
+            }
+        }));
+    }
+    for (auto &w : workers)
+        w.join();
+
+    REQUIRE(m.size() == threads * per_thread / 2);
+    uint64_t previous = 0;
+    size_t visited = 0;
+    bool ordered = true;
+    m.for_each([&](const std::pair<const uint64_t, uint64_t> &x) {
+        ordered = ordered && (visited == 0 || previous < x.first) && x.second % 2 == 1;
+        previous = x.first;
+        visited++;
+    });
+    REQUIRE(ordered);
+    REQUIRE(visited == threads * per_thread / 2);
+}